@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlayerBufferBudget+Private.h
\ No newline at end of file
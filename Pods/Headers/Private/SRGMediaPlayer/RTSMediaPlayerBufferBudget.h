@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlayerBufferBudget.h
\ No newline at end of file
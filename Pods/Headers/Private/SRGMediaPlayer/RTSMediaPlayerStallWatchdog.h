@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlayerStallWatchdog.h
\ No newline at end of file
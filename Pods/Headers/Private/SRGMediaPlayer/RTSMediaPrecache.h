@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPrecache.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaResourceLoading+Private.h
\ No newline at end of file
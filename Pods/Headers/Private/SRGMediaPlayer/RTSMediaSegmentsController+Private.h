@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaSegmentsController+Private.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaTimeshiftBuffer.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaTimeshiftRecorder.h
\ No newline at end of file
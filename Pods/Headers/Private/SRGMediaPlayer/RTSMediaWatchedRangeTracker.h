@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaWatchedRangeTracker.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaBlackoutSchedule.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaCaptionIndex.h
\ No newline at end of file
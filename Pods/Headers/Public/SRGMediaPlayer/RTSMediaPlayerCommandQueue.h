@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlayerCommandQueue.h
\ No newline at end of file
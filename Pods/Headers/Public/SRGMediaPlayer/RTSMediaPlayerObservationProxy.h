@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlayerObservationProxy.h
\ No newline at end of file
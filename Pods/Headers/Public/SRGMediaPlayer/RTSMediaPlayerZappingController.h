@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlayerZappingController.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaPlaylistRewriter.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaSegmentIndex.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaTimeRangeSet.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSMediaTimeSchedule.h
\ No newline at end of file
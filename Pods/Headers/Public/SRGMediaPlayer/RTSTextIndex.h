@@ -0,0 +1 @@
+../../../../RTSMediaPlayer/RTSTextIndex.h
\ No newline at end of file
@@ -4,14 +4,12 @@
 //  License information is available from the LICENSE file.
 //
 
-#import <CoreMedia/CoreMedia.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
 #import <UIKit/UIKit.h>
 #import "Segment.h"
 
-@interface SegmentCollectionViewCell : UICollectionViewCell
+@interface SegmentCollectionViewCell : UICollectionViewCell <RTSSegmentedTimelineViewCell>
 
 @property (nonatomic, strong) Segment *segment;
 
-- (void)updateAppearanceWithTime:(CMTime)time identifier:(NSString *)identifier;
-
 @end
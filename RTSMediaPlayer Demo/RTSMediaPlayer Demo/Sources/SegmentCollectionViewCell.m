@@ -49,22 +49,12 @@
 	self.progressView.progress = 0.f;
 }
 
-#pragma mark - UI
+#pragma mark - RTSSegmentedTimelineViewCell protocol
 
-- (void)updateAppearanceWithTime:(CMTime)time identifier:(NSString *)identifier
+- (void)setActive:(BOOL)active progress:(float)progress
 {
-	if ([self.segment.segmentIdentifier isEqualToString:identifier]) {
-		CMTimeRange r = self.segment.timeRange;
-		float progress = (CMTimeGetSeconds(time) - CMTimeGetSeconds(r.start)) / (CMTimeGetSeconds(CMTimeAdd(r.start, r.duration)) - CMTimeGetSeconds(r.start));
-		progress = fminf(1.f, fmaxf(0.f, progress));
-		
-		self.progressView.progress = progress;
-		self.backgroundColor = (progress != 0.f && progress != 1.f) ? [UIColor colorWithRed:128.0 / 256.0 green:0.0 / 256.0 blue:0.0 / 256.0 alpha:1.0] : [UIColor blackColor];
-	}
-	else {
-		self.progressView.progress = 0.;
-		self.backgroundColor = [UIColor blackColor];
-	}
+	self.progressView.progress = progress;
+	self.backgroundColor = active ? [UIColor colorWithRed:128.0 / 256.0 green:0.0 / 256.0 blue:0.0 / 256.0 alpha:1.0] : [UIColor blackColor];
 }
 
 @end
\ No newline at end of file
@@ -37,7 +37,8 @@ static NSString *StringForPlaybackState(RTSMediaPlaybackState playbackState)
 					 @(RTSMediaPlaybackStateSeeking) : @"SEEKING",
 					 @(RTSMediaPlaybackStatePaused) : @"PAUSED",
 					 @(RTSMediaPlaybackStateStalled) : @"STALLED",
-					 @(RTSMediaPlaybackStateEnded) : @"ENDED",};
+					 @(RTSMediaPlaybackStateEnded) : @"ENDED",
+					 @(RTSMediaPlaybackStateTrickPlaying) : @"TRICK PLAYING",};
 	});
 	return s_names[@(playbackState)] ?: @"UNKNOWN";
 }
@@ -105,13 +106,6 @@ static NSString *StringForPlaybackState(RTSMediaPlaybackState playbackState)
 											   object:nil];
 }
 
-- (void)updateAppearanceWithTime:(CMTime)time
-{
-	for (SegmentCollectionViewCell *segmentCell in [self.timelineView visibleCells]) {
-		[segmentCell updateAppearanceWithTime:time identifier:self.mediaPlayerController.identifier];
-	}
-}
-
 - (void)viewWillAppear:(BOOL)animated
 {
 	[super viewWillAppear:animated];
@@ -193,17 +187,14 @@ static NSString *StringForPlaybackState(RTSMediaPlaybackState playbackState)
 
 - (void)timeSlider:(RTSTimeSlider *)slider isMovingToPlaybackTime:(CMTime)time withValue:(CGFloat)value interactive:(BOOL)interactive
 {
-	[self updateAppearanceWithTime:time];
-
+	// The timeline tracks the playhead itself, only reflect the slider position while it is being dragged
 	if (interactive) {
-		NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id<RTSMediaSegment>  _Nonnull segment, NSDictionary<NSString *,id> * _Nullable bindings) {
-			return [[segment segmentIdentifier] isEqualToString:self.mediaPlayerController.identifier]
-			&& CMTimeRangeContainsTime(segment.timeRange, time);
-		}];
-		id<RTSMediaSegment> segment = [[self.timelineView.segmentsController.visibleSegments filteredArrayUsingPredicate:predicate] firstObject];
+		[self.timelineView updateWithPlayheadTime:time];
+		
+		id<RTSMediaSegment> segment = [self.timelineView.segmentsController visibleSegmentAtTime:time];
 		if (segment) {
 			[self.timelineView scrollToSegment:segment animated:YES];
-		}		
+		}
 	}
 }
 
@@ -216,11 +207,6 @@ static NSString *StringForPlaybackState(RTSMediaPlaybackState playbackState)
 	return segmentCell;
 }
 
-- (void)timelineViewDidScroll:(RTSSegmentedTimelineView *)timelineView
-{
-	[self updateAppearanceWithTime:self.timelineSlider.time];
-}
-
 #pragma mark - Actions
 
 - (IBAction)dismiss:(id)sender
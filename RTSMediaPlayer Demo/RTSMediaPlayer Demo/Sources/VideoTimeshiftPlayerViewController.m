@@ -23,7 +23,8 @@ static NSString *StringForPlaybackState(RTSMediaPlaybackState playbackState)
 					 @(RTSMediaPlaybackStateSeeking) : @"SEEKING",
 					 @(RTSMediaPlaybackStatePaused) : @"PAUSED",
 					 @(RTSMediaPlaybackStateStalled) : @"STALLED",
-					 @(RTSMediaPlaybackStateEnded) : @"ENDED",};
+					 @(RTSMediaPlaybackStateEnded) : @"ENDED",
+					 @(RTSMediaPlaybackStateTrickPlaying) : @"TRICK PLAYING",};
 	});
 	return s_names[@(playbackState)] ?: @"UNKNOWN";
 }
@@ -0,0 +1,218 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+// Virtual clock origin
+static NSDate *DateMake(NSTimeInterval seconds)
+{
+	return [NSDate dateWithTimeIntervalSinceReferenceDate:1000000. + seconds];
+}
+
+static RTSMediaBlackoutWindow *WindowMake(NSTimeInterval startTime, NSTimeInterval endTime)
+{
+	return [RTSMediaBlackoutWindow windowWithStartDate:DateMake(startTime) endDate:DateMake(endTime)];
+}
+
+// The schedule is driven by a virtual clock, the controller by the wall clock with local streams
+@interface RTSMediaBlackoutScheduleTestCase : XCTestCase <RTSMediaBlackoutScheduleDelegate>
+
+@property (nonatomic) RTSMediaBlackoutSchedule *blackoutSchedule;
+@property (nonatomic) NSMutableArray<NSString *> *events;
+
+@end
+
+@implementation RTSMediaBlackoutScheduleTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.blackoutSchedule = [RTSMediaBlackoutSchedule new];
+	self.blackoutSchedule.delegate = self;
+	self.events = [NSMutableArray array];
+}
+
+- (void) tearDown
+{
+	self.blackoutSchedule = nil;
+	self.events = nil;
+}
+
+#pragma mark - Helpers
+
+- (void) updateFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime step:(NSTimeInterval)step
+{
+	for (NSTimeInterval time = startTime; time <= endTime; time += step) {
+		[self.blackoutSchedule updateWithDate:DateMake(time)];
+	}
+}
+
+#pragma mark - RTSMediaBlackoutScheduleDelegate protocol
+
+- (void) blackoutScheduleDidRequireSlate:(RTSMediaBlackoutSchedule *)blackoutSchedule
+{
+	[self.events addObject:[NSString stringWithFormat:@"require@%.0f", [blackoutSchedule.currentDate timeIntervalSinceDate:DateMake(0.)]]];
+}
+
+- (void) blackoutScheduleDidReleaseSlate:(RTSMediaBlackoutSchedule *)blackoutSchedule
+{
+	[self.events addObject:[NSString stringWithFormat:@"release@%.0f", [blackoutSchedule.currentDate timeIntervalSinceDate:DateMake(0.)]]];
+}
+
+- (void) blackoutSchedule:(RTSMediaBlackoutSchedule *)blackoutSchedule didEnterWindow:(RTSMediaBlackoutWindow *)window
+{
+	[self.events addObject:[NSString stringWithFormat:@"enter%.0f@%.0f", [window.startDate timeIntervalSinceDate:DateMake(0.)], [blackoutSchedule.currentDate timeIntervalSinceDate:DateMake(0.)]]];
+}
+
+- (void) blackoutSchedule:(RTSMediaBlackoutSchedule *)blackoutSchedule didExitWindow:(RTSMediaBlackoutWindow *)window
+{
+	[self.events addObject:[NSString stringWithFormat:@"exit%.0f@%.0f", [window.startDate timeIntervalSinceDate:DateMake(0.)], [blackoutSchedule.currentDate timeIntervalSinceDate:DateMake(0.)]]];
+}
+
+#pragma mark - Tests
+
+- (void) testWindows
+{
+	self.blackoutSchedule.slatePreparationInterval = 5.;
+	self.blackoutSchedule.windows = @[ WindowMake(40., 50.), WindowMake(20., 30.), WindowMake(60., 60.) ];
+	XCTAssertEqual(self.blackoutSchedule.windows.count, 2);
+	XCTAssertEqualObjects(self.blackoutSchedule.windows.firstObject, WindowMake(20., 30.));
+
+	[self updateFromTime:0. toTime:60. step:1.];
+	NSArray<NSString *> *expectedEvents = @[ @"require@15", @"enter20@20", @"exit20@30", @"release@30",
+											 @"require@35", @"enter40@40", @"exit40@50", @"release@50" ];
+	XCTAssertEqualObjects(self.events, expectedEvents);
+
+	// Window ends are excluded
+	XCTAssertFalse([WindowMake(20., 30.) containsDate:DateMake(30.)]);
+	XCTAssertTrue([WindowMake(20., 30.) containsDate:DateMake(20.)]);
+}
+
+- (void) testCloseWindowsShareSlate
+{
+	self.blackoutSchedule.slatePreparationInterval = 5.;
+	self.blackoutSchedule.windows = @[ WindowMake(20., 30.), WindowMake(33., 40.), WindowMake(40., 45.) ];
+
+	[self updateFromTime:0. toTime:50. step:1.];
+	NSArray<NSString *> *expectedEvents = @[ @"require@15", @"enter20@20", @"exit20@30", @"enter33@33", @"exit33@40",
+											 @"enter40@40", @"exit40@45", @"release@45" ];
+	XCTAssertEqualObjects(self.events, expectedEvents);
+}
+
+- (void) testJumps
+{
+	self.blackoutSchedule.slatePreparationInterval = 5.;
+	self.blackoutSchedule.windows = @[ WindowMake(20., 30.), WindowMake(100., 110.) ];
+
+	// Jumping into a window requires the slate before entering it, jumping out of it releases the slate after exiting it
+	[self.blackoutSchedule updateWithDate:DateMake(0.)];
+	[self.blackoutSchedule updateWithDate:DateMake(25.)];
+	XCTAssertTrue(self.blackoutSchedule.slateRequired);
+	XCTAssertEqualObjects(self.blackoutSchedule.currentWindow, WindowMake(20., 30.));
+	[self.blackoutSchedule updateWithDate:DateMake(105.)];
+	[self.blackoutSchedule updateWithDate:DateMake(10.)];
+
+	// Backwards as well, and unknown dates end everything
+	[self.blackoutSchedule updateWithDate:DateMake(29.)];
+	[self.blackoutSchedule updateWithDate:nil];
+	XCTAssertNil(self.blackoutSchedule.currentWindow);
+	XCTAssertFalse(self.blackoutSchedule.slateRequired);
+
+	NSArray<NSString *> *expectedEvents = @[ @"require@25", @"enter20@25", @"exit20@105", @"enter100@105",
+											 @"exit100@10", @"release@10", @"require@29", @"enter20@29", @"exit20@0", @"release@0" ];
+	XCTAssertEqualObjects(self.events, expectedEvents);
+}
+
+- (void) testWindowChanges
+{
+	self.blackoutSchedule.windows = @[ WindowMake(20., 30.) ];
+	[self.blackoutSchedule updateWithDate:DateMake(25.)];
+	XCTAssertNotNil(self.blackoutSchedule.currentWindow);
+
+	// Windows removed or added while within them are exited or entered immediately
+	self.blackoutSchedule.windows = nil;
+	XCTAssertNil(self.blackoutSchedule.currentWindow);
+	XCTAssertFalse(self.blackoutSchedule.slateRequired);
+
+	self.blackoutSchedule.windows = @[ WindowMake(0., 100.) ];
+	XCTAssertEqualObjects(self.blackoutSchedule.currentWindow, WindowMake(0., 100.));
+	XCTAssertTrue(self.blackoutSchedule.slateRequired);
+}
+
+- (void) testNextTransitionDate
+{
+	self.blackoutSchedule.slatePreparationInterval = 5.;
+	self.blackoutSchedule.windows = @[ WindowMake(40., 50.), WindowMake(20., 30.) ];
+
+	XCTAssertEqualObjects([self.blackoutSchedule nextTransitionDateAfterDate:DateMake(0.)], DateMake(15.));
+	XCTAssertEqualObjects([self.blackoutSchedule nextTransitionDateAfterDate:DateMake(15.)], DateMake(20.));
+	XCTAssertEqualObjects([self.blackoutSchedule nextTransitionDateAfterDate:DateMake(25.)], DateMake(30.));
+	XCTAssertEqualObjects([self.blackoutSchedule nextTransitionDateAfterDate:DateMake(30.)], DateMake(35.));
+	XCTAssertNil([self.blackoutSchedule nextTransitionDateAfterDate:DateMake(50.)]);
+	XCTAssertNil([self.blackoutSchedule nextTransitionDateAfterDate:nil]);
+}
+
+- (void) testSlateSwitching
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeLive segmentCount:30 segmentDuration:1. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([server start]);
+
+	TestHLSServer *slateServer = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeLive segmentCount:30 segmentDuration:1. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([slateServer start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+	mediaPlayerController.slateURL = slateServer.masterPlaylistURL;
+	mediaPlayerController.slatePreparationInterval = 5.;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// The slate is not loaded before it is needed
+	XCTAssertEqual(slateServer.requestedPaths.count, 0);
+
+	NSDate *startDate = [NSDate dateWithTimeIntervalSinceNow:8.];
+	RTSMediaBlackoutWindow *window = [RTSMediaBlackoutWindow windowWithStartDate:startDate endDate:[startDate dateByAddingTimeInterval:3.]];
+	mediaPlayerController.blackoutWindows = @[ window ];
+
+	[self expectationForNotification:RTSMediaPlayerBlackoutDidStartNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertEqualObjects(notification.userInfo[RTSMediaPlayerBlackoutWindowUserInfoKey], window);
+		XCTAssertTrue([notification.userInfo[RTSMediaPlayerSlatePreBufferedUserInfoKey] boolValue]);
+
+		// Switched exactly when the window starts
+		XCTAssertEqualWithAccuracy([[NSDate date] timeIntervalSinceDate:startDate], 0., 0.05);
+		return YES;
+	}];
+	[self waitForExpectationsWithTimeout:20. handler:nil];
+
+	XCTAssertTrue(mediaPlayerController.blackedOut);
+	XCTAssertTrue(mediaPlayerController.player.muted);
+	XCTAssertFalse(mediaPlayerController.muted);
+	XCTAssertTrue([slateServer.requestedPaths containsObject:@"/master.m3u8"]);
+
+	[self expectationForNotification:RTSMediaPlayerBlackoutDidEndNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertEqualWithAccuracy([[NSDate date] timeIntervalSinceDate:window.endDate], 0., 0.05);
+		return YES;
+	}];
+	[self waitForExpectationsWithTimeout:20. handler:nil];
+
+	// The media kept playing during the window
+	XCTAssertFalse(mediaPlayerController.blackedOut);
+	XCTAssertFalse(mediaPlayerController.player.muted);
+	XCTAssertEqual(mediaPlayerController.playbackState, RTSMediaPlaybackStatePlaying);
+
+	[mediaPlayerController reset];
+	[slateServer stop];
+	[server stop];
+}
+
+@end
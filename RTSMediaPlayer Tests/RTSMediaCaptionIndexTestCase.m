@@ -0,0 +1,180 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+static CMTimeRange TimeRangeMake(NSTimeInterval startTime, NSTimeInterval duration)
+{
+	return CMTimeRangeMake(CMTimeMakeWithSeconds(startTime, NSEC_PER_SEC), CMTimeMakeWithSeconds(duration, NSEC_PER_SEC));
+}
+
+@interface RTSMediaCaptionIndexTestCase : XCTestCase
+
+@end
+
+@implementation RTSMediaCaptionIndexTestCase
+
+#pragma mark - Tests
+
+- (void) testWebVTTParsing
+{
+	NSString *string = @"WEBVTT\r\n"
+		"\r\n"
+		"NOTE This block is not a cue\r\n"
+		"\r\n"
+		"1\r\n"
+		"00:01.000 --> 00:04.000 align:start\r\n"
+		"<v Anchor>Good evening &amp; welcome</v>\r\n"
+		"to the <i>news</i>\r\n"
+		"\r\n"
+		"01:00:10.500 --> 01:00:12.000\r\n"
+		"Tonight's main story\r\n"
+		"\r\n"
+		"invalid --> 00:20.000\r\n"
+		"Never indexed\r\n";
+
+	RTSMediaCaptionIndex *captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:@"media"];
+	[captionIndex addCuesFromWebVTTString:string];
+	XCTAssertEqual(captionIndex.cueCount, 2);
+
+	RTSMediaCaptionMatch *match = [captionIndex matchesForPhrase:@"welcome to the news" maximumMatchCount:10].firstObject;
+	XCTAssertEqualObjects(match.text, @"Good evening & welcome to the news");
+	XCTAssertTrue(match.phraseMatch);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(match.time), 1., 0.001);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(match.timeRange.duration), 3., 0.001);
+
+	match = [captionIndex matchesForPhrase:@"tonights main story" maximumMatchCount:10].firstObject;
+	XCTAssertTrue(match.phraseMatch);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(match.time), 3610.5, 0.001);
+
+	XCTAssertEqual([captionIndex matchesForPhrase:@"never" maximumMatchCount:10].count, 0);
+	XCTAssertEqual([captionIndex matchesForPhrase:@"anchor" maximumMatchCount:10].count, 0);
+}
+
+- (void) testRanking
+{
+	RTSMediaCaptionIndex *captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:@"media"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(0., 2.) text:@"The council met in Bern"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(10., 2.) text:@"The federal budget"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(20., 2.) text:@"The Federal Council said"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(30., 2.) text:@"Nothing to see here"];
+
+	NSArray<RTSMediaCaptionMatch *> *matches = [captionIndex matchesForPhrase:@"federal council" maximumMatchCount:10];
+	XCTAssertEqual(matches.count, 3);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(matches[0].time), 20., 0.001);
+	XCTAssertTrue(matches[0].phraseMatch);
+	XCTAssertTrue(matches[0].score > 1.);
+
+	// Partial matches with the same score are sorted by time
+	XCTAssertFalse(matches[1].phraseMatch);
+	XCTAssertTrue(matches[1].score < 1.);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(matches[1].time), 0., 0.001);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(matches[2].time), 10., 0.001);
+
+	XCTAssertEqual([captionIndex matchesForPhrase:@"federal council" maximumMatchCount:1].count, 1);
+	XCTAssertEqual([captionIndex matchesForPhrase:@"" maximumMatchCount:10].count, 0);
+	XCTAssertEqual([captionIndex matchesForPhrase:@"unknown" maximumMatchCount:10].count, 0);
+}
+
+- (void) testPhrasesAcrossCues
+{
+	RTSMediaCaptionIndex *captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:@"media"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(0., 2.) text:@"and now the"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(2.5, 2.) text:@"weather forecast"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(60., 2.) text:@"sunny with the"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(120., 2.) text:@"weather improving"];
+
+	// The phrase continues in the following cue, unless separated by a gap
+	NSArray<RTSMediaCaptionMatch *> *matches = [captionIndex matchesForPhrase:@"the weather" maximumMatchCount:10];
+	XCTAssertEqual(matches.count, 4);
+	XCTAssertTrue(matches[0].phraseMatch);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(matches[0].time), 0., 0.001);
+	XCTAssertFalse(matches[1].phraseMatch);
+}
+
+- (void) testNormalization
+{
+	RTSMediaCaptionIndex *captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:@"media"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(5., 2.) text:@"L’ÉTÉ À GENÈVE"];
+
+	RTSMediaCaptionMatch *match = [captionIndex matchesForPhrase:@"l'ete a geneve" maximumMatchCount:10].firstObject;
+	XCTAssertTrue(match.phraseMatch);
+	XCTAssertEqualObjects(match.text, @"L’ÉTÉ À GENÈVE");
+
+	XCTAssertTrue([captionIndex matchesForPhrase:@"Genève" maximumMatchCount:10].firstObject.phraseMatch);
+}
+
+- (void) testIncrementalIndexing
+{
+	RTSMediaCaptionIndex *captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:@"media"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(0., 2.) text:@"first cue"];
+	XCTAssertEqual([captionIndex matchesForPhrase:@"cue" maximumMatchCount:10].count, 1);
+
+	// Cues received again (e.g. after seeking backwards) are ignored
+	[captionIndex addCueWithTimeRange:TimeRangeMake(0., 2.) text:@"first\ncue"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(10., 2.) text:@"second cue"];
+	[captionIndex addCueWithTimeRange:TimeRangeMake(5., 2.) text:@"cue added out of order"];
+	XCTAssertEqual(captionIndex.cueCount, 3);
+
+	XCTestExpectation *searchExpectation = [self expectationWithDescription:@"Search finished"];
+	[captionIndex searchPhrase:@"cue" maximumMatchCount:10 completionHandler:^(NSArray<RTSMediaCaptionMatch *> *matches) {
+		XCTAssertTrue([NSThread isMainThread]);
+		XCTAssertEqualObjects([matches valueForKey:@"text"], (@[ @"first cue", @"cue added out of order", @"second cue" ]));
+		[searchExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void) testControllerIndex
+{
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:[NSURL URLWithString:@"https://devimages.apple.com.edgekey.net/streaming/examples/bipbop_16x9/bipbop_16x9_variant.m3u8"]];
+	XCTAssertFalse(mediaPlayerController.captionIndexingEnabled);
+
+	RTSMediaCaptionIndex *captionIndex = mediaPlayerController.captionIndex;
+	XCTAssertEqualObjects(captionIndex.identifier, mediaPlayerController.identifier);
+	XCTAssertEqual(mediaPlayerController.captionIndex, captionIndex);
+
+	[mediaPlayerController prepareToPlayIdentifier:@"other"];
+	XCTAssertEqualObjects(mediaPlayerController.captionIndex.identifier, @"other");
+	XCTAssertNotEqual(mediaPlayerController.captionIndex, captionIndex);
+
+	[mediaPlayerController reset];
+}
+
+- (void) testLegibleOutputsAreDetached
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// Toggling indexing on the same item does not stack outputs
+	AVPlayerItem *playerItem = mediaPlayerController.playerItem;
+	for (NSInteger i = 0; i < 3; ++i) {
+		mediaPlayerController.captionIndexingEnabled = YES;
+		XCTAssertEqual(playerItem.outputs.count, 1);
+		mediaPlayerController.captionIndexingEnabled = NO;
+		XCTAssertEqual(playerItem.outputs.count, 0);
+	}
+
+	// No output is left on the item once released
+	mediaPlayerController.captionIndexingEnabled = YES;
+	XCTAssertEqual(playerItem.outputs.count, 1);
+	[mediaPlayerController reset];
+	XCTAssertEqual(playerItem.outputs.count, 0);
+
+	[server stop];
+}
+
+@end
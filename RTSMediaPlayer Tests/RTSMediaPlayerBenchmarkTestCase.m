@@ -0,0 +1,447 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <mach/mach.h>
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "Segment.h"
+#import "TestHLSServer.h"
+
+// Segment list payloads are made of fixed-length "start,duration,name" records
+static const NSUInteger SegmentRecordCount = 20000;
+static const NSUInteger SegmentRecordLength = 32;
+static const NSUInteger SegmentBatchSize = 500;
+
+// Transcripts of about 40 hours of continuous captions
+static const NSUInteger CaptionCueCount = 50000;
+
+static CMTime TimeMake(NSTimeInterval seconds)
+{
+	return CMTimeMakeWithSeconds(seconds, NSEC_PER_SEC);
+}
+
+static uint64_t MemoryFootprint(void)
+{
+	task_vm_info_data_t info;
+	mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+	if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+		return 0;
+	}
+	return info.phys_footprint;
+}
+
+/**
+ *  Benchmarks run against the local HLS server with scripted network conditions. Network decisions are seeded, so that
+ *  a scenario behaves the same from one run to the next. Measurements are logged for comparison between revisions
+ */
+@interface RTSMediaPlayerBenchmarkTestCase : XCTestCase <RTSMediaSegmentsDataSource>
+
+@property (nonatomic) NSData *segmentsPayload;
+@property (nonatomic) NSUInteger segmentsPlayheadIndex;
+@property (nonatomic) BOOL deliversSegmentsProgressively;
+@property (nonatomic) uint64_t peakMemoryFootprint;
+
+@end
+
+@implementation RTSMediaPlayerBenchmarkTestCase
+
+#pragma mark - Helpers
+
+- (void) waitForPlaybackState:(RTSMediaPlaybackState)playbackState ofMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == playbackState;
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+// Seeded random words, mostly common ones, as well as a single "needle in the haystack" phrase in the middle
+- (NSString *) captionsWebVTTStringWithCueCount:(NSUInteger)count
+{
+	NSArray<NSString *> *words = @[ @"the", @"a", @"minister", @"said", @"federal", @"council", @"today", @"weather", @"rain", @"sun",
+									@"geneva", @"zurich", @"bern", @"vote", @"election", @"people", @"new", @"law", @"economy", @"bank" ];
+
+	srand48(42);
+	NSMutableString *string = [NSMutableString stringWithString:@"WEBVTT\n\n"];
+	for (NSUInteger i = 0; i < count; ++i) {
+		NSMutableArray<NSString *> *cueWords = [NSMutableArray array];
+		if (i == count / 2) {
+			[cueWords addObject:@"needle in the haystack"];
+		}
+		else {
+			NSUInteger wordCount = 6 + (NSUInteger)(drand48() * 8);
+			for (NSUInteger j = 0; j < wordCount; ++j) {
+				NSUInteger wordIndex = (NSUInteger)(drand48() * drand48() * words.count);
+				[cueWords addObject:(drand48() < 0.05) ? [NSString stringWithFormat:@"name%@", @((NSUInteger)(drand48() * 20000))] : words[wordIndex]];
+			}
+		}
+
+		NSUInteger startTime = i * 3;
+		[string appendFormat:@"%02lu:%02lu:%02lu.000 --> %02lu:%02lu:%02lu.500\n%@\n\n",
+		 (unsigned long)(startTime / 3600), (unsigned long)(startTime / 60 % 60), (unsigned long)(startTime % 60),
+		 (unsigned long)((startTime + 2) / 3600), (unsigned long)((startTime + 2) / 60 % 60), (unsigned long)((startTime + 2) % 60),
+		 [cueWords componentsJoinedByString:@" "]];
+	}
+	return [string copy];
+}
+
+- (NSData *) segmentsPayloadWithCount:(NSUInteger)count
+{
+	NSMutableData *payload = [NSMutableData dataWithCapacity:count * SegmentRecordLength];
+	for (NSUInteger i = 0; i < count; ++i) {
+		NSString *record = [NSString stringWithFormat:@"%09.1f,%05.1f,%-15s\n", i * 4., 4., [NSString stringWithFormat:@"segment%@", @(i)].UTF8String];
+		[payload appendData:[record dataUsingEncoding:NSUTF8StringEncoding]];
+	}
+	return [payload copy];
+}
+
+- (NSArray<NSString *> *) fieldsOfRecordAtIndex:(NSUInteger)index
+{
+	NSString *record = [[NSString alloc] initWithBytes:(const char *)self.segmentsPayload.bytes + index * SegmentRecordLength
+												length:SegmentRecordLength - 1
+											  encoding:NSUTF8StringEncoding];
+	return [record componentsSeparatedByString:@","];
+}
+
+- (Segment *) segmentWithFields:(NSArray<NSString *> *)fields
+{
+	CMTimeRange timeRange = CMTimeRangeMake(TimeMake(fields[0].doubleValue), TimeMake(fields[1].doubleValue));
+	NSString *name = [fields[2] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+	Segment *segment = [[Segment alloc] initWithIdentifier:@"media" name:name timeRange:timeRange];
+	segment.logical = YES;
+	return segment;
+}
+
+- (void) sampleMemoryFootprint
+{
+	self.peakMemoryFootprint = MAX(self.peakMemoryFootprint, MemoryFootprint());
+}
+
+// Batches are delivered in separate run loop iterations, starting with the one containing the playhead, then
+// alternating after and before it
+- (void) deliverSegmentsForIdentifier:(NSString *)identifier batchIndexes:(NSArray<NSNumber *> *)batchIndexes position:(NSUInteger)position batchHandler:(RTSMediaSegmentsBatchHandler)batchHandler
+{
+	dispatch_async(dispatch_get_main_queue(), ^{
+		NSUInteger startIndex = batchIndexes[position].unsignedIntegerValue * SegmentBatchSize;
+		NSUInteger endIndex = MIN(startIndex + SegmentBatchSize, SegmentRecordCount);
+
+		NSMutableArray<Segment *> *segments = [NSMutableArray arrayWithCapacity:endIndex - startIndex];
+		for (NSUInteger i = startIndex; i < endIndex; ++i) {
+			[segments addObject:[self segmentWithFields:[self fieldsOfRecordAtIndex:i]]];
+		}
+		[self sampleMemoryFootprint];
+
+		BOOL finished = (position == batchIndexes.count - 1);
+		batchHandler(identifier, [segments copy], finished, nil);
+		if (!finished) {
+			[self deliverSegmentsForIdentifier:identifier batchIndexes:batchIndexes position:position + 1 batchHandler:batchHandler];
+		}
+	});
+}
+
+- (void) loadSegmentsProgressively:(BOOL)progressively firstVisibleSegmentDuration:(NSTimeInterval *)pFirstVisibleSegmentDuration
+{
+	self.deliversSegmentsProgressively = progressively;
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] init];
+	RTSMediaSegmentsController *segmentsController = [[RTSMediaSegmentsController alloc] init];
+	segmentsController.dataSource = self;
+	segmentsController.playerController = mediaPlayerController;
+
+	uint64_t baselineMemoryFootprint = MemoryFootprint();
+	self.peakMemoryFootprint = baselineMemoryFootprint;
+
+	CFTimeInterval startTime = CACurrentMediaTime();
+	__block CFTimeInterval firstVisibleSegmentTime = 0.;
+
+	XCTestExpectation *completionExpectation = [self expectationWithDescription:@"Segments loaded"];
+	[segmentsController reloadSegmentsForIdentifier:@"media" batchHandler:^(NSIndexSet *insertedVisibleSegmentIndexes) {
+		[self sampleMemoryFootprint];
+		if (firstVisibleSegmentTime == 0. && insertedVisibleSegmentIndexes.count != 0) {
+			firstVisibleSegmentTime = CACurrentMediaTime();
+		}
+	} completionHandler:^(NSError *error) {
+		XCTAssertNil(error);
+		[completionExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:120. handler:nil];
+
+	NSTimeInterval totalDuration = CACurrentMediaTime() - startTime;
+	XCTAssertEqual(segmentsController.visibleSegments.count, SegmentRecordCount);
+	XCTAssertNotNil([segmentsController visibleSegmentAtTime:TimeMake(SegmentRecordCount * 2.)]);
+
+	NSLog(@"%@ segment loading: first visible segment after %.3f sec., %@ segments after %.3f sec., peak memory +%.1f MB",
+		  progressively ? @"Progressive" : @"Whole list",
+		  firstVisibleSegmentTime - startTime,
+		  @(SegmentRecordCount),
+		  totalDuration,
+		  (self.peakMemoryFootprint - baselineMemoryFootprint) / (1024. * 1024.));
+
+	if (pFirstVisibleSegmentDuration) {
+		*pFirstVisibleSegmentDuration = firstVisibleSegmentTime - startTime;
+	}
+}
+
+#pragma mark - NSObject protocol
+
+// The progressive variant of the segments data source is only available when enabled
+- (BOOL) respondsToSelector:(SEL)aSelector
+{
+	if (aSelector == @selector(segmentsController:segmentsForIdentifier:withBatchHandler:)) {
+		return self.deliversSegmentsProgressively;
+	}
+	return [super respondsToSelector:aSelector];
+}
+
+#pragma mark - RTSMediaSegmentsDataSource protocol
+
+// The whole payload is parsed before segments are created from it
+- (id) segmentsController:(RTSMediaSegmentsController *)controller segmentsForIdentifier:(NSString *)identifier withCompletionHandler:(RTSMediaSegmentsCompletionHandler)completionHandler
+{
+	dispatch_async(dispatch_get_main_queue(), ^{
+		NSMutableArray<NSArray<NSString *> *> *records = [NSMutableArray arrayWithCapacity:SegmentRecordCount];
+		for (NSUInteger i = 0; i < SegmentRecordCount; ++i) {
+			[records addObject:[self fieldsOfRecordAtIndex:i]];
+		}
+
+		NSMutableArray<Segment *> *segments = [NSMutableArray arrayWithCapacity:SegmentRecordCount];
+		for (NSArray<NSString *> *fields in records) {
+			[segments addObject:[self segmentWithFields:fields]];
+		}
+		[self sampleMemoryFootprint];
+
+		completionHandler(identifier, [segments copy], nil);
+	});
+	return nil;
+}
+
+- (id) segmentsController:(RTSMediaSegmentsController *)controller segmentsForIdentifier:(NSString *)identifier withBatchHandler:(RTSMediaSegmentsBatchHandler)batchHandler
+{
+	NSUInteger batchCount = (SegmentRecordCount + SegmentBatchSize - 1) / SegmentBatchSize;
+	NSUInteger playheadBatchIndex = MIN(self.segmentsPlayheadIndex / SegmentBatchSize, batchCount - 1);
+
+	NSMutableArray<NSNumber *> *batchIndexes = [NSMutableArray arrayWithCapacity:batchCount];
+	for (NSUInteger distance = 0; batchIndexes.count < batchCount; ++distance) {
+		if (playheadBatchIndex + distance < batchCount) {
+			[batchIndexes addObject:@(playheadBatchIndex + distance)];
+		}
+		if (distance != 0 && distance <= playheadBatchIndex) {
+			[batchIndexes addObject:@(playheadBatchIndex - distance)];
+		}
+	}
+
+	[self deliverSegmentsForIdentifier:identifier batchIndexes:[batchIndexes copy] position:0 batchHandler:batchHandler];
+	return nil;
+}
+
+- (void) cancelSegmentsRequest:(id)request
+{}
+
+#pragma mark - Tests
+
+- (void) testNetworkProfileIsDeterministic
+{
+	TestHLSNetworkProfile *profile = [TestHLSNetworkProfile edgeProfile];
+	TestHLSNetworkProfile *otherProfile = [profile copy];
+	for (NSUInteger attempt = 0; attempt < 10; ++attempt) {
+		double value = [profile randomValueForPath:@"/segment0.aac" attempt:attempt salt:1];
+		XCTAssertEqual(value, [otherProfile randomValueForPath:@"/segment0.aac" attempt:attempt salt:1]);
+		XCTAssertTrue(value >= 0. && value < 1.);
+	}
+
+	otherProfile.seed = profile.seed + 1;
+	XCTAssertNotEqual([profile randomValueForPath:@"/segment0.aac" attempt:0 salt:1], [otherProfile randomValueForPath:@"/segment0.aac" attempt:0 salt:1]);
+}
+
+- (void) testStartupBreakdown
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:10 segmentDuration:4.];
+	server.networkProfile = [TestHLSNetworkProfile cellularProfile];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+
+	NSDate *startDate = [NSDate date];
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	NSDate *playingDate = [NSDate date];
+
+	NSDate *playlistDate = [server dateOfFirstRequestForPath:@"/playlist.m3u8"];
+	NSDate *firstSegmentDate = [server dateOfFirstRequestForPath:[server pathForSegmentAtIndex:0]];
+	XCTAssertNotNil(playlistDate);
+	XCTAssertNotNil(firstSegmentDate);
+	XCTAssertTrue([playlistDate compare:firstSegmentDate] != NSOrderedDescending);
+	XCTAssertTrue([firstSegmentDate compare:playingDate] != NSOrderedDescending);
+
+	NSLog(@"Startup in %.3f sec.: playlist requested after %.3f sec., first segment after %.3f sec., playing %.3f sec. later",
+		  [playingDate timeIntervalSinceDate:startDate],
+		  [playlistDate timeIntervalSinceDate:startDate],
+		  [firstSegmentDate timeIntervalSinceDate:startDate],
+		  [playingDate timeIntervalSinceDate:firstSegmentDate]);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testSeekLatency
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:4.];
+	server.networkProfile = [TestHLSNetworkProfile cellularProfile];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+
+	NSMutableArray<NSNumber *> *seekDurations = [NSMutableArray array];
+	for (NSNumber *time in @[ @90., @20., @60., @100., @40. ]) {
+		XCTestExpectation *seekExpectation = [self expectationWithDescription:@"Seek finished"];
+		CFTimeInterval startTime = CACurrentMediaTime();
+		[mediaPlayerController seekToTime:TimeMake(time.doubleValue) completionHandler:^(BOOL finished) {
+			XCTAssertTrue(finished);
+			[seekExpectation fulfill];
+		}];
+		[self waitForExpectationsWithTimeout:30. handler:nil];
+		[seekDurations addObject:@(CACurrentMediaTime() - startTime)];
+
+		XCTAssertEqualWithAccuracy(CMTimeGetSeconds(mediaPlayerController.playerItem.currentTime), time.doubleValue, 1.);
+	}
+
+	NSArray<NSNumber *> *sortedSeekDurations = [seekDurations sortedArrayUsingSelector:@selector(compare:)];
+	NSLog(@"Seek latency: median %.3f sec., max %.3f sec.", sortedSeekDurations[sortedSeekDurations.count / 2].doubleValue, sortedSeekDurations.lastObject.doubleValue);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testRebufferRatio
+{
+	// Segments are padded to 400 kbps. The network barely sustains playback, then drops below the media bit rate for
+	// a while before recovering
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:15 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	server.networkProfile = [TestHLSNetworkProfile profileWithBandwidth:500000. latency:0.05];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+
+	__block CFTimeInterval stallStartTime = 0.;
+	__block NSTimeInterval stalledDuration = 0.;
+	id playbackStateObserver = [[NSNotificationCenter defaultCenter] addObserverForName:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController queue:nil usingBlock:^(NSNotification *notification) {
+		if (mediaPlayerController.playbackState == RTSMediaPlaybackStateStalled) {
+			stallStartTime = CACurrentMediaTime();
+		}
+		else if (stallStartTime != 0.) {
+			stalledDuration += CACurrentMediaTime() - stallStartTime;
+			stallStartTime = 0.;
+		}
+	}];
+
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	CFTimeInterval startTime = CACurrentMediaTime();
+
+	[server setNetworkProfile:[TestHLSNetworkProfile profileWithBandwidth:100000. latency:0.05] afterDelay:2.];
+	[server setNetworkProfile:[TestHLSNetworkProfile unlimitedProfile] afterDelay:12.];
+
+	// Playback must recover after the drop and reach the end
+	[self waitForPlaybackState:RTSMediaPlaybackStateEnded ofMediaPlayerController:mediaPlayerController];
+	[[NSNotificationCenter defaultCenter] removeObserver:playbackStateObserver];
+
+	NSTimeInterval totalDuration = CACurrentMediaTime() - startTime;
+	NSLog(@"Rebuffer ratio: %.1f %% (%.3f sec. stalled over %.3f sec.)", 100. * stalledDuration / totalDuration, stalledDuration, totalDuration);
+	XCTAssertTrue(stalledDuration > 0.);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testLiveAndDVRFixtures
+{
+	TestHLSServer *liveServer = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeLive segmentCount:0 segmentDuration:2. variantBandwidths:nil];
+	XCTAssertTrue([liveServer start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:liveServer.playlistURL];
+	mediaPlayerController.minimumDVRWindowLength = 20.;
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	XCTAssertEqual(mediaPlayerController.streamType, RTSMediaStreamTypeLive);
+	[mediaPlayerController reset];
+	[liveServer stop];
+
+	TestHLSServer *DVRServer = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeDVR segmentCount:30 segmentDuration:2. variantBandwidths:@[ @200000, @100000 ]];
+	XCTAssertTrue([DVRServer start]);
+
+	mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:DVRServer.masterPlaylistURL];
+	mediaPlayerController.minimumDVRWindowLength = 20.;
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	XCTAssertEqual(mediaPlayerController.streamType, RTSMediaStreamTypeDVR);
+	XCTAssertTrue(mediaPlayerController.live);
+	[mediaPlayerController reset];
+	[DVRServer stop];
+}
+
+- (void) testErrorProfile
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:5 segmentDuration:4.];
+	TestHLSNetworkProfile *networkProfile = [TestHLSNetworkProfile unlimitedProfile];
+	networkProfile.errorRate = 1.;
+	server.networkProfile = networkProfile;
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+	[self expectationForNotification:RTSMediaPlayerPlaybackDidFailNotification object:mediaPlayerController handler:nil];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	XCTAssertTrue(server.failedRequestCount > 0);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testSegmentLoading
+{
+	self.segmentsPayload = [self segmentsPayloadWithCount:SegmentRecordCount];
+	self.segmentsPlayheadIndex = SegmentRecordCount / 2;
+
+	NSTimeInterval wholeListFirstVisibleSegmentDuration = 0.;
+	[self loadSegmentsProgressively:NO firstVisibleSegmentDuration:&wholeListFirstVisibleSegmentDuration];
+
+	NSTimeInterval progressiveFirstVisibleSegmentDuration = 0.;
+	[self loadSegmentsProgressively:YES firstVisibleSegmentDuration:&progressiveFirstVisibleSegmentDuration];
+
+	XCTAssertTrue(progressiveFirstVisibleSegmentDuration < wholeListFirstVisibleSegmentDuration);
+}
+
+- (void) testCaptionIndexing
+{
+	NSString *string = [self captionsWebVTTStringWithCueCount:CaptionCueCount];
+	RTSMediaCaptionIndex *captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:@"captions"];
+
+	uint64_t initialMemoryFootprint = MemoryFootprint();
+	CFTimeInterval indexingStartTime = CACurrentMediaTime();
+	[captionIndex addCuesFromWebVTTString:string];
+	XCTAssertEqual(captionIndex.cueCount, CaptionCueCount);
+	CFTimeInterval indexingDuration = CACurrentMediaTime() - indexingStartTime;
+
+	NSLog(@"Caption indexing: %@ cues (%.1f MB of WebVTT) in %.3f sec., memory +%.1f MB",
+		  @(CaptionCueCount), [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding] / 1e6, indexingDuration, ((double)MemoryFootprint() - (double)initialMemoryFootprint) / 1e6);
+
+	for (NSString *phrase in @[ @"needle in the haystack", @"the minister said", @"federal council", @"the" ]) {
+		CFTimeInterval searchStartTime = CACurrentMediaTime();
+		NSArray<RTSMediaCaptionMatch *> *matches = [captionIndex matchesForPhrase:phrase maximumMatchCount:20];
+		NSLog(@"Caption search for '%@': %@ matches in %.3f msec.", phrase, @(matches.count), (CACurrentMediaTime() - searchStartTime) * 1000.);
+		XCTAssertTrue(matches.count > 0);
+	}
+
+	RTSMediaCaptionMatch *match = [captionIndex matchesForPhrase:@"needle in the haystack" maximumMatchCount:1].firstObject;
+	XCTAssertTrue(match.phraseMatch);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(match.time), (CaptionCueCount / 2) * 3., 0.001);
+}
+
+@end
@@ -0,0 +1,129 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+@interface RTSMediaPlayerBufferBudgetTestCase : XCTestCase
+@end
+
+@implementation RTSMediaPlayerBufferBudgetTestCase
+
+#pragma mark - Allocation
+
+- (void) testNoPlayers
+{
+	NSArray *durations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:@[] bitRates:@[] maximumBytes:1024];
+	XCTAssertEqual(durations.count, 0);
+}
+
+- (void) testSinglePlayerIsCapped
+{
+	// 48 MB at 1 Mbps would be more than 6 minutes of buffer
+	NSArray *durations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:@[ @(RTSMediaPlayerBufferPriorityVisibleAudible) ]
+																				bitRates:@[ @(1000000.) ]
+																			maximumBytes:48 * 1024 * 1024];
+	XCTAssertEqualWithAccuracy([durations.firstObject doubleValue], RTSMediaPlayerBufferBudgetMaximumForwardBufferDuration, 0.001);
+}
+
+- (void) testSharesFollowPriorities
+{
+	// 3 MB shared among 4 players at 1 Mbps: weights are 8, 4, 2 and 1
+	NSArray *priorities = @[ @(RTSMediaPlayerBufferPriorityVisibleAudible),
+							 @(RTSMediaPlayerBufferPriorityVisibleMuted),
+							 @(RTSMediaPlayerBufferPriorityHidden),
+							 @(RTSMediaPlayerBufferPriorityPaused) ];
+	NSArray *bitRates = @[ @(1000000.), @(1000000.), @(1000000.), @(1000000.) ];
+	NSArray *durations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:priorities bitRates:bitRates maximumBytes:3000000];
+	
+	// Minimum durations are reserved first (8 seconds in total), the 16 seconds left are shared
+	NSTimeInterval minimumDuration = RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration;
+	XCTAssertEqualWithAccuracy([durations[0] doubleValue], minimumDuration + 16. * 8. / 15., 0.001);
+	XCTAssertEqualWithAccuracy([durations[1] doubleValue], minimumDuration + 16. * 4. / 15., 0.001);
+	XCTAssertEqualWithAccuracy([durations[2] doubleValue], minimumDuration + 16. * 2. / 15., 0.001);
+	XCTAssertEqualWithAccuracy([durations[3] doubleValue], minimumDuration + 16. * 1. / 15., 0.001);
+}
+
+- (void) testManyPlayersStayWithinBudget
+{
+	// 100 players at 1 Mbps would need 25 MB for their minimum durations, but only 3 MB are available
+	NSMutableArray *priorities = [NSMutableArray array];
+	NSMutableArray *bitRates = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 100; ++i) {
+		[priorities addObject:@(i == 0 ? RTSMediaPlayerBufferPriorityVisibleAudible : RTSMediaPlayerBufferPriorityHidden)];
+		[bitRates addObject:@(1000000.)];
+	}
+	NSArray *durations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:priorities bitRates:bitRates maximumBytes:3000000];
+	
+	double bytes = 0.;
+	for (NSNumber *duration in durations) {
+		XCTAssertEqualWithAccuracy(duration.doubleValue, 0.24, 0.001);
+		bytes += duration.doubleValue * 1000000. / 8.;
+	}
+	XCTAssertLessThanOrEqual(bytes, 3000000. + 1.);
+}
+
+- (void) testUnusedBytesAreRedistributed
+{
+	// The low bit rate audible player is capped, the bytes it does not use are given to the other player
+	NSArray *priorities = @[ @(RTSMediaPlayerBufferPriorityVisibleAudible), @(RTSMediaPlayerBufferPriorityHidden) ];
+	NSArray *bitRates = @[ @(64000.), @(4000000.) ];
+	NSArray *durations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:priorities bitRates:bitRates maximumBytes:10000000];
+	
+	XCTAssertEqualWithAccuracy([durations[0] doubleValue], RTSMediaPlayerBufferBudgetMaximumForwardBufferDuration, 0.001);
+	
+	double remainingBytes = 10000000. - RTSMediaPlayerBufferBudgetMaximumForwardBufferDuration * 64000. / 8.;
+	XCTAssertEqualWithAccuracy([durations[1] doubleValue], 8. * remainingBytes / 4000000., 0.001);
+}
+
+- (void) testUnknownBitRateUsesDefault
+{
+	NSArray *durations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:@[ @(RTSMediaPlayerBufferPriorityHidden) ]
+																				bitRates:@[ @0 ]
+																			maximumBytes:5000000];
+	XCTAssertEqualWithAccuracy([durations.firstObject doubleValue], 20., 0.001);
+}
+
+#pragma mark - Players
+
+- (void) testEffectivePriority
+{
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] init];
+	XCTAssertEqual(mediaPlayerController.effectiveBufferPriority, RTSMediaPlayerBufferPriorityVisibleAudible);
+	
+	mediaPlayerController.muted = YES;
+	XCTAssertEqual(mediaPlayerController.effectiveBufferPriority, RTSMediaPlayerBufferPriorityVisibleMuted);
+	
+	mediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityHidden;
+	XCTAssertEqual(mediaPlayerController.effectiveBufferPriority, RTSMediaPlayerBufferPriorityHidden);
+}
+
+- (void) testRebalanceWhenPrioritiesChange
+{
+	RTSMediaPlayerBufferBudget *bufferBudget = [[RTSMediaPlayerBufferBudget alloc] initWithMaximumBytes:3000000];
+	
+	RTSMediaPlayerController *mediaPlayerController1 = [[RTSMediaPlayerController alloc] init];
+	mediaPlayerController1.bufferBudget = bufferBudget;
+	
+	RTSMediaPlayerController *mediaPlayerController2 = [[RTSMediaPlayerController alloc] init];
+	mediaPlayerController2.bufferBudget = bufferBudget;
+	
+	XCTAssertEqual(bufferBudget.mediaPlayerControllers.count, 2);
+	
+	[bufferBudget rebalance];
+	XCTAssertEqualWithAccuracy(mediaPlayerController1.allocatedForwardBufferDuration, mediaPlayerController2.allocatedForwardBufferDuration, 0.001);
+	
+	// Rebalancing is scheduled automatically
+	mediaPlayerController2.bufferPriority = RTSMediaPlayerBufferPriorityHidden;
+	[[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+	XCTAssertGreaterThan(mediaPlayerController1.allocatedForwardBufferDuration, mediaPlayerController2.allocatedForwardBufferDuration);
+	
+	mediaPlayerController2.bufferBudget = nil;
+	XCTAssertEqual(bufferBudget.mediaPlayerControllers.count, 1);
+	XCTAssertEqual(mediaPlayerController2.allocatedForwardBufferDuration, 0.);
+}
+
+@end
@@ -0,0 +1,247 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+static CMTime TimeMake(NSTimeInterval seconds)
+{
+	return CMTimeMakeWithSeconds(seconds, NSEC_PER_SEC);
+}
+
+@interface RTSMediaPlayerCommandQueueTestCase : XCTestCase
+
+@property (nonatomic) RTSMediaPlayerCommandQueue *commandQueue;
+
+@end
+
+@implementation RTSMediaPlayerCommandQueueTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.commandQueue = [[RTSMediaPlayerCommandQueue alloc] init];
+}
+
+#pragma mark - Tests
+
+- (void) testLastSeekWins
+{
+	__block NSNumber *firstFinished = nil;
+	__block NSNumber *secondFinished = nil;
+	[self.commandQueue enqueueSeekToTime:TimeMake(10.) completionHandler:^(BOOL finished) {
+		firstFinished = @(finished);
+	}];
+	[self.commandQueue enqueueSeekToTime:TimeMake(20.) completionHandler:^(BOOL finished) {
+		secondFinished = @(finished);
+	}];
+
+	XCTAssertEqualObjects(firstFinished, @NO);
+	XCTAssertNil(secondFinished);
+	XCTAssertEqual(CMTimeGetSeconds(self.commandQueue.seekTime), 20.);
+
+	__block NSUInteger applyCount = 0;
+	[self.commandQueue applyUsingBlock:^(CMTime seekTime, RTSMediaPlayerPlaybackCommand playbackCommand, void (^completionHandler)(BOOL finished)) {
+		applyCount++;
+		XCTAssertEqual(CMTimeGetSeconds(seekTime), 20.);
+		XCTAssertEqual(playbackCommand, RTSMediaPlayerPlaybackCommandNone);
+		completionHandler(YES);
+	}];
+
+	XCTAssertEqual(applyCount, 1);
+	XCTAssertEqualObjects(secondFinished, @YES);
+	XCTAssertTrue(self.commandQueue.empty);
+}
+
+- (void) testPlayAndPauseCancelOut
+{
+	__block NSNumber *playFinished = nil;
+	__block NSNumber *pauseFinished = nil;
+	[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPlay completionHandler:^(BOOL finished) {
+		playFinished = @(finished);
+	}];
+	[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPause completionHandler:^(BOOL finished) {
+		pauseFinished = @(finished);
+	}];
+
+	XCTAssertEqualObjects(playFinished, @NO);
+	XCTAssertEqual(self.commandQueue.playbackCommand, RTSMediaPlayerPlaybackCommandPause);
+
+	[self.commandQueue applyUsingBlock:^(CMTime seekTime, RTSMediaPlayerPlaybackCommand playbackCommand, void (^completionHandler)(BOOL finished)) {
+		XCTAssertTrue(CMTIME_IS_INVALID(seekTime));
+		XCTAssertEqual(playbackCommand, RTSMediaPlayerPlaybackCommandPause);
+		completionHandler(YES);
+	}];
+	XCTAssertEqualObjects(pauseFinished, @YES);
+}
+
+- (void) testRepeatedCommandsCompleteTogether
+{
+	__block NSUInteger finishedCount = 0;
+	for (NSUInteger i = 0; i < 3; ++i) {
+		[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPlay completionHandler:^(BOOL finished) {
+			if (finished) {
+				finishedCount++;
+			}
+		}];
+	}
+	XCTAssertEqual(finishedCount, 0);
+
+	[self.commandQueue applyUsingBlock:^(CMTime seekTime, RTSMediaPlayerPlaybackCommand playbackCommand, void (^completionHandler)(BOOL finished)) {
+		completionHandler(YES);
+	}];
+	XCTAssertEqual(finishedCount, 3);
+}
+
+- (void) testCancel
+{
+	__block NSNumber *seekFinished = nil;
+	__block NSNumber *playFinished = nil;
+	[self.commandQueue enqueueSeekToTime:TimeMake(10.) completionHandler:^(BOOL finished) {
+		seekFinished = @(finished);
+	}];
+	[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPlay completionHandler:^(BOOL finished) {
+		playFinished = @(finished);
+	}];
+	XCTAssertFalse(self.commandQueue.empty);
+
+	[self.commandQueue cancel];
+
+	XCTAssertEqualObjects(seekFinished, @NO);
+	XCTAssertEqualObjects(playFinished, @NO);
+	XCTAssertTrue(self.commandQueue.empty);
+}
+
+- (void) testSeekBeforeReadyIsApplied
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+
+	// Both seeks are issued while loading. Only the last one is performed
+	XCTestExpectation *firstSeekExpectation = [self expectationWithDescription:@"First seek superseded"];
+	XCTestExpectation *secondSeekExpectation = [self expectationWithDescription:@"Second seek applied"];
+	[mediaPlayerController play];
+	[mediaPlayerController seekToTime:TimeMake(30.) completionHandler:^(BOOL finished) {
+		XCTAssertFalse(finished);
+		[firstSeekExpectation fulfill];
+	}];
+	[mediaPlayerController seekToTime:TimeMake(60.) completionHandler:^(BOOL finished) {
+		XCTAssertTrue(finished);
+		[secondSeekExpectation fulfill];
+	}];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(mediaPlayerController.playerItem.currentTime), 60., 2.);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testPauseBeforeReadyCancelsPlay
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+
+	__block BOOL playing = NO;
+	id playbackStateObserver = [[NSNotificationCenter defaultCenter] addObserverForName:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController queue:nil usingBlock:^(NSNotification *notification) {
+		if (mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying) {
+			playing = YES;
+		}
+	}];
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePaused;
+	}];
+	[mediaPlayerController play];
+	[mediaPlayerController pause];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[[NSNotificationCenter defaultCenter] removeObserver:playbackStateObserver];
+
+	XCTAssertFalse(playing);
+	XCTAssertEqual(mediaPlayerController.player.rate, 0.f);
+
+	// Seeks are ignored while idle, and never apply to the next media loaded
+	__block NSNumber *seekFinished = nil;
+	[mediaPlayerController reset];
+	[mediaPlayerController seekToTime:TimeMake(30.) completionHandler:^(BOOL finished) {
+		seekFinished = @(finished);
+	}];
+	XCTAssertEqualObjects(seekFinished, @NO);
+
+	// Pending seeks are discarded when resetting
+	seekFinished = nil;
+	[mediaPlayerController prepareToPlay];
+	[mediaPlayerController seekToTime:TimeMake(30.) completionHandler:^(BOOL finished) {
+		seekFinished = @(finished);
+	}];
+	XCTAssertNil(seekFinished);
+	[mediaPlayerController reset];
+	XCTAssertEqualObjects(seekFinished, @NO);
+
+	[server stop];
+}
+
+- (void) testPauseWhenIdleIsIgnored
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+
+	// Nothing is being loaded, the pause must not apply when playback is later requested
+	[mediaPlayerController pause];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// Same when loading at a given time
+	[mediaPlayerController reset];
+	[mediaPlayerController pause];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController playAtTime:TimeMake(30.)];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(mediaPlayerController.playerItem.currentTime), 30., 2.);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testPlayAtTimeWhenIdleCallsCompletionHandler
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+
+	XCTestExpectation *completionExpectation = [self expectationWithDescription:@"Play at time completed"];
+	[mediaPlayerController playAtTime:TimeMake(30.) completionHandler:^(BOOL finished) {
+		XCTAssertTrue(finished);
+		XCTAssertEqualWithAccuracy(CMTimeGetSeconds(mediaPlayerController.playerItem.currentTime), 30., 2.);
+		[completionExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+@end
@@ -0,0 +1,212 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+@interface RTSMediaPlayerHandoffTestCase : XCTestCase
+
+@property (nonatomic) TestHLSServer *server;
+@property (nonatomic) RTSMediaPlayerController *sourceMediaPlayerController;
+@property (nonatomic) RTSMediaPlayerController *destinationMediaPlayerController;
+
+@end
+
+@implementation RTSMediaPlayerHandoffTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([self.server start]);
+
+	self.sourceMediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:self.server.playlistURL];
+	self.destinationMediaPlayerController = [[RTSMediaPlayerController alloc] init];
+}
+
+- (void) tearDown
+{
+	[self.sourceMediaPlayerController reset];
+	[self.destinationMediaPlayerController reset];
+	self.sourceMediaPlayerController = nil;
+	self.destinationMediaPlayerController = nil;
+
+	[self.server stop];
+	self.server = nil;
+}
+
+#pragma mark - Tests
+
+- (void) testHandoffDuringPlayback
+{
+	RTSMediaPlayerController *sourceMediaPlayerController = self.sourceMediaPlayerController;
+	RTSMediaPlayerController *destinationMediaPlayerController = self.destinationMediaPlayerController;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:sourceMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return sourceMediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[sourceMediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	AVPlayer *player = sourceMediaPlayerController.player;
+	NSUInteger requestCount = self.server.requestedPaths.count;
+
+	// Observers registered on the source must follow the player
+	XCTestExpectation *boundaryExpectation = [self expectationWithDescription:@"Boundary crossed after handoff"];
+	CMTime boundaryTime = CMTimeAdd(player.currentTime, CMTimeMakeWithSeconds(2., NSEC_PER_SEC));
+	id boundaryObserver = [sourceMediaPlayerController addBoundaryTimeObserverForTimes:@[ [NSValue valueWithCMTime:boundaryTime] ] queue:NULL usingBlock:^(CMTime time) {
+		[boundaryExpectation fulfill];
+	}];
+
+	[self expectationForNotification:RTSMediaPlayerDidTakeOverPlaybackNotification object:destinationMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		// Within a frame
+		XCTAssertTrue([notification.userInfo[RTSMediaPlayerHandoffDurationUserInfoKey] doubleValue] < 1. / 60.);
+		return YES;
+	}];
+	XCTAssertTrue([destinationMediaPlayerController takeOverPlaybackFromMediaPlayerController:sourceMediaPlayerController]);
+
+	XCTAssertEqual(destinationMediaPlayerController.player, player);
+	XCTAssertEqualObjects(destinationMediaPlayerController.identifier, self.server.playlistURL.absoluteString);
+	XCTAssertEqual(destinationMediaPlayerController.playbackState, RTSMediaPlaybackStatePlaying);
+	XCTAssertTrue(player.rate > 0.f);
+
+	XCTAssertNil(sourceMediaPlayerController.player);
+	XCTAssertEqual(sourceMediaPlayerController.playbackState, RTSMediaPlaybackStateIdle);
+
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// Nothing has been loaded again
+	NSArray<NSString *> *requestedPaths = [self.server.requestedPaths subarrayWithRange:NSMakeRange(requestCount, self.server.requestedPaths.count - requestCount)];
+	XCTAssertFalse([requestedPaths containsObject:@"/playlist.m3u8"]);
+	XCTAssertFalse([requestedPaths containsObject:[self.server pathForSegmentAtIndex:0]]);
+
+	[destinationMediaPlayerController removeBoundaryTimeObserver:boundaryObserver];
+}
+
+- (void) testHandoffFromPausedPlayer
+{
+	RTSMediaPlayerController *sourceMediaPlayerController = self.sourceMediaPlayerController;
+	RTSMediaPlayerController *destinationMediaPlayerController = self.destinationMediaPlayerController;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:sourceMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return sourceMediaPlayerController.playbackState == RTSMediaPlaybackStatePaused;
+	}];
+	[sourceMediaPlayerController prepareToPlay];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	AVPlayer *player = sourceMediaPlayerController.player;
+	XCTAssertTrue([destinationMediaPlayerController takeOverPlaybackFromMediaPlayerController:sourceMediaPlayerController]);
+	XCTAssertEqual(destinationMediaPlayerController.player, player);
+	XCTAssertEqual(destinationMediaPlayerController.playbackState, RTSMediaPlaybackStatePaused);
+	XCTAssertEqual(sourceMediaPlayerController.playbackState, RTSMediaPlaybackStateIdle);
+
+	// Playback can be resumed by the new controller
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:destinationMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return destinationMediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[destinationMediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (void) testHandoffFromIdlePlayer
+{
+	XCTAssertFalse([self.destinationMediaPlayerController takeOverPlaybackFromMediaPlayerController:self.sourceMediaPlayerController]);
+	XCTAssertFalse([self.destinationMediaPlayerController takeOverPlaybackFromMediaPlayerController:self.destinationMediaPlayerController]);
+	XCTAssertEqual(self.destinationMediaPlayerController.playbackState, RTSMediaPlaybackStateIdle);
+	XCTAssertNil(self.destinationMediaPlayerController.player);
+}
+
+- (void) testHandoffTimeshiftedStream
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeLive segmentCount:0 segmentDuration:1. variantBandwidths:nil];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *sourceMediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+	sourceMediaPlayerController.timeshiftDepth = 60.;
+	RTSMediaPlayerController *destinationMediaPlayerController = self.destinationMediaPlayerController;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:sourceMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return sourceMediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[sourceMediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	XCTAssertTrue(sourceMediaPlayerController.timeshifting);
+
+	// Recording continues for the new controller
+	XCTAssertTrue([destinationMediaPlayerController takeOverPlaybackFromMediaPlayerController:sourceMediaPlayerController]);
+	XCTAssertFalse(sourceMediaPlayerController.timeshifting);
+	XCTAssertTrue(destinationMediaPlayerController.timeshifting);
+	XCTAssertEqual(destinationMediaPlayerController.timeshiftDepth, 60.);
+
+	// The window keeps growing, which requires the recorder to serve the playlist
+	CMTime duration = destinationMediaPlayerController.timeRange.duration;
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:4.]];
+	XCTAssertEqual(destinationMediaPlayerController.playbackState, RTSMediaPlaybackStatePlaying);
+	XCTAssertTrue(CMTimeGetSeconds(destinationMediaPlayerController.timeRange.duration) > CMTimeGetSeconds(duration) + 2.);
+
+	[sourceMediaPlayerController reset];
+	[destinationMediaPlayerController reset];
+	XCTAssertFalse(destinationMediaPlayerController.timeshifting);
+
+	[server stop];
+}
+
+- (void) testHandoffSettings
+{
+	RTSMediaPlayerController *sourceMediaPlayerController = self.sourceMediaPlayerController;
+	RTSMediaPlayerController *destinationMediaPlayerController = self.destinationMediaPlayerController;
+
+	RTSMediaPlayerBufferBudget *bufferBudget = [[RTSMediaPlayerBufferBudget alloc] initWithMaximumBytes:3000000];
+	NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[NSUUID UUID].UUIDString];
+	RTSMediaWatchedRangeTracker *watchedRangeTracker = [[RTSMediaWatchedRangeTracker alloc] initWithFileURL:fileURL];
+	NSArray<RTSMediaPlayerStallRecoveryStep *> *stallRecoverySteps = @[ [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionWait timeout:5.] ];
+
+	sourceMediaPlayerController.muted = YES;
+	sourceMediaPlayerController.preferredPeakBitRate = 500000.;
+	sourceMediaPlayerController.bufferBudget = bufferBudget;
+	sourceMediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityVisibleMuted;
+	sourceMediaPlayerController.watchedRangeTracker = watchedRangeTracker;
+	sourceMediaPlayerController.captionIndexingEnabled = YES;
+	sourceMediaPlayerController.stallRecoverySteps = stallRecoverySteps;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:sourceMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return sourceMediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[sourceMediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	RTSMediaCaptionIndex *captionIndex = sourceMediaPlayerController.captionIndex;
+	AVPlayerItem *playerItem = sourceMediaPlayerController.playerItem;
+	NSString *identifier = sourceMediaPlayerController.identifier;
+	NSTimeInterval watchedDuration = [watchedRangeTracker watchedTimeRangeSetForIdentifier:identifier].totalDuration;
+	XCTAssertTrue([destinationMediaPlayerController takeOverPlaybackFromMediaPlayerController:sourceMediaPlayerController]);
+
+	XCTAssertTrue(destinationMediaPlayerController.muted);
+	XCTAssertTrue(destinationMediaPlayerController.player.muted);
+	XCTAssertEqual(destinationMediaPlayerController.preferredPeakBitRate, 500000.);
+	XCTAssertEqual(playerItem.preferredPeakBitRate, 500000.);
+	XCTAssertEqual(destinationMediaPlayerController.bufferBudget, bufferBudget);
+	XCTAssertEqual(destinationMediaPlayerController.bufferPriority, RTSMediaPlayerBufferPriorityVisibleMuted);
+	XCTAssertTrue([bufferBudget.mediaPlayerControllers containsObject:destinationMediaPlayerController]);
+	XCTAssertEqual(destinationMediaPlayerController.watchedRangeTracker, watchedRangeTracker);
+	XCTAssertEqualObjects(destinationMediaPlayerController.stallRecoverySteps, stallRecoverySteps);
+
+	// Captions are indexed by the receiver only, in the same index
+	XCTAssertTrue(destinationMediaPlayerController.captionIndexingEnabled);
+	XCTAssertEqual(destinationMediaPlayerController.captionIndex, captionIndex);
+	XCTAssertEqual(playerItem.outputs.count, 1);
+
+	// Watched ranges are still recorded
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:3.]];
+	XCTAssertTrue([watchedRangeTracker watchedTimeRangeSetForIdentifier:identifier].totalDuration > watchedDuration + 2.);
+
+	[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+@end
@@ -8,6 +8,8 @@
 #import <SRGMediaPlayer/SRGMediaPlayer.h>
 #import <MAKVONotificationCenter/MAKVONotificationCenter.h>
 
+#import "TestHLSServer.h"
+
 @interface RTSMediaPlayerPlaybackTestCase : XCTestCase
 @property RTSMediaPlayerController *mediaPlayerController;
 @end
@@ -121,6 +123,115 @@
 	[self waitForExpectationsWithTimeout:30. handler:nil];
 }
 
+- (void) testIdleResourceReclamation
+{
+	self.mediaPlayerController.idleReclamationDelay = 2.;
+	
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:self.mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return self.mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[self.mediaPlayerController playAtTime:CMTimeMakeWithSeconds(60., 1.)];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	RTSMediaStreamType streamType = self.mediaPlayerController.streamType;
+	RTSMediaType mediaType = self.mediaPlayerController.mediaType;
+	CMTimeRange timeRange = self.mediaPlayerController.timeRange;
+	XCTAssertNotEqual(streamType, RTSMediaStreamTypeUnknown);
+	
+	[self expectationForNotification:RTSMediaPlayerDidReclaimResourcesNotification object:self.mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertNotNil(notification.userInfo[RTSMediaPlayerReclaimedBytesUserInfoKey]);
+		return YES;
+	}];
+	[self.mediaPlayerController pause];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	XCTAssertTrue(self.mediaPlayerController.reclaimed);
+	XCTAssertNil(self.mediaPlayerController.player);
+	XCTAssertEqual(self.mediaPlayerController.playbackState, RTSMediaPlaybackStatePaused);
+	
+	// The stream shape is kept while reclaimed
+	XCTAssertEqual(self.mediaPlayerController.streamType, streamType);
+	XCTAssertEqual(self.mediaPlayerController.mediaType, mediaType);
+	XCTAssertTrue(CMTimeRangeEqual(self.mediaPlayerController.timeRange, timeRange));
+	
+	[self expectationForNotification:RTSMediaPlayerDidResumeReclaimedPlaybackNotification object:self.mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertGreaterThan([notification.userInfo[RTSMediaPlayerResumeLatencyUserInfoKey] doubleValue], 0.);
+		return YES;
+	}];
+	[self.mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	XCTAssertFalse(self.mediaPlayerController.reclaimed);
+	XCTAssertGreaterThanOrEqual(CMTimeGetSeconds(self.mediaPlayerController.playerItem.currentTime), 60.);
+}
+
+- (void) testResetReclaimedPlayer
+{
+	self.mediaPlayerController.idleReclamationDelay = 1.;
+	
+	[self expectationForNotification:RTSMediaPlayerDidReclaimResourcesNotification object:self.mediaPlayerController handler:nil];
+	[self.mediaPlayerController prepareToPlay];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:self.mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return self.mediaPlayerController.playbackState == RTSMediaPlaybackStateIdle;
+	}];
+	[self.mediaPlayerController reset];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	XCTAssertFalse(self.mediaPlayerController.reclaimed);
+	XCTAssertEqual(self.mediaPlayerController.streamType, RTSMediaStreamTypeUnknown);
+}
+
+// Bytes of the segments fetched from the server which lie before the specified segment
+- (unsigned long long) bytesFetchedFromServer:(TestHLSServer *)server beforeSegmentAtIndex:(NSUInteger)segmentIndex
+{
+	unsigned long long bytes = 0;
+	NSArray<NSString *> *requestedPaths = server.requestedPaths;
+	for (NSUInteger i = 0; i < segmentIndex; ++i) {
+		if ([requestedPaths containsObject:[server pathForSegmentAtIndex:i]]) {
+			bytes += [server sizeOfSegmentAtIndex:i];
+		}
+	}
+	return bytes;
+}
+
+- (void) testPlayAtTimeFromIdleOnlyFetchesTargetRegion
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:60 segmentDuration:6.];
+	XCTAssertTrue([server start]);
+	
+	NSUInteger startSegmentIndex = 50;
+	CMTime startTime = CMTimeMakeWithSeconds(startSegmentIndex * server.segmentDuration + 1., NSEC_PER_SEC);
+	
+	// Reference: playback from the start fetches the first segments
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	XCTAssertTrue([self bytesFetchedFromServer:server beforeSegmentAtIndex:startSegmentIndex] > 0);
+	[mediaPlayerController reset];
+	[server resetStatistics];
+	
+	// Starting at a later position must not fetch anything before it
+	mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.playlistURL];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController playAtTime:startTime];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(mediaPlayerController.playerItem.currentTime), CMTimeGetSeconds(startTime), 1.);
+	XCTAssertEqual([self bytesFetchedFromServer:server beforeSegmentAtIndex:startSegmentIndex], 0);
+	XCTAssertTrue([server.requestedPaths containsObject:[server pathForSegmentAtIndex:startSegmentIndex]]);
+	
+	[mediaPlayerController reset];
+	[server stop];
+}
+
 - (void) testPlayingMissingMovieSendsPlaybackDidFailNotificationWithError
 {
 	[self expectationForNotification:RTSMediaPlayerPlaybackDidFailNotification object:self.mediaPlayerController handler:^BOOL(NSNotification *notification) {
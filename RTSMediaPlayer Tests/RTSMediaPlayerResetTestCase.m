@@ -0,0 +1,97 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+@interface RTSMediaPlayerResetTestCase : XCTestCase
+
+@property (nonatomic) TestHLSServer *server;
+@property (nonatomic) RTSMediaPlayerController *mediaPlayerController;
+
+@end
+
+@implementation RTSMediaPlayerResetTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([self.server start]);
+
+	self.mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:self.server.playlistURL];
+}
+
+- (void) tearDown
+{
+	[self.mediaPlayerController reset];
+	self.mediaPlayerController = nil;
+
+	[self.server stop];
+	self.server = nil;
+}
+
+#pragma mark - Tests
+
+- (void) testResetDuringPlayback
+{
+	RTSMediaPlayerController *mediaPlayerController = self.mediaPlayerController;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	AVPlayer *player = mediaPlayerController.player;
+
+	// Boundary close to the current time, likely to be in flight when resetting
+	__block BOOL boundaryCrossed = NO;
+	CMTime boundaryTime = CMTimeAdd(player.currentTime, CMTimeMakeWithSeconds(0.1, NSEC_PER_SEC));
+	[mediaPlayerController addBoundaryTimeObserverForTimes:@[ [NSValue valueWithCMTime:boundaryTime] ] queue:NULL usingBlock:^(CMTime time) {
+		boundaryCrossed = YES;
+	}];
+
+	__block NSInteger playbackStateChangeCount = 0;
+	id playbackStateObserver = [[NSNotificationCenter defaultCenter] addObserverForName:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController queue:nil usingBlock:^(NSNotification *notification) {
+		playbackStateChangeCount++;
+	}];
+
+	[mediaPlayerController reset];
+
+	// Detached immediately
+	XCTAssertEqual(mediaPlayerController.playbackState, RTSMediaPlaybackStateIdle);
+	XCTAssertNil(mediaPlayerController.player);
+	XCTAssertEqual(playbackStateChangeCount, 1);
+
+	// The previous player is silenced immediately, even if it is released later
+	XCTAssertEqual(player.rate, 0.f);
+
+	// The previous player and its item are torn down in the background. No late callback must reach the controller in
+	// the meantime
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.]];
+
+	XCTAssertNil(player.currentItem);
+	XCTAssertFalse(boundaryCrossed);
+	XCTAssertEqual(playbackStateChangeCount, 1);
+	XCTAssertEqual(mediaPlayerController.playbackState, RTSMediaPlaybackStateIdle);
+
+	[[NSNotificationCenter defaultCenter] removeObserver:playbackStateObserver];
+
+	// Playback can be restarted normally
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	XCTAssertNotEqual(mediaPlayerController.player, player);
+}
+
+@end
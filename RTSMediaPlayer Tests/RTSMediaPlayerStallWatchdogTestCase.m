@@ -0,0 +1,250 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+@interface RTSMediaPlayerStallWatchdogTestCase : XCTestCase <RTSMediaPlayerStallWatchdogDelegate, RTSMediaPlayerControllerDataSource>
+
+@property (nonatomic) NSMutableArray<NSNumber *> *performedActions;
+@property (nonatomic) NSSet<NSNumber *> *unavailableActions;
+@property (nonatomic) NSNumber *lastRecoveredAction;
+
+@property (nonatomic) TestHLSServer *alternateServer;
+
+@end
+
+@implementation RTSMediaPlayerStallWatchdogTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.performedActions = [NSMutableArray array];
+	self.unavailableActions = nil;
+	self.lastRecoveredAction = nil;
+}
+
+- (void) tearDown
+{
+	[self.alternateServer stop];
+	self.alternateServer = nil;
+}
+
+#pragma mark - Helpers
+
+- (NSArray<RTSMediaPlayerStallRecoveryStep *> *) stepsWithTimeout:(NSTimeInterval)timeout
+{
+	return @[ [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionWait timeout:timeout],
+			  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionCapBitRate timeout:timeout],
+			  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionRebuildItem timeout:timeout],
+			  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionSwitchURL timeout:timeout] ];
+}
+
+- (void) waitForDuration:(NSTimeInterval)duration
+{
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:duration]];
+}
+
+#pragma mark - RTSMediaPlayerStallWatchdogDelegate protocol
+
+- (BOOL) stallWatchdog:(RTSMediaPlayerStallWatchdog *)stallWatchdog performRecoveryStep:(RTSMediaPlayerStallRecoveryStep *)step
+{
+	if ([self.unavailableActions containsObject:@(step.action)]) {
+		return NO;
+	}
+
+	[self.performedActions addObject:@(step.action)];
+	return YES;
+}
+
+- (void) stallWatchdog:(RTSMediaPlayerStallWatchdog *)stallWatchdog didRecoverAfterDuration:(NSTimeInterval)duration lastAction:(RTSMediaPlayerStallRecoveryAction)lastAction
+{
+	self.lastRecoveredAction = @(lastAction);
+}
+
+#pragma mark - RTSMediaPlayerControllerDataSource protocol
+
+- (id) mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+	 contentURLForIdentifier:(NSString *)identifier
+		   completionHandler:(void (^)(NSString *identifier, NSURL *contentURL, NSError *error))completionHandler
+{
+	completionHandler(identifier, [NSURL URLWithString:identifier], nil);
+	return nil;
+}
+
+- (void) cancelContentURLRequest:(id)request
+{}
+
+- (void) mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+alternateContentURLForIdentifier:(NSString *)identifier
+			  failedContentURL:(NSURL *)failedContentURL
+			 completionHandler:(void (^)(NSURL *contentURL))completionHandler
+{
+	completionHandler(self.alternateServer.masterPlaylistURL);
+}
+
+#pragma mark - Tests
+
+- (void) testEscalation
+{
+	RTSMediaPlayerStallWatchdog *stallWatchdog = [[RTSMediaPlayerStallWatchdog alloc] initWithSteps:[self stepsWithTimeout:0.5]];
+	stallWatchdog.delegate = self;
+
+	[stallWatchdog stallDidStart];
+	XCTAssertTrue(stallWatchdog.stalled);
+	XCTAssertEqualObjects(self.performedActions, @[ @(RTSMediaPlayerStallRecoveryActionWait) ]);
+
+	// Stalling again while recovering does not restart escalation
+	[stallWatchdog stallDidStart];
+	XCTAssertEqual(self.performedActions.count, 1);
+
+	[self waitForDuration:1.2];
+	NSArray<NSNumber *> *expectedActions = @[ @(RTSMediaPlayerStallRecoveryActionWait),
+											  @(RTSMediaPlayerStallRecoveryActionCapBitRate),
+											  @(RTSMediaPlayerStallRecoveryActionRebuildItem) ];
+	XCTAssertEqualObjects(self.performedActions, expectedActions);
+	XCTAssertEqual(stallWatchdog.currentStepIndex, 2);
+
+	[stallWatchdog stallDidEnd];
+	XCTAssertFalse(stallWatchdog.stalled);
+	XCTAssertEqual(stallWatchdog.currentStepIndex, NSNotFound);
+	XCTAssertEqualObjects(self.lastRecoveredAction, @(RTSMediaPlayerStallRecoveryActionRebuildItem));
+
+	// No further action once recovered
+	[self waitForDuration:1.];
+	XCTAssertEqual(self.performedActions.count, 3);
+}
+
+- (void) testUnavailableActionsAreSkipped
+{
+	self.unavailableActions = [NSSet setWithObjects:@(RTSMediaPlayerStallRecoveryActionCapBitRate), @(RTSMediaPlayerStallRecoveryActionRebuildItem), nil];
+
+	RTSMediaPlayerStallWatchdog *stallWatchdog = [[RTSMediaPlayerStallWatchdog alloc] initWithSteps:[self stepsWithTimeout:0.5]];
+	stallWatchdog.delegate = self;
+	[stallWatchdog stallDidStart];
+
+	[self waitForDuration:0.8];
+	XCTAssertEqualObjects(self.performedActions, (@[ @(RTSMediaPlayerStallRecoveryActionWait), @(RTSMediaPlayerStallRecoveryActionSwitchURL) ]));
+
+	// All steps exhausted
+	[self waitForDuration:1.];
+	XCTAssertEqual(self.performedActions.count, 2);
+	XCTAssertTrue(stallWatchdog.stalled);
+}
+
+- (void) testCancel
+{
+	RTSMediaPlayerStallWatchdog *stallWatchdog = [[RTSMediaPlayerStallWatchdog alloc] initWithSteps:[self stepsWithTimeout:0.3]];
+	stallWatchdog.delegate = self;
+	[stallWatchdog stallDidStart];
+	[stallWatchdog cancel];
+
+	[self waitForDuration:1.];
+	XCTAssertEqual(self.performedActions.count, 1);
+	XCTAssertNil(self.lastRecoveredAction);
+	XCTAssertEqual(stallWatchdog.stallDuration, 0.);
+}
+
+- (void) testRebuildItemRecovers
+{
+	// Segments padded to 400 kbps, served slightly faster than they are played, then starved
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	server.networkProfile = [TestHLSNetworkProfile profileWithBandwidth:500000. latency:0.05];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+	mediaPlayerController.stallRecoverySteps = @[ [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionWait timeout:1.],
+												  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionRebuildItem timeout:20.] ];
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	server.networkProfile = [TestHLSNetworkProfile profileWithBandwidth:1000. latency:0.05];
+
+	// Rebuilding the item is not reported as a playback state change
+	__block BOOL rebuildStateReported = NO;
+	id playbackStateObserver = [[NSNotificationCenter defaultCenter] addObserverForName:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController queue:nil usingBlock:^(NSNotification *notification) {
+		RTSMediaPlaybackState playbackState = mediaPlayerController.playbackState;
+		if (playbackState == RTSMediaPlaybackStateIdle || playbackState == RTSMediaPlaybackStatePreparing || playbackState == RTSMediaPlaybackStateReady) {
+			rebuildStateReported = YES;
+		}
+	}];
+
+	// The network is restored when the item is rebuilt
+	__block CMTime stallTime = kCMTimeInvalid;
+	[self expectationForNotification:RTSMediaPlayerStallRecoveryActionNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		if ([notification.userInfo[RTSMediaPlayerStallRecoveryActionUserInfoKey] integerValue] != RTSMediaPlayerStallRecoveryActionRebuildItem) {
+			return NO;
+		}
+
+		server.networkProfile = [TestHLSNetworkProfile unlimitedProfile];
+		return YES;
+	}];
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		if (mediaPlayerController.playbackState == RTSMediaPlaybackStateStalled) {
+			stallTime = mediaPlayerController.playerItem.currentTime;
+		}
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStateStalled;
+	}];
+	[self expectationForNotification:RTSMediaPlayerDidRecoverFromStallNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertEqualObjects(notification.userInfo[RTSMediaPlayerStallRecoveryActionUserInfoKey], @(RTSMediaPlayerStallRecoveryActionRebuildItem));
+		XCTAssertTrue([notification.userInfo[RTSMediaPlayerStallDurationUserInfoKey] doubleValue] >= 1.);
+		return YES;
+	}];
+	[self waitForExpectationsWithTimeout:60. handler:nil];
+
+	[[NSNotificationCenter defaultCenter] removeObserver:playbackStateObserver];
+	XCTAssertFalse(rebuildStateReported);
+
+	// Playback resumed where it stalled
+	XCTAssertEqual(mediaPlayerController.playbackState, RTSMediaPlaybackStatePlaying);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(mediaPlayerController.playerItem.currentTime), CMTimeGetSeconds(stallTime), 2.);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+- (void) testSwitchURLRecovers
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	server.networkProfile = [TestHLSNetworkProfile profileWithBandwidth:500000. latency:0.05];
+	XCTAssertTrue([server start]);
+
+	self.alternateServer = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([self.alternateServer start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentIdentifier:server.masterPlaylistURL.absoluteString dataSource:self];
+	mediaPlayerController.stallRecoverySteps = @[ [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionWait timeout:1.],
+												  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionSwitchURL timeout:20.] ];
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// The first server stays starved, only the alternate one can serve the media
+	server.networkProfile = [TestHLSNetworkProfile profileWithBandwidth:1000. latency:0.05];
+
+	[self expectationForNotification:RTSMediaPlayerDidRecoverFromStallNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertEqualObjects(notification.userInfo[RTSMediaPlayerStallRecoveryActionUserInfoKey], @(RTSMediaPlayerStallRecoveryActionSwitchURL));
+		return YES;
+	}];
+	[self waitForExpectationsWithTimeout:60. handler:nil];
+
+	XCTAssertTrue([self.alternateServer.requestedPaths containsObject:@"/master.m3u8"]);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+@end
@@ -0,0 +1,145 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+@interface RTSMediaPlayerTrickPlayTestCase : XCTestCase
+
+@property (nonatomic) TestHLSServer *server;
+@property (nonatomic) RTSMediaPlayerController *mediaPlayerController;
+
+@end
+
+@implementation RTSMediaPlayerTrickPlayTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2.];
+	XCTAssertTrue([self.server start]);
+
+	self.mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:self.server.playlistURL];
+}
+
+- (void) tearDown
+{
+	[self.mediaPlayerController reset];
+	self.mediaPlayerController = nil;
+
+	[self.server stop];
+	self.server = nil;
+}
+
+#pragma mark - Helpers
+
+- (void) waitForPlaybackState:(RTSMediaPlaybackState)playbackState
+{
+	RTSMediaPlayerController *mediaPlayerController = self.mediaPlayerController;
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == playbackState;
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (NSTimeInterval) currentTime
+{
+	return CMTimeGetSeconds(self.mediaPlayerController.player.currentTime);
+}
+
+#pragma mark - Tests
+
+- (void) testFastForward
+{
+	[self.mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying];
+
+	NSTimeInterval startTime = [self currentTime];
+	[self.mediaPlayerController playAtRate:8.f];
+	XCTAssertEqual(self.mediaPlayerController.playbackState, RTSMediaPlaybackStateTrickPlaying);
+	XCTAssertEqual(self.mediaPlayerController.trickPlayRate, 8.f);
+
+	// The position moves much faster than time, with or without I-frames
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:2.]];
+	XCTAssertEqual(self.mediaPlayerController.playbackState, RTSMediaPlaybackStateTrickPlaying);
+	XCTAssertTrue([self currentTime] - startTime > 6.);
+
+	[self.mediaPlayerController playAtRate:1.f];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying];
+	XCTAssertEqual(self.mediaPlayerController.trickPlayRate, 0.f);
+	XCTAssertEqual(self.mediaPlayerController.player.rate, 1.f);
+}
+
+- (void) testFastReverseStopsAtBeginning
+{
+	[self.mediaPlayerController playAtTime:CMTimeMakeWithSeconds(10., NSEC_PER_SEC)];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying];
+
+	[self.mediaPlayerController playAtRate:-8.f];
+	XCTAssertEqual(self.mediaPlayerController.playbackState, RTSMediaPlaybackStateTrickPlaying);
+
+	[self waitForPlaybackState:RTSMediaPlaybackStatePaused];
+	XCTAssertEqualWithAccuracy([self currentTime], 0., 0.5);
+	XCTAssertEqual(self.mediaPlayerController.trickPlayRate, 0.f);
+}
+
+- (void) testSeekEndsTrickPlay
+{
+	[self.mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying];
+
+	[self.mediaPlayerController playAtRate:4.f];
+	XCTAssertEqual(self.mediaPlayerController.playbackState, RTSMediaPlaybackStateTrickPlaying);
+
+	XCTestExpectation *seekExpectation = [self expectationWithDescription:@"Seek finished"];
+	[self.mediaPlayerController seekToTime:CMTimeMakeWithSeconds(20., NSEC_PER_SEC) completionHandler:^(BOOL finished) {
+		[seekExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	XCTAssertEqual(self.mediaPlayerController.trickPlayRate, 0.f);
+	XCTAssertEqual(self.mediaPlayerController.player.rate, 1.f);
+	XCTAssertEqualWithAccuracy([self currentTime], 20., 0.5);
+}
+
+- (void) testStepsAreCoalesced
+{
+	[self.mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying];
+
+	// Stepping pauses playback
+	[self expectationForNotification:RTSMediaPlayerDidStepNotification object:self.mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		XCTAssertTrue([notification.userInfo[RTSMediaPlayerStepLatencyUserInfoKey] doubleValue] > 0.);
+		return YES;
+	}];
+	[self.mediaPlayerController stepByCount:1];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	XCTAssertEqual(self.mediaPlayerController.playbackState, RTSMediaPlaybackStatePaused);
+
+	// Steps requested in a row all apply (audio only, frames of the default 25 fps duration)
+	NSTimeInterval startTime = [self currentTime];
+	[self expectationForNotification:RTSMediaPlayerDidStepNotification object:self.mediaPlayerController handler:nil];
+	for (NSInteger i = 0; i < 5; ++i) {
+		[self.mediaPlayerController stepByCount:1];
+	}
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+	XCTAssertEqualWithAccuracy([self currentTime] - startTime, 5. / 25., 0.05);
+
+	startTime = [self currentTime];
+	[self expectationForNotification:RTSMediaPlayerDidStepNotification object:self.mediaPlayerController handler:nil];
+	[self.mediaPlayerController stepByCount:-2];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.5]];
+	XCTAssertEqualWithAccuracy([self currentTime] - startTime, -2. / 25., 0.05);
+}
+
+@end
@@ -0,0 +1,132 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+// One minute of periodic updates, every 200 ms
+static const NSUInteger PeriodicUpdateCount = 300;
+
+// Private bound properties and outlets
+@interface RTSMediaPlayerViewController (Tests)
+
+@property (nonatomic) BOOL timeSliderHidden;
+@property (nonatomic) BOOL hourLabelsDisplayed;
+@property (nonatomic) BOOL liveButtonVisible;
+
+@property (weak) NSLayoutConstraint *valueLabelWidthConstraint;
+@property (weak) NSLayoutConstraint *timeLeftValueLabelWidthConstraint;
+
+@end
+
+// Count layout passes, which the shipping class does not do
+@interface TestMediaPlayerViewController : RTSMediaPlayerViewController
+
+@property (nonatomic) NSUInteger layoutPassCount;
+
+@end
+
+@implementation TestMediaPlayerViewController
+
+- (void) viewDidLayoutSubviews
+{
+	[super viewDidLayoutSubviews];
+	++self.layoutPassCount;
+}
+
+@end
+
+@interface RTSMediaPlayerViewControllerTestCase : XCTestCase
+
+@property (nonatomic) TestHLSServer *server;
+@property (nonatomic) TestMediaPlayerViewController *mediaPlayerViewController;
+
+@end
+
+@implementation RTSMediaPlayerViewControllerTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2.];
+	XCTAssertTrue([self.server start]);
+
+	self.mediaPlayerViewController = [[TestMediaPlayerViewController alloc] initWithContentURL:self.server.playlistURL];
+
+	// Lay the view out once. The run loop is never run afterwards, so that playback notifications cannot update bindings
+	// while a test is running
+	UIView *view = self.mediaPlayerViewController.view;
+	view.frame = CGRectMake(0.f, 0.f, 568.f, 320.f);
+	[view layoutIfNeeded];
+}
+
+- (void) tearDown
+{
+	[self.mediaPlayerViewController.mediaPlayerController reset];
+	self.mediaPlayerViewController = nil;
+
+	[self.server stop];
+	self.server = nil;
+}
+
+#pragma mark - Tests
+
+- (void) testUnchangedBindingsDoNotTriggerLayout
+{
+	TestMediaPlayerViewController *mediaPlayerViewController = self.mediaPlayerViewController;
+	NSUInteger layoutPassCount = mediaPlayerViewController.layoutPassCount;
+
+	// What the periodic observer does every 200 ms during playback
+	for (NSInteger i = 0; i < 100; ++i) {
+		mediaPlayerViewController.timeSliderHidden = mediaPlayerViewController.timeSliderHidden;
+		mediaPlayerViewController.hourLabelsDisplayed = mediaPlayerViewController.hourLabelsDisplayed;
+		mediaPlayerViewController.liveButtonVisible = mediaPlayerViewController.liveButtonVisible;
+		[mediaPlayerViewController.view layoutIfNeeded];
+	}
+	XCTAssertEqual(mediaPlayerViewController.layoutPassCount, layoutPassCount);
+
+	// Label widths are constraints, changing them requires a new layout pass
+	mediaPlayerViewController.hourLabelsDisplayed = !mediaPlayerViewController.hourLabelsDisplayed;
+	[mediaPlayerViewController.view layoutIfNeeded];
+	XCTAssertEqual(mediaPlayerViewController.layoutPassCount, layoutPassCount + 1);
+
+	mediaPlayerViewController.hourLabelsDisplayed = mediaPlayerViewController.hourLabelsDisplayed;
+	[mediaPlayerViewController.view layoutIfNeeded];
+	XCTAssertEqual(mediaPlayerViewController.layoutPassCount, layoutPassCount + 1);
+}
+
+- (void) testLayoutPassesPerPeriodicUpdate
+{
+	TestMediaPlayerViewController *mediaPlayerViewController = self.mediaPlayerViewController;
+
+	// What the periodic observer did before bindings were introduced: label widths were rewritten every 200 ms
+	NSUInteger layoutPassCount = mediaPlayerViewController.layoutPassCount;
+	for (NSUInteger i = 0; i < PeriodicUpdateCount; ++i) {
+		mediaPlayerViewController.valueLabelWidthConstraint.constant = mediaPlayerViewController.valueLabelWidthConstraint.constant;
+		mediaPlayerViewController.timeLeftValueLabelWidthConstraint.constant = mediaPlayerViewController.timeLeftValueLabelWidthConstraint.constant;
+		[mediaPlayerViewController.view setNeedsLayout];
+		[mediaPlayerViewController.view layoutIfNeeded];
+	}
+	NSUInteger unboundLayoutPassCount = mediaPlayerViewController.layoutPassCount - layoutPassCount;
+
+	layoutPassCount = mediaPlayerViewController.layoutPassCount;
+	for (NSUInteger i = 0; i < PeriodicUpdateCount; ++i) {
+		mediaPlayerViewController.timeSliderHidden = mediaPlayerViewController.timeSliderHidden;
+		mediaPlayerViewController.hourLabelsDisplayed = mediaPlayerViewController.hourLabelsDisplayed;
+		mediaPlayerViewController.liveButtonVisible = mediaPlayerViewController.liveButtonVisible;
+		[mediaPlayerViewController.view layoutIfNeeded];
+	}
+	NSUInteger boundLayoutPassCount = mediaPlayerViewController.layoutPassCount - layoutPassCount;
+
+	NSLog(@"Layout passes per minute of steady playback: %@ before bindings, %@ with bindings", @(unboundLayoutPassCount), @(boundLayoutPassCount));
+	XCTAssertEqual(unboundLayoutPassCount, PeriodicUpdateCount);
+	XCTAssertEqual(boundLayoutPassCount, 0);
+}
+
+@end
@@ -0,0 +1,127 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+@interface ZappingTestDataSource : NSObject <RTSMediaPlayerControllerDataSource>
+
+@end
+
+@interface RTSMediaPlayerZappingControllerTestCase : XCTestCase
+
+@property (nonatomic) ZappingTestDataSource *dataSource;
+@property (nonatomic) RTSMediaPlayerZappingController *zappingController;
+
+@end
+
+@implementation RTSMediaPlayerZappingControllerTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.dataSource = [[ZappingTestDataSource alloc] init];
+	self.zappingController = [[RTSMediaPlayerZappingController alloc] initWithDataSource:self.dataSource];
+	self.zappingController.identifiers = @[ @"CHANNEL-1", @"CHANNEL-2", @"CHANNEL-3", @"CHANNEL-4" ];
+}
+
+- (void) tearDown
+{
+	[self.zappingController reset];
+	self.zappingController = nil;
+	self.dataSource = nil;
+}
+
+#pragma mark - Helpers
+
+- (NSArray<NSString *> *) neighbourIdentifiers
+{
+	NSArray<NSString *> *identifiers = [self.zappingController.neighbourMediaPlayerControllers valueForKey:@"identifier"];
+	return [identifiers sortedArrayUsingSelector:@selector(compare:)];
+}
+
+#pragma mark - Tests
+
+- (void) testNeighboursAroundCurrentIdentifier
+{
+	[self.zappingController playIdentifier:@"CHANNEL-1"];
+	XCTAssertEqualObjects(self.zappingController.currentIdentifier, @"CHANNEL-1");
+	XCTAssertFalse(self.zappingController.mediaPlayerController.muted);
+
+	// The list wraps around
+	XCTAssertEqualObjects([self neighbourIdentifiers], (@[ @"CHANNEL-2", @"CHANNEL-4" ]));
+	for (RTSMediaPlayerController *neighbourMediaPlayerController in self.zappingController.neighbourMediaPlayerControllers) {
+		XCTAssertTrue(neighbourMediaPlayerController.muted);
+		XCTAssertEqual(neighbourMediaPlayerController.preferredPeakBitRate, RTSMediaPlayerZappingControllerDefaultNeighbourPeakBitRate);
+		XCTAssertEqual(neighbourMediaPlayerController.bufferBudget, self.zappingController.bufferBudget);
+	}
+
+	self.zappingController.neighbourCount = 0;
+	XCTAssertEqual(self.zappingController.neighbourMediaPlayerControllers.count, 0);
+
+	self.zappingController.neighbourCount = 5;
+	XCTAssertEqualObjects([self neighbourIdentifiers], (@[ @"CHANNEL-2", @"CHANNEL-3", @"CHANNEL-4" ]));
+}
+
+- (void) testZapToPreBufferedNeighbour
+{
+	[self.zappingController playIdentifier:@"CHANNEL-1"];
+
+	RTSMediaPlayerController *activeMediaPlayerController = self.zappingController.mediaPlayerController;
+	RTSMediaPlayerController *nextMediaPlayerController = [self.zappingController.neighbourMediaPlayerControllers filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"identifier == %@", @"CHANNEL-2"]].firstObject;
+	XCTAssertNotNil(nextMediaPlayerController);
+
+	// Wait until the neighbour is pre-buffered
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:nextMediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return nextMediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[self expectationForNotification:RTSMediaPlayerZappingControllerDidZapNotification object:self.zappingController handler:^BOOL(NSNotification *notification) {
+		XCTAssertTrue([notification.userInfo[RTSMediaPlayerZapPreBufferedUserInfoKey] boolValue]);
+		XCTAssertNotNil(notification.userInfo[RTSMediaPlayerZapLatencyUserInfoKey]);
+		return YES;
+	}];
+	[self.zappingController zapToNextIdentifier];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// The neighbour player has been promoted, and the previously active player is now a muted neighbour
+	XCTAssertEqual(self.zappingController.mediaPlayerController, nextMediaPlayerController);
+	XCTAssertFalse(nextMediaPlayerController.muted);
+	XCTAssertEqual(nextMediaPlayerController.preferredPeakBitRate, 0.);
+	XCTAssertTrue([self.zappingController.neighbourMediaPlayerControllers containsObject:activeMediaPlayerController]);
+	XCTAssertTrue(activeMediaPlayerController.muted);
+	XCTAssertEqualObjects([self neighbourIdentifiers], (@[ @"CHANNEL-1", @"CHANNEL-3" ]));
+	XCTAssertTrue(self.zappingController.lastZapLatency >= 0.);
+}
+
+- (void) testIdentifierOutsideList
+{
+	[self.zappingController playIdentifier:@"OTHER"];
+	XCTAssertEqualObjects(self.zappingController.currentIdentifier, @"OTHER");
+	XCTAssertEqual(self.zappingController.neighbourMediaPlayerControllers.count, 0);
+
+	[self.zappingController zapToNextIdentifier];
+	XCTAssertEqualObjects(self.zappingController.currentIdentifier, @"OTHER");
+}
+
+@end
+
+@implementation ZappingTestDataSource
+
+#pragma mark - RTSMediaPlayerControllerDataSource protocol
+
+- (id)mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController contentURLForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSString *, NSURL *, NSError *))completionHandler
+{
+	completionHandler(identifier, [NSURL URLWithString:@"https://devimages.apple.com.edgekey.net/streaming/examples/bipbop_16x9/bipbop_16x9_variant.m3u8"], nil);
+	return nil;
+}
+
+- (void)cancelContentURLRequest:(id)request
+{}
+
+@end
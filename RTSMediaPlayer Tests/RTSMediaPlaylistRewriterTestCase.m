@@ -0,0 +1,188 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+static NSString * const RTSMediaPlaylistRewriterTestMasterPlaylist = @"#EXTM3U\n"
+	"#EXT-X-MEDIA:TYPE=AUDIO,GROUP-ID=\"audio\",NAME=\"English\",URI=\"audio/en.m3u8\"\n"
+	"#EXT-X-STREAM-INF:BANDWIDTH=12000000,RESOLUTION=3840x2160,AUDIO=\"audio\"\n"
+	"2160p/index.m3u8\n"
+	"#EXT-X-STREAM-INF:BANDWIDTH=5000000,RESOLUTION=1920x1080,AUDIO=\"audio\"\n"
+	"1080p/index.m3u8\n"
+	"#EXT-X-STREAM-INF:BANDWIDTH=2500000,RESOLUTION=1280x720,AUDIO=\"audio\"\n"
+	"720p/index.m3u8\n"
+	"#EXT-X-STREAM-INF:BANDWIDTH=1200000,RESOLUTION=960x540,AUDIO=\"audio\"\n"
+	"540p/index.m3u8\n"
+	"#EXT-X-STREAM-INF:BANDWIDTH=600000,RESOLUTION=640x360,AUDIO=\"audio\"\n"
+	"360p/index.m3u8\n"
+	"#EXT-X-STREAM-INF:BANDWIDTH=64000,CODECS=\"mp4a.40.2\"\n"
+	"audio/index.m3u8\n"
+	"#EXT-X-I-FRAME-STREAM-INF:BANDWIDTH=300000,RESOLUTION=1280x720,URI=\"720p/iframes.m3u8\"\n";
+
+@interface RTSMediaPlaylistRewriterTestCase : XCTestCase
+
+@property (nonatomic) RTSMediaPlaylistRewriter *playlistRewriter;
+
+@end
+
+@implementation RTSMediaPlaylistRewriterTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.playlistRewriter = [[RTSMediaPlaylistRewriter alloc] init];
+	self.playlistRewriter.maximumResolution = CGSizeMake(1920., 1080.);
+}
+
+#pragma mark - Helpers
+
+- (NSArray<NSString *> *) variantURIsInPlaylist:(NSString *)playlist
+{
+	NSMutableArray<NSString *> *variantURIs = [NSMutableArray array];
+	NSArray<NSString *> *lines = [playlist componentsSeparatedByString:@"\n"];
+	[lines enumerateObjectsUsingBlock:^(NSString *line, NSUInteger index, BOOL *stop) {
+		if ([line hasPrefix:@"#EXT-X-STREAM-INF:"] && index + 1 < lines.count) {
+			[variantURIs addObject:lines[index + 1]];
+		}
+	}];
+	return [variantURIs copy];
+}
+
+- (NSString *) rewrittenPlaylist:(NSString *)playlist viewSize:(CGSize)viewSize
+{
+	NSData *data = [self.playlistRewriter rewrittenPlaylistWithData:[playlist dataUsingEncoding:NSUTF8StringEncoding]
+																URL:[NSURL URLWithString:@"http://www.server.com/media/master.m3u8"]
+														   viewSize:viewSize];
+	return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+// Late requests made by a previous player might be received after the master playlist has been requested
+- (NSString *) firstVariantPlaylistPathRequestedFromServer:(TestHLSServer *)server
+{
+	NSArray<NSString *> *requestedPaths = server.requestedPaths;
+	NSUInteger masterPlaylistIndex = [requestedPaths indexOfObject:@"/master.m3u8"];
+	if (masterPlaylistIndex == NSNotFound) {
+		return nil;
+	}
+
+	for (NSString *path in [requestedPaths subarrayWithRange:NSMakeRange(masterPlaylistIndex + 1, requestedPaths.count - masterPlaylistIndex - 1)]) {
+		if ([path hasPrefix:@"/variant"] && [path.lastPathComponent isEqualToString:@"playlist.m3u8"]) {
+			return path;
+		}
+	}
+	return nil;
+}
+
+- (NSTimeInterval) startupDurationWithMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+
+	CFTimeInterval startTime = CACurrentMediaTime();
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	NSTimeInterval startupDuration = CACurrentMediaTime() - startTime;
+
+	[mediaPlayerController reset];
+	return startupDuration;
+}
+
+#pragma mark - Tests
+
+- (void) testFirstVariantMatchesBandwidthAndViewSize
+{
+	self.playlistRewriter.estimatedBandwidth = 4000000.;
+
+	// 3.2 Mbps available, 720p fits
+	NSString *playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeMake(1334., 750.)];
+	XCTAssertEqualObjects([self variantURIsInPlaylist:playlist].firstObject, @"http://www.server.com/media/720p/index.m3u8");
+
+	// Small view
+	playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeMake(640., 360.)];
+	XCTAssertEqualObjects([self variantURIsInPlaylist:playlist].firstObject, @"http://www.server.com/media/360p/index.m3u8");
+
+	// Unknown view size, best variant within the bandwidth
+	playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeZero];
+	XCTAssertEqualObjects([self variantURIsInPlaylist:playlist].firstObject, @"http://www.server.com/media/720p/index.m3u8");
+
+	// Not enough bandwidth for any video variant: the lightest video variant is used, never audio only
+	self.playlistRewriter.estimatedBandwidth = 100000.;
+	playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeMake(1334., 750.)];
+	XCTAssertEqualObjects([self variantURIsInPlaylist:playlist].firstObject, @"http://www.server.com/media/360p/index.m3u8");
+}
+
+- (void) testOtherVariantsKeepTheirOrder
+{
+	self.playlistRewriter.estimatedBandwidth = 2000000.;
+
+	NSString *playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeMake(1920., 1080.)];
+	NSArray<NSString *> *expectedVariantURIs = @[ @"http://www.server.com/media/540p/index.m3u8",
+												  @"http://www.server.com/media/1080p/index.m3u8",
+												  @"http://www.server.com/media/720p/index.m3u8",
+												  @"http://www.server.com/media/360p/index.m3u8",
+												  @"http://www.server.com/media/audio/index.m3u8" ];
+	XCTAssertEqualObjects([self variantURIsInPlaylist:playlist], expectedVariantURIs);
+}
+
+- (void) testVariantsExceedingCapsAreDropped
+{
+	NSString *playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeZero];
+	XCTAssertFalse([playlist containsString:@"2160p"]);
+
+	self.playlistRewriter.maximumBitRate = 3000000.;
+	playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeZero];
+	XCTAssertEqual([self variantURIsInPlaylist:playlist].count, 4);
+	XCTAssertFalse([playlist containsString:@"1080p"]);
+
+	// Variants are kept if none is supported
+	self.playlistRewriter.maximumBitRate = 1000.;
+	playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeZero];
+	XCTAssertEqual([self variantURIsInPlaylist:playlist].count, 6);
+}
+
+- (void) testURIsAreMadeAbsolute
+{
+	NSString *playlist = [self rewrittenPlaylist:RTSMediaPlaylistRewriterTestMasterPlaylist viewSize:CGSizeZero];
+	XCTAssertTrue([playlist containsString:@"URI=\"http://www.server.com/media/audio/en.m3u8\""]);
+	XCTAssertTrue([playlist containsString:@"URI=\"http://www.server.com/media/720p/iframes.m3u8\""]);
+
+	// Media playlists are left untouched otherwise
+	NSString *mediaPlaylist = @"#EXTM3U\r\n#EXT-X-TARGETDURATION:10\r\n#EXTINF:10,\r\nsegment0.ts\r\n#EXTINF:10,\r\n/absolute/segment1.ts\r\n#EXT-X-ENDLIST";
+	playlist = [self rewrittenPlaylist:mediaPlaylist viewSize:CGSizeZero];
+	NSString *expectedPlaylist = @"#EXTM3U\n#EXT-X-TARGETDURATION:10\n#EXTINF:10,\nhttp://www.server.com/media/segment0.ts\n#EXTINF:10,\nhttp://www.server.com/absolute/segment1.ts\n#EXT-X-ENDLIST\n";
+	XCTAssertEqualObjects(playlist, expectedPlaylist);
+}
+
+- (void) testStartupLatencyBenchmark
+{
+	// Variants listed from the highest to the lowest bandwidth, on a 2 Mbps network
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:5 segmentDuration:4. variantBandwidths:@[ @4000000, @2000000, @800000, @200000 ]];
+	XCTAssertTrue([server start]);
+	server.maximumThroughput = 2000000.;
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+	NSTimeInterval startupDuration = [self startupDurationWithMediaPlayerController:mediaPlayerController];
+	XCTAssertEqualObjects([self firstVariantPlaylistPathRequestedFromServer:server], [server pathForVariantPlaylistAtIndex:0]);
+
+	[server resetStatistics];
+
+	self.playlistRewriter.estimatedBandwidth = 2000000.;
+	mediaPlayerController.playlistRewriter = self.playlistRewriter;
+	NSTimeInterval rewrittenStartupDuration = [self startupDurationWithMediaPlayerController:mediaPlayerController];
+	XCTAssertEqualObjects([self firstVariantPlaylistPathRequestedFromServer:server], [server pathForVariantPlaylistAtIndex:2]);
+
+	NSLog(@"Startup in %.3f sec. (%.3f sec. with playlist rewriting)", startupDuration, rewrittenStartupDuration);
+	XCTAssertTrue(rewrittenStartupDuration < startupDuration);
+
+	[server stop];
+}
+
+@end
@@ -0,0 +1,221 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+@interface RTSMediaPrecacheTestCase : XCTestCase <RTSMediaPlayerControllerDataSource>
+
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) NSMutableDictionary<NSString *, NSURL *> *contentURLs;
+@property (nonatomic) NSUInteger contentURLRequestCount;
+
+@end
+
+@implementation RTSMediaPrecacheTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString]];
+	self.contentURLs = [NSMutableDictionary dictionary];
+	self.contentURLRequestCount = 0;
+}
+
+- (void) tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:NULL];
+}
+
+#pragma mark - Helpers
+
+- (NSArray<NSString *> *) precacheIdentifiers:(NSArray<NSString *> *)identifiers withPrecache:(RTSMediaPrecache *)precache
+{
+	__block NSArray<NSString *> *precachedIdentifiers = nil;
+	XCTestExpectation *precacheExpectation = [self expectationWithDescription:@"Precaching finished"];
+	[precache precacheIdentifiers:identifiers withDataSource:self completionHandler:^(NSArray<NSString *> *identifiers) {
+		XCTAssertTrue([NSThread isMainThread]);
+		precachedIdentifiers = identifiers;
+		[precacheExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	return precachedIdentifiers;
+}
+
+#pragma mark - RTSMediaPlayerControllerDataSource protocol
+
+- (id) mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+	 contentURLForIdentifier:(NSString *)identifier
+		   completionHandler:(void (^)(NSString *identifier, NSURL *contentURL, NSError *error))completionHandler
+{
+	XCTAssertTrue([NSThread isMainThread]);
+	self.contentURLRequestCount++;
+	completionHandler(identifier, self.contentURLs[identifier], nil);
+	return nil;
+}
+
+- (void) cancelContentURLRequest:(id)request
+{}
+
+#pragma mark - Tests
+
+- (void) testPrecaching
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000, @200000 ]];
+	XCTAssertTrue([server start]);
+	self.contentURLs[@"media"] = server.masterPlaylistURL;
+
+	RTSMediaPrecache *precache = [[RTSMediaPrecache alloc] initWithDirectoryURL:self.directoryURL];
+	precache.prefetchedDuration = 5.;
+	XCTAssertFalse([precache containsIdentifier:@"media"]);
+
+	// Unknown identifiers are not precached
+	NSArray<NSString *> *precachedIdentifiers = [self precacheIdentifiers:@[ @"media", @"unknown" ] withPrecache:precache];
+	XCTAssertEqualObjects(precachedIdentifiers, @[ @"media" ]);
+	XCTAssertTrue([precache containsIdentifier:@"media"]);
+	XCTAssertEqualObjects([precache contentURLForIdentifier:@"media"], server.masterPlaylistURL);
+
+	// The first variant listed, and the segments covering the prefetched duration
+	NSArray<NSString *> *expectedPaths = @[ @"/master.m3u8",
+											[server pathForVariantPlaylistAtIndex:0],
+											@"/variant0/segment0.aac",
+											@"/variant0/segment1.aac",
+											@"/variant0/segment2.aac" ];
+	XCTAssertEqualObjects(server.requestedPaths, expectedPaths);
+	XCTAssertTrue(precache.byteCount > 0);
+	XCTAssertTrue(precache.byteCount <= precache.byteBudget);
+
+	// Precached identifiers are neither resolved nor fetched again, also by another precache using the same directory
+	[server resetStatistics];
+	self.contentURLRequestCount = 0;
+
+	RTSMediaPrecache *otherPrecache = [[RTSMediaPrecache alloc] initWithDirectoryURL:self.directoryURL];
+	XCTAssertEqualObjects([self precacheIdentifiers:@[ @"media" ] withPrecache:otherPrecache], @[ @"media" ]);
+	XCTAssertEqual(self.contentURLRequestCount, 0);
+	XCTAssertEqual(server.requestedPaths.count, 0);
+	XCTAssertEqual(otherPrecache.byteCount, precache.byteCount);
+
+	[otherPrecache removeIdentifier:@"media"];
+	XCTAssertFalse([otherPrecache containsIdentifier:@"media"]);
+	XCTAssertEqual(otherPrecache.byteCount, 0);
+
+	[server stop];
+}
+
+- (void) testExpiration
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([server start]);
+	self.contentURLs[@"media"] = server.masterPlaylistURL;
+
+	RTSMediaPrecache *precache = [[RTSMediaPrecache alloc] initWithDirectoryURL:self.directoryURL];
+	[self precacheIdentifiers:@[ @"media" ] withPrecache:precache];
+	XCTAssertTrue([precache containsIdentifier:@"media"]);
+
+	precache.maximumEntryAge = 0.;
+	XCTAssertFalse([precache containsIdentifier:@"media"]);
+	XCTAssertNil([precache contentURLForIdentifier:@"media"]);
+	XCTAssertNil([precache assetForIdentifier:@"media" contentURL:server.masterPlaylistURL]);
+
+	[server stop];
+}
+
+- (void) testByteBudget
+{
+	NSMutableArray<TestHLSServer *> *servers = [NSMutableArray array];
+	NSMutableArray<NSString *> *identifiers = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 3; ++i) {
+		TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+		XCTAssertTrue([server start]);
+		[servers addObject:server];
+
+		NSString *identifier = [NSString stringWithFormat:@"media%@", @(i)];
+		self.contentURLs[identifier] = server.masterPlaylistURL;
+		[identifiers addObject:identifier];
+	}
+
+	// Enough for a few segments of the first media only
+	unsigned long long segmentSize = 400000. * servers.firstObject.segmentDuration / 8.;
+	unsigned long long byteBudget = 5 * segmentSize;
+
+	RTSMediaPrecache *precache = [[RTSMediaPrecache alloc] initWithDirectoryURL:self.directoryURL];
+	precache.byteBudget = byteBudget;
+	precache.prefetchedDuration = 20.;
+
+	// The first identifiers have priority. Later ones are still precached (at least their playlists) once the budget is exhausted
+	NSArray<NSString *> *precachedIdentifiers = [self precacheIdentifiers:identifiers withPrecache:precache];
+	XCTAssertEqualObjects(precachedIdentifiers, identifiers);
+	XCTAssertTrue(precache.byteCount <= byteBudget);
+	XCTAssertTrue([servers[0].requestedPaths containsObject:@"/variant0/segment3.aac"]);
+	XCTAssertFalse([servers[0].requestedPaths containsObject:@"/variant0/segment5.aac"]);
+	XCTAssertNotNil([precache assetForIdentifier:@"media2" contentURL:servers[2].masterPlaylistURL]);
+
+	// Older entries are evicted to make room for new ones
+	precache.byteBudget = 3 * segmentSize;
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([server start]);
+	[servers addObject:server];
+	self.contentURLs[@"media3"] = server.masterPlaylistURL;
+
+	XCTAssertEqualObjects([self precacheIdentifiers:@[ @"media3" ] withPrecache:precache], @[ @"media3" ]);
+	XCTAssertTrue([precache containsIdentifier:@"media3"]);
+	XCTAssertFalse([precache containsIdentifier:@"media0"]);
+	XCTAssertTrue(precache.byteCount <= precache.byteBudget);
+
+	for (TestHLSServer *server in servers) {
+		[server stop];
+	}
+}
+
+- (void) testLiveStream
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeLive segmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([server start]);
+	self.contentURLs[@"live"] = server.masterPlaylistURL;
+
+	// The start of live playlists moves, segments are not precached
+	RTSMediaPrecache *precache = [[RTSMediaPrecache alloc] initWithDirectoryURL:self.directoryURL];
+	XCTAssertEqualObjects([self precacheIdentifiers:@[ @"live" ] withPrecache:precache], @[ @"live" ]);
+	XCTAssertEqualObjects(server.requestedPaths, (@[ @"/master.m3u8", [server pathForVariantPlaylistAtIndex:0] ]));
+
+	[server stop];
+}
+
+- (void) testPlaybackFromPrecache
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000, @200000 ]];
+	XCTAssertTrue([server start]);
+	self.contentURLs[@"media"] = server.masterPlaylistURL;
+
+	RTSMediaPrecache *precache = [[RTSMediaPrecache alloc] initWithDirectoryURL:self.directoryURL];
+	[self precacheIdentifiers:@[ @"media" ] withPrecache:precache];
+
+	[server resetStatistics];
+	self.contentURLRequestCount = 0;
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentIdentifier:@"other" dataSource:self];
+	mediaPlayerController.precache = precache;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController playIdentifier:@"media"];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	// Playback started from the cache, without resolving the URL
+	XCTAssertEqual(self.contentURLRequestCount, 0);
+	XCTAssertFalse([server.requestedPaths containsObject:@"/master.m3u8"]);
+	XCTAssertFalse([server.requestedPaths containsObject:[server pathForVariantPlaylistAtIndex:0]]);
+	XCTAssertFalse([server.requestedPaths containsObject:@"/variant0/segment0.aac"]);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+@end
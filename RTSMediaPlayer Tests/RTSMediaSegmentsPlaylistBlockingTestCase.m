@@ -0,0 +1,237 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "Segment.h"
+#import "TestHLSServer.h"
+
+static NSString * const PlaylistBlockingTestMediaIdentifier = @"MEDIA";
+
+@interface PlaylistBlockingTestDataSource : NSObject <RTSMediaPlayerControllerDataSource, RTSMediaSegmentsDataSource>
+
+- (instancetype)initWithServer:(TestHLSServer *)server;
+
+@property (nonatomic, readonly) TestHLSServer *server;
+
+@end
+
+@interface RTSMediaSegmentsPlaylistBlockingTestCase : XCTestCase
+
+@property (nonatomic) TestHLSServer *server;
+@property (nonatomic) PlaylistBlockingTestDataSource *dataSource;
+
+@property (nonatomic) RTSMediaPlayerController *mediaPlayerController;
+@property (nonatomic) RTSMediaSegmentsController *mediaSegmentsController;
+
+@end
+
+@implementation RTSMediaSegmentsPlaylistBlockingTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.server = [[TestHLSServer alloc] initWithSegmentCount:20 segmentDuration:6.];
+	XCTAssertTrue([self.server start]);
+
+	self.dataSource = [[PlaylistBlockingTestDataSource alloc] initWithServer:self.server];
+
+	self.mediaPlayerController = [[RTSMediaPlayerController alloc] init];
+	self.mediaPlayerController.dataSource = self.dataSource;
+
+	self.mediaSegmentsController = [[RTSMediaSegmentsController alloc] init];
+	self.mediaSegmentsController.dataSource = self.dataSource;
+	self.mediaSegmentsController.playerController = self.mediaPlayerController;
+	self.mediaSegmentsController.removesBlockedSegmentsFromPlaylist = YES;
+}
+
+- (void) tearDown
+{
+	[self.mediaPlayerController reset];
+	self.mediaPlayerController = nil;
+	self.mediaSegmentsController = nil;
+	self.dataSource = nil;
+
+	[self.server stop];
+	self.server = nil;
+}
+
+#pragma mark - Tests
+
+- (void) testBlockedMediaSegmentsAreRemovedFromPlaylist
+{
+	NSString *playlist = @"#EXTM3U\n#EXT-X-TARGETDURATION:10\n#EXT-X-PLAYLIST-TYPE:VOD\n"
+		"#EXTINF:10,\nsegment0.ts\n#EXTINF:10,\nsegment1.ts\n#EXTINF:10,\nsegment2.ts\n"
+		"#EXTINF:10,\nsegment3.ts\n#EXTINF:10,\nsegment4.ts\n#EXTINF:10,\nsegment5.ts\n#EXT-X-ENDLIST\n";
+
+	// The second blocked range only partially covers media segments, which must be kept
+	NSArray<NSValue *> *blockedTimeRanges = @[ [NSValue valueWithCMTimeRange:CMTimeRangeMake(CMTimeMakeWithSeconds(15., NSEC_PER_SEC), CMTimeMakeWithSeconds(25., NSEC_PER_SEC))],
+											   [NSValue valueWithCMTimeRange:CMTimeRangeMake(CMTimeMakeWithSeconds(45., NSEC_PER_SEC), CMTimeMakeWithSeconds(10., NSEC_PER_SEC))] ];
+
+	NSArray<NSValue *> *removedTimeRanges = nil;
+	NSData *data = [[[RTSMediaPlaylistRewriter alloc] init] rewrittenPlaylistWithData:[playlist dataUsingEncoding:NSUTF8StringEncoding]
+																				  URL:[NSURL URLWithString:@"http://www.server.com/media/playlist.m3u8"]
+																			 viewSize:CGSizeZero
+																	blockedTimeRanges:blockedTimeRanges
+																	removedTimeRanges:&removedTimeRanges];
+	NSString *rewrittenPlaylist = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+
+	NSString *expectedPlaylist = @"#EXTM3U\n#EXT-X-TARGETDURATION:10\n#EXT-X-PLAYLIST-TYPE:VOD\n"
+		"#EXTINF:10,\nhttp://www.server.com/media/segment0.ts\n#EXTINF:10,\nhttp://www.server.com/media/segment1.ts\n"
+		"#EXT-X-DISCONTINUITY\n#EXTINF:10,\nhttp://www.server.com/media/segment4.ts\n#EXTINF:10,\nhttp://www.server.com/media/segment5.ts\n#EXT-X-ENDLIST\n";
+	XCTAssertEqualObjects(rewrittenPlaylist, expectedPlaylist);
+
+	XCTAssertEqual(removedTimeRanges.count, 1);
+	CMTimeRange removedTimeRange = [removedTimeRanges.firstObject CMTimeRangeValue];
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(removedTimeRange.start), 20., 0.001);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(removedTimeRange.duration), 20., 0.001);
+}
+
+- (void) testLiveSlidingWindowIsLeftUntouched
+{
+	NSString *playlist = @"#EXTM3U\n#EXT-X-TARGETDURATION:10\n#EXT-X-MEDIA-SEQUENCE:42\n"
+		"#EXTINF:10,\nsegment42.ts\n#EXTINF:10,\nsegment43.ts\n";
+	NSArray<NSValue *> *blockedTimeRanges = @[ [NSValue valueWithCMTimeRange:CMTimeRangeMake(kCMTimeZero, CMTimeMakeWithSeconds(60., NSEC_PER_SEC))] ];
+
+	NSArray<NSValue *> *removedTimeRanges = nil;
+	NSData *data = [[[RTSMediaPlaylistRewriter alloc] init] rewrittenPlaylistWithData:[playlist dataUsingEncoding:NSUTF8StringEncoding]
+																				  URL:[NSURL URLWithString:@"http://www.server.com/live/playlist.m3u8"]
+																			 viewSize:CGSizeZero
+																	blockedTimeRanges:blockedTimeRanges
+																	removedTimeRanges:&removedTimeRanges];
+	NSString *rewrittenPlaylist = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+
+	XCTAssertTrue([rewrittenPlaylist containsString:@"segment42.ts"]);
+	XCTAssertTrue([rewrittenPlaylist containsString:@"segment43.ts"]);
+	XCTAssertEqual(removedTimeRanges.count, 0);
+}
+
+- (void) testLiveWindowStartingAtFirstSegmentIsLeftUntouched
+{
+	// Later reloads of the same playlist do not start at sequence 0 anymore. Removed time ranges must not change
+	NSString *playlist = @"#EXTM3U\n#EXT-X-TARGETDURATION:10\n#EXT-X-MEDIA-SEQUENCE:0\n"
+		"#EXTINF:10,\nsegment0.ts\n#EXTINF:10,\nsegment1.ts\n";
+	NSArray<NSValue *> *blockedTimeRanges = @[ [NSValue valueWithCMTimeRange:CMTimeRangeMake(kCMTimeZero, CMTimeMakeWithSeconds(60., NSEC_PER_SEC))] ];
+
+	NSArray<NSValue *> *removedTimeRanges = nil;
+	NSData *data = [[[RTSMediaPlaylistRewriter alloc] init] rewrittenPlaylistWithData:[playlist dataUsingEncoding:NSUTF8StringEncoding]
+																				  URL:[NSURL URLWithString:@"http://www.server.com/live/playlist.m3u8"]
+																			 viewSize:CGSizeZero
+																	blockedTimeRanges:blockedTimeRanges
+																	removedTimeRanges:&removedTimeRanges];
+	NSString *rewrittenPlaylist = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+
+	XCTAssertTrue([rewrittenPlaylist containsString:@"segment0.ts"]);
+	XCTAssertTrue([rewrittenPlaylist containsString:@"segment1.ts"]);
+	XCTAssertEqual(removedTimeRanges.count, 0);
+}
+
+// Blocked segment from 30 to 60 seconds, played across from 28 seconds
+- (void) testBlockedMediaSegmentsAreNeverFetched
+{
+	XCTestExpectation *segmentsExpectation = [self expectationWithDescription:@"Segments loaded"];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:PlaylistBlockingTestMediaIdentifier completionHandler:^(NSError *error) {
+		XCTAssertNil(error);
+		[segmentsExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	__block BOOL seekUponBlocking = NO;
+	id segmentObserver = [[NSNotificationCenter defaultCenter] addObserverForName:RTSMediaPlaybackSegmentDidChangeNotification object:self.mediaSegmentsController queue:nil usingBlock:^(NSNotification *notification) {
+		if ([notification.userInfo[RTSMediaPlaybackSegmentChangeValueInfoKey] integerValue] == RTSMediaPlaybackSegmentSeekUponBlockingStart) {
+			seekUponBlocking = YES;
+		}
+	}];
+
+	// Play a few seconds past the cut, located at 30 seconds in player time
+	XCTestExpectation *playbackExpectation = [self expectationWithDescription:@"Played across the cut"];
+	__block id timeObserver = nil;
+	timeObserver = [self.mediaPlayerController addPeriodicTimeObserverForInterval:CMTimeMakeWithSeconds(0.5, NSEC_PER_SEC) queue:NULL usingBlock:^(CMTime time) {
+		if (timeObserver && CMTimeGetSeconds(time) >= 34.) {
+			[self.mediaPlayerController removePeriodicTimeObserver:timeObserver];
+			timeObserver = nil;
+			[playbackExpectation fulfill];
+		}
+	}];
+	[self.mediaPlayerController playIdentifier:PlaylistBlockingTestMediaIdentifier atTime:CMTimeMakeWithSeconds(28., NSEC_PER_SEC)];
+	[self waitForExpectationsWithTimeout:60. handler:nil];
+
+	[[NSNotificationCenter defaultCenter] removeObserver:segmentObserver];
+
+	XCTAssertFalse(seekUponBlocking);
+
+	NSArray<NSString *> *requestedPaths = self.server.requestedPaths;
+	for (NSUInteger index = 5; index < 10; ++index) {
+		XCTAssertFalse([requestedPaths containsObject:[self.server pathForSegmentAtIndex:index]]);
+	}
+	XCTAssertTrue([requestedPaths containsObject:[self.server pathForSegmentAtIndex:10]]);
+
+	// Time mapping between media and player times
+	NSTimeInterval segmentDuration = self.server.segmentDuration;
+	NSArray<NSValue *> *removedTimeRanges = self.mediaSegmentsController.removedTimeRanges;
+	XCTAssertEqual(removedTimeRanges.count, 1);
+	CMTimeRange removedTimeRange = [removedTimeRanges.firstObject CMTimeRangeValue];
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(removedTimeRange.start), 5 * segmentDuration, 0.01);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds(removedTimeRange.duration), 5 * segmentDuration, 0.01);
+
+	RTSMediaSegmentsController *mediaSegmentsController = self.mediaSegmentsController;
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds([mediaSegmentsController playerTimeForMediaTime:CMTimeMakeWithSeconds(20., NSEC_PER_SEC)]), 20., 0.01);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds([mediaSegmentsController playerTimeForMediaTime:CMTimeMakeWithSeconds(45., NSEC_PER_SEC)]), 5 * segmentDuration, 0.01);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds([mediaSegmentsController playerTimeForMediaTime:CMTimeMakeWithSeconds(70., NSEC_PER_SEC)]), 70. - 5 * segmentDuration, 0.01);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds([mediaSegmentsController mediaTimeForPlayerTime:CMTimeMakeWithSeconds(20., NSEC_PER_SEC)]), 20., 0.01);
+	XCTAssertEqualWithAccuracy(CMTimeGetSeconds([mediaSegmentsController mediaTimeForPlayerTime:CMTimeMakeWithSeconds(40., NSEC_PER_SEC)]), 40. + 5 * segmentDuration, 0.01);
+
+	// Segment lookups use player times
+	XCTAssertEqualObjects([(Segment *)[mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(35., NSEC_PER_SEC)] name], @"full_length");
+	XCTAssertEqualObjects([(Segment *)[mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(25., NSEC_PER_SEC)] name], @"full_length");
+}
+
+@end
+
+@implementation PlaylistBlockingTestDataSource
+
+- (instancetype)initWithServer:(TestHLSServer *)server
+{
+	if (self = [super init]) {
+		_server = server;
+	}
+	return self;
+}
+
+#pragma mark - RTSMediaPlayerControllerDataSource protocol
+
+- (id)mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController contentURLForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSString *, NSURL *, NSError *))completionHandler
+{
+	completionHandler(identifier, self.server.playlistURL, nil);
+	return nil;
+}
+
+- (void)cancelContentURLRequest:(id)request
+{}
+
+#pragma mark - RTSMediaSegmentsDataSource protocol
+
+- (id)segmentsController:(RTSMediaSegmentsController *)controller segmentsForIdentifier:(NSString *)identifier withCompletionHandler:(RTSMediaSegmentsCompletionHandler)completionHandler
+{
+	NSTimeInterval segmentDuration = self.server.segmentDuration;
+
+	Segment *fullLength = [[Segment alloc] initWithIdentifier:identifier name:@"full_length" timeRange:CMTimeRangeMake(kCMTimeZero, CMTimeMakeWithSeconds(self.server.segmentCount * segmentDuration, NSEC_PER_SEC))];
+	fullLength.logical = YES;
+
+	Segment *blockedSegment = [[Segment alloc] initWithIdentifier:identifier name:@"blocked" timeRange:CMTimeRangeMake(CMTimeMakeWithSeconds(5 * segmentDuration, NSEC_PER_SEC), CMTimeMakeWithSeconds(5 * segmentDuration, NSEC_PER_SEC))];
+	blockedSegment.logical = YES;
+	blockedSegment.blocked = YES;
+
+	completionHandler(identifier, @[fullLength, blockedSegment], nil);
+	return nil;
+}
+
+- (void)cancelSegmentsRequest:(id)request
+{}
+
+@end
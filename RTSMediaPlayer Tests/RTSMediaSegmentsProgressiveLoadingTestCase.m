@@ -0,0 +1,209 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+#import <SRGMediaPlayer/RTSMediaSegmentIndex.h>
+
+#import "Segment.h"
+
+static NSString * const MediaIdentifier = @"VIDEO-full1";
+
+static Segment *SegmentMake(NSString *name, NSTimeInterval startTime, NSTimeInterval duration)
+{
+	CMTimeRange timeRange = CMTimeRangeMake(CMTimeMakeWithSeconds(startTime, NSEC_PER_SEC), CMTimeMakeWithSeconds(duration, NSEC_PER_SEC));
+	Segment *segment = [[Segment alloc] initWithIdentifier:MediaIdentifier name:name timeRange:timeRange];
+	segment.logical = YES;
+	return segment;
+}
+
+static CMTime TimeMake(NSTimeInterval seconds)
+{
+	return CMTimeMakeWithSeconds(seconds, NSEC_PER_SEC);
+}
+
+@interface RTSMediaSegmentsProgressiveLoadingTestCase : XCTestCase <RTSMediaPlayerControllerDataSource, RTSMediaSegmentsDataSource>
+
+@property (nonatomic) RTSMediaPlayerController *mediaPlayerController;
+@property (nonatomic) RTSMediaSegmentsController *mediaSegmentsController;
+
+@property (nonatomic) NSArray<NSArray<Segment *> *> *batches;
+@property (nonatomic) NSError *error;
+
+@end
+
+@implementation RTSMediaSegmentsProgressiveLoadingTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentIdentifier:MediaIdentifier dataSource:self];
+
+	self.mediaSegmentsController = [[RTSMediaSegmentsController alloc] init];
+	self.mediaSegmentsController.dataSource = self;
+	self.mediaSegmentsController.playerController = self.mediaPlayerController;
+
+	self.batches = nil;
+	self.error = nil;
+}
+
+- (void) tearDown
+{
+	self.mediaSegmentsController = nil;
+	self.mediaPlayerController = nil;
+}
+
+#pragma mark - RTSMediaPlayerControllerDataSource protocol
+
+- (id) mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+	 contentURLForIdentifier:(NSString *)identifier
+		   completionHandler:(void (^)(NSString *identifier, NSURL *contentURL, NSError *error))completionHandler
+{
+	completionHandler(identifier, [NSURL URLWithString:@"https://devimages.apple.com.edgekey.net/streaming/examples/bipbop_16x9/bipbop_16x9_variant.m3u8"], nil);
+	return nil;
+}
+
+- (void) cancelContentURLRequest:(id)request
+{}
+
+#pragma mark - RTSMediaSegmentsDataSource protocol
+
+- (id) segmentsController:(RTSMediaSegmentsController *)controller segmentsForIdentifier:(NSString *)identifier withCompletionHandler:(RTSMediaSegmentsCompletionHandler)completionHandler
+{
+	XCTFail(@"The progressive variant must be preferred");
+	return nil;
+}
+
+// Each batch is delivered in a separate run loop iteration
+- (id) segmentsController:(RTSMediaSegmentsController *)controller segmentsForIdentifier:(NSString *)identifier withBatchHandler:(RTSMediaSegmentsBatchHandler)batchHandler
+{
+	NSArray<NSArray<Segment *> *> *batches = self.batches;
+	NSError *error = self.error;
+	[batches enumerateObjectsUsingBlock:^(NSArray<Segment *> *segments, NSUInteger idx, BOOL *stop) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			BOOL last = (idx == batches.count - 1);
+			batchHandler(identifier, segments, last && !error, last ? error : nil);
+		});
+	}];
+	return nil;
+}
+
+- (void) cancelSegmentsRequest:(id)request
+{}
+
+#pragma mark - Tests
+
+- (void) testBatchesAreMerged
+{
+	Segment *hiddenSegment = SegmentMake(@"hidden", 50., 5.);
+	hiddenSegment.visible = NO;
+
+	// Segments around the playhead first, then before and after
+	self.batches = @[ @[ SegmentMake(@"segment4", 40., 10.), SegmentMake(@"segment3", 30., 10.) ],
+					  @[ SegmentMake(@"segment1", 10., 10.), SegmentMake(@"segment2", 20., 10.) ],
+					  @[ hiddenSegment, SegmentMake(@"segment5", 60., 10.) ] ];
+
+	NSMutableArray<NSIndexSet *> *insertedIndexesArray = [NSMutableArray array];
+	XCTestExpectation *completionExpectation = [self expectationWithDescription:@"Segments loaded"];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:MediaIdentifier batchHandler:^(NSIndexSet *insertedVisibleSegmentIndexes) {
+		[insertedIndexesArray addObject:insertedVisibleSegmentIndexes];
+
+		// Segments can be looked up as soon as they have been received
+		if (insertedIndexesArray.count == 1) {
+			XCTAssertEqualObjects([(Segment *)[self.mediaSegmentsController segmentAtTime:TimeMake(35.)] name], @"segment3");
+			XCTAssertNil([self.mediaSegmentsController segmentAtTime:TimeMake(15.)]);
+		}
+	} completionHandler:^(NSError *error) {
+		XCTAssertNil(error);
+		[completionExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:10. handler:nil];
+
+	NSMutableIndexSet *secondBatchIndexes = [NSMutableIndexSet indexSetWithIndex:0];
+	[secondBatchIndexes addIndex:1];
+	NSArray<NSIndexSet *> *expectedInsertedIndexesArray = @[ [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 2)],
+															 secondBatchIndexes,
+															 [NSIndexSet indexSetWithIndex:4] ];
+	XCTAssertEqualObjects(insertedIndexesArray, expectedInsertedIndexesArray);
+
+	// Segments are sorted by start time
+	XCTAssertEqualObjects([self.mediaSegmentsController.visibleSegments valueForKey:@"name"], (@[ @"segment1", @"segment2", @"segment3", @"segment4", @"segment5" ]));
+	XCTAssertEqual(self.mediaSegmentsController.segments.count, 6);
+
+	XCTAssertEqualObjects([(Segment *)[self.mediaSegmentsController segmentAtTime:TimeMake(15.)] name], @"segment1");
+	XCTAssertEqualObjects([(Segment *)[self.mediaSegmentsController segmentAtTime:TimeMake(52.)] name], @"hidden");
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:TimeMake(52.)], NSNotFound);
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:TimeMake(65.)], 4);
+}
+
+- (void) testErrorKeepsDeliveredSegments
+{
+	self.batches = @[ @[ SegmentMake(@"segment1", 0., 10.) ], @[] ];
+	self.error = [NSError errorWithDomain:@"ch.rts.RTSMediaPlayer-tests" code:1 userInfo:nil];
+
+	XCTestExpectation *completionExpectation = [self expectationWithDescription:@"Segments loaded"];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:MediaIdentifier batchHandler:nil completionHandler:^(NSError *error) {
+		XCTAssertNotNil(error);
+		[completionExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:10. handler:nil];
+
+	XCTAssertEqual(self.mediaSegmentsController.visibleSegments.count, 1);
+}
+
+- (void) testBatchesOfPreviousReloadAreIgnored
+{
+	self.batches = @[ @[ SegmentMake(@"old1", 0., 10.) ], @[ SegmentMake(@"old2", 10., 10.) ] ];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:MediaIdentifier batchHandler:nil completionHandler:^(NSError *error) {
+		XCTFail(@"The first reload must not complete");
+	}];
+
+	self.batches = @[ @[ SegmentMake(@"new", 0., 10.) ] ];
+	XCTestExpectation *completionExpectation = [self expectationWithDescription:@"Segments loaded"];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:MediaIdentifier batchHandler:nil completionHandler:^(NSError *error) {
+		[completionExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:10. handler:nil];
+
+	XCTAssertEqualObjects([self.mediaSegmentsController.segments valueForKey:@"name"], @[ @"new" ]);
+}
+
+- (void) testIndexUpdateMatchesCreation
+{
+	srand48(42);
+
+	NSMutableArray<Segment *> *segments = [NSMutableArray array];
+	RTSMediaSegmentIndex *segmentIndex = [[RTSMediaSegmentIndex alloc] initWithSegments:segments passingTest:nil];
+
+	BOOL (^predicate)(id<RTSMediaSegment>) = ^BOOL(id<RTSMediaSegment> segment) {
+		return segment.visible;
+	};
+
+	// Insert segments with overlapping and identical time ranges at arbitrary positions
+	for (NSUInteger batch = 0; batch < 20; ++batch) {
+		NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+		NSUInteger count = 1 + (NSUInteger)(drand48() * 10);
+		for (NSUInteger i = 0; i < count; ++i) {
+			Segment *segment = SegmentMake([NSString stringWithFormat:@"%@-%@", @(batch), @(i)], floor(drand48() * 100.), 1. + floor(drand48() * 10.));
+			segment.visible = (drand48() < 0.8);
+
+			NSUInteger index = (NSUInteger)(drand48() * (segments.count + 1));
+			[indexes shiftIndexesStartingAtIndex:index by:1];
+			[indexes addIndex:index];
+			[segments insertObject:segment atIndex:index];
+		}
+
+		[segmentIndex updateWithSegments:[segments copy] insertedAtIndexes:indexes passingTest:predicate];
+
+		RTSMediaSegmentIndex *createdSegmentIndex = [[RTSMediaSegmentIndex alloc] initWithSegments:[segments copy] passingTest:predicate];
+		for (NSTimeInterval time = -1.; time < 115.; time += 0.5) {
+			XCTAssertEqual([segmentIndex indexOfSegmentAtTime:TimeMake(time)], [createdSegmentIndex indexOfSegmentAtTime:TimeMake(time)]);
+		}
+	}
+}
+
+@end
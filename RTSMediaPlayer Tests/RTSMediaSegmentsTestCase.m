@@ -720,6 +720,42 @@
 	[self waitForExpectationsWithTimeout:60. handler:nil];
 }
 
+- (void) testSegmentLookup
+{
+	[self.mediaPlayerController prepareToPlayIdentifier:@"VIDEO-full1"];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:@"SEGMENTS-full_length_with_consecutive_segments" completionHandler:nil];
+	
+	// The full length is neither logical nor visible
+	XCTAssertNil([self.mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(1., 1.)]);
+	XCTAssertNil([self.mediaSegmentsController visibleSegmentAtTime:CMTimeMakeWithSeconds(1., 1.)]);
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:CMTimeMakeWithSeconds(1., 1.)], NSNotFound);
+	
+	XCTAssertEqualObjects([[self.mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(2., 1.)] name], @"segment1");
+	XCTAssertEqualObjects([[self.mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(4.5, 10.)] name], @"segment1");
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:CMTimeMakeWithSeconds(4.5, 10.)], 0);
+	
+	// Time ranges do not include their end
+	XCTAssertEqualObjects([[self.mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(5., 1.)] name], @"segment2");
+	XCTAssertEqualObjects([[self.mediaSegmentsController visibleSegmentAtTime:CMTimeMakeWithSeconds(5., 1.)] name], @"segment2");
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:CMTimeMakeWithSeconds(5., 1.)], 1);
+	
+	XCTAssertNil([self.mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(9., 1.)]);
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:CMTimeMakeWithSeconds(9., 1.)], NSNotFound);
+	XCTAssertNil([self.mediaSegmentsController segmentAtTime:kCMTimeInvalid]);
+}
+
+// Segments belonging to another media must not be found
+- (void) testSegmentLookupForOtherMedia
+{
+	[self.mediaPlayerController prepareToPlayIdentifier:@"VIDEO-other"];
+	[self.mediaSegmentsController reloadSegmentsForIdentifier:@"SEGMENTS-full_length_with_consecutive_segments" completionHandler:nil];
+	
+	XCTAssertEqual(self.mediaSegmentsController.visibleSegments.count, 2);
+	XCTAssertNil([self.mediaSegmentsController segmentAtTime:CMTimeMakeWithSeconds(3., 1.)]);
+	XCTAssertNil([self.mediaSegmentsController visibleSegmentAtTime:CMTimeMakeWithSeconds(3., 1.)]);
+	XCTAssertEqual([self.mediaSegmentsController indexOfVisibleSegmentAtTime:CMTimeMakeWithSeconds(3., 1.)], NSNotFound);
+}
+
 @end
 
 @implementation SegmentsTestDataSource
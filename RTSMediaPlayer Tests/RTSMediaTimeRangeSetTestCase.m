@@ -0,0 +1,140 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+static NSValue *TimeRangeValue(NSTimeInterval startTime, NSTimeInterval duration)
+{
+	return [NSValue valueWithCMTimeRange:CMTimeRangeMake(CMTimeMakeWithSeconds(startTime, 1000), CMTimeMakeWithSeconds(duration, 1000))];
+}
+
+@interface RTSMediaTimeRangeSetTestCase : XCTestCase
+@end
+
+@implementation RTSMediaTimeRangeSetTestCase
+
+- (void) testEmptySet
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [RTSMediaTimeRangeSet new];
+	XCTAssertEqual(timeRangeSet.count, 0);
+	XCTAssertEqual(timeRangeSet.totalDuration, 0.);
+	XCTAssertFalse([timeRangeSet containsTime:0.]);
+	XCTAssertEqual([timeRangeSet contiguousDurationAfterTime:0.], 0.);
+}
+
+- (void) testTimeRangesAreSortedAndMerged
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [RTSMediaTimeRangeSet new];
+	[timeRangeSet addTimeRangeFromTime:20. toTime:30.];
+	[timeRangeSet addTimeRangeFromTime:0. toTime:5.];
+	[timeRangeSet addTimeRangeFromTime:40. toTime:50.];
+	XCTAssertEqual(timeRangeSet.count, 3);
+	XCTAssertEqual([timeRangeSet startTimeAtIndex:0], 0.);
+	XCTAssertEqual([timeRangeSet startTimeAtIndex:1], 20.);
+	XCTAssertEqual([timeRangeSet startTimeAtIndex:2], 40.);
+	
+	// Touching intervals are merged
+	[timeRangeSet addTimeRangeFromTime:5. toTime:10.];
+	XCTAssertEqual(timeRangeSet.count, 3);
+	XCTAssertEqual([timeRangeSet endTimeAtIndex:0], 10.);
+	
+	// An interval spanning several others replaces them
+	[timeRangeSet addTimeRangeFromTime:25. toTime:45.];
+	XCTAssertEqual(timeRangeSet.count, 2);
+	XCTAssertEqual([timeRangeSet startTimeAtIndex:1], 20.);
+	XCTAssertEqual([timeRangeSet endTimeAtIndex:1], 50.);
+	
+	// Intervals already covered do not change anything
+	[timeRangeSet addTimeRangeFromTime:22. toTime:23.];
+	XCTAssertEqual(timeRangeSet.count, 2);
+	XCTAssertEqual(timeRangeSet.totalDuration, 40.);
+	
+	// Empty intervals are ignored
+	[timeRangeSet addTimeRangeFromTime:60. toTime:60.];
+	XCTAssertEqual(timeRangeSet.count, 2);
+}
+
+- (void) testDurationsAroundTime
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [[RTSMediaTimeRangeSet alloc] initWithTimeRanges:@[ TimeRangeValue(0., 10.), TimeRangeValue(20., 10.) ]];
+	XCTAssertEqual(timeRangeSet.count, 2);
+	
+	XCTAssertEqualWithAccuracy([timeRangeSet contiguousDurationAfterTime:4.], 6., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet contiguousDurationBeforeTime:4.], 4., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationAfterTime:4.], 16., 0.001);
+	
+	XCTAssertEqual([timeRangeSet indexOfTimeRangeContainingTime:15.], NSNotFound);
+	XCTAssertEqual([timeRangeSet contiguousDurationAfterTime:15.], 0.);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationAfterTime:15.], 10., 0.001);
+	
+	XCTAssertEqual([timeRangeSet indexOfTimeRangeContainingTime:20.], 1);
+	XCTAssertEqual([timeRangeSet indexOfTimeRangeContainingTime:30.], 1);
+	XCTAssertEqual([timeRangeSet contiguousDurationAfterTime:30.], 0.);
+}
+
+- (void) testInvalidTimeRangesAreIgnored
+{
+	NSArray *timeRanges = @[ [NSValue valueWithCMTimeRange:kCMTimeRangeInvalid], TimeRangeValue(5., 0.), TimeRangeValue(10., 5.) ];
+	RTSMediaTimeRangeSet *timeRangeSet = [[RTSMediaTimeRangeSet alloc] initWithTimeRanges:timeRanges];
+	XCTAssertEqual(timeRangeSet.count, 1);
+	XCTAssertEqual([timeRangeSet startTimeAtIndex:0], 10.);
+}
+
+- (void) testCopyAndEquality
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [[RTSMediaTimeRangeSet alloc] initWithTimeRanges:@[ TimeRangeValue(0., 10.) ]];
+	RTSMediaTimeRangeSet *timeRangeSetCopy = [timeRangeSet copy];
+	XCTAssertEqualObjects(timeRangeSet, timeRangeSetCopy);
+	
+	[timeRangeSet addTimeRangeFromTime:20. toTime:30.];
+	XCTAssertNotEqualObjects(timeRangeSet, timeRangeSetCopy);
+	XCTAssertEqual(timeRangeSetCopy.count, 1);
+	
+	[timeRangeSet removeAllTimeRanges];
+	XCTAssertEqual(timeRangeSet.count, 0);
+}
+
+- (void) testTotalDurationBetweenTimes
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [RTSMediaTimeRangeSet new];
+	[timeRangeSet addTimeRangeFromTime:0. toTime:10.];
+	[timeRangeSet addTimeRangeFromTime:20. toTime:30.];
+	[timeRangeSet addTimeRangeFromTime:40. toTime:50.];
+	XCTAssertEqualWithAccuracy(timeRangeSet.totalDuration, 30., 0.001);
+	
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:0. toTime:50.], 30., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:5. toTime:25.], 10., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:10. toTime:20.], 0., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:22. toTime:28.], 6., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:-10. toTime:100.], 30., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:30. toTime:20.], 0., 0.001);
+	
+	// Cumulative durations are updated after mutations
+	[timeRangeSet addTimeRangeFromTime:5. toTime:25.];
+	XCTAssertEqualWithAccuracy(timeRangeSet.totalDuration, 40., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:35. toTime:45.], 5., 0.001);
+	
+	[timeRangeSet setTimeRanges:@[ TimeRangeValue(45., 5.) ]];
+	XCTAssertEqualWithAccuracy(timeRangeSet.totalDuration, 5., 0.001);
+	XCTAssertEqualWithAccuracy([timeRangeSet totalDurationFromTime:0. toTime:47.], 2., 0.001);
+}
+
+- (void) testArchiving
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [RTSMediaTimeRangeSet new];
+	[timeRangeSet addTimeRangeFromTime:0. toTime:10.5];
+	[timeRangeSet addTimeRangeFromTime:20.25 toTime:30.];
+	
+	NSData *data = [NSKeyedArchiver archivedDataWithRootObject:timeRangeSet];
+	RTSMediaTimeRangeSet *unarchivedTimeRangeSet = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+	XCTAssertEqualObjects(unarchivedTimeRangeSet, timeRangeSet);
+	XCTAssertEqualWithAccuracy(unarchivedTimeRangeSet.totalDuration, 20.25, 0.001);
+	
+	XCTAssertTrue([RTSMediaTimeRangeSet supportsSecureCoding]);
+}
+
+@end
@@ -0,0 +1,219 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+static CMTime TimeMake(NSTimeInterval seconds)
+{
+	return CMTimeMakeWithSeconds(seconds, 1000);
+}
+
+static NSValue *TimeValue(NSTimeInterval seconds)
+{
+	return [NSValue valueWithCMTime:TimeMake(seconds)];
+}
+
+static CMTimeRange TimeRangeMake(NSTimeInterval start, NSTimeInterval duration)
+{
+	return CMTimeRangeMake(TimeMake(start), TimeMake(duration));
+}
+
+// The schedule is driven by a virtual clock advancing in fixed steps, as a player would during playback
+@interface RTSMediaTimeScheduleTestCase : XCTestCase
+
+@property (nonatomic) RTSMediaTimeSchedule *timeSchedule;
+@property (nonatomic) NSMutableArray<NSString *> *events;
+
+@end
+
+@implementation RTSMediaTimeScheduleTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	self.timeSchedule = [RTSMediaTimeSchedule new];
+	self.events = [NSMutableArray array];
+}
+
+- (void) tearDown
+{
+	self.timeSchedule = nil;
+	self.events = nil;
+}
+
+#pragma mark - Helpers
+
+- (void) playFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime step:(NSTimeInterval)step
+{
+	[self.timeSchedule jumpToTime:TimeMake(startTime)];
+	for (NSTimeInterval time = startTime + step; time <= endTime; time += step) {
+		[self.timeSchedule playToTime:TimeMake(time)];
+	}
+}
+
+- (id) addRangeWithName:(NSString *)name timeRange:(CMTimeRange)timeRange
+{
+	return [self.timeSchedule addTimeRange:timeRange enterBlock:^(CMTime time) {
+		[self.events addObject:[NSString stringWithFormat:@"enter %@", name]];
+	} exitBlock:^(CMTime time) {
+		[self.events addObject:[NSString stringWithFormat:@"exit %@", name]];
+	}];
+}
+
+#pragma mark - Tests
+
+- (void) testBoundariesCrossedInOrder
+{
+	NSMutableArray<NSNumber *> *times = [NSMutableArray array];
+	id observer = [self.timeSchedule addBoundaryTimes:@[ TimeValue(75.), TimeValue(25.), TimeValue(50.) ] usingBlock:^(CMTime time) {
+		[times addObject:@(CMTimeGetSeconds(time))];
+	}];
+	XCTAssertNotNil(observer);
+	XCTAssertEqual(self.timeSchedule.boundaryTimes.count, 3);
+
+	// A single large step crosses several boundaries at once
+	[self.timeSchedule jumpToTime:kCMTimeZero];
+	[self.timeSchedule playToTime:TimeMake(60.)];
+	XCTAssertEqualObjects(times, (@[ @25., @50. ]));
+
+	[self.timeSchedule playToTime:TimeMake(100.)];
+	XCTAssertEqualObjects(times, (@[ @25., @50., @75. ]));
+
+	// Boundaries are not reported again when the playhead does not move
+	[self.timeSchedule playToTime:TimeMake(100.)];
+	XCTAssertEqual(times.count, 3);
+}
+
+- (void) testBoundaryReachedExactly
+{
+	__block NSInteger count = 0;
+	[self.timeSchedule addBoundaryTimes:@[ TimeValue(10.) ] usingBlock:^(CMTime time) {
+		++count;
+	}];
+
+	// As when driven by a player boundary observer
+	[self.timeSchedule jumpToTime:kCMTimeZero];
+	[self.timeSchedule playToTime:TimeMake(10.)];
+	XCTAssertEqual(count, 1);
+
+	[self.timeSchedule playToTime:TimeMake(11.)];
+	XCTAssertEqual(count, 1);
+}
+
+- (void) testBoundariesSkippedBySeek
+{
+	__block NSInteger count = 0;
+	[self.timeSchedule addBoundaryTimes:@[ TimeValue(10.), TimeValue(20.) ] usingBlock:^(CMTime time) {
+		++count;
+	}];
+
+	[self playFromTime:0. toTime:5. step:0.5];
+	[self.timeSchedule jumpToTime:TimeMake(15.)];
+	XCTAssertEqual(count, 0);
+
+	[self playFromTime:15. toTime:25. step:0.5];
+	XCTAssertEqual(count, 1);
+}
+
+- (void) testRangeEnterAndExitDuringPlayback
+{
+	[self addRangeWithName:@"chapter" timeRange:TimeRangeMake(10., 10.)];
+
+	[self playFromTime:0. toTime:15. step:0.1];
+	XCTAssertEqualObjects(self.events, @[ @"enter chapter" ]);
+
+	[self playFromTime:15. toTime:30. step:0.1];
+	XCTAssertEqualObjects(self.events, (@[ @"enter chapter", @"exit chapter" ]));
+}
+
+- (void) testAdjacentRangesSwitchInOrder
+{
+	[self addRangeWithName:@"first" timeRange:TimeRangeMake(0., 10.)];
+	[self addRangeWithName:@"second" timeRange:TimeRangeMake(10., 10.)];
+
+	[self.timeSchedule jumpToTime:TimeMake(5.)];
+	[self.timeSchedule playToTime:TimeMake(10.)];
+	XCTAssertEqualObjects(self.events, (@[ @"enter first", @"exit first", @"enter second" ]));
+
+	// Rewind across the shared edge
+	[self.events removeAllObjects];
+	[self.timeSchedule playToTime:TimeMake(9.)];
+	XCTAssertEqualObjects(self.events, (@[ @"exit second", @"enter first" ]));
+}
+
+- (void) testShortRangeCrossedInSingleStep
+{
+	[self addRangeWithName:@"ad" timeRange:TimeRangeMake(10., 0.5)];
+
+	[self playFromTime:0. toTime:20. step:1.];
+	XCTAssertEqualObjects(self.events, (@[ @"enter ad", @"exit ad" ]));
+}
+
+- (void) testRangesAcrossSeeks
+{
+	[self addRangeWithName:@"first" timeRange:TimeRangeMake(10., 10.)];
+	[self addRangeWithName:@"second" timeRange:TimeRangeMake(30., 10.)];
+
+	// Seek into a range
+	[self.timeSchedule jumpToTime:TimeMake(15.)];
+	XCTAssertEqualObjects(self.events, @[ @"enter first" ]);
+
+	// Seek from a range into another one: exits are reported first
+	[self.timeSchedule jumpToTime:TimeMake(35.)];
+	XCTAssertEqualObjects(self.events, (@[ @"enter first", @"exit first", @"enter second" ]));
+
+	// Seek within the same range
+	[self.timeSchedule jumpToTime:TimeMake(38.)];
+	XCTAssertEqual(self.events.count, 3);
+
+	// Seek over a range: nothing is reported for it
+	[self.events removeAllObjects];
+	[self.timeSchedule jumpToTime:TimeMake(5.)];
+	[self.timeSchedule jumpToTime:TimeMake(25.)];
+	XCTAssertEqualObjects(self.events, @[ @"exit second" ]);
+
+	// Reset
+	[self.timeSchedule jumpToTime:TimeMake(12.)];
+	[self.timeSchedule jumpToTime:kCMTimeInvalid];
+	XCTAssertEqualObjects(self.events, (@[ @"exit second", @"enter first", @"exit first" ]));
+}
+
+- (void) testRangeAddedWhilePlayheadInside
+{
+	[self.timeSchedule jumpToTime:TimeMake(15.)];
+	[self addRangeWithName:@"chapter" timeRange:TimeRangeMake(10., 10.)];
+	XCTAssertEqualObjects(self.events, @[ @"enter chapter" ]);
+}
+
+- (void) testRemovedObserversAreNotCalled
+{
+	__block NSInteger count = 0;
+	id boundaryObserver = [self.timeSchedule addBoundaryTimes:@[ TimeValue(10.) ] usingBlock:^(CMTime time) {
+		++count;
+	}];
+	id rangeObserver = [self addRangeWithName:@"chapter" timeRange:TimeRangeMake(5., 10.)];
+
+	[self.timeSchedule removeEntryWithIdentifier:boundaryObserver];
+	[self.timeSchedule removeEntryWithIdentifier:rangeObserver];
+	XCTAssertEqual(self.timeSchedule.boundaryTimes.count, 0);
+
+	[self playFromTime:0. toTime:20. step:1.];
+	XCTAssertEqual(count, 0);
+	XCTAssertEqual(self.events.count, 0);
+}
+
+- (void) testInvalidRegistrations
+{
+	XCTAssertNil([self.timeSchedule addBoundaryTimes:@[ [NSValue valueWithCMTime:kCMTimeInvalid] ] usingBlock:^(CMTime time) {}]);
+	XCTAssertNil([self.timeSchedule addBoundaryTimes:@[ TimeValue(1.) ] usingBlock:nil]);
+	XCTAssertNil([self addRangeWithName:@"empty" timeRange:TimeRangeMake(10., 0.)]);
+	XCTAssertNil([self addRangeWithName:@"invalid" timeRange:kCMTimeRangeInvalid]);
+	XCTAssertEqual(self.timeSchedule.boundaryTimes.count, 0);
+}
+
+@end
@@ -0,0 +1,161 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+static NSData *SegmentDataMake(NSUInteger length, uint8_t byte)
+{
+	NSMutableData *data = [NSMutableData dataWithLength:length];
+	memset(data.mutableBytes, byte, length);
+	return [data copy];
+}
+
+@interface RTSMediaTimeshiftTestCase : XCTestCase
+
+@end
+
+@implementation RTSMediaTimeshiftTestCase
+
+#pragma mark - Helpers
+
+- (void) waitForPlaybackState:(RTSMediaPlaybackState)playbackState ofMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == playbackState;
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (NSArray<NSNumber *> *) sequenceNumbersInBuffer:(RTSMediaTimeshiftBuffer *)buffer
+{
+	return [buffer.segments valueForKey:@"sequenceNumber"];
+}
+
+#pragma mark - Tests
+
+- (void) testRingBuffer
+{
+	RTSMediaTimeshiftBuffer *buffer = [[RTSMediaTimeshiftBuffer alloc] initWithFileURL:nil byteCapacity:1000 depth:100.];
+	XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:buffer.fileURL.path]);
+
+	for (uint8_t i = 0; i < 3; ++i) {
+		XCTAssertTrue([buffer appendSegmentWithData:SegmentDataMake(300, i) duration:1. discontinuous:NO]);
+	}
+	XCTAssertEqualObjects([self sequenceNumbersInBuffer:buffer], (@[ @0, @1, @2 ]));
+	XCTAssertEqual(buffer.byteCount, 900);
+
+	// The end of the file is too small, the next segment overwrites the oldest one at the beginning of the file
+	XCTAssertTrue([buffer appendSegmentWithData:SegmentDataMake(300, 3) duration:1. discontinuous:NO]);
+	XCTAssertEqualObjects([self sequenceNumbersInBuffer:buffer], (@[ @1, @2, @3 ]));
+	XCTAssertNil([buffer dataForSegmentWithSequenceNumber:0]);
+	XCTAssertEqualObjects([buffer dataForSegmentWithSequenceNumber:1], SegmentDataMake(300, 1));
+	XCTAssertEqualObjects([buffer dataForSegmentWithSequenceNumber:3], SegmentDataMake(300, 3));
+	XCTAssertNil([buffer dataForSegmentWithSequenceNumber:4]);
+
+	// Larger segments evict as many segments as needed
+	XCTAssertTrue([buffer appendSegmentWithData:SegmentDataMake(500, 4) duration:1. discontinuous:NO]);
+	XCTAssertEqualObjects([self sequenceNumbersInBuffer:buffer], (@[ @3, @4 ]));
+	XCTAssertEqualObjects([buffer dataForSegmentWithSequenceNumber:3], SegmentDataMake(300, 3));
+	XCTAssertEqualObjects([buffer dataForSegmentWithSequenceNumber:4], SegmentDataMake(500, 4));
+	XCTAssertEqual(buffer.byteCount, 800);
+
+	// Segments larger than the file cannot be stored
+	XCTAssertFalse([buffer appendSegmentWithData:SegmentDataMake(1001, 5) duration:1. discontinuous:NO]);
+	XCTAssertEqual(buffer.nextSequenceNumber, 5);
+
+	// Sequence numbers are not reused
+	[buffer removeAllSegments];
+	XCTAssertEqual(buffer.segments.count, 0);
+	XCTAssertEqual(buffer.byteCount, 0);
+	XCTAssertTrue([buffer appendSegmentWithData:SegmentDataMake(100, 5) duration:1. discontinuous:NO]);
+	XCTAssertEqualObjects([self sequenceNumbersInBuffer:buffer], (@[ @5 ]));
+
+	// The file is removed with the buffer
+	NSString *filePath = buffer.fileURL.path;
+	buffer = nil;
+	XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:filePath]);
+}
+
+- (void) testDepth
+{
+	RTSMediaTimeshiftBuffer *buffer = [[RTSMediaTimeshiftBuffer alloc] initWithFileURL:nil byteCapacity:1000 depth:5.];
+	for (uint8_t i = 0; i < 8; ++i) {
+		XCTAssertTrue([buffer appendSegmentWithData:SegmentDataMake(10, i) duration:1. discontinuous:(i == 2 || i == 6)]);
+	}
+	XCTAssertEqualObjects([self sequenceNumbersInBuffer:buffer], (@[ @3, @4, @5, @6, @7 ]));
+	XCTAssertEqualWithAccuracy(buffer.duration, 5., 0.001);
+
+	// Discontinuities evicted are counted
+	XCTAssertEqual(buffer.discontinuitySequenceNumber, 1);
+	XCTAssertTrue(buffer.segments[3].discontinuous);
+}
+
+- (void) testLiveStreamTimeshift
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithStreamType:TestHLSServerStreamTypeLive segmentCount:0 segmentDuration:1. variantBandwidths:@[ @400000, @200000 ]];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+	mediaPlayerController.timeshiftDepth = 60.;
+	mediaPlayerController.liveTolerance = 2.;
+
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	XCTAssertTrue(mediaPlayerController.timeshifting);
+
+	// The window grows while the stream is recorded, also when paused
+	[mediaPlayerController pause];
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:6.]];
+	XCTAssertEqual(mediaPlayerController.streamType, RTSMediaStreamTypeDVR);
+
+	CMTimeRange timeRange = mediaPlayerController.timeRange;
+	XCTAssertTrue(CMTimeGetSeconds(timeRange.duration) > 3.);
+
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	XCTAssertFalse(mediaPlayerController.live);
+
+	// Back to live
+	XCTestExpectation *seekExpectation = [self expectationWithDescription:@"Seek finished"];
+	[mediaPlayerController seekToTime:CMTimeRangeGetEnd(mediaPlayerController.timeRange) completionHandler:^(BOOL finished) {
+		[seekExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+	XCTAssertTrue(mediaPlayerController.live);
+
+	// Only the first variant is loaded, each segment once
+	NSArray<NSString *> *segmentPaths = [server.requestedPaths filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '.aac'"]];
+	XCTAssertTrue(segmentPaths.count > 0);
+	XCTAssertEqual([NSSet setWithArray:segmentPaths].count, segmentPaths.count);
+	XCTAssertEqual([segmentPaths filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF BEGINSWITH '/variant1/'"]].count, 0);
+
+	[mediaPlayerController reset];
+	XCTAssertFalse(mediaPlayerController.timeshifting);
+
+	[server stop];
+}
+
+- (void) testOnDemandStreamPlayedAsIs
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2. variantBandwidths:@[ @400000 ]];
+	XCTAssertTrue([server start]);
+
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+	mediaPlayerController.timeshiftDepth = 60.;
+
+	[mediaPlayerController play];
+	[self waitForPlaybackState:RTSMediaPlaybackStatePlaying ofMediaPlayerController:mediaPlayerController];
+	XCTAssertFalse(mediaPlayerController.timeshifting);
+	XCTAssertEqual(mediaPlayerController.streamType, RTSMediaStreamTypeOnDemand);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+@end
@@ -0,0 +1,119 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <XCTest/XCTest.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+#import "TestHLSServer.h"
+
+@interface RTSMediaWatchedRangeTrackerTestCase : XCTestCase
+
+@property (nonatomic) NSURL *fileURL;
+
+@end
+
+@implementation RTSMediaWatchedRangeTrackerTestCase
+
+#pragma mark - Setup and teardown
+
+- (void) setUp
+{
+	NSString *fileName = [NSString stringWithFormat:@"WatchedRanges-%@.archive", [NSUUID UUID].UUIDString];
+	self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+}
+
+- (void) tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:NULL];
+}
+
+#pragma mark - Tests
+
+- (void) testWatchedDurations
+{
+	RTSMediaWatchedRangeTracker *tracker = [RTSMediaWatchedRangeTracker new];
+	XCTAssertNil(tracker.fileURL);
+
+	[tracker addWatchedTimeRangeFromTime:0. toTime:30. forIdentifier:@"media"];
+	[tracker addWatchedTimeRangeFromTime:25. toTime:40. forIdentifier:@"media"];
+	[tracker addWatchedTimeRangeFromTime:60. toTime:80. forIdentifier:@"media"];
+	[tracker addWatchedTimeRangeFromTime:0. toTime:100. forIdentifier:@"other"];
+
+	XCTAssertEqual([tracker watchedTimeRangeSetForIdentifier:@"media"].count, 2);
+	XCTAssertEqualWithAccuracy([tracker watchedFractionForIdentifier:@"media" duration:100.], 0.6, 0.001);
+	XCTAssertEqualWithAccuracy([tracker watchedDurationForIdentifier:@"media" fromTime:30. toTime:70.], 20., 0.001);
+	XCTAssertEqualWithAccuracy([tracker watchedDurationForIdentifier:@"media" inTimeRange:CMTimeRangeMake(CMTimeMakeWithSeconds(35., NSEC_PER_SEC), CMTimeMakeWithSeconds(30., NSEC_PER_SEC))], 10., 0.001);
+	XCTAssertEqualWithAccuracy([tracker watchedFractionForIdentifier:@"other" duration:50.], 1., 0.001);
+	XCTAssertEqualWithAccuracy([tracker watchedFractionForIdentifier:@"unknown" duration:100.], 0., 0.001);
+	XCTAssertEqualWithAccuracy([tracker watchedFractionForIdentifier:@"media" duration:0.], 0., 0.001);
+
+	// Returned sets are copies
+	[[tracker watchedTimeRangeSetForIdentifier:@"media"] removeAllTimeRanges];
+	XCTAssertEqual([tracker watchedTimeRangeSetForIdentifier:@"media"].count, 2);
+
+	[tracker removeWatchedTimeRangesForIdentifier:@"media"];
+	XCTAssertEqual([tracker watchedTimeRangeSetForIdentifier:@"media"].count, 0);
+	XCTAssertEqual([tracker watchedTimeRangeSetForIdentifier:@"other"].count, 1);
+
+	[tracker removeAllWatchedTimeRanges];
+	XCTAssertEqual([tracker watchedTimeRangeSetForIdentifier:@"other"].count, 0);
+}
+
+- (void) testPersistence
+{
+	RTSMediaWatchedRangeTracker *tracker = [[RTSMediaWatchedRangeTracker alloc] initWithFileURL:self.fileURL];
+	[tracker addWatchedTimeRangeFromTime:0. toTime:30. forIdentifier:@"media"];
+	[tracker addWatchedTimeRangeFromTime:60. toTime:80. forIdentifier:@"media"];
+	XCTAssertTrue([tracker save]);
+
+	RTSMediaWatchedRangeTracker *reloadedTracker = [[RTSMediaWatchedRangeTracker alloc] initWithFileURL:self.fileURL];
+	XCTAssertEqualObjects([reloadedTracker watchedTimeRangeSetForIdentifier:@"media"], [tracker watchedTimeRangeSetForIdentifier:@"media"]);
+	XCTAssertEqualWithAccuracy([reloadedTracker watchedFractionForIdentifier:@"media" duration:100.], 0.5, 0.001);
+
+	// Corrupt files are ignored
+	[[@"corrupt" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:self.fileURL atomically:YES];
+	RTSMediaWatchedRangeTracker *corruptTracker = [[RTSMediaWatchedRangeTracker alloc] initWithFileURL:self.fileURL];
+	XCTAssertEqual([corruptTracker watchedTimeRangeSetForIdentifier:@"media"].count, 0);
+}
+
+- (void) testPlaybackTracking
+{
+	TestHLSServer *server = [[TestHLSServer alloc] initWithSegmentCount:30 segmentDuration:2.];
+	XCTAssertTrue([server start]);
+
+	RTSMediaWatchedRangeTracker *tracker = [RTSMediaWatchedRangeTracker new];
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:server.masterPlaylistURL];
+	mediaPlayerController.watchedRangeTracker = tracker;
+
+	[self expectationForNotification:RTSMediaPlayerPlaybackStateDidChangeNotification object:mediaPlayerController handler:^BOOL(NSNotification *notification) {
+		return mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying;
+	}];
+	[mediaPlayerController play];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:2.]];
+
+	XCTestExpectation *seekExpectation = [self expectationWithDescription:@"Seek finished"];
+	[mediaPlayerController seekToTime:CMTimeMakeWithSeconds(40., NSEC_PER_SEC) completionHandler:^(BOOL finished) {
+		[seekExpectation fulfill];
+	}];
+	[self waitForExpectationsWithTimeout:30. handler:nil];
+
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:2.]];
+	[mediaPlayerController pause];
+
+	// Both played parts are recorded, the part skipped by the seek is not
+	NSString *identifier = mediaPlayerController.identifier;
+	XCTAssertEqual([tracker watchedTimeRangeSetForIdentifier:identifier].count, 2);
+	XCTAssertTrue([tracker watchedDurationForIdentifier:identifier fromTime:0. toTime:5.] > 1.);
+	XCTAssertEqualWithAccuracy([tracker watchedDurationForIdentifier:identifier fromTime:5. toTime:39.], 0., 0.001);
+	XCTAssertTrue([tracker watchedDurationForIdentifier:identifier fromTime:39. toTime:45.] > 1.);
+
+	[mediaPlayerController reset];
+	[server stop];
+}
+
+@end
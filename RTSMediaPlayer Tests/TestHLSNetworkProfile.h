@@ -0,0 +1,61 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  Network conditions emulated by a test server. All random decisions are made from a seed, the path of the requested
+ *  resource and the number of times it has been requested, so that a given scenario always behaves the same way,
+ *  whatever the order in which concurrent requests are received
+ */
+@interface TestHLSNetworkProfile : NSObject <NSCopying>
+
+/**
+ *  No limitation (the default profile)
+ */
++ (TestHLSNetworkProfile *)unlimitedProfile;
+
+/**
+ *  Typical mobile network conditions
+ */
++ (TestHLSNetworkProfile *)cellularProfile;				// 4 Mbps, 60 ms latency, 20 ms jitter
++ (TestHLSNetworkProfile *)edgeProfile;					// 200 kbps, 400 ms latency, 100 ms jitter, 1% loss
+
++ (TestHLSNetworkProfile *)profileWithBandwidth:(double)bandwidth latency:(NSTimeInterval)latency;
+
+/**
+ *  The bandwidth of each connection, in bits per second. 0 for no limit
+ */
+@property (nonatomic) double bandwidth;
+
+/**
+ *  The delay before a response starts, and the maximum random deviation applied to it (in seconds)
+ */
+@property (nonatomic) NSTimeInterval latency;
+@property (nonatomic) NSTimeInterval jitter;
+
+/**
+ *  The probability (between 0 and 1) that a connection is dropped before its response body has been entirely sent
+ */
+@property (nonatomic) double lossRate;
+
+/**
+ *  The probability (between 0 and 1) that a request is answered with an error status code (503 by default)
+ */
+@property (nonatomic) double errorRate;
+@property (nonatomic) NSInteger errorStatusCode;
+
+/**
+ *  The seed from which random decisions are made. Default is 0
+ */
+@property (nonatomic) uint32_t seed;
+
+/**
+ *  Return a deterministic random value in [0, 1) for the specified request and salt (identifying the decision made)
+ */
+- (double)randomValueForPath:(NSString *)path attempt:(NSUInteger)attempt salt:(uint32_t)salt;
+
+@end
@@ -0,0 +1,110 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "TestHLSNetworkProfile.h"
+
+// FNV-1a hash
+static uint32_t HashBytes(uint32_t hash, const void *bytes, NSUInteger length)
+{
+	const uint8_t *position = bytes;
+	for (NSUInteger i = 0; i < length; ++i) {
+		hash ^= position[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+@implementation TestHLSNetworkProfile
+
+#pragma mark - Class methods
+
++ (TestHLSNetworkProfile *)unlimitedProfile
+{
+	return [[TestHLSNetworkProfile alloc] init];
+}
+
++ (TestHLSNetworkProfile *)cellularProfile
+{
+	TestHLSNetworkProfile *profile = [self profileWithBandwidth:4000000. latency:0.06];
+	profile.jitter = 0.02;
+	return profile;
+}
+
++ (TestHLSNetworkProfile *)edgeProfile
+{
+	TestHLSNetworkProfile *profile = [self profileWithBandwidth:200000. latency:0.4];
+	profile.jitter = 0.1;
+	profile.lossRate = 0.01;
+	return profile;
+}
+
++ (TestHLSNetworkProfile *)profileWithBandwidth:(double)bandwidth latency:(NSTimeInterval)latency
+{
+	TestHLSNetworkProfile *profile = [[TestHLSNetworkProfile alloc] init];
+	profile.bandwidth = bandwidth;
+	profile.latency = latency;
+	return profile;
+}
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.errorStatusCode = 503;
+	}
+	return self;
+}
+
+#pragma mark - Random values
+
+- (double)randomValueForPath:(NSString *)path attempt:(NSUInteger)attempt salt:(uint32_t)salt
+{
+	NSData *pathData = [path dataUsingEncoding:NSUTF8StringEncoding];
+	uint32_t values[] = { self.seed, (uint32_t)attempt, salt };
+
+	uint32_t hash = HashBytes(2166136261u, pathData.bytes, pathData.length);
+	hash = HashBytes(hash, values, sizeof(values));
+
+	// Final avalanche (MurmurHash3), so that close inputs yield unrelated values
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
+	return (double)hash / ((double)UINT32_MAX + 1.);
+}
+
+#pragma mark - NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	TestHLSNetworkProfile *profile = [[TestHLSNetworkProfile allocWithZone:zone] init];
+	profile.bandwidth = self.bandwidth;
+	profile.latency = self.latency;
+	profile.jitter = self.jitter;
+	profile.lossRate = self.lossRate;
+	profile.errorRate = self.errorRate;
+	profile.errorStatusCode = self.errorStatusCode;
+	profile.seed = self.seed;
+	return profile;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; bandwidth: %.0f; latency: %.3f; jitter: %.3f; lossRate: %.3f; errorRate: %.3f>",
+			[self class],
+			self,
+			self.bandwidth,
+			self.latency,
+			self.jitter,
+			self.lossRate,
+			self.errorRate];
+}
+
+@end
@@ -0,0 +1,112 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "TestHLSNetworkProfile.h"
+
+/**
+ *  Stream types
+ */
+typedef NS_ENUM(NSInteger, TestHLSServerStreamType) {
+	TestHLSServerStreamTypeOnDemand = 0,
+	TestHLSServerStreamTypeLive,				// Sliding window of 3 segments
+	TestHLSServerStreamTypeDVR					// Sliding window of `segmentCount` segments
+};
+
+/**
+ *  A minimal HTTP server bound to the loopback interface, serving a generated audio-only HLS stream (packed AAC segments
+ *  containing silence), either VOD or live. Live playlists start with a full window when the server is started, and
+ *  a new segment becomes available every segment duration. Requests and bytes served are recorded so that tests can
+ *  check what the player fetched.
+ *
+ *  Network conditions can be emulated with a network profile, which can be changed at any time (even scheduled in
+ *  advance, to script a scenario). Since the server only uses the loopback interface, benchmarks run against it are
+ *  reproducible and do not require any network access
+ */
+@interface TestHLSServer : NSObject
+
+- (instancetype)initWithSegmentCount:(NSUInteger)segmentCount segmentDuration:(NSTimeInterval)segmentDuration;
+
+/**
+ *  Additionally serve a master playlist listing variants with the specified bandwidths (in bits per second, in master
+ *  playlist order). Variant segments are padded so that their size matches their bandwidth
+ */
+- (instancetype)initWithSegmentCount:(NSUInteger)segmentCount segmentDuration:(NSTimeInterval)segmentDuration variantBandwidths:(NSArray<NSNumber *> *)variantBandwidths;
+
+/**
+ *  Serve a stream of the specified type, optionally with variants
+ */
+- (instancetype)initWithStreamType:(TestHLSServerStreamType)streamType
+					  segmentCount:(NSUInteger)segmentCount
+				   segmentDuration:(NSTimeInterval)segmentDuration
+				 variantBandwidths:(NSArray<NSNumber *> *)variantBandwidths;
+
+/**
+ *  Start or stop listening. The server listens on a random free port
+ */
+- (BOOL)start;
+- (void)stop;
+
+/**
+ *  The URL of the stream playlist, nil if the server is not running
+ */
+@property (nonatomic, readonly) NSURL *playlistURL;
+
+/**
+ *  The URL of the master playlist, nil if the server is not running or has no variants
+ */
+@property (nonatomic, readonly) NSURL *masterPlaylistURL;
+
+/**
+ *  The maximum throughput of each connection, in bits per second. Set to 0 (the default) for no limit. If the network
+ *  profile also limits the bandwidth, the lowest limit applies
+ */
+@property (atomic) double maximumThroughput;
+
+/**
+ *  The emulated network conditions. Changes apply to requests being served as well (for the bandwidth). Default is
+ *  the unlimited profile
+ */
+@property (atomic, copy) TestHLSNetworkProfile *networkProfile;
+
+/**
+ *  Change the network profile after the specified delay (in seconds)
+ */
+- (void)setNetworkProfile:(TestHLSNetworkProfile *)networkProfile afterDelay:(NSTimeInterval)delay;
+
+@property (nonatomic, readonly) TestHLSServerStreamType streamType;
+@property (nonatomic, readonly) NSUInteger segmentCount;
+@property (nonatomic, readonly) NSTimeInterval segmentDuration;			// Actual duration, rounded to a whole number of audio frames
+
+/**
+ *  Segment information
+ */
+- (NSString *)pathForSegmentAtIndex:(NSUInteger)index;
+- (NSUInteger)sizeOfSegmentAtIndex:(NSUInteger)index;
+
+/**
+ *  Variant information
+ */
+@property (nonatomic, readonly) NSArray<NSNumber *> *variantBandwidths;
+
+- (NSString *)pathForVariantPlaylistAtIndex:(NSUInteger)index;
+
+/**
+ *  Statistics since the server was started or last reset
+ */
+@property (nonatomic, readonly) unsigned long long bytesServed;				// Response bodies only
+@property (nonatomic, readonly) NSArray<NSString *> *requestedPaths;		// In request order
+@property (nonatomic, readonly) NSUInteger failedRequestCount;				// Errors and dropped connections
+
+/**
+ *  The date at which a resource was requested for the first time, nil if never requested
+ */
+- (NSDate *)dateOfFirstRequestForPath:(NSString *)path;
+
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,561 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "TestHLSServer.h"
+
+#import <libextobjc/EXTScope.h>
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <unistd.h>
+
+static const NSUInteger TestHLSServerSampleRate = 44100;
+static const NSUInteger TestHLSServerSamplesPerFrame = 1024;
+static const NSUInteger TestHLSServerMaximumRequestLength = 16 * 1024;
+static const NSUInteger TestHLSServerThrottledWriteLength = 16 * 1024;
+static const NSUInteger TestHLSServerLiveWindowSegmentCount = 3;
+
+// Salts identifying the random decisions made for a request
+static const uint32_t TestHLSServerJitterSalt = 1;
+static const uint32_t TestHLSServerErrorSalt = 2;
+static const uint32_t TestHLSServerLossSalt = 3;
+static const uint32_t TestHLSServerLossPositionSalt = 4;
+
+// A silent stereo AAC-LC frame at 44.1 kHz, ADTS header included
+static const uint8_t TestHLSServerSilentFrame[] = { 0xFF, 0xF1, 0x50, 0x80, 0x02, 0x1F, 0xFC, 0x21, 0x00, 0x49, 0x90, 0x02, 0x19, 0x00, 0x23, 0x80 };
+
+static void AppendSyncSafeInteger(NSMutableData *data, uint32_t value)
+{
+	uint8_t bytes[] = { (value >> 21) & 0x7F, (value >> 14) & 0x7F, (value >> 7) & 0x7F, value & 0x7F };
+	[data appendBytes:bytes length:sizeof(bytes)];
+}
+
+// Packed audio segments must start with an ID3 tag holding the 90 kHz timestamp of their first sample. The tag can be
+// padded with zeroes to make segments larger
+static NSData *TimestampTag(uint64_t timestamp, NSUInteger paddingLength)
+{
+	static const char owner[] = "com.apple.streaming.transportStreamTimestamp";
+
+	NSMutableData *frameData = [NSMutableData dataWithBytes:owner length:sizeof(owner)];
+	uint8_t timestampBytes[8];
+	for (NSUInteger i = 0; i < 8; ++i) {
+		timestampBytes[i] = (timestamp >> (56 - 8 * i)) & 0xFF;
+	}
+	[frameData appendBytes:timestampBytes length:sizeof(timestampBytes)];
+
+	NSMutableData *tagData = [NSMutableData dataWithBytes:"ID3\x04\x00\x00" length:6];
+	AppendSyncSafeInteger(tagData, (uint32_t)(10 + frameData.length + paddingLength));
+	[tagData appendBytes:"PRIV" length:4];
+	AppendSyncSafeInteger(tagData, (uint32_t)frameData.length);
+	[tagData appendBytes:"\x00\x00" length:2];
+	[tagData appendData:frameData];
+	[tagData increaseLengthBy:paddingLength];
+	return [tagData copy];
+}
+
+static BOOL WriteData(int fileDescriptor, const void *bytes, NSUInteger length)
+{
+	const uint8_t *position = bytes;
+	while (length > 0) {
+		ssize_t writtenLength = write(fileDescriptor, position, length);
+		if (writtenLength <= 0) {
+			return NO;
+		}
+		position += writtenLength;
+		length -= writtenLength;
+	}
+	return YES;
+}
+
+@interface TestHLSServer ()
+
+@property (nonatomic) TestHLSServerStreamType streamType;
+@property (nonatomic) NSUInteger segmentCount;
+@property (nonatomic) NSUInteger framesPerSegment;
+@property (nonatomic) NSArray<NSNumber *> *variantBandwidths;
+@property (nonatomic) NSDictionary<NSString *, NSData *> *resources;
+
+@property (nonatomic) dispatch_queue_t connectionQueue;
+@property (nonatomic) dispatch_source_t listeningSource;
+@property (nonatomic) uint16_t port;
+@property (atomic) NSDate *startDate;
+
+@property (nonatomic) unsigned long long bytesServed;
+@property (nonatomic) NSMutableArray<NSString *> *mutableRequestedPaths;
+@property (nonatomic) NSMutableDictionary<NSString *, NSDate *> *firstRequestDates;
+@property (nonatomic) NSCountedSet<NSString *> *requestCounts;
+@property (nonatomic) NSUInteger failedRequestCount;
+
+@end
+
+@implementation TestHLSServer
+
+#pragma mark - Object lifecycle
+
+- (instancetype)initWithStreamType:(TestHLSServerStreamType)streamType
+					  segmentCount:(NSUInteger)segmentCount
+				   segmentDuration:(NSTimeInterval)segmentDuration
+				 variantBandwidths:(NSArray<NSNumber *> *)variantBandwidths
+{
+	if (self = [super init]) {
+		self.streamType = streamType;
+		self.segmentCount = (streamType == TestHLSServerStreamTypeLive) ? TestHLSServerLiveWindowSegmentCount : segmentCount;
+		self.variantBandwidths = variantBandwidths ?: @[];
+		self.framesPerSegment = MAX(ceil(segmentDuration * TestHLSServerSampleRate / TestHLSServerSamplesPerFrame), 1);
+		self.connectionQueue = dispatch_queue_create("ch.srgssr.mediaplayer.tests.server", DISPATCH_QUEUE_CONCURRENT);
+		self.networkProfile = [TestHLSNetworkProfile unlimitedProfile];
+		self.mutableRequestedPaths = [NSMutableArray array];
+		self.firstRequestDates = [NSMutableDictionary dictionary];
+		self.requestCounts = [NSCountedSet set];
+		[self generateResources];
+	}
+	return self;
+}
+
+- (instancetype)initWithSegmentCount:(NSUInteger)segmentCount segmentDuration:(NSTimeInterval)segmentDuration variantBandwidths:(NSArray<NSNumber *> *)variantBandwidths
+{
+	return [self initWithStreamType:TestHLSServerStreamTypeOnDemand segmentCount:segmentCount segmentDuration:segmentDuration variantBandwidths:variantBandwidths];
+}
+
+- (instancetype)initWithSegmentCount:(NSUInteger)segmentCount segmentDuration:(NSTimeInterval)segmentDuration
+{
+	return [self initWithSegmentCount:segmentCount segmentDuration:segmentDuration variantBandwidths:nil];
+}
+
+- (instancetype)init
+{
+	return [self initWithSegmentCount:10 segmentDuration:6.];
+}
+
+- (void)dealloc
+{
+	[self stop];
+}
+
+#pragma mark - Getters and setters
+
+- (NSTimeInterval)segmentDuration
+{
+	return (NSTimeInterval)(self.framesPerSegment * TestHLSServerSamplesPerFrame) / TestHLSServerSampleRate;
+}
+
+- (NSURL *)playlistURL
+{
+	if (!self.listeningSource) {
+		return nil;
+	}
+
+	NSString *URLString = [NSString stringWithFormat:@"http://127.0.0.1:%@/playlist.m3u8", @(self.port)];
+	return [NSURL URLWithString:URLString];
+}
+
+- (NSURL *)masterPlaylistURL
+{
+	if (!self.listeningSource || self.variantBandwidths.count == 0) {
+		return nil;
+	}
+
+	NSString *URLString = [NSString stringWithFormat:@"http://127.0.0.1:%@/master.m3u8", @(self.port)];
+	return [NSURL URLWithString:URLString];
+}
+
+- (unsigned long long)bytesServed
+{
+	@synchronized(self) {
+		return _bytesServed;
+	}
+}
+
+- (NSArray<NSString *> *)requestedPaths
+{
+	@synchronized(self) {
+		return [self.mutableRequestedPaths copy];
+	}
+}
+
+- (NSUInteger)failedRequestCount
+{
+	@synchronized(self) {
+		return _failedRequestCount;
+	}
+}
+
+- (NSDate *)dateOfFirstRequestForPath:(NSString *)path
+{
+	@synchronized(self) {
+		return self.firstRequestDates[path];
+	}
+}
+
+- (void)setNetworkProfile:(TestHLSNetworkProfile *)networkProfile afterDelay:(NSTimeInterval)delay
+{
+	@weakify(self)
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.connectionQueue, ^{
+		@strongify(self)
+		self.networkProfile = networkProfile;
+	});
+}
+
+// The lowest limit applies
+- (double)effectiveThroughput
+{
+	double maximumThroughput = self.maximumThroughput;
+	double bandwidth = self.networkProfile.bandwidth;
+	if (maximumThroughput > 0. && bandwidth > 0.) {
+		return MIN(maximumThroughput, bandwidth);
+	}
+	else {
+		return MAX(maximumThroughput, bandwidth);
+	}
+}
+
+#pragma mark - Fixture
+
+- (NSString *)pathForSegmentAtIndex:(NSUInteger)index
+{
+	return [NSString stringWithFormat:@"/segment%@.aac", @(index)];
+}
+
+- (NSUInteger)sizeOfSegmentAtIndex:(NSUInteger)index
+{
+	return [self dataForPath:[self pathForSegmentAtIndex:index]].length;
+}
+
+- (NSString *)pathForVariantPlaylistAtIndex:(NSUInteger)index
+{
+	return [NSString stringWithFormat:@"/variant%@/playlist.m3u8", @(index)];
+}
+
+// Live media playlists and segments are generated when requested, see `-dataForPath:`
+- (void)generateResources
+{
+	BOOL onDemand = (self.streamType == TestHLSServerStreamTypeOnDemand);
+
+	NSMutableDictionary<NSString *, NSData *> *resources = [NSMutableDictionary dictionary];
+	if (onDemand) {
+		[self addMediaPlaylistWithPath:@"/playlist.m3u8" segmentPathPrefix:@"/segment" bandwidth:0. toResources:resources];
+	}
+
+	if (self.variantBandwidths.count != 0) {
+		NSMutableString *masterPlaylist = [NSMutableString stringWithString:@"#EXTM3U\n"];
+		[self.variantBandwidths enumerateObjectsUsingBlock:^(NSNumber *bandwidth, NSUInteger index, BOOL *stop) {
+			NSString *playlistPath = [self pathForVariantPlaylistAtIndex:index];
+			if (onDemand) {
+				NSString *segmentPathPrefix = [[playlistPath stringByDeletingLastPathComponent] stringByAppendingPathComponent:@"segment"];
+				[self addMediaPlaylistWithPath:playlistPath segmentPathPrefix:segmentPathPrefix bandwidth:bandwidth.doubleValue toResources:resources];
+			}
+
+			// Relative URIs, as usually found in master playlists
+			[masterPlaylist appendFormat:@"#EXT-X-STREAM-INF:BANDWIDTH=%@,CODECS=\"mp4a.40.2\"\n%@\n", bandwidth, [playlistPath substringFromIndex:1]];
+		}];
+		resources[@"/master.m3u8"] = [masterPlaylist dataUsingEncoding:NSUTF8StringEncoding];
+	}
+
+	self.resources = [resources copy];
+}
+
+- (void)addMediaPlaylistWithPath:(NSString *)path segmentPathPrefix:(NSString *)segmentPathPrefix bandwidth:(double)bandwidth toResources:(NSMutableDictionary<NSString *, NSData *> *)resources
+{
+	for (NSUInteger i = 0; i < self.segmentCount; ++i) {
+		NSString *segmentPath = [NSString stringWithFormat:@"%@%@.aac", segmentPathPrefix, @(i)];
+		resources[segmentPath] = [self segmentDataAtIndex:i bandwidth:bandwidth];
+	}
+	resources[path] = [self mediaPlaylistWithFirstSegmentIndex:0];
+}
+
+// Segments are padded to match the bandwidth if larger than the one of the audio itself
+- (NSData *)segmentDataAtIndex:(NSUInteger)index bandwidth:(double)bandwidth
+{
+	NSUInteger audioLength = self.framesPerSegment * sizeof(TestHLSServerSilentFrame);
+	NSUInteger segmentLength = (NSUInteger)(bandwidth * self.segmentDuration / 8.);
+	NSUInteger paddingLength = (segmentLength > audioLength) ? segmentLength - audioLength : 0;
+
+	uint64_t sampleCount = (uint64_t)index * self.framesPerSegment * TestHLSServerSamplesPerFrame;
+	NSMutableData *segmentData = [NSMutableData dataWithData:TimestampTag(sampleCount * 90000 / TestHLSServerSampleRate, paddingLength)];
+	for (NSUInteger j = 0; j < self.framesPerSegment; ++j) {
+		[segmentData appendBytes:TestHLSServerSilentFrame length:sizeof(TestHLSServerSilentFrame)];
+	}
+	return [segmentData copy];
+}
+
+// Segment URIs are relative to the playlist
+- (NSData *)mediaPlaylistWithFirstSegmentIndex:(NSUInteger)firstSegmentIndex
+{
+	BOOL onDemand = (self.streamType == TestHLSServerStreamTypeOnDemand);
+
+	NSMutableString *playlist = [NSMutableString stringWithString:@"#EXTM3U\n#EXT-X-VERSION:3\n"];
+	[playlist appendFormat:@"#EXT-X-TARGETDURATION:%@\n", @(ceil(self.segmentDuration))];
+	[playlist appendFormat:@"#EXT-X-MEDIA-SEQUENCE:%@\n", @(firstSegmentIndex)];
+	if (onDemand) {
+		[playlist appendString:@"#EXT-X-PLAYLIST-TYPE:VOD\n"];
+	}
+
+	for (NSUInteger i = firstSegmentIndex; i < firstSegmentIndex + self.segmentCount; ++i) {
+		[playlist appendFormat:@"#EXTINF:%.5f,\nsegment%@.aac\n", self.segmentDuration, @(i)];
+	}
+
+	if (onDemand) {
+		[playlist appendString:@"#EXT-X-ENDLIST\n"];
+	}
+	return [playlist dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+// Index of the last segment available in live playlists
+- (NSUInteger)liveSegmentIndex
+{
+	NSDate *startDate = self.startDate;
+	NSTimeInterval elapsedDuration = startDate ? MAX(-[startDate timeIntervalSinceNow], 0.) : 0.;
+	return self.segmentCount - 1 + (NSUInteger)floor(elapsedDuration / self.segmentDuration);
+}
+
+- (NSData *)dataForPath:(NSString *)path
+{
+	NSData *data = self.resources[path];
+	if (data || self.streamType == TestHLSServerStreamTypeOnDemand) {
+		return data;
+	}
+
+	// Live paths: /playlist.m3u8, /segment<N>.aac, and the same within /variant<M> directories
+	NSString *directory = [path stringByDeletingLastPathComponent];
+	double bandwidth = 0.;
+	if (![directory isEqualToString:@"/"]) {
+		NSScanner *scanner = [NSScanner scannerWithString:directory];
+		NSInteger variantIndex = 0;
+		if (![scanner scanString:@"/variant" intoString:NULL] || ![scanner scanInteger:&variantIndex] || !scanner.atEnd
+				|| variantIndex < 0 || variantIndex >= self.variantBandwidths.count) {
+			return nil;
+		}
+		bandwidth = self.variantBandwidths[variantIndex].doubleValue;
+	}
+
+	NSUInteger liveSegmentIndex = [self liveSegmentIndex];
+	NSString *fileName = path.lastPathComponent;
+	if ([fileName isEqualToString:@"playlist.m3u8"]) {
+		return [self mediaPlaylistWithFirstSegmentIndex:liveSegmentIndex + 1 - self.segmentCount];
+	}
+
+	NSScanner *scanner = [NSScanner scannerWithString:fileName];
+	NSInteger segmentIndex = 0;
+	if ([scanner scanString:@"segment" intoString:NULL] && [scanner scanInteger:&segmentIndex] && [scanner scanString:@".aac" intoString:NULL] && scanner.atEnd
+			&& segmentIndex >= 0 && segmentIndex <= liveSegmentIndex) {
+		return [self segmentDataAtIndex:segmentIndex bandwidth:bandwidth];
+	}
+	return nil;
+}
+
+#pragma mark - Server
+
+- (BOOL)start
+{
+	if (self.listeningSource) {
+		return YES;
+	}
+
+	int listeningSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (listeningSocket < 0) {
+		return NO;
+	}
+
+	int reuseAddress = 1;
+	setsockopt(listeningSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_port = 0;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	socklen_t addressLength = sizeof(address);
+	if (bind(listeningSocket, (struct sockaddr *)&address, sizeof(address)) != 0
+			|| listen(listeningSocket, 16) != 0
+			|| getsockname(listeningSocket, (struct sockaddr *)&address, &addressLength) != 0) {
+		close(listeningSocket);
+		return NO;
+	}
+	self.port = ntohs(address.sin_port);
+	self.startDate = [NSDate date];
+
+	[self resetStatistics];
+
+	@weakify(self)
+	dispatch_source_t listeningSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, listeningSocket, 0, self.connectionQueue);
+	dispatch_source_set_event_handler(listeningSource, ^{
+		@strongify(self)
+
+		int connectionSocket = accept(listeningSocket, NULL, NULL);
+		if (connectionSocket < 0) {
+			return;
+		}
+
+		if (!self) {
+			close(connectionSocket);
+			return;
+		}
+
+		int noSigPipe = 1;
+		setsockopt(connectionSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+
+		dispatch_async(self.connectionQueue, ^{
+			[self handleConnectionWithSocket:connectionSocket];
+			close(connectionSocket);
+		});
+	});
+	dispatch_source_set_cancel_handler(listeningSource, ^{
+		close(listeningSocket);
+	});
+	dispatch_resume(listeningSource);
+
+	self.listeningSource = listeningSource;
+	return YES;
+}
+
+- (void)stop
+{
+	if (!self.listeningSource) {
+		return;
+	}
+
+	dispatch_source_cancel(self.listeningSource);
+	self.listeningSource = nil;
+}
+
+- (void)resetStatistics
+{
+	@synchronized(self) {
+		_bytesServed = 0;
+		_failedRequestCount = 0;
+		[self.mutableRequestedPaths removeAllObjects];
+		[self.firstRequestDates removeAllObjects];
+	}
+}
+
+// One request per connection, which is closed after the response has been sent
+- (void)handleConnectionWithSocket:(int)connectionSocket
+{
+	NSMutableData *requestData = [NSMutableData data];
+	NSData *separatorData = [@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+	while ([requestData rangeOfData:separatorData options:0 range:NSMakeRange(0, requestData.length)].location == NSNotFound) {
+		uint8_t buffer[1024];
+		ssize_t readLength = read(connectionSocket, buffer, sizeof(buffer));
+		if (readLength <= 0 || requestData.length > TestHLSServerMaximumRequestLength) {
+			return;
+		}
+		[requestData appendBytes:buffer length:readLength];
+	}
+
+	NSString *request = [[NSString alloc] initWithData:requestData encoding:NSUTF8StringEncoding];
+	NSArray<NSString *> *lines = [request componentsSeparatedByString:@"\r\n"];
+	NSArray<NSString *> *requestLineComponents = [lines.firstObject componentsSeparatedByString:@" "];
+	if (requestLineComponents.count < 2) {
+		return;
+	}
+
+	NSString *path = [requestLineComponents[1] componentsSeparatedByString:@"?"].firstObject;
+	NSUInteger attempt = 0;
+	@synchronized(self) {
+		[self.mutableRequestedPaths addObject:path];
+		if (!self.firstRequestDates[path]) {
+			self.firstRequestDates[path] = [NSDate date];
+		}
+
+		// Attempts are counted over the server lifetime, so that a scenario replays identically after statistics are reset
+		attempt = [self.requestCounts countForObject:path];
+		[self.requestCounts addObject:path];
+	}
+
+	TestHLSNetworkProfile *networkProfile = self.networkProfile;
+	NSTimeInterval latency = networkProfile.latency + networkProfile.jitter * (2. * [networkProfile randomValueForPath:path attempt:attempt salt:TestHLSServerJitterSalt] - 1.);
+	if (latency > 0.) {
+		[NSThread sleepForTimeInterval:latency];
+	}
+
+	if ([networkProfile randomValueForPath:path attempt:attempt salt:TestHLSServerErrorSalt] < networkProfile.errorRate) {
+		@synchronized(self) {
+			_failedRequestCount++;
+		}
+
+		NSString *response = [NSString stringWithFormat:@"HTTP/1.1 %@ Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", @(networkProfile.errorStatusCode)];
+		NSData *responseData = [response dataUsingEncoding:NSUTF8StringEncoding];
+		WriteData(connectionSocket, responseData.bytes, responseData.length);
+		return;
+	}
+
+	NSData *data = [self dataForPath:path];
+	if (!data) {
+		NSString *response = @"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+		NSData *responseData = [response dataUsingEncoding:NSUTF8StringEncoding];
+		WriteData(connectionSocket, responseData.bytes, responseData.length);
+		return;
+	}
+
+	NSRange range = NSMakeRange(0, data.length);
+	BOOL partial = NO;
+	for (NSString *line in lines) {
+		if (![line.lowercaseString hasPrefix:@"range: bytes="]) {
+			continue;
+		}
+
+		NSArray<NSString *> *bounds = [[line substringFromIndex:13] componentsSeparatedByString:@"-"];
+		NSUInteger start = (NSUInteger)bounds.firstObject.longLongValue;
+		NSUInteger end = (bounds.count > 1 && bounds[1].length != 0) ? (NSUInteger)bounds[1].longLongValue : data.length - 1;
+		if (start < data.length && start <= end) {
+			range = NSMakeRange(start, MIN(end, data.length - 1) - start + 1);
+			partial = YES;
+		}
+	}
+
+	NSString *contentType = [path.pathExtension isEqualToString:@"m3u8"] ? @"application/vnd.apple.mpegurl" : @"audio/aac";
+	NSMutableString *response = [NSMutableString stringWithString:partial ? @"HTTP/1.1 206 Partial Content\r\n" : @"HTTP/1.1 200 OK\r\n"];
+	[response appendFormat:@"Content-Type: %@\r\nContent-Length: %@\r\nAccept-Ranges: bytes\r\nConnection: close\r\n", contentType, @(range.length)];
+	if (partial) {
+		[response appendFormat:@"Content-Range: bytes %@-%@/%@\r\n", @(range.location), @(NSMaxRange(range) - 1), @(data.length)];
+	}
+	[response appendString:@"\r\n"];
+
+	NSData *headerData = [response dataUsingEncoding:NSUTF8StringEncoding];
+	if (!WriteData(connectionSocket, headerData.bytes, headerData.length)) {
+		return;
+	}
+
+	if ([requestLineComponents.firstObject isEqualToString:@"HEAD"]) {
+		return;
+	}
+
+	// Dropped connections are closed after part of the body has been sent
+	NSUInteger length = range.length;
+	if ([networkProfile randomValueForPath:path attempt:attempt salt:TestHLSServerLossSalt] < networkProfile.lossRate) {
+		@synchronized(self) {
+			_failedRequestCount++;
+		}
+		length = (NSUInteger)(length * [networkProfile randomValueForPath:path attempt:attempt salt:TestHLSServerLossPositionSalt]);
+	}
+
+	[self writeBodyBytes:(const uint8_t *)data.bytes + range.location length:length toSocket:connectionSocket];
+}
+
+- (void)writeBodyBytes:(const uint8_t *)bytes length:(NSUInteger)length toSocket:(int)connectionSocket
+{
+	while (length > 0) {
+		double maximumThroughput = [self effectiveThroughput];
+		NSUInteger writeLength = (maximumThroughput > 0.) ? MIN(length, TestHLSServerThrottledWriteLength) : length;
+		if (!WriteData(connectionSocket, bytes, writeLength)) {
+			return;
+		}
+
+		@synchronized(self) {
+			_bytesServed += writeLength;
+		}
+
+		bytes += writeLength;
+		length -= writeLength;
+
+		if (maximumThroughput > 0.) {
+			[NSThread sleepForTimeInterval:8. * writeLength / maximumThroughput];
+		}
+	}
+}
+
+@end
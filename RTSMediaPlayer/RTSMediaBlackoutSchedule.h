@@ -0,0 +1,111 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+@class RTSMediaBlackoutSchedule;
+
+/**
+ *  Clocks against which blackout windows are evaluated
+ */
+typedef NS_ENUM(NSInteger, RTSMediaBlackoutClock) {
+	/**
+	 *  The date of the device
+	 */
+	RTSMediaBlackoutClockWallClock = 0,
+	/**
+	 *  The date of the content being played, from its `EXT-X-PROGRAM-DATE-TIME` tags (see `-[AVPlayerItem currentDate]`).
+	 *  The date of the device is used for contents without program dates
+	 */
+	RTSMediaBlackoutClockProgramDate
+};
+
+/**
+ *  A time interval during which a media must not be shown, e.g. because of rights restrictions. Windows are half-open:
+ *  a date equal to the end date is not contained in the window
+ */
+@interface RTSMediaBlackoutWindow : NSObject <NSCopying>
+
++ (RTSMediaBlackoutWindow *)windowWithStartDate:(NSDate *)startDate endDate:(NSDate *)endDate;
+
+@property (nonatomic, readonly) NSDate *startDate;
+@property (nonatomic, readonly) NSDate *endDate;
+
+- (BOOL)containsDate:(NSDate *)date;
+
+@end
+
+/**
+ *  Protocol through which a blackout schedule has the slate prepared and displayed
+ */
+@protocol RTSMediaBlackoutScheduleDelegate <NSObject>
+
+/**
+ *  Called when the slate is needed soon (see `slatePreparationInterval`) or now, so that it can be pre-buffered, and
+ *  when it is not needed anymore. Consecutive windows separated by less than the preparation interval share the slate
+ */
+- (void)blackoutScheduleDidRequireSlate:(RTSMediaBlackoutSchedule *)blackoutSchedule;
+- (void)blackoutScheduleDidReleaseSlate:(RTSMediaBlackoutSchedule *)blackoutSchedule;
+
+/**
+ *  Called when the date enters or exits a window
+ */
+- (void)blackoutSchedule:(RTSMediaBlackoutSchedule *)blackoutSchedule didEnterWindow:(RTSMediaBlackoutWindow *)window;
+- (void)blackoutSchedule:(RTSMediaBlackoutSchedule *)blackoutSchedule didExitWindow:(RTSMediaBlackoutWindow *)window;
+
+@end
+
+/**
+ *  A blackout schedule tracks a date against a set of blackout windows, and tells its delegate when the slate replacing
+ *  the media must be prepared, displayed and released.
+ *
+ *  As for `RTSMediaTimeSchedule`, the schedule does not observe any clock by itself. Its date must be updated with
+ *  `-updateWithDate:`, which makes it possible to drive it with a virtual clock. When the date changes, windows exited
+ *  are reported first, then the slate requirement change, if any, and finally the window entered. The schedule must be
+ *  used from the main thread
+ */
+@interface RTSMediaBlackoutSchedule : NSObject
+
+/**
+ *  The windows, sorted by start date. Empty windows are discarded. If windows overlap, the one starting first applies
+ */
+@property (nonatomic, copy) NSArray<RTSMediaBlackoutWindow *> *windows;
+
+/**
+ *  The time before a window starts at which the slate is required, in seconds. Default is 10 seconds
+ */
+@property (nonatomic) NSTimeInterval slatePreparationInterval;
+
+@property (nonatomic, weak) id<RTSMediaBlackoutScheduleDelegate> delegate;
+
+/**
+ *  Move the schedule to the specified date, forwards or backwards. A nil date means the date is unknown (e.g. nothing
+ *  is being played), in which case the current window is exited and the slate released
+ */
+- (void)updateWithDate:(NSDate *)date;
+
+/**
+ *  The last date the schedule was updated with, nil if unknown
+ */
+@property (nonatomic, readonly) NSDate *currentDate;
+
+/**
+ *  The window containing the current date, nil if none
+ */
+@property (nonatomic, readonly) RTSMediaBlackoutWindow *currentWindow;
+
+/**
+ *  Return YES iff the slate is currently required
+ */
+@property (nonatomic, readonly, getter=isSlateRequired) BOOL slateRequired;
+
+/**
+ *  The first date after the specified one at which the schedule state changes (slate required, window entered or
+ *  exited), nil if none. Use it to update the schedule exactly when needed
+ */
+- (NSDate *)nextTransitionDateAfterDate:(NSDate *)date;
+
+@end
@@ -0,0 +1,230 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaBlackoutSchedule.h"
+
+#import "RTSMediaPlayerLogger+Private.h"
+
+@interface RTSMediaBlackoutWindow ()
+
+@property (nonatomic) NSDate *startDate;
+@property (nonatomic) NSDate *endDate;
+
+@property (nonatomic, readonly, getter=isEmpty) BOOL empty;
+
+@end
+
+@implementation RTSMediaBlackoutWindow
+
++ (RTSMediaBlackoutWindow *)windowWithStartDate:(NSDate *)startDate endDate:(NSDate *)endDate
+{
+	NSParameterAssert(startDate);
+	NSParameterAssert(endDate);
+
+	RTSMediaBlackoutWindow *window = [[RTSMediaBlackoutWindow alloc] init];
+	window.startDate = startDate;
+	window.endDate = endDate;
+	return window;
+}
+
+- (BOOL)containsDate:(NSDate *)date
+{
+	return date && [date compare:self.startDate] != NSOrderedAscending && [date compare:self.endDate] == NSOrderedAscending;
+}
+
+- (BOOL)isEmpty
+{
+	return [self.endDate compare:self.startDate] != NSOrderedDescending;
+}
+
+#pragma mark - NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	// Immutable
+	return self;
+}
+
+#pragma mark - Equality
+
+- (BOOL)isEqual:(id)object
+{
+	if (![object isKindOfClass:[RTSMediaBlackoutWindow class]]) {
+		return NO;
+	}
+
+	RTSMediaBlackoutWindow *otherWindow = object;
+	return [self.startDate isEqualToDate:otherWindow.startDate] && [self.endDate isEqualToDate:otherWindow.endDate];
+}
+
+- (NSUInteger)hash
+{
+	return self.startDate.hash ^ self.endDate.hash;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; startDate: %@; endDate: %@>",
+			[self class],
+			self,
+			self.startDate,
+			self.endDate];
+}
+
+@end
+
+@interface RTSMediaBlackoutSchedule ()
+
+@property (nonatomic) NSDate *currentDate;
+@property (nonatomic) RTSMediaBlackoutWindow *currentWindow;
+@property (nonatomic, getter=isSlateRequired) BOOL slateRequired;
+
+@end
+
+@implementation RTSMediaBlackoutSchedule
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		_windows = @[];
+		_slatePreparationInterval = 10.;
+	}
+	return self;
+}
+
+#pragma mark - Getters and setters
+
+- (void)setWindows:(NSArray<RTSMediaBlackoutWindow *> *)windows
+{
+	NSArray<RTSMediaBlackoutWindow *> *nonEmptyWindows = [windows filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(RTSMediaBlackoutWindow *window, NSDictionary *bindings) {
+		return !window.empty;
+	}]];
+	NSSortDescriptor *startDateSortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"startDate" ascending:YES];
+	_windows = [nonEmptyWindows sortedArrayUsingDescriptors:@[ startDateSortDescriptor ]] ?: @[];
+
+	[self updateWithDate:self.currentDate];
+}
+
+- (void)setSlatePreparationInterval:(NSTimeInterval)slatePreparationInterval
+{
+	_slatePreparationInterval = MAX(slatePreparationInterval, 0.);
+	[self updateWithDate:self.currentDate];
+}
+
+#pragma mark - Updates
+
+- (RTSMediaBlackoutWindow *)windowContainingDate:(NSDate *)date
+{
+	if (!date) {
+		return nil;
+	}
+
+	for (RTSMediaBlackoutWindow *window in self.windows) {
+		if ([window.startDate compare:date] == NSOrderedDescending) {
+			break;
+		}
+		else if ([window containsDate:date]) {
+			return window;
+		}
+	}
+	return nil;
+}
+
+- (BOOL)isSlateRequiredAtDate:(NSDate *)date
+{
+	if (!date) {
+		return NO;
+	}
+
+	NSDate *preparationEndDate = [date dateByAddingTimeInterval:self.slatePreparationInterval];
+	for (RTSMediaBlackoutWindow *window in self.windows) {
+		if ([window.startDate compare:preparationEndDate] == NSOrderedDescending) {
+			break;
+		}
+		else if ([window.endDate compare:date] == NSOrderedDescending) {
+			return YES;
+		}
+	}
+	return NO;
+}
+
+- (void)updateWithDate:(NSDate *)date
+{
+	self.currentDate = date;
+
+	RTSMediaBlackoutWindow *previousWindow = self.currentWindow;
+	RTSMediaBlackoutWindow *window = [self windowContainingDate:date];
+	BOOL slateRequired = [self isSlateRequiredAtDate:date];
+
+	// The delegate might update the schedule as well. Commit the new state first
+	BOOL windowChanged = (previousWindow != window && ![previousWindow isEqual:window]);
+	BOOL slateRequirementChanged = (self.slateRequired != slateRequired);
+	self.currentWindow = window;
+	self.slateRequired = slateRequired;
+
+	id<RTSMediaBlackoutScheduleDelegate> delegate = self.delegate;
+	if (windowChanged && previousWindow) {
+		RTSMediaPlayerLogDebug(@"Blackout window exited: %@", previousWindow);
+		[delegate blackoutSchedule:self didExitWindow:previousWindow];
+	}
+
+	if (slateRequirementChanged) {
+		if (slateRequired) {
+			[delegate blackoutScheduleDidRequireSlate:self];
+		}
+		else {
+			[delegate blackoutScheduleDidReleaseSlate:self];
+		}
+	}
+
+	if (windowChanged && window) {
+		RTSMediaPlayerLogDebug(@"Blackout window entered: %@", window);
+		[delegate blackoutSchedule:self didEnterWindow:window];
+	}
+}
+
+- (NSDate *)nextTransitionDateAfterDate:(NSDate *)date
+{
+	if (!date) {
+		return nil;
+	}
+
+	NSDate *nextTransitionDate = nil;
+	for (RTSMediaBlackoutWindow *window in self.windows) {
+		NSDate *preparationDate = [window.startDate dateByAddingTimeInterval:-self.slatePreparationInterval];
+		for (NSDate *transitionDate in @[ preparationDate, window.startDate, window.endDate ]) {
+			if ([transitionDate compare:date] == NSOrderedDescending
+					&& (!nextTransitionDate || [transitionDate compare:nextTransitionDate] == NSOrderedAscending)) {
+				nextTransitionDate = transitionDate;
+			}
+		}
+
+		// Windows are sorted by start date, later ones cannot have earlier transitions
+		if (nextTransitionDate && [preparationDate compare:nextTransitionDate] == NSOrderedDescending) {
+			break;
+		}
+	}
+	return nextTransitionDate;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; windows: %@; currentDate: %@; currentWindow: %@; slateRequired: %@>",
+			[self class],
+			self,
+			@(self.windows.count),
+			self.currentDate,
+			self.currentWindow,
+			self.slateRequired ? @"YES" : @"NO"];
+}
+
+@end
@@ -0,0 +1,101 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <Foundation/Foundation.h>
+
+#import "RTSMediaPlayerController.h"
+
+/**
+ *  A caption cue matching a searched phrase
+ */
+@interface RTSMediaCaptionMatch : NSObject
+
+/**
+ *  The time range of the cue, and its start time (the time to seek to)
+ */
+@property (nonatomic, readonly) CMTimeRange timeRange;
+@property (nonatomic, readonly) CMTime time;
+
+/**
+ *  The text of the cue, as received
+ */
+@property (nonatomic, readonly, copy) NSString *text;
+
+/**
+ *  The match score, between 0 and 2. Cues where the whole phrase starts score above 1 (the phrase can continue in the
+ *  following cue), other cues score below 1 according to the searched words they contain, rare words weighing more
+ */
+@property (nonatomic, readonly) double score;
+@property (nonatomic, readonly, getter=isPhraseMatch) BOOL phraseMatch;
+
+@end
+
+/**
+ *  A caption index maintains a full-text index of the captions of a media, so that users can search what is said and
+ *  seek to it, e.g. by passing the `time` of a match to `-[RTSMediaPlayerController seekToTime:completionHandler:]`.
+ *
+ *  Cues are added incrementally, as captions are received, and can be searched at any time. Cues are indexed and
+ *  searched on a background serial queue, an index can therefore be used from any thread. Cues added twice (same start
+ *  time and text, e.g. received again after a seek) are ignored.
+ *
+ *  Text and searched phrases are folded (case and diacritics insensitive). The index itself is a compact inverted index
+ *  (see `RTSTextIndex.h`), typically smaller than the caption text
+ */
+@interface RTSMediaCaptionIndex : NSObject
+
+/**
+ *  Create an index for the media with the specified identifier
+ */
+- (instancetype)initWithIdentifier:(NSString *)identifier NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, copy) NSString *identifier;
+
+/**
+ *  The number of cues indexed. Waits until cues added before have been indexed
+ */
+@property (nonatomic, readonly) NSUInteger cueCount;
+
+/**
+ *  Add a cue. Line breaks are replaced with spaces
+ */
+- (void)addCueWithTimeRange:(CMTimeRange)timeRange text:(NSString *)text;
+
+/**
+ *  Add the cues of a WebVTT document (e.g. sidecar subtitles). Cue tags are removed and character references decoded.
+ *  The document is parsed on the index queue
+ */
+- (void)addCuesFromWebVTTString:(NSString *)string;
+
+/**
+ *  Search a phrase, calling the completion handler on the main thread with the best matches (at most the specified
+ *  count), best first. Matches with the same score are sorted by time
+ */
+- (void)searchPhrase:(NSString *)phrase maximumMatchCount:(NSUInteger)maximumMatchCount completionHandler:(void (^)(NSArray<RTSMediaCaptionMatch *> *matches))completionHandler;
+
+/**
+ *  Same as `-searchPhrase:maximumMatchCount:completionHandler:`, but synchronous. Waits until cues added before have
+ *  been indexed
+ */
+- (NSArray<RTSMediaCaptionMatch *> *)matchesForPhrase:(NSString *)phrase maximumMatchCount:(NSUInteger)maximumMatchCount;
+
+@end
+
+@interface RTSMediaPlayerController (RTSMediaCaptionIndex)
+
+/**
+ *  If set to YES, the captions displayed by the controller (for the selected legible media option, if any) are added
+ *  to its caption index as they are played. Default is NO
+ */
+@property (nonatomic, getter=isCaptionIndexingEnabled) BOOL captionIndexingEnabled;
+
+/**
+ *  The caption index of the media being played, nil if the controller has no identifier. A new index is created when
+ *  the identifier changes. Sidecar captions can be added to it as well (see `-addCuesFromWebVTTString:`)
+ */
+@property (nonatomic, readonly) RTSMediaCaptionIndex *captionIndex;
+
+@end
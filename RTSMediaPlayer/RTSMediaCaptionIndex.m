@@ -0,0 +1,298 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaCaptionIndex.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "RTSMediaPlayerLogger+Private.h"
+#import "RTSTextIndex.h"
+
+// Return the time in seconds of a WebVTT timestamp (hh:mm:ss.ttt or mm:ss.ttt), NAN if invalid
+static NSTimeInterval RTSMediaCaptionTimeFromWebVTTTimestamp(NSString *timestamp)
+{
+	NSArray<NSString *> *components = [timestamp componentsSeparatedByString:@":"];
+	if (components.count < 2 || components.count > 3) {
+		return NAN;
+	}
+
+	NSTimeInterval time = 0.;
+	for (NSString *component in components) {
+		NSScanner *scanner = [NSScanner scannerWithString:component];
+		double value = 0.;
+		if (![scanner scanDouble:&value] || !scanner.isAtEnd || value < 0.) {
+			return NAN;
+		}
+		time = time * 60. + value;
+	}
+	return time;
+}
+
+// Remove cue tags (e.g. voice or styling spans) and decode character references
+static NSString *RTSMediaCaptionTextFromWebVTTText(NSString *text)
+{
+	static NSRegularExpression *s_tagRegularExpression;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		s_tagRegularExpression = [NSRegularExpression regularExpressionWithPattern:@"<[^>]*>" options:0 error:NULL];
+	});
+
+	text = [s_tagRegularExpression stringByReplacingMatchesInString:text options:0 range:NSMakeRange(0, text.length) withTemplate:@""];
+	text = [text stringByReplacingOccurrencesOfString:@"&lt;" withString:@"<"];
+	text = [text stringByReplacingOccurrencesOfString:@"&gt;" withString:@">"];
+	text = [text stringByReplacingOccurrencesOfString:@"&nbsp;" withString:@" "];
+	return [text stringByReplacingOccurrencesOfString:@"&amp;" withString:@"&"];
+}
+
+// Text and queries must be normalized alike
+static NSString *RTSMediaCaptionNormalizedString(NSString *string)
+{
+	NSString *foldedString = [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale:nil];
+	return [foldedString stringByReplacingOccurrencesOfString:@"’" withString:@"'"];
+}
+
+@interface RTSMediaCaptionMatch ()
+
+@property (nonatomic) CMTimeRange timeRange;
+@property (nonatomic, copy) NSString *text;
+@property (nonatomic) double score;
+@property (nonatomic, getter=isPhraseMatch) BOOL phraseMatch;
+
+@end
+
+@implementation RTSMediaCaptionMatch
+
+- (CMTime)time
+{
+	return self.timeRange.start;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; time: %.3f; score: %.3f; phraseMatch: %@; text: %@>",
+			[self class],
+			self,
+			CMTimeGetSeconds(self.time),
+			self.score,
+			self.phraseMatch ? @"YES" : @"NO",
+			self.text];
+}
+
+@end
+
+@interface RTSMediaCaptionIndex ()
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic) RTSTextIndexRef textIndex;
+@property (nonatomic) dispatch_queue_t queue;
+
+// Accessed on the queue only
+@property (nonatomic) NSMutableArray<NSString *> *cueTexts;
+@property (nonatomic) NSMutableSet<NSString *> *cueKeys;
+
+@end
+
+@implementation RTSMediaCaptionIndex
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithIdentifier:nil];
+}
+
+- (instancetype)initWithIdentifier:(NSString *)identifier
+{
+	if (self = [super init]) {
+		self.textIndex = RTSTextIndexCreate();
+		if (!self.textIndex) {
+			return nil;
+		}
+
+		self.identifier = identifier;
+		self.queue = dispatch_queue_create("ch.srgssr.mediaplayer.captionindex", DISPATCH_QUEUE_SERIAL);
+		self.cueTexts = [NSMutableArray array];
+		self.cueKeys = [NSMutableSet set];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	if (_textIndex) {
+		RTSTextIndexDestroy(_textIndex);
+	}
+}
+
+#pragma mark - Getters and setters
+
+- (NSUInteger)cueCount
+{
+	__block NSUInteger cueCount = 0;
+	dispatch_sync(self.queue, ^{
+		cueCount = self.cueTexts.count;
+	});
+	return cueCount;
+}
+
+#pragma mark - Indexing
+
+- (void)addCueWithTimeRange:(CMTimeRange)timeRange text:(NSString *)text
+{
+	if (!CMTIMERANGE_IS_VALID(timeRange) || CMTIMERANGE_IS_INDEFINITE(timeRange) || text.length == 0) {
+		return;
+	}
+
+	NSTimeInterval startTime = CMTimeGetSeconds(timeRange.start);
+	NSTimeInterval endTime = CMTimeGetSeconds(CMTimeRangeGetEnd(timeRange));
+	dispatch_async(self.queue, ^{
+		[self indexCueWithStartTime:startTime endTime:endTime text:text];
+	});
+}
+
+- (void)addCuesFromWebVTTString:(NSString *)string
+{
+	if (string.length == 0) {
+		return;
+	}
+
+	dispatch_async(self.queue, ^{
+		CFTimeInterval startTime = CACurrentMediaTime();
+		NSUInteger cueCount = self.cueTexts.count;
+
+		NSString *normalizedString = [[string stringByReplacingOccurrencesOfString:@"\r\n" withString:@"\n"] stringByReplacingOccurrencesOfString:@"\r" withString:@"\n"];
+		NSArray<NSString *> *lines = [[normalizedString componentsSeparatedByString:@"\n"] arrayByAddingObject:@""];
+
+		// Cues are made of a timing line and of the text lines which follow it, up to the next empty line. Other blocks
+		// (header, notes, styles) have no timing line and are ignored
+		NSTimeInterval cueStartTime = NAN, cueEndTime = NAN;
+		NSMutableArray<NSString *> *cueLines = nil;
+		for (NSString *line in lines) {
+			NSRange arrowRange = [line rangeOfString:@"-->"];
+			if (arrowRange.location != NSNotFound) {
+				NSString *startTimestamp = [[line substringToIndex:arrowRange.location] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+				NSArray<NSString *> *endComponents = [[[line substringFromIndex:NSMaxRange(arrowRange)] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]
+													  componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+
+				// Cue settings might follow the end time
+				cueStartTime = RTSMediaCaptionTimeFromWebVTTTimestamp(startTimestamp);
+				cueEndTime = RTSMediaCaptionTimeFromWebVTTTimestamp(endComponents.firstObject);
+				cueLines = [NSMutableArray array];
+			}
+			else if (line.length == 0) {
+				if (cueLines.count != 0 && !isnan(cueStartTime) && !isnan(cueEndTime)) {
+					NSString *text = RTSMediaCaptionTextFromWebVTTText([cueLines componentsJoinedByString:@" "]);
+					[self indexCueWithStartTime:cueStartTime endTime:cueEndTime text:text];
+				}
+				cueLines = nil;
+			}
+			else {
+				[cueLines addObject:line];
+			}
+		}
+
+		RTSMediaPlayerLogDebug(@"%@ WebVTT cues indexed in %.3f msec. (%@ terms, %@ bytes)",
+							   @(self.cueTexts.count - cueCount),
+							   (CACurrentMediaTime() - startTime) * 1000.,
+							   @(RTSTextIndexGetTermCount(self.textIndex)),
+							   @(RTSTextIndexGetMemorySize(self.textIndex)));
+	});
+}
+
+// Must be called on the queue
+- (void)indexCueWithStartTime:(NSTimeInterval)startTime endTime:(NSTimeInterval)endTime text:(NSString *)text
+{
+	NSArray<NSString *> *components = [text componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+	text = [[components filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]] componentsJoinedByString:@" "];
+	if (text.length == 0) {
+		return;
+	}
+
+	NSString *key = [NSString stringWithFormat:@"%.1f %@", startTime, text];
+	if ([self.cueKeys containsObject:key]) {
+		return;
+	}
+
+	size_t cueIndex = RTSTextIndexAddCue(self.textIndex, startTime, MAX(startTime, endTime), RTSMediaCaptionNormalizedString(text).UTF8String);
+	if (cueIndex == (size_t)-1) {
+		RTSMediaPlayerLogError(@"Caption cue at %.3f could not be indexed", startTime);
+		return;
+	}
+
+	[self.cueTexts addObject:text];
+	[self.cueKeys addObject:key];
+}
+
+#pragma mark - Search
+
+- (void)searchPhrase:(NSString *)phrase maximumMatchCount:(NSUInteger)maximumMatchCount completionHandler:(void (^)(NSArray<RTSMediaCaptionMatch *> *matches))completionHandler
+{
+	NSParameterAssert(completionHandler);
+
+	dispatch_async(self.queue, ^{
+		NSArray<RTSMediaCaptionMatch *> *matches = [self matchesOnQueueForPhrase:phrase maximumMatchCount:maximumMatchCount];
+		dispatch_async(dispatch_get_main_queue(), ^{
+			completionHandler(matches);
+		});
+	});
+}
+
+- (NSArray<RTSMediaCaptionMatch *> *)matchesForPhrase:(NSString *)phrase maximumMatchCount:(NSUInteger)maximumMatchCount
+{
+	__block NSArray<RTSMediaCaptionMatch *> *matches = nil;
+	dispatch_sync(self.queue, ^{
+		matches = [self matchesOnQueueForPhrase:phrase maximumMatchCount:maximumMatchCount];
+	});
+	return matches;
+}
+
+// Must be called on the queue
+- (NSArray<RTSMediaCaptionMatch *> *)matchesOnQueueForPhrase:(NSString *)phrase maximumMatchCount:(NSUInteger)maximumMatchCount
+{
+	if (phrase.length == 0 || maximumMatchCount == 0 || self.cueTexts.count == 0) {
+		return @[];
+	}
+
+	maximumMatchCount = MIN(maximumMatchCount, self.cueTexts.count);
+	RTSTextIndexMatch *textIndexMatches = malloc(maximumMatchCount * sizeof(RTSTextIndexMatch));
+	if (!textIndexMatches) {
+		return @[];
+	}
+
+	CFTimeInterval startTime = CACurrentMediaTime();
+	size_t matchCount = RTSTextIndexSearch(self.textIndex, RTSMediaCaptionNormalizedString(phrase).UTF8String, textIndexMatches, maximumMatchCount);
+	RTSMediaPlayerLogDebug(@"Caption search for '%@' returned %@ matches in %.3f msec.", phrase, @(matchCount), (CACurrentMediaTime() - startTime) * 1000.);
+
+	NSMutableArray<RTSMediaCaptionMatch *> *matches = [NSMutableArray arrayWithCapacity:matchCount];
+	for (size_t i = 0; i < matchCount; ++i) {
+		RTSTextIndexMatch textIndexMatch = textIndexMatches[i];
+
+		RTSMediaCaptionMatch *match = [[RTSMediaCaptionMatch alloc] init];
+		match.timeRange = CMTimeRangeFromTimeToTime(CMTimeMakeWithSeconds(textIndexMatch.startTime, NSEC_PER_SEC),
+													CMTimeMakeWithSeconds(textIndexMatch.endTime, NSEC_PER_SEC));
+		match.text = self.cueTexts[textIndexMatch.cueIndex];
+		match.score = textIndexMatch.score;
+		match.phraseMatch = (textIndexMatch.phrase != 0);
+		[matches addObject:match];
+	}
+	free(textIndexMatches);
+
+	return [matches copy];
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; identifier: %@>",
+			[self class],
+			self,
+			self.identifier];
+}
+
+@end
@@ -0,0 +1,25 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlayerBufferBudget.h"
+
+/**
+ *  Private interface for implementation purposes
+ */
+@interface RTSMediaPlayerBufferBudget (Private)
+
+/**
+ *  Register or unregister a media player controller. Registered controllers are weakly referenced
+ */
+- (void)addMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController;
+- (void)removeMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController;
+
+/**
+ *  Schedule a rebalance for the next run loop iteration. Several calls made in a row are coalesced
+ */
+- (void)setNeedsRebalance;
+
+@end
@@ -0,0 +1,112 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "RTSMediaPlayerConstants.h"
+
+// Forward declarations
+@class RTSMediaPlayerController;
+
+/**
+ *  The default memory budget shared by all players (in bytes)
+ */
+FOUNDATION_EXTERN unsigned long long const RTSMediaPlayerBufferBudgetDefaultMaximumBytes;
+
+/**
+ *  Bounds applied to the forward buffer duration allocated to a player (in seconds). When the budget cannot cover the
+ *  minimum duration of all players, each of them receives the same fraction of it instead
+ */
+FOUNDATION_EXTERN NSTimeInterval const RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration;
+FOUNDATION_EXTERN NSTimeInterval const RTSMediaPlayerBufferBudgetMaximumForwardBufferDuration;
+
+/**
+ *  A buffer budget distributes a fixed amount of memory among several media player controllers, so that the total
+ *  amount of buffered media stays bounded, no matter how many players are alive at the same time.
+ *
+ *  Each player receives a share of the budget according to its buffer priority (see `RTSMediaPlayerBufferPriority`),
+ *  which is converted into a `preferredForwardBufferDuration` based on the bit rate of the stream being played. The
+ *  budget is rebalanced automatically when a player priority, bit rate or playback state changes.
+ *
+ *  All media player controllers share the process-wide budget returned by `+sharedBufferBudget` by default. Forward
+ *  buffer durations can only be applied on iOS 10 and above, the budget does nothing on earlier versions.
+ */
+@interface RTSMediaPlayerBufferBudget : NSObject
+
+/**
+ *  The budget shared by all media player controllers by default
+ */
++ (RTSMediaPlayerBufferBudget *)sharedBufferBudget;
+
+/**
+ *  Create a budget with the specified maximum size
+ *
+ *  @param maximumBytes The amount of memory to distribute among players, in bytes
+ */
+- (instancetype)initWithMaximumBytes:(unsigned long long)maximumBytes NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The amount of memory distributed among players, in bytes. Defaults to `RTSMediaPlayerBufferBudgetDefaultMaximumBytes`
+ *  for the shared budget
+ */
+@property (nonatomic) unsigned long long maximumBytes;
+
+/**
+ *  The media player controllers currently sharing the budget
+ */
+@property (nonatomic, readonly) NSArray<RTSMediaPlayerController *> *mediaPlayerControllers;
+
+/**
+ *  Estimation of the number of bytes currently held in the buffers of all players sharing the budget
+ */
+@property (nonatomic, readonly) unsigned long long estimatedBytes;
+
+/**
+ *  Immediately recalculate and apply the forward buffer durations of all players. You do not need to call this method
+ *  yourself, rebalancing is automatically scheduled when needed
+ */
+- (void)rebalance;
+
+/**
+ *  Return the forward buffer durations (in seconds, as `NSNumber`s) allocated for a list of players, described by their
+ *  priorities and bit rates (a zero bit rate means unknown). Pure function used by the budget, exposed for testing
+ *  purposes
+ *
+ *  @param priorities   The player priorities, as `NSNumber`s wrapping `RTSMediaPlayerBufferPriority` values
+ *  @param bitRates     The corresponding bit rates, in bits per second
+ *  @param maximumBytes The amount of memory to distribute
+ */
++ (NSArray<NSNumber *> *)forwardBufferDurationsForPriorities:(NSArray<NSNumber *> *)priorities
+                                                    bitRates:(NSArray<NSNumber *> *)bitRates
+                                                maximumBytes:(unsigned long long)maximumBytes;
+
+@end
+
+@interface RTSMediaPlayerController (RTSMediaPlayerBufferBudget)
+
+/**
+ *  The buffer priority of the player. Defaults to `RTSMediaPlayerBufferPriorityVisibleAudible`. Muted and paused players
+ *  are automatically treated with a lower priority (see `effectiveBufferPriority`)
+ */
+@property (nonatomic) RTSMediaPlayerBufferPriority bufferPriority;
+
+/**
+ *  The priority actually used when distributing the buffer budget, taking into account the muted and playback states
+ */
+@property (nonatomic, readonly) RTSMediaPlayerBufferPriority effectiveBufferPriority;
+
+/**
+ *  The budget the player participates in. Defaults to the shared buffer budget. Set to nil to let `AVPlayer` choose
+ *  its forward buffer duration freely
+ */
+@property (nonatomic) RTSMediaPlayerBufferBudget *bufferBudget;
+
+/**
+ *  The forward buffer duration currently allocated to the player by its budget (0 if none)
+ */
+@property (nonatomic, readonly) NSTimeInterval allocatedForwardBufferDuration;
+
+@end
@@ -0,0 +1,267 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlayerBufferBudget.h"
+#import "RTSMediaPlayerBufferBudget+Private.h"
+
+#import "RTSMediaPlayerController.h"
+#import "RTSMediaPlayerController+Private.h"
+#import "RTSMediaPlayerLogger+Private.h"
+
+unsigned long long const RTSMediaPlayerBufferBudgetDefaultMaximumBytes = 48 * 1024 * 1024;
+
+NSTimeInterval const RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration = 2.;
+NSTimeInterval const RTSMediaPlayerBufferBudgetMaximumForwardBufferDuration = 60.;
+
+// Bit rate assumed when a stream bit rate is not known yet (in bits per second)
+static const double RTSMediaPlayerBufferBudgetDefaultBitRate = 2. * 1000. * 1000.;
+
+static double RTSMediaPlayerBufferPriorityWeight(RTSMediaPlayerBufferPriority priority)
+{
+	switch (priority) {
+		case RTSMediaPlayerBufferPriorityVisibleAudible: {
+			return 8.;
+		}
+
+		case RTSMediaPlayerBufferPriorityVisibleMuted: {
+			return 4.;
+		}
+
+		case RTSMediaPlayerBufferPriorityHidden: {
+			return 2.;
+		}
+
+		case RTSMediaPlayerBufferPriorityPaused: {
+			return 1.;
+		}
+	}
+	return 1.;
+}
+
+@interface RTSMediaPlayerBufferBudget ()
+
+@property (nonatomic) NSHashTable *registeredMediaPlayerControllers;
+@property (nonatomic, getter=isRebalanceScheduled) BOOL rebalanceScheduled;
+
+@end
+
+@implementation RTSMediaPlayerBufferBudget
+
+#pragma mark - Class methods
+
++ (RTSMediaPlayerBufferBudget *)sharedBufferBudget
+{
+	static RTSMediaPlayerBufferBudget *s_sharedBufferBudget;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		s_sharedBufferBudget = [[RTSMediaPlayerBufferBudget alloc] initWithMaximumBytes:RTSMediaPlayerBufferBudgetDefaultMaximumBytes];
+	});
+	return s_sharedBufferBudget;
+}
+
++ (NSArray<NSNumber *> *)forwardBufferDurationsForPriorities:(NSArray<NSNumber *> *)priorities
+                                                    bitRates:(NSArray<NSNumber *> *)bitRates
+                                                maximumBytes:(unsigned long long)maximumBytes
+{
+	NSParameterAssert(priorities.count == bitRates.count);
+
+	NSUInteger count = priorities.count;
+	if (count == 0) {
+		return @[];
+	}
+
+	double *effectiveBitRates = calloc(count, sizeof(double));
+	double *durations = calloc(count, sizeof(double));
+	BOOL *capped = calloc(count, sizeof(BOOL));
+
+	// Each player first receives the minimum duration, so that the sum of allocated bytes never exceeds the budget
+	double minimumBytes = 0.;
+	for (NSUInteger i = 0; i < count; ++i) {
+		double bitRate = [bitRates[i] doubleValue];
+		effectiveBitRates[i] = (bitRate > 0.) ? bitRate : RTSMediaPlayerBufferBudgetDefaultBitRate;
+		minimumBytes += RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration * effectiveBitRates[i] / 8.;
+	}
+
+	// Too many players for the budget to cover their minimum durations. Scale all of them down by the same factor
+	if (minimumBytes >= maximumBytes) {
+		double scale = (minimumBytes > 0.) ? maximumBytes / minimumBytes : 0.;
+		for (NSUInteger i = 0; i < count; ++i) {
+			durations[i] = RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration * scale;
+		}
+	}
+	else {
+		// Water-filling: distribute the bytes left above minimum durations proportionally to the weights of players which
+		// have not reached the maximum duration yet. Bytes left unused by capped players are given back to the others at
+		// the next pass
+		double extraBytes = maximumBytes - minimumBytes;
+		double remainingBytes = extraBytes;
+		NSTimeInterval maximumExtraDuration = RTSMediaPlayerBufferBudgetMaximumForwardBufferDuration - RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration;
+		BOOL capping = YES;
+		while (capping) {
+			capping = NO;
+
+			double totalWeight = 0.;
+			for (NSUInteger i = 0; i < count; ++i) {
+				if (!capped[i]) {
+					totalWeight += RTSMediaPlayerBufferPriorityWeight([priorities[i] integerValue]);
+				}
+			}
+
+			if (totalWeight == 0.) {
+				break;
+			}
+
+			for (NSUInteger i = 0; i < count; ++i) {
+				if (capped[i]) {
+					continue;
+				}
+
+				double bytes = remainingBytes * RTSMediaPlayerBufferPriorityWeight([priorities[i] integerValue]) / totalWeight;
+				durations[i] = 8. * bytes / effectiveBitRates[i];
+
+				if (durations[i] >= maximumExtraDuration) {
+					durations[i] = maximumExtraDuration;
+					capped[i] = YES;
+					capping = YES;
+				}
+			}
+
+			if (capping) {
+				remainingBytes = extraBytes;
+				for (NSUInteger i = 0; i < count; ++i) {
+					if (capped[i]) {
+						remainingBytes -= durations[i] * effectiveBitRates[i] / 8.;
+					}
+				}
+				remainingBytes = MAX(remainingBytes, 0.);
+			}
+		}
+
+		for (NSUInteger i = 0; i < count; ++i) {
+			durations[i] += RTSMediaPlayerBufferBudgetMinimumForwardBufferDuration;
+		}
+	}
+
+	NSMutableArray<NSNumber *> *forwardBufferDurations = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; ++i) {
+		[forwardBufferDurations addObject:@(durations[i])];
+	}
+
+	free(effectiveBitRates);
+	free(durations);
+	free(capped);
+
+	return [forwardBufferDurations copy];
+}
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithMaximumBytes:RTSMediaPlayerBufferBudgetDefaultMaximumBytes];
+}
+
+- (instancetype)initWithMaximumBytes:(unsigned long long)maximumBytes
+{
+	if (self = [super init]) {
+		_maximumBytes = maximumBytes;
+		self.registeredMediaPlayerControllers = [NSHashTable weakObjectsHashTable];
+	}
+	return self;
+}
+
+#pragma mark - Getters and setters
+
+- (void)setMaximumBytes:(unsigned long long)maximumBytes
+{
+	_maximumBytes = maximumBytes;
+	[self setNeedsRebalance];
+}
+
+- (NSArray<RTSMediaPlayerController *> *)mediaPlayerControllers
+{
+	return self.registeredMediaPlayerControllers.allObjects;
+}
+
+- (unsigned long long)estimatedBytes
+{
+	unsigned long long estimatedBytes = 0;
+	for (RTSMediaPlayerController *mediaPlayerController in self.mediaPlayerControllers) {
+		estimatedBytes += mediaPlayerController.estimatedBufferedBytes;
+	}
+	return estimatedBytes;
+}
+
+#pragma mark - Registration (private)
+
+- (void)addMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	NSParameterAssert(mediaPlayerController);
+
+	[self.registeredMediaPlayerControllers addObject:mediaPlayerController];
+	[self setNeedsRebalance];
+}
+
+- (void)removeMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	NSParameterAssert(mediaPlayerController);
+
+	[self.registeredMediaPlayerControllers removeObject:mediaPlayerController];
+	[mediaPlayerController setAllocatedForwardBufferDuration:0.];
+	[self setNeedsRebalance];
+}
+
+#pragma mark - Rebalancing
+
+- (void)setNeedsRebalance
+{
+	if (self.rebalanceScheduled) {
+		return;
+	}
+
+	// Coalesce changes received during the same run loop iteration
+	self.rebalanceScheduled = YES;
+	dispatch_async(dispatch_get_main_queue(), ^{
+		if (self.rebalanceScheduled) {
+			[self rebalance];
+		}
+	});
+}
+
+- (void)rebalance
+{
+	self.rebalanceScheduled = NO;
+
+	NSArray<RTSMediaPlayerController *> *mediaPlayerControllers = self.mediaPlayerControllers;
+
+	NSMutableArray<NSNumber *> *priorities = [NSMutableArray arrayWithCapacity:mediaPlayerControllers.count];
+	NSMutableArray<NSNumber *> *bitRates = [NSMutableArray arrayWithCapacity:mediaPlayerControllers.count];
+	for (RTSMediaPlayerController *mediaPlayerController in mediaPlayerControllers) {
+		[priorities addObject:@(mediaPlayerController.effectiveBufferPriority)];
+		[bitRates addObject:@(mediaPlayerController.indicatedBitRate)];
+	}
+
+	NSArray<NSNumber *> *forwardBufferDurations = [RTSMediaPlayerBufferBudget forwardBufferDurationsForPriorities:priorities
+																										 bitRates:bitRates
+																									 maximumBytes:self.maximumBytes];
+	[mediaPlayerControllers enumerateObjectsUsingBlock:^(RTSMediaPlayerController *mediaPlayerController, NSUInteger idx, BOOL *stop) {
+		[mediaPlayerController setAllocatedForwardBufferDuration:[forwardBufferDurations[idx] doubleValue]];
+	}];
+
+	RTSMediaPlayerLogDebug(@"Buffer budget rebalanced among %@ players (%@ bytes estimated for %@ bytes allowed)", @(mediaPlayerControllers.count),
+						   @(self.estimatedBytes), @(self.maximumBytes));
+}
+
+@end
+
+@implementation RTSMediaPlayerController (RTSMediaPlayerBufferBudget)
+
+@dynamic bufferPriority;
+@dynamic effectiveBufferPriority;
+@dynamic bufferBudget;
+@dynamic allocatedForwardBufferDuration;
+
+@end
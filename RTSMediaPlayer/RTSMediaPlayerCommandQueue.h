@@ -0,0 +1,71 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <Foundation/Foundation.h>
+
+/**
+ *  Playback commands
+ */
+typedef NS_ENUM(NSInteger, RTSMediaPlayerPlaybackCommand) {
+	RTSMediaPlayerPlaybackCommandNone = 0,
+	RTSMediaPlayerPlaybackCommandPlay,
+	RTSMediaPlayerPlaybackCommandPause
+};
+
+/**
+ *  Commands issued to a player before it is able to execute them (e.g. a seek before its item is ready to play) are
+ *  collected in a command queue, and applied in a single step once the player is ready. Commands are collapsed as
+ *  they are enqueued:
+ *
+ *    - The last seek wins. Previous seeks complete with `finished` set to NO.
+ *    - Playback commands cancel each other out: a play followed by a pause (or conversely) leaves only the last
+ *      command, the previous one completing with `finished` set to NO. Repeated commands are applied once.
+ *
+ *  A seek and a playback command can be pending at the same time. A command queue must be used from a single thread
+ */
+@interface RTSMediaPlayerCommandQueue : NSObject
+
+/**
+ *  Enqueue a playback command. The completion handler (optional) is called when the command is applied, cancelled
+ *  or superseded
+ */
+- (void)enqueuePlaybackCommand:(RTSMediaPlayerPlaybackCommand)playbackCommand completionHandler:(void (^)(BOOL finished))completionHandler;
+
+/**
+ *  Enqueue a seek to the specified time. Invalid times are ignored. The completion handler (optional) is called when
+ *  the seek is applied, cancelled or superseded
+ */
+- (void)enqueueSeekToTime:(CMTime)time completionHandler:(void (^)(BOOL finished))completionHandler;
+
+/**
+ *  Return YES iff no command is pending
+ */
+@property (nonatomic, readonly, getter=isEmpty) BOOL empty;
+
+/**
+ *  The pending playback command, `RTSMediaPlayerPlaybackCommandNone` if none
+ */
+@property (nonatomic, readonly) RTSMediaPlayerPlaybackCommand playbackCommand;
+
+/**
+ *  The pending seek time, `kCMTimeInvalid` if none
+ */
+@property (nonatomic, readonly) CMTime seekTime;
+
+/**
+ *  Dequeue all pending commands and call the block to apply them. The block must call the completion handler it
+ *  receives exactly once, when the commands have been applied, which calls the completion handlers of all commands
+ *  applied. Commands enqueued by the block are kept for later
+ */
+- (void)applyUsingBlock:(void (^)(CMTime seekTime, RTSMediaPlayerPlaybackCommand playbackCommand, void (^completionHandler)(BOOL finished)))block;
+
+/**
+ *  Discard all pending commands. Their completion handlers are called with `finished` set to NO
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,142 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlayerCommandQueue.h"
+
+#import "RTSMediaPlayerLogger+Private.h"
+
+@interface RTSMediaPlayerCommandQueue ()
+
+@property (nonatomic) RTSMediaPlayerPlaybackCommand playbackCommand;
+@property (nonatomic, copy) void (^playbackCompletionHandler)(BOOL finished);
+
+@property (nonatomic) CMTime seekTime;
+@property (nonatomic, copy) void (^seekCompletionHandler)(BOOL finished);
+
+@end
+
+@implementation RTSMediaPlayerCommandQueue
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.seekTime = kCMTimeInvalid;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[self cancel];
+}
+
+#pragma mark - Getters and setters
+
+- (BOOL)isEmpty
+{
+	return self.playbackCommand == RTSMediaPlayerPlaybackCommandNone && CMTIME_IS_INVALID(self.seekTime);
+}
+
+#pragma mark - Commands
+
+- (void)enqueuePlaybackCommand:(RTSMediaPlayerPlaybackCommand)playbackCommand completionHandler:(void (^)(BOOL finished))completionHandler
+{
+	if (playbackCommand == RTSMediaPlayerPlaybackCommandNone) {
+		return;
+	}
+
+	void (^previousCompletionHandler)(BOOL) = self.playbackCompletionHandler;
+
+	// Repeated commands are applied once, all of them completing together
+	if (self.playbackCommand == playbackCommand) {
+		self.playbackCompletionHandler = ^(BOOL finished) {
+			if (previousCompletionHandler) {
+				previousCompletionHandler(finished);
+			}
+			if (completionHandler) {
+				completionHandler(finished);
+			}
+		};
+		return;
+	}
+
+	if (self.playbackCommand != RTSMediaPlayerPlaybackCommandNone) {
+		RTSMediaPlayerLogDebug(@"Pending %@ cancelled out", (self.playbackCommand == RTSMediaPlayerPlaybackCommandPlay) ? @"play" : @"pause");
+	}
+
+	self.playbackCommand = playbackCommand;
+	self.playbackCompletionHandler = completionHandler;
+
+	// Called last, so that the queue is consistent if the handler enqueues commands
+	if (previousCompletionHandler) {
+		previousCompletionHandler(NO);
+	}
+}
+
+- (void)enqueueSeekToTime:(CMTime)time completionHandler:(void (^)(BOOL finished))completionHandler
+{
+	if (CMTIME_IS_INVALID(time)) {
+		return;
+	}
+
+	void (^previousCompletionHandler)(BOOL) = self.seekCompletionHandler;
+	if (CMTIME_IS_VALID(self.seekTime)) {
+		RTSMediaPlayerLogDebug(@"Pending seek to %.2f sec. superseded", CMTimeGetSeconds(self.seekTime));
+	}
+
+	self.seekTime = time;
+	self.seekCompletionHandler = completionHandler;
+
+	if (previousCompletionHandler) {
+		previousCompletionHandler(NO);
+	}
+}
+
+- (void)applyUsingBlock:(void (^)(CMTime, RTSMediaPlayerPlaybackCommand, void (^)(BOOL)))block
+{
+	NSParameterAssert(block);
+
+	CMTime seekTime = self.seekTime;
+	RTSMediaPlayerPlaybackCommand playbackCommand = self.playbackCommand;
+	void (^seekCompletionHandler)(BOOL) = self.seekCompletionHandler;
+	void (^playbackCompletionHandler)(BOOL) = self.playbackCompletionHandler;
+	[self clear];
+
+	block(seekTime, playbackCommand, ^(BOOL finished) {
+		if (seekCompletionHandler) {
+			seekCompletionHandler(finished);
+		}
+		if (playbackCompletionHandler) {
+			playbackCompletionHandler(finished);
+		}
+	});
+}
+
+- (void)cancel
+{
+	void (^seekCompletionHandler)(BOOL) = self.seekCompletionHandler;
+	void (^playbackCompletionHandler)(BOOL) = self.playbackCompletionHandler;
+	[self clear];
+
+	if (seekCompletionHandler) {
+		seekCompletionHandler(NO);
+	}
+	if (playbackCompletionHandler) {
+		playbackCompletionHandler(NO);
+	}
+}
+
+- (void)clear
+{
+	self.seekTime = kCMTimeInvalid;
+	self.seekCompletionHandler = nil;
+	self.playbackCommand = RTSMediaPlayerPlaybackCommandNone;
+	self.playbackCompletionHandler = nil;
+}
+
+@end
@@ -88,6 +88,12 @@ typedef NS_ENUM(NSInteger, RTSMediaPlaybackState) {
 	 *  The player has reached the end of the media and has automatically stopped playback.
 	 */
 	RTSMediaPlaybackStateEnded,
+	
+	/**
+	 *  The media is played at a rate other than the normal one, fast forward or in reverse (see `-playAtRate:`). Playback
+	 *  returns to the paused state when the beginning of the media is reached in reverse.
+	 */
+	RTSMediaPlaybackStateTrickPlaying,
 };
 
 /**
@@ -142,6 +148,63 @@ typedef NS_ENUM(NSInteger, RTSMediaStreamType) {
 	RTSMediaStreamTypeDVR,
 };
 
+/**
+ *  @enum RTSMediaPlayerBufferPriority
+ *
+ *  Enumeration of the priorities with which players share the forward buffer budget (see `RTSMediaPlayerBufferBudget`),
+ *  from the highest to the lowest one.
+ */
+typedef NS_ENUM(NSInteger, RTSMediaPlayerBufferPriority) {
+	/**
+	 *  The player is visible and can be heard
+	 */
+	RTSMediaPlayerBufferPriorityVisibleAudible,
+	/**
+	 *  The player is visible but muted (e.g. secondary player of a multi-view layout)
+	 */
+	RTSMediaPlayerBufferPriorityVisibleMuted,
+	/**
+	 *  The player is not visible (e.g. feed preview scrolled away, player underneath a modal)
+	 */
+	RTSMediaPlayerBufferPriorityHidden,
+	/**
+	 *  The player is paused
+	 */
+	RTSMediaPlayerBufferPriorityPaused,
+};
+
+/**
+ *  @enum RTSMediaBufferHealth
+ *
+ *  Enumeration of the possible buffer health levels, based on the duration which can be played from the buffer
+ *  without interruption.
+ */
+typedef NS_ENUM(NSInteger, RTSMediaBufferHealth) {
+	/**
+	 *  No media is being played
+	 */
+	RTSMediaBufferHealthUnknown,
+	/**
+	 *  Nothing is buffered ahead of the playhead. Playback stalls or is about to
+	 */
+	RTSMediaBufferHealthEmpty,
+	/**
+	 *  Less than `RTSMediaBufferHealthSufficientDuration` is buffered ahead of the playhead
+	 */
+	RTSMediaBufferHealthLow,
+	/**
+	 *  At least `RTSMediaBufferHealthSufficientDuration` is buffered ahead of the playhead, or the buffer reaches the end
+	 *  of the media
+	 */
+	RTSMediaBufferHealthSufficient,
+};
+
+/**
+ *  Buffered durations (in seconds) delimiting the buffer health levels
+ */
+FOUNDATION_EXTERN NSTimeInterval const RTSMediaBufferHealthEmptyDuration;
+FOUNDATION_EXTERN NSTimeInterval const RTSMediaBufferHealthSufficientDuration;
+
 /**
  *  -------------------------------------------
  *  @name Media player controller notifications
@@ -162,6 +225,61 @@ FOUNDATION_EXTERN NSString * const RTSMediaPlayerPreviousPlaybackStateUserInfoKe
 FOUNDATION_EXTERN NSString * const RTSMediaPlayerPlaybackDidFailNotification;				// Notification name
 FOUNDATION_EXTERN NSString * const RTSMediaPlayerPlaybackDidFailErrorUserInfoKey;			// Key to access the error information as an `NSError`
 
+/**
+ *  Posted when the buffer health level changes (use `RTSMediaPlayerPreviousBufferHealthUserInfoKey` to retrieve the
+ *  previous level from the notification `userInfo` dictionary)
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerBufferHealthDidChangeNotification;		// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerPreviousBufferHealthUserInfoKey;			// Key to access the previous buffer health as an `NSNumber` (wrapping an `RTSMediaBufferHealth` value)
+
+/**
+ *  Posted when the resources of a paused player have been reclaimed (see `idleReclamationDelay`). Use `RTSMediaPlayerReclaimedBytesUserInfoKey`
+ *  to retrieve the estimated amount of buffered media which has been released
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerDidReclaimResourcesNotification;			// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerReclaimedBytesUserInfoKey;				// Key to access the estimated number of released bytes as an `NSNumber`
+
+/**
+ *  Posted when playback of a player whose resources had been reclaimed has resumed. Use `RTSMediaPlayerResumeLatencyUserInfoKey`
+ *  to retrieve the time needed to rebuild the player
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerDidResumeReclaimedPlaybackNotification;	// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerResumeLatencyUserInfoKey;					// Key to access the delay between the resume request and playback, in seconds, as an `NSNumber`
+
+/**
+ *  Posted when a controller has taken over playback from another one (see `-takeOverPlaybackFromMediaPlayerController:`).
+ *  Use `RTSMediaPlayerHandoffDurationUserInfoKey` to retrieve the time needed for the handoff
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerDidTakeOverPlaybackNotification;			// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerHandoffDurationUserInfoKey;				// Key to access the handoff duration, in seconds, as an `NSNumber`
+
+/**
+ *  Posted each time an action is taken to recover from a stall (see `stallRecoverySteps`), and when playback has
+ *  recovered. Use `RTSMediaPlayerStallRecoveryActionUserInfoKey` to retrieve the action taken (the last one when
+ *  recovered), and `RTSMediaPlayerStallDurationUserInfoKey` to retrieve the time elapsed since playback stalled
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerStallRecoveryActionNotification;			// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerDidRecoverFromStallNotification;			// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerStallRecoveryActionUserInfoKey;			// Key to access the action as an `NSNumber` (wrapping an `RTSMediaPlayerStallRecoveryAction` value)
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerStallDurationUserInfoKey;					// Key to access the stall duration, in seconds, as an `NSNumber`
+
+/**
+ *  Posted when a blackout window starts and ends (see `blackoutWindows`). Use `RTSMediaPlayerBlackoutWindowUserInfoKey`
+ *  to retrieve the window, and `RTSMediaPlayerSlatePreBufferedUserInfoKey` to know whether the slate was already playing
+ *  when the window started
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerBlackoutDidStartNotification;				// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerBlackoutDidEndNotification;				// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerBlackoutWindowUserInfoKey;				// Key to access the `RTSMediaBlackoutWindow`
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerSlatePreBufferedUserInfoKey;				// Key to access an `NSNumber` wrapping a boolean, YES iff the slate was playing when the window started
+
+/**
+ *  Posted when the frame requested by `-stepByCount:` is available. Use `RTSMediaPlayerStepLatencyUserInfoKey` to retrieve
+ *  the time needed to step
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerDidStepNotification;						// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerStepLatencyUserInfoKey;					// Key to access the delay between the step request and the new frame, in seconds, as an `NSNumber`
+
 /**
  *  Posted when the overlay is shown or hidden
  */
@@ -11,4 +11,19 @@
 
 @property (nonatomic, weak) RTSMediaSegmentsController *segmentsController;
 
+/**
+ *  The bit rate of the variant currently played, as reported by the access log (0 if unknown)
+ */
+@property (nonatomic, readonly) double indicatedBitRate;
+
+/**
+ *  Estimation of the number of bytes currently buffered ahead of the playhead
+ */
+@property (nonatomic, readonly) unsigned long long estimatedBufferedBytes;
+
+/**
+ *  Called by the buffer budget to apply the forward buffer duration allocated to the player
+ */
+- (void)setAllocatedForwardBufferDuration:(NSTimeInterval)allocatedForwardBufferDuration;
+
 @end
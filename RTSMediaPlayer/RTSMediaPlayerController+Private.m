@@ -9,5 +9,7 @@
 @implementation RTSMediaPlayerController (Private)
 
 @dynamic segmentsController;
+@dynamic indicatedBitRate;
+@dynamic estimatedBufferedBytes;
 
 @end
@@ -8,8 +8,11 @@
 #import <AVFoundation/AVFoundation.h>
 #import <AVKit/AVKit.h>
 
+#import "RTSMediaBlackoutSchedule.h"
 #import "RTSMediaPlayerConstants.h"
 
+@class RTSMediaPlayerStallRecoveryStep;
+@class RTSMediaTimeRangeSet;
 @protocol RTSMediaPlayerControllerDataSource;
 
 /**
@@ -184,7 +187,7 @@
 - (void)playIdentifier:(NSString *)identifier;
 
 /**
- *  Pause
+ *  Pause. If the player is not ready yet, playback will not start automatically once it is
  */
 - (void)pause;
 
@@ -199,8 +202,19 @@
  */
 @property (nonatomic, getter=isMuted) BOOL muted;
 
+/**
+ *  The desired limit of network bandwidth consumption, in bits per second. The player selects the best variant below
+ *  this limit, if any. Set to 0 (the default) for no limit. Negative values are clamped to 0
+ */
+@property (nonatomic) double preferredPeakBitRate;
+
 /**
  *  Seek to specific time of the playback. The completion handler (if any) will be called when seeking ends
+ *
+ *  @discussion Commands (play, pause and seek) issued before the player is ready to play are queued and applied in a
+ *              single step when it becomes ready. The last seek wins, and a play followed by a pause (or conversely)
+ *              cancel each other out. Seeks which are superseded or discarded (e.g. by a reset) complete with `finished`
+ *              set to NO. Seeks are ignored while the player is idle, and complete with `finished` set to NO as well
  */
 - (void)seekToTime:(CMTime)time completionHandler:(void (^)(BOOL finished))completionHandler;
 
@@ -224,6 +238,190 @@
  */
 - (void)playIdentifier:(NSString *)identifier atTime:(CMTime)time;
 
+/**
+ *  -----------------------------------
+ *  @name Reclaiming resources when idle
+ *  -----------------------------------
+ */
+
+/**
+ *  The delay after which a paused player releases its resources (player, decoders, buffers, observers), in seconds. The
+ *  identifier, position, stream type and last displayed frame are kept, so that calling `play` transparently rebuilds
+ *  the player at the position where it was paused. Set to 0 (the default) to disable automatic reclamation
+ *
+ *  @discussion While its resources have been reclaimed, the controller stays in the paused state but has no `player`.
+ *              Its `streamType`, `mediaType` and `timeRange` are those of the stream when it was paused, until the
+ *              rebuilt player plays. Resources are never reclaimed during AirPlay or picture in picture playback
+ */
+@property (nonatomic) NSTimeInterval idleReclamationDelay;
+
+/**
+ *  Return YES iff the resources of the player have been reclaimed and will be rebuilt when playback is resumed
+ */
+@property (nonatomic, readonly, getter=isReclaimed) BOOL reclaimed;
+
+/**
+ *  Immediately reclaim the resources of a paused player (e.g. upon a memory warning). Does nothing if the player is not
+ *  paused. Calling `prepareToPlay` on a reclaimed player does nothing, call `play` to resume playback
+ */
+- (void)reclaimResources;
+
+/**
+ *  ----------------------------
+ *  @name Recovering from stalls
+ *  ----------------------------
+ */
+
+/**
+ *  The steps taken, in order, to recover when playback stalls (see `RTSMediaPlayerStallWatchdog`). Default is nil, in
+ *  which case the controller simply waits until enough media has been buffered for playback to resume
+ *
+ *  @discussion Bit rate caps remain applied until the controller is reset. Items are rebuilt at the current position,
+ *              the playback state going through the preparing and ready states. Alternative URLs are retrieved from
+ *              the data source, URL switching steps being skipped if it does not provide any. Each action taken is
+ *              notified with `RTSMediaPlayerStallRecoveryActionNotification`, the recovery itself with
+ *              `RTSMediaPlayerDidRecoverFromStallNotification`. Pausing or resetting the controller ends recovery
+ */
+@property (nonatomic, copy) NSArray<RTSMediaPlayerStallRecoveryStep *> *stallRecoverySteps;
+
+/**
+ *  ------------------
+ *  @name Blacking out
+ *  ------------------
+ */
+
+/**
+ *  Windows during which the media must not be shown, e.g. because of rights restrictions on live sports. During a
+ *  window, the media is hidden and muted, and the slate stream (see `slateURL`) is displayed instead. The media keeps
+ *  playing meanwhile, so that it is displayed again without any delay once the window ends. Default is nil
+ *
+ *  @discussion The slate starts playing, muted and hidden, `slatePreparationInterval` seconds before a window starts,
+ *              so that it is buffered when needed. Pictures and sounds are swapped in a single frame when the date of
+ *              `blackoutClock` reaches a window edge. Windows are only evaluated while a media is loaded. The start and
+ *              end of each window are notified with `RTSMediaPlayerBlackoutDidStartNotification` and `RTSMediaPlayerBlackoutDidEndNotification`
+ */
+@property (nonatomic, copy) NSArray<RTSMediaBlackoutWindow *> *blackoutWindows;
+
+/**
+ *  The clock against which blackout windows are evaluated. Default is `RTSMediaBlackoutClockWallClock`
+ */
+@property (nonatomic) RTSMediaBlackoutClock blackoutClock;
+
+/**
+ *  The URL of the stream displayed during blackout windows (preferably a live stream, or an on-demand stream longer
+ *  than the windows). If nil, nothing is displayed during windows. Default is nil
+ */
+@property (nonatomic) NSURL *slateURL;
+
+/**
+ *  The time before a blackout window starts at which the slate starts buffering, in seconds. Default is 10 seconds
+ */
+@property (nonatomic) NSTimeInterval slatePreparationInterval;
+
+/**
+ *  Return YES iff a blackout window is in progress
+ */
+@property (nonatomic, readonly, getter=isBlackedOut) BOOL blackedOut;
+
+/**
+ *  ------------------
+ *  @name Timeshifting
+ *  ------------------
+ */
+
+/**
+ *  The depth of the local timeshift buffer, in seconds. Live streams without DVR window are recorded while they are
+ *  played, and behave as DVR streams whose window grows up to this depth: they can be paused, sought backwards, and
+ *  played live again by seeking to the end of `timeRange`. Set to 0 (the default) to disable timeshifting
+ *
+ *  @discussion Recording continues while playback is paused, until the controller is reset. Only the variant playback
+ *              starts with is recorded, and the playlist rewriter is not used. Streams which are not live, or whose own
+ *              window is at least as long as the depth, are played as is. Changes are taken into account the next time
+ *              a media is loaded. See `RTSMediaTimeshiftRecorder`
+ */
+@property (nonatomic) NSTimeInterval timeshiftDepth;
+
+/**
+ *  The size of the file in which live streams are recorded, in bytes. Once the file is full, the oldest segments are
+ *  evicted even if the depth has not been reached. Default is 64 MB
+ */
+@property (nonatomic) NSUInteger timeshiftByteCapacity;
+
+/**
+ *  Return YES iff the current media is being recorded for timeshifting
+ */
+@property (nonatomic, readonly, getter=isTimeshifting) BOOL timeshifting;
+
+/**
+ *  -----------------------------
+ *  @name Stepping and trick play
+ *  -----------------------------
+ */
+
+/**
+ *  Pause playback and move the specified number of frames forward (positive count) or backward (negative count).
+ *  `RTSMediaPlayerDidStepNotification` is posted when the new frame is available
+ *
+ *  @discussion Frames are decoded by the player item when it can step in the requested direction. Otherwise the
+ *              position is moved by the video frame duration with exact seeks, which are coalesced: steps requested
+ *              while a seek is in progress only move its target, and a single seek is made once it completes
+ */
+- (void)stepByCount:(NSInteger)stepCount;
+
+/**
+ *  Return YES iff the current media can be played fast forward (rates greater than 2) or fast in reverse (rates lower
+ *  than -1) by the player. This is usually the case for files and for HTTP live streams providing I-frame playlists
+ */
+@property (nonatomic, readonly) BOOL canPlayFastForward;
+@property (nonatomic, readonly) BOOL canPlayFastReverse;
+
+/**
+ *  Play at the specified rate, negative rates playing in reverse. The player enters the `RTSMediaPlaybackStateTrickPlaying`
+ *  state, left when calling `-play`, `-pause`, `-stepByCount:` or when seeking (playback then resumes at the normal rate).
+ *  A rate of 1 is equivalent to `-play`, a rate of 0 to `-pause`. Does nothing if the media is not ready to play
+ *
+ *  @discussion Rates the player cannot play at (e.g. fast rates for streams without I-frame playlists) are emulated with
+ *              tolerant seeks, made one after the other and targeting the position which would have been reached at
+ *              the requested rate, at most every 0.25 seconds
+ */
+- (void)playAtRate:(float)rate;
+
+/**
+ *  The rate requested with `-playAtRate:` while trick playing, 0 otherwise
+ */
+@property (nonatomic, readonly) float trickPlayRate;
+
+/**
+ *  ---------------------------
+ *  @name Handing playback over
+ *  ---------------------------
+ */
+
+/**
+ *  Take over playback from another controller (e.g. when moving from an inline player to a full screen one), without
+ *  interrupting it. The player and its item, the periodic, boundary and time range observers, as well as the segments
+ *  controller, are transferred to the receiver, which adopts the identifier and the playback state of the other
+ *  controller. Observer identifiers remain valid and must be removed from the receiver afterwards. The player is displayed
+ *  in the view of the receiver before being removed from the view of the other controller, which is reset
+ *
+ *  Playback settings are adopted from the other controller and applied to the player: muting, peak bit rate, buffer
+ *  budget and priority, playlist rewriter, precache, timeshifting, watched range tracker, caption indexing (with the
+ *  index built so far), stall recovery steps and blackout windows. Commands not applied yet are transferred as well.
+ *  The receiver only keeps its external playback settings, which depend on where it is displayed. Trick play is not
+ *  handed over, and a stall or blackout window in progress is entered again by the receiver. The receiver is reset
+ *  before the handoff if it was playing another media. No media is loaded again
+ *
+ *  @param mediaPlayerController The controller to take playback over from
+ *
+ *  @return YES iff the handoff could be made. It fails if the other controller has no player (idle, preparing or
+ *          reclaimed) or is in picture in picture, in which case both controllers are left unchanged
+ *
+ *  @discussion Playback state changes leading to the state of the other controller are notified by the receiver, as
+ *              if the media had been loaded instantaneously. `RTSMediaPlayerDidTakeOverPlaybackNotification` is posted
+ *              when the handoff is complete
+ */
+- (BOOL)takeOverPlaybackFromMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController;
+
 /**
  *  ------------------------------------
  *  @name Accessing playback information
@@ -277,6 +475,33 @@
  */
 @property (nonatomic) NSTimeInterval liveTolerance;
 
+/**
+ *  -------------------
+ *  @name Buffer health
+ *  -------------------
+ */
+
+/**
+ *  The parts of the media currently loaded in the buffer. Unlike `playerItem.loadedTimeRanges`, the set is maintained as
+ *  buffering progresses and is cheap to read
+ */
+@property (nonatomic, readonly, copy) RTSMediaTimeRangeSet *loadedTimeRangeSet;
+
+/**
+ *  The duration which can be played from the buffer without interruption, from the current playhead position (in seconds)
+ */
+@property (nonatomic, readonly) NSTimeInterval bufferedAheadDuration;
+
+/**
+ *  The duration available in the buffer before the current playhead position, without interruption (in seconds)
+ */
+@property (nonatomic, readonly) NSTimeInterval bufferedBehindDuration;
+
+/**
+ *  The current buffer health level. Changes are notified with `RTSMediaPlayerBufferHealthDidChangeNotification`
+ */
+@property (nonatomic, readonly) RTSMediaBufferHealth bufferHealth;
+
 /**
  *  --------------------
  *  @name Time observers
@@ -307,6 +532,47 @@
  */
 - (void)removePeriodicTimeObserver:(id)observer;
 
+/**
+ *  Register a block to be called when playback crosses one of the specified times (e.g. quartiles, ad markers or chapter
+ *  edges). Times are not reported when they are skipped over by a seek. Unlike usual `AVPlayer` boundary time observers,
+ *  such observers survive player changes and can be registered before the player is available
+ *
+ *  @param times The times to observe, as `NSValue`s wrapping `CMTime`s
+ *  @param queue The serial queue onto which block should be enqueued (main queue if NULL)
+ *  @param block The block to be executed, receiving the time which has been crossed
+ *
+ *  @return The time observer, nil if no valid time was provided. The observer is retained by the media player controller,
+ *          remove it with `-removeBoundaryTimeObserver:`
+ */
+- (id)addBoundaryTimeObserverForTimes:(NSArray<NSValue *> *)times queue:(dispatch_queue_t)queue usingBlock:(void (^)(CMTime time))block;
+
+/**
+ *  Register blocks to be called when the playhead enters or exits a time range, whether during playback or after a seek.
+ *  The time range does not include its end time. When the player is reset, exit blocks of ranges the playhead was in
+ *  are called with an invalid time
+ *
+ *  @param timeRange  The time range to observe
+ *  @param queue      The serial queue onto which blocks should be enqueued (main queue if NULL)
+ *  @param enterBlock The block to be executed when entering the range (optional)
+ *  @param exitBlock  The block to be executed when exiting the range (optional)
+ *
+ *  @discussion Blocks receive the time of the range edge which has been crossed, or the playhead time after a seek
+ *
+ *  @return The time observer, nil if the time range is invalid or empty. The observer is retained by the media player
+ *          controller, remove it with `-removeBoundaryTimeObserver:`
+ */
+- (id)addTimeRangeObserverForTimeRange:(CMTimeRange)timeRange
+								 queue:(dispatch_queue_t)queue
+							enterBlock:(void (^)(CMTime time))enterBlock
+							 exitBlock:(void (^)(CMTime time))exitBlock;
+
+/**
+ *  Remove a boundary or time range observer (does nothing if the observer is not registered). No exit block is called
+ *
+ *  @param observer The time observer to remove
+ */
+- (void)removeBoundaryTimeObserver:(id)observer;
+
 /**
  *  -------------
  *  @name Airplay
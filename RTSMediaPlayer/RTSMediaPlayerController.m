@@ -9,10 +9,25 @@
 #import <libextobjc/EXTScope.h>
 
 #import "RTSMediaPlayerController.h"
+#import "RTSMediaPlayerController+Private.h"
 #import "RTSMediaPlayerControllerDataSource.h"
+#import "RTSMediaBlackoutSchedule.h"
+#import "RTSMediaCaptionIndex.h"
+#import "RTSMediaPlayerBufferBudget.h"
+#import "RTSMediaPlayerBufferBudget+Private.h"
+#import "RTSMediaPlayerCommandQueue.h"
+#import "RTSMediaPlayerStallWatchdog.h"
+#import "RTSMediaPrecache.h"
+#import "RTSMediaPlaylistRewriter.h"
 #import "RTSMediaSegmentsController.h"
+#import "RTSMediaSegmentsController+Private.h"
+#import "RTSMediaTimeRangeSet.h"
+#import "RTSMediaTimeSchedule.h"
+#import "RTSMediaTimeshiftRecorder.h"
+#import "RTSMediaWatchedRangeTracker.h"
 
 #import "RTSMediaPlayerError.h"
+#import "RTSMediaPlayerObservationProxy.h"
 #import "RTSMediaPlayerView.h"
 #import "RTSPeriodicTimeObserver.h"
 #import "RTSActivityGestureRecognizer.h"
@@ -26,10 +41,36 @@ static const void * const RTSMediaPlayerPictureInPictureActiveContext = &RTSMedi
 NSTimeInterval const RTSMediaPlayerOverlayHidingDelay = 5.0;
 NSTimeInterval const RTSMediaLiveDefaultTolerance = 30.0;		// same tolerance as built-in iOS player
 
+NSTimeInterval const RTSMediaBufferHealthEmptyDuration = 0.5;
+NSTimeInterval const RTSMediaBufferHealthSufficientDuration = 5.0;
+
+// Caption cues still displayed after a seek or a stall are considered to have ended at most after this duration
+static const NSTimeInterval RTSMediaCaptionMaximumCueDuration = 10.;
+
+// Playhead positions further apart than what playback covered since the previous one (plus this margin) are discontinuities
+static const NSTimeInterval RTSMediaWatchedRangeTolerance = 0.5;
+
+// Boundary times reached slightly before the current time is reported are still considered crossed
+static const NSTimeInterval RTSMediaBoundaryTimeTolerance = 0.1;
+
+// Trick play emulated with seeks displays at most one frame per interval, and the frame duration assumed when the video
+// frame rate is unknown
+static const NSTimeInterval RTSMediaTrickPlaySeekInterval = 0.25;
+static const int32_t RTSMediaDefaultFrameRate = 25;
+
 NSString * const RTSMediaPlayerErrorDomain = @"RTSMediaPlayerErrorDomain";
 
 NSString * const RTSMediaPlayerPlaybackStateDidChangeNotification = @"RTSMediaPlayerPlaybackStateDidChange";
 NSString * const RTSMediaPlayerPlaybackDidFailNotification = @"RTSMediaPlayerPlaybackDidFail";
+NSString * const RTSMediaPlayerBufferHealthDidChangeNotification = @"RTSMediaPlayerBufferHealthDidChange";
+NSString * const RTSMediaPlayerDidReclaimResourcesNotification = @"RTSMediaPlayerDidReclaimResources";
+NSString * const RTSMediaPlayerDidResumeReclaimedPlaybackNotification = @"RTSMediaPlayerDidResumeReclaimedPlayback";
+NSString * const RTSMediaPlayerDidTakeOverPlaybackNotification = @"RTSMediaPlayerDidTakeOverPlayback";
+NSString * const RTSMediaPlayerStallRecoveryActionNotification = @"RTSMediaPlayerStallRecoveryAction";
+NSString * const RTSMediaPlayerDidRecoverFromStallNotification = @"RTSMediaPlayerDidRecoverFromStall";
+NSString * const RTSMediaPlayerBlackoutDidStartNotification = @"RTSMediaPlayerBlackoutDidStart";
+NSString * const RTSMediaPlayerBlackoutDidEndNotification = @"RTSMediaPlayerBlackoutDidEnd";
+NSString * const RTSMediaPlayerDidStepNotification = @"RTSMediaPlayerDidStep";
 
 NSString * const RTSMediaPlayerPictureInPictureStateChangeNotification = @"RTSMediaPlayerPictureInPictureStateChangeNotification";
 
@@ -42,10 +83,20 @@ NSString * const RTSMediaPlayerPlaybackDidFailErrorUserInfoKey = @"Error";
 
 NSString * const RTSMediaPlayerPreviousPlaybackStateUserInfoKey = @"PreviousPlaybackState";
 
+NSString * const RTSMediaPlayerPreviousBufferHealthUserInfoKey = @"PreviousBufferHealth";
+NSString * const RTSMediaPlayerReclaimedBytesUserInfoKey = @"ReclaimedBytes";
+NSString * const RTSMediaPlayerResumeLatencyUserInfoKey = @"ResumeLatency";
+NSString * const RTSMediaPlayerHandoffDurationUserInfoKey = @"HandoffDuration";
+NSString * const RTSMediaPlayerStallRecoveryActionUserInfoKey = @"StallRecoveryAction";
+NSString * const RTSMediaPlayerStallDurationUserInfoKey = @"StallDuration";
+NSString * const RTSMediaPlayerBlackoutWindowUserInfoKey = @"BlackoutWindow";
+NSString * const RTSMediaPlayerSlatePreBufferedUserInfoKey = @"SlatePreBuffered";
+NSString * const RTSMediaPlayerStepLatencyUserInfoKey = @"StepLatency";
+
 NSString * const RTSMediaPlayerStateMachineContentURLInfoKey = @"ContentURL";
 NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"BlockingReason";
 
-@interface RTSMediaPlayerController () <RTSMediaPlayerControllerDataSource, UIGestureRecognizerDelegate>
+@interface RTSMediaPlayerController () <AVPlayerItemLegibleOutputPushDelegate, RTSMediaBlackoutScheduleDelegate, RTSMediaPlayerControllerDataSource, RTSMediaPlayerStallWatchdogDelegate, UIGestureRecognizerDelegate>
 
 @property (readwrite, copy) NSString *identifier;
 
@@ -58,6 +109,7 @@ NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"Bloc
 @property (readwrite) TKState *seekingState;
 @property (readwrite) TKState *stalledState;
 @property (readwrite) TKState *endedState;
+@property (readwrite) TKState *trickPlayingState;
 
 @property (readwrite) TKEvent *loadEvent;
 @property (readwrite) TKEvent *loadSuccessEvent;
@@ -68,15 +120,20 @@ NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"Bloc
 @property (readwrite) TKEvent *stopEvent;
 @property (readwrite) TKEvent *stallEvent;
 @property (readwrite) TKEvent *resetEvent;
+@property (readwrite) TKEvent *trickPlayEvent;
 
 @property (readwrite) RTSMediaPlaybackState playbackState;
 @property (readwrite) AVPlayer *player;
 @property (readwrite) id periodicTimeObserver;
+@property (readwrite) RTSMediaPlayerObservationProxy *observationProxy;
 @property (readwrite) id playbackStartObserver;
 @property (readwrite) CMTime previousPlaybackTime;
 @property (readwrite) NSValue *startTimeValue;
+@property (readwrite) BOOL startTimeApplied;
 
 @property (readwrite) NSMutableDictionary *periodicTimeObservers;
+@property (readwrite) RTSMediaTimeSchedule *timeSchedule;
+@property (readwrite) NSArray *timeScheduleObservers;
 
 @property (readonly) RTSMediaPlayerView *playerView;
 @property (readonly) RTSActivityGestureRecognizer *activityGestureRecognizer;
@@ -88,11 +145,74 @@ NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"Bloc
 @property (nonatomic) AVPictureInPictureController *pictureInPictureController;
 
 @property (nonatomic, weak) RTSMediaSegmentsController *segmentsController;
+@property (nonatomic) NSMutableDictionary<NSString *, NSArray<NSValue *> *> *removedTimeRangesByPlaylist;
+@property (nonatomic) NSString *playedPlaylist;
 
 @property (nonatomic) id contentURLRequestHandle;
+@property (nonatomic) NSURL *contentURL;
 
 @property (nonatomic, assign) BOOL playScheduled;
 @property (nonatomic, assign) BOOL pauseScheduled;
+@property (nonatomic) RTSMediaPlayerCommandQueue *commandQueue;
+@property (nonatomic, readonly, getter=isReadyForCommands) BOOL readyForCommands;
+
+@property (nonatomic) RTSMediaPlayerBufferPriority bufferPriority;
+@property (nonatomic) RTSMediaPlayerBufferBudget *bufferBudget;
+@property (nonatomic) NSTimeInterval allocatedForwardBufferDuration;
+@property (nonatomic) double indicatedBitRate;
+@property (nonatomic) RTSMediaPlaylistRewriter *playlistRewriter;
+@property (nonatomic) RTSMediaPrecache *precache;
+@property (nonatomic) RTSMediaWatchedRangeTracker *watchedRangeTracker;
+@property (nonatomic) NSTimeInterval watchedTime;
+@property (nonatomic) CFTimeInterval watchedUpdateTime;
+
+@property (nonatomic, getter=isCaptionIndexingEnabled) BOOL captionIndexingEnabled;
+@property (nonatomic) RTSMediaCaptionIndex *captionIndex;
+@property (nonatomic) AVPlayerItemLegibleOutput *legibleOutput;
+@property (nonatomic, weak) AVPlayerItem *legibleOutputPlayerItem;
+@property (nonatomic, copy) NSString *pendingCueText;
+@property (nonatomic) NSTimeInterval pendingCueStartTime;
+
+@property (nonatomic) RTSMediaTimeRangeSet *trackedTimeRangeSet;
+@property (nonatomic) RTSMediaBufferHealth bufferHealth;
+
+@property (readonly) dispatch_source_t reclamationTimer;
+@property (nonatomic, getter=isReclaimed) BOOL reclaimed;
+@property (nonatomic) NSValue *reclaimedTimeValue;
+@property (nonatomic) NSNumber *reclaimedLiveOffset;
+@property (nonatomic) NSValue *reclaimedTimeRangeValue;
+@property (nonatomic) RTSMediaStreamType reclaimedStreamType;
+@property (nonatomic) RTSMediaType reclaimedMediaType;
+@property (nonatomic) NSNumber *startLiveOffset;
+@property (nonatomic) UIView *posterView;
+@property (nonatomic) CFTimeInterval resumeStartTime;
+@property (nonatomic) AVPlayer *handoffPlayer;
+@property (nonatomic) BOOL playerHandedOver;								// The player is released without being stopped
+
+@property (nonatomic) RTSMediaPlayerStallWatchdog *stallWatchdog;
+@property (nonatomic) double stallPeakBitRate;
+@property (nonatomic) NSURL *rebuildContentURL;
+@property (nonatomic, getter=isRebuildingPlayer) BOOL rebuildingPlayer;
+
+@property (nonatomic) RTSMediaBlackoutSchedule *blackoutSchedule;
+@property (nonatomic, getter=isBlackedOut) BOOL blackedOut;
+@property (nonatomic) RTSMediaPlayerController *slateMediaPlayerController;
+@property (nonatomic) UIView *blackoutView;
+@property (nonatomic) NSDate *blackoutTriggerDate;
+@property (nonatomic) id blackoutBoundaryObserver;
+@property (readonly) dispatch_source_t blackoutTimer;
+
+@property (nonatomic) RTSMediaTimeshiftRecorder *timeshiftRecorder;
+
+@property (nonatomic) float trickPlayRate;
+@property (nonatomic, getter=isTrickPlayEmulated) BOOL trickPlayEmulated;
+@property (nonatomic) CMTime trickPlayStartTime;
+@property (nonatomic) CFTimeInterval trickPlayStartMediaTime;
+@property (nonatomic, getter=isTrickPlaySeeking) BOOL trickPlaySeeking;
+@property (nonatomic) CMTime stepTargetTime;								// Valid while stepping with seeks
+@property (nonatomic, getter=isStepSeeking) BOOL stepSeeking;
+@property (nonatomic) CMTime stepStartTime;
+@property (nonatomic) CFTimeInterval stepStartMediaTime;					// 0 if no step is pending
 
 @end
 
@@ -107,6 +227,8 @@ NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"Bloc
 @synthesize playbackState = _playbackState;
 @synthesize stateMachine = _stateMachine;
 @synthesize idleTimer = _idleTimer;
+@synthesize reclamationTimer = _reclamationTimer;
+@synthesize blackoutTimer = _blackoutTimer;
 @synthesize identifier = _identifier;
 @synthesize muted = _muted;
 @synthesize allowsExternalPlayback = _allowsExternalPlayback;
@@ -135,9 +257,19 @@ NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"Bloc
 	_overlaysVisible = YES;		// The player always open with visible overlays
 	_allowsExternalPlayback = YES;
 	_usesExternalPlaybackWhileExternalScreenIsActive = NO;
+	_bufferPriority = RTSMediaPlayerBufferPriorityVisibleAudible;
+	_timeshiftByteCapacity = 64 * 1024 * 1024;
 	
+	self.bufferBudget = [RTSMediaPlayerBufferBudget sharedBufferBudget];
 	self.overlayViewsHidingDelay = RTSMediaPlayerOverlayHidingDelay;
 	self.periodicTimeObservers = [NSMutableDictionary dictionary];
+	self.timeSchedule = [RTSMediaTimeSchedule new];
+	self.trackedTimeRangeSet = [RTSMediaTimeRangeSet new];
+	self.commandQueue = [RTSMediaPlayerCommandQueue new];
+	self.watchedTime = NAN;
+	self.stepTargetTime = kCMTimeInvalid;
+	self.blackoutSchedule = [RTSMediaBlackoutSchedule new];
+	self.blackoutSchedule.delegate = self;
 	
 	[self.stateMachine activate];
 
@@ -156,7 +288,13 @@ NSString * const RTSMediaPlayerPlaybackSeekingUponBlockingReasonInfoKey = @"Bloc
 	[_view removeFromSuperview];
 	[_activityView removeGestureRecognizer:_activityGestureRecognizer];
 	
+	[_bufferBudget removeMediaPlayerController:self];
+	
 	self.player = nil;
+	
+	if (_blackoutTimer) {
+		dispatch_source_cancel(_blackoutTimer);
+	}
 }
 
 #pragma mark - RTSMediaPlayerControllerDataSource
@@ -211,30 +349,33 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	TKState *paused = [TKState stateWithName:@"Paused"];
 	TKState *stalled = [TKState stateWithName:@"Stalled"];
 	TKState *ended = [TKState stateWithName:@"Ended"];
-	[stateMachine addStates:@[ idle, preparing, ready, playing, seeking, paused, stalled, ended ]];
+	TKState *trickPlaying = [TKState stateWithName:@"Trick Playing"];
+	[stateMachine addStates:@[ idle, preparing, ready, playing, seeking, paused, stalled, ended, trickPlaying ]];
 	stateMachine.initialState = idle;
 	
 	TKEvent *load = [TKEvent eventWithName:@"Load" transitioningFromStates:@[ idle ] toState:preparing];
 	TKEvent *loadSuccess = [TKEvent eventWithName:@"Load Success" transitioningFromStates:@[ preparing ] toState:ready];
-	TKEvent *play = [TKEvent eventWithName:@"Play" transitioningFromStates:@[ ready, paused, stalled, ended, seeking ] toState:playing];
-	TKEvent *seek = [TKEvent eventWithName:@"Seek" transitioningFromStates:@[ ready, paused, stalled, ended, playing ] toState:seeking]; // Including 'Stalled"?
-	TKEvent *pause = [TKEvent eventWithName:@"Pause" transitioningFromStates:@[ ready, playing, seeking ] toState:paused];
-	TKEvent *end = [TKEvent eventWithName:@"End" transitioningFromStates:@[ playing ] toState:ended];
+	TKEvent *play = [TKEvent eventWithName:@"Play" transitioningFromStates:@[ ready, paused, stalled, ended, seeking, trickPlaying ] toState:playing];
+	TKEvent *seek = [TKEvent eventWithName:@"Seek" transitioningFromStates:@[ ready, paused, stalled, ended, playing, trickPlaying ] toState:seeking]; // Including 'Stalled"?
+	TKEvent *pause = [TKEvent eventWithName:@"Pause" transitioningFromStates:@[ ready, playing, seeking, trickPlaying ] toState:paused];
+	TKEvent *end = [TKEvent eventWithName:@"End" transitioningFromStates:@[ playing, trickPlaying ] toState:ended];
 	TKEvent *stall = [TKEvent eventWithName:@"Stall" transitioningFromStates:@[ playing ] toState:stalled];
+	TKEvent *trickPlay = [TKEvent eventWithName:@"Trick Play" transitioningFromStates:@[ ready, paused, stalled, ended, seeking, playing ] toState:trickPlaying];
     NSMutableSet *allStatesButIdle = [NSMutableSet setWithSet:stateMachine.states];
     [allStatesButIdle removeObject:idle];
     TKEvent *reset = [TKEvent eventWithName:@"Reset" transitioningFromStates:[allStatesButIdle allObjects] toState:idle];
 	
-	[stateMachine addEvents:@[ load, loadSuccess, play, seek, pause, end, stall, reset ]];
+	[stateMachine addEvents:@[ load, loadSuccess, play, seek, pause, end, stall, reset, trickPlay ]];
 	
-	NSDictionary *states = @{ idle.name:      @(RTSMediaPlaybackStateIdle),
-							  preparing.name: @(RTSMediaPlaybackStatePreparing),
-							  ready.name:     @(RTSMediaPlaybackStateReady),
-							  playing.name:   @(RTSMediaPlaybackStatePlaying),
-							  seeking.name:   @(RTSMediaPlaybackStateSeeking),
-							  paused.name:    @(RTSMediaPlaybackStatePaused),
-							  stalled.name:   @(RTSMediaPlaybackStateStalled),
-							  ended.name:     @(RTSMediaPlaybackStateEnded) };
+	NSDictionary *states = @{ idle.name:         @(RTSMediaPlaybackStateIdle),
+							  preparing.name:    @(RTSMediaPlaybackStatePreparing),
+							  ready.name:        @(RTSMediaPlaybackStateReady),
+							  playing.name:      @(RTSMediaPlaybackStatePlaying),
+							  seeking.name:      @(RTSMediaPlaybackStateSeeking),
+							  paused.name:       @(RTSMediaPlaybackStatePaused),
+							  stalled.name:      @(RTSMediaPlaybackStateStalled),
+							  ended.name:        @(RTSMediaPlaybackStateEnded),
+							  trickPlaying.name: @(RTSMediaPlaybackStateTrickPlaying) };
 	
 	NSCAssert(states.allKeys.count == stateMachine.states.count, @"Must handle all states");
 	
@@ -248,6 +389,20 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 																					 TKTransition *t = notification.userInfo[TKStateMachineDidChangeStateTransitionUserInfoKey];
 																					 RTSMediaPlayerLogDebug(@"(%@) ---[%@]---> (%@)", t.sourceState.name, t.event.name.lowercaseString, t.destinationState.name);
 																					 NSInteger newPlaybackState = [states[t.destinationState.name] integerValue];
+																					 
+																					 // A reclaimed player remains paused until it is rebuilt
+																					 if (self.reclaimed && newPlaybackState == RTSMediaPlaybackStateIdle) {
+																						 return;
+																					 }
+																					 
+																					 // A player rebuilt to recover from a stall keeps its playback state until the new player is ready
+																					 if (self.rebuildingPlayer) {
+																						 if (newPlaybackState == RTSMediaPlaybackStateIdle || newPlaybackState == RTSMediaPlaybackStatePreparing
+																								 || newPlaybackState == RTSMediaPlaybackStateReady) {
+																							 return;
+																						 }
+																						 self.rebuildingPlayer = NO;
+																					 }
 																					 self.playbackState = newPlaybackState;
 																				 }];
 	
@@ -260,6 +415,29 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
     
 	[preparing setDidEnterStateBlock:^(TKState *state, TKTransition *transition) {
 		@strongify(self)
+		
+		// The player of another controller is adopted as is, see `-takeOverPlaybackFromMediaPlayerController:`
+		if (self.handoffPlayer) {
+			[self fireEvent:self.loadSuccessEvent userInfo:nil];
+			return;
+		}
+		
+		// Players rebuilt to recover from a stall do not request a URL again, see `-rebuildPlayerWithContentURL:`
+		if (self.rebuildContentURL) {
+			NSURL *contentURL = self.rebuildContentURL;
+			self.rebuildContentURL = nil;
+			[self fireEvent:self.loadSuccessEvent userInfo:@{ RTSMediaPlayerStateMachineContentURLInfoKey : contentURL }];
+			return;
+		}
+		
+		// Identifiers precached in advance do not request a URL either, see `RTSMediaPrecache`
+		NSURL *precachedContentURL = [self.precache contentURLForIdentifier:self.identifier];
+		if (precachedContentURL) {
+			RTSMediaPlayerLogDebug(@"Content URL of %@ available from the precache", self.identifier);
+			[self fireEvent:self.loadSuccessEvent userInfo:@{ RTSMediaPlayerStateMachineContentURLInfoKey : precachedContentURL }];
+			return;
+		}
+		
 		if (!self.dataSource) {
 			@throw [NSException exceptionWithName:NSInternalInconsistencyException
 										   reason:@"RTSMediaPlayerController dataSource can not be nil."
@@ -287,12 +465,30 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	[ready setWillEnterStateBlock:^(TKState *state, TKTransition *transition) {
 		@strongify(self)
 		
-		NSURL *contentURL = transition.userInfo[RTSMediaPlayerStateMachineContentURLInfoKey];
-		RTSMediaPlayerLogInfo(@"Player URL: %@", contentURL);
+		if (self.handoffPlayer) {
+			self.player = self.handoffPlayer;
+			self.handoffPlayer = nil;
+		}
+		else {
+			NSURL *contentURL = transition.userInfo[RTSMediaPlayerStateMachineContentURLInfoKey];
+			RTSMediaPlayerLogInfo(@"Player URL: %@", contentURL);
+			self.contentURL = contentURL;
+			
+			// Position the item before it is attached to the player, so that buffering starts at the requested time instead of
+			// at the beginning of the media. DVR positions relative to the live edge can only be resolved once the item is ready
+			AVPlayerItem *playerItem = [self playerItemWithURL:contentURL];
+			CMTime startTime = self.startTimeValue ? [self.startTimeValue CMTimeValue] : kCMTimeInvalid;
+			if (!self.startLiveOffset && CMTIME_IS_NUMERIC(startTime) && CMTIME_COMPARE_INLINE(startTime, >, kCMTimeZero)) {
+				RTSMediaPlayerLogDebug(@"Starting at %.2f sec. before buffering", CMTimeGetSeconds(startTime));
+				[playerItem seekToTime:startTime toleranceBefore:kCMTimeZero toleranceAfter:kCMTimeZero];
+				self.startTimeApplied = YES;
+			}
+			
+			// The player observes its "currentItem.status" keyPath, see callback in `observeValueForKeyPath:ofObject:change:context:`
+			self.player = [AVPlayer playerWithPlayerItem:playerItem];
+		}
 		
-		// The player observes its "currentItem.status" keyPath, see callback in `observeValueForKeyPath:ofObject:change:context:`
-		self.player = [AVPlayer playerWithURL:contentURL];
-		self.player.muted = _muted;
+		self.player.muted = _muted || self.blackedOut;
 		self.player.allowsExternalPlayback = _allowsExternalPlayback;
 		self.player.usesExternalPlaybackWhileExternalScreenIsActive = _usesExternalPlaybackWhileExternalScreenIsActive;
 		self.player.actionAtItemEnd = AVPlayerActionAtItemEndNone;
@@ -314,6 +510,26 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	[playing setDidEnterStateBlock:^(TKState *state, TKTransition *transition) {
 		@strongify(self)
 		[self resetIdleTimer];
+		
+		// Playback may start without any time jump being reported
+		[self.timeSchedule playToTime:self.player.currentTime];
+		
+		if (self.resumeStartTime != 0.) {
+			NSTimeInterval resumeLatency = CACurrentMediaTime() - self.resumeStartTime;
+			self.resumeStartTime = 0.;
+			[self removePosterView];
+			[self clearReclaimedStreamShape];
+			
+			RTSMediaPlayerLogInfo(@"Reclaimed playback resumed in %.3f sec.", resumeLatency);
+			[self postNotificationName:RTSMediaPlayerDidResumeReclaimedPlaybackNotification userInfo:@{ RTSMediaPlayerResumeLatencyUserInfoKey : @(resumeLatency) }];
+		}
+		
+		[self.stallWatchdog stallDidEnd];
+	}];
+	
+	[stalled setDidEnterStateBlock:^(TKState *state, TKTransition *transition) {
+		@strongify(self)
+		[self.stallWatchdog stallDidStart];
 	}];
 	
 	[playing setWillExitStateBlock:^(TKState *state, TKTransition *transition) {
@@ -321,10 +537,30 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 		[self registerPlaybackStartBoundaryObserver];
 	}];
 	
+	[paused setDidEnterStateBlock:^(TKState *state, TKTransition *transition) {
+		@strongify(self)
+		[self scheduleResourceReclamation];
+	}];
+	
+	[paused setWillExitStateBlock:^(TKState *state, TKTransition *transition) {
+		@strongify(self)
+		[self cancelResourceReclamation];
+	}];
+	
+	// Emulation seeks stop by themselves once trick play has been left, see `-seekForTrickPlay`
+	[trickPlaying setWillExitStateBlock:^(TKState *state, TKTransition *transition) {
+		@strongify(self)
+		self.trickPlayRate = 0.f;
+		self.trickPlayEmulated = NO;
+	}];
+	
 	[reset setWillFireEventBlock:^(TKEvent *event, TKTransition *transition) {
 		@strongify(self)
 		NSDictionary *errorUserInfo = transition.userInfo;
 		if (errorUserInfo) {
+			[self.stallWatchdog cancel];
+			self.rebuildingPlayer = NO;
+			
 			RTSMediaPlayerLogError(@"Playback did fail: %@", errorUserInfo[RTSMediaPlayerPlaybackDidFailErrorUserInfoKey]);
 			[self postNotificationName:RTSMediaPlayerPlaybackDidFailNotification userInfo:errorUserInfo];
 		}
@@ -337,6 +573,23 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 		self.previousPlaybackTime = kCMTimeInvalid;
 		self.playerView.player = nil;
 		self.player = nil;
+		
+		self.startLiveOffset = nil;
+		self.startTimeApplied = NO;
+		self.resumeStartTime = 0.;
+		[self removePosterView];
+		
+		// Seeks made by the released player might never complete
+		self.trickPlaySeeking = NO;
+		self.stepSeeking = NO;
+		self.stepTargetTime = kCMTimeInvalid;
+		self.stepStartMediaTime = 0.;
+		
+		// Leave observed time ranges, except when the player is only rebuilt later at the same position
+		if (!self.reclaimed) {
+			[self.timeSchedule jumpToTime:kCMTimeInvalid];
+			[self clearReclaimedStreamShape];
+		}
 	}];
 	
 	self.idleState = idle;
@@ -346,6 +599,7 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	self.stalledState = stalled;
 	self.seekingState = seeking;
 	self.endedState = ended;
+	self.trickPlayingState = trickPlaying;
 	
 	self.loadEvent = load;
 	self.loadSuccessEvent = loadSuccess;
@@ -355,6 +609,7 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	self.stallEvent = stall;
 	self.seekEvent = seek;
 	self.resetEvent = reset;
+	self.trickPlayEvent = trickPlay;
 	
 	_stateMachine = stateMachine;
 	
@@ -388,6 +643,12 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 - (void)loadPlayerAndAutoStartAtTime:(NSValue *)startTimeValue
 {
 	if ([self.stateMachine.currentState isEqual:self.idleState]) {
+		// The poster is kept until playback actually resumes
+		if (self.reclaimed) {
+			[self clearReclaimedState];
+			self.resumeStartTime = CACurrentMediaTime();
+		}
+		
 		self.startTimeValue = startTimeValue;
 		[self fireEvent:self.loadEvent userInfo:nil];
 	}
@@ -395,6 +656,10 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 
 - (void)prepareToPlay
 {
+	if (self.reclaimed) {
+		return;
+	}
+	
 	[self loadPlayerAndAutoStartAtTime:nil];
 }
 
@@ -410,10 +675,25 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 		[self reset];
 	}
 	
-	if ([self.stateMachine.currentState isEqual:self.idleState]) {
+	if (!self.readyForCommands) {
+		// Supersedes any pending pause. Applied once the item is ready to play, see `-applyPendingCommandsWithAutoStart:`
+		[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPlay completionHandler:nil];
+	}
+	
+	if (self.reclaimed) {
+		// DVR positions are resolved against the live edge once the stream is ready, since the window has moved meanwhile
+		self.startLiveOffset = self.reclaimedLiveOffset;
+		[self loadPlayerAndAutoStartAtTime:self.reclaimedTimeValue ?: [NSValue valueWithCMTime:kCMTimeZero]];
+	}
+	else if ([self.stateMachine.currentState isEqual:self.idleState]) {
 		[self loadPlayerAndAutoStartAtTime:[NSValue valueWithCMTime:kCMTimeZero]];
 	}
-	else {
+	else if ([self.stateMachine.currentState isEqual:self.trickPlayingState]) {
+		// Rate changes are ignored by the KVO implementation method while trick playing
+		[self fireEvent:self.playEvent userInfo:nil];
+		[self.player play];
+	}
+	else if (self.readyForCommands) {
 		[self.player play];
 	}
 }
@@ -452,7 +732,21 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 
 - (void)pause
 {
-	// The state machine state is updated to 'Paused' in the KVO implementation method
+	[self.stallWatchdog cancel];
+	
+	// Prevents playback from starting automatically once the item is ready to play. When idle, nothing is being loaded
+	// and the pause is ignored, otherwise it would still apply the next time a media is loaded
+	if (!self.readyForCommands) {
+		if (![self.stateMachine.currentState isEqual:self.idleState]) {
+			[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPause completionHandler:nil];
+		}
+		return;
+	}
+	
+	// The state machine state is updated to 'Paused' in the KVO implementation method, except when trick playing
+	if ([self.stateMachine.currentState isEqual:self.trickPlayingState]) {
+		[self fireEvent:self.pauseEvent userInfo:nil];
+	}
 	[self.player pause];
 }
 
@@ -460,7 +754,11 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 {
 	_muted = muted;
 	
-	self.player.muted = muted;
+	self.player.muted = muted || self.blackedOut;
+	if (self.blackedOut) {
+		self.slateMediaPlayerController.muted = muted;
+	}
+	[self.bufferBudget setNeedsRebalance];
 }
 
 - (BOOL)isMuted
@@ -468,6 +766,30 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	return _muted;
 }
 
+- (void)setPreferredPeakBitRate:(double)preferredPeakBitRate
+{
+	if (preferredPeakBitRate < 0.) {
+		RTSMediaPlayerLogWarning(@"The preferred peak bit rate cannot be negative. Set to 0");
+		preferredPeakBitRate = 0.;
+	}
+	
+	_preferredPeakBitRate = preferredPeakBitRate;
+	self.playerItem.preferredPeakBitRate = [self effectivePeakBitRate];
+}
+
+// The lowest of the preferred peak bit rate and of the cap applied to recover from stalls
+- (double)effectivePeakBitRate
+{
+	double preferredPeakBitRate = self.preferredPeakBitRate;
+	double stallPeakBitRate = self.stallPeakBitRate;
+	if (preferredPeakBitRate > 0. && stallPeakBitRate > 0.) {
+		return MIN(preferredPeakBitRate, stallPeakBitRate);
+	}
+	else {
+		return MAX(preferredPeakBitRate, stallPeakBitRate);
+	}
+}
+
 - (void)setAllowsExternalPlayback:(BOOL)allowsExternalPlayback
 {
 	_allowsExternalPlayback = allowsExternalPlayback;
@@ -491,6 +813,31 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 }
 
 - (void)reset
+{
+	CFTimeInterval resetStartTime = CACurrentMediaTime();
+	
+	if (self.reclaimed) {
+		[self clearReclaimedState];
+		[self clearReclaimedStreamShape];
+		[self removePosterView];
+		self.playbackState = RTSMediaPlaybackStateIdle;
+	}
+	
+	[self.stallWatchdog cancel];
+	self.stallPeakBitRate = 0.;
+	self.rebuildContentURL = nil;
+	self.rebuildingPlayer = NO;
+	
+	[self.timeshiftRecorder stop];
+	self.timeshiftRecorder = nil;
+	
+	[self releaseResources];
+	[self.commandQueue cancel];
+	
+	RTSMediaPlayerLogDebug(@"Reset in %.3f msec.", (CACurrentMediaTime() - resetStartTime) * 1000.);
+}
+
+- (void)releaseResources
 {
 	// Reset the PIP controller so that it gets lazily attached again. This forces a new player layer relationship,
 	// preventing black screen issues when playing another media identifier while already in picture in picture mode
@@ -512,11 +859,44 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 		return;
 	}
 	
-	// Avoid exception: "AVPlayerItem cannot service a seek request with a completion handler until its status is AVPlayerItemStatusReadyToPlay"
-	if (!self.player || self.player.status != AVPlayerItemStatusReadyToPlay) {
+	// Playback will resume at the new position when the player is rebuilt
+	if (self.reclaimed) {
+		self.reclaimedTimeValue = [NSValue valueWithCMTime:time];
+		self.reclaimedLiveOffset = nil;
+		if (completionHandler) {
+			completionHandler(YES);
+		}
+		return;
+	}
+	
+	// Like pauses, seeks are ignored while idle. Nothing is being loaded, and they would otherwise apply to whatever
+	// media is loaded next
+	if ([self.stateMachine.currentState isEqual:self.idleState]) {
+		RTSMediaPlayerLogDebug(@"Seek to %.2f sec. ignored while idle", CMTimeGetSeconds(time));
+		if (completionHandler) {
+			completionHandler(NO);
+		}
+		return;
+	}
+	
+	// Avoid exception: "AVPlayerItem cannot service a seek request with a completion handler until its status is AVPlayerItemStatusReadyToPlay".
+	// The seek is applied once the item is ready, see `-applyPendingCommandsWithAutoStart:`
+	if (!self.readyForCommands) {
+		RTSMediaPlayerLogDebug(@"Seek to %.2f sec. scheduled", CMTimeGetSeconds(time));
+		[self.commandQueue enqueueSeekToTime:time completionHandler:completionHandler];
 		return;
 	}
 	
+	// Record what was watched up to the seek, and nothing in between
+	[self updateWatchedTimeRangesWithTime:self.player.currentTime];
+	self.watchedTime = NAN;
+	
+	// Trick play ends with the seek, after which playback resumes at the normal rate
+	if ([self.stateMachine.currentState isEqual:self.trickPlayingState]) {
+		[self fireEvent:self.seekEvent userInfo:nil];
+		self.player.rate = 1.f;
+	}
+	
 	if (self.stateMachine.currentState != self.seekingState) {
 		[self fireEvent:self.seekEvent userInfo:nil];
 	}
@@ -537,7 +917,18 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 - (void)playAtTime:(CMTime)time completionHandler:(void (^)(BOOL finished))completionHandler;
 {
 	if ([self.stateMachine.currentState isEqual:self.idleState]) {
+		if (!self.identifier) {
+			if (completionHandler) {
+				completionHandler(NO);
+			}
+			return;
+		}
+		
 		[self loadPlayerAndAutoStartAtTime:[NSValue valueWithCMTime:time]];
+		
+		// The start time is applied with pending commands, after which the handler is called, see
+		// `-applyPendingCommandsWithAutoStart:`
+		[self.commandQueue enqueuePlaybackCommand:RTSMediaPlayerPlaybackCommandPlay completionHandler:completionHandler];
 	}
 	else {
 		[self seekToTime:time completionHandler:completionHandler];
@@ -549,6 +940,45 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 	return self.player.currentItem;
 }
 
+- (BOOL)isReadyForCommands
+{
+	return self.player.currentItem.status == AVPlayerItemStatusReadyToPlay;
+}
+
+// Commands issued before the item was ready to play are applied in a single step: the item is positioned once, and
+// playback starts or not according to the last playback command, or to how loading was requested if there is none
+- (void)applyPendingCommandsWithAutoStart:(BOOL)autoStart
+{
+	CMTime startTime = (self.startTimeValue && !self.startTimeApplied) ? [self.startTimeValue CMTimeValue] : kCMTimeInvalid;
+	
+	[self.commandQueue applyUsingBlock:^(CMTime seekTime, RTSMediaPlayerPlaybackCommand playbackCommand, void (^completionHandler)(BOOL finished)) {
+		BOOL shouldPlay = (playbackCommand == RTSMediaPlayerPlaybackCommandNone) ? autoStart : (playbackCommand == RTSMediaPlayerPlaybackCommandPlay);
+		
+		// Like when preparing to play, the pause event is sent once the player is prerolled
+		self.pauseScheduled = !shouldPlay;
+		
+		void (^positionCompletionBlock)(BOOL) = ^(BOOL finished) {
+			if (finished && shouldPlay) {
+				[self play];
+			}
+			completionHandler(finished);
+		};
+		
+		// A zero start time means starting at the default position
+		CMTime positionTime = CMTIME_IS_VALID(seekTime) ? seekTime : startTime;
+		if (CMTIME_IS_NUMERIC(positionTime) && (CMTIME_IS_VALID(seekTime) || CMTIME_COMPARE_INLINE(positionTime, !=, kCMTimeZero))) {
+			RTSMediaPlayerLogDebug(@"Applying pending commands at %.2f sec. (%@)", CMTimeGetSeconds(positionTime), shouldPlay ? @"playing" : @"paused");
+			
+			// Not using [self seek...] to avoid triggering undesirable state events.
+			[self.player seekToTime:positionTime toleranceBefore:kCMTimeZero toleranceAfter:kCMTimeZero completionHandler:positionCompletionBlock];
+		}
+		else {
+			RTSMediaPlayerLogDebug(@"Applying pending commands (%@)", shouldPlay ? @"playing" : @"paused");
+			positionCompletionBlock(YES);
+		}
+	}];
+}
+
 - (RTSMediaPlaybackState)playbackState
 {
 	@synchronized(self) {
@@ -567,128 +997,1369 @@ static NSDictionary *ErrorUserInfo(RTSMediaPlayerError code, NSString *localized
 		
 		_playbackState = playbackState;
 		
+		[self.bufferBudget setNeedsRebalance];
 		[self postNotificationName:RTSMediaPlayerPlaybackStateDidChangeNotification userInfo:userInfo];
 	}
 }
 
-#pragma mark - Specialized Accessors
+#pragma mark - Buffer budget
 
-- (CMTimeRange)timeRange
+- (void)setBufferBudget:(RTSMediaPlayerBufferBudget *)bufferBudget
 {
-	AVPlayerItem *playerItem = self.playerItem;
-	
-	NSValue *firstSeekableTimeRangeValue = [playerItem.seekableTimeRanges firstObject];
-	if (!firstSeekableTimeRangeValue) {
-		return kCMTimeRangeInvalid;
-	}
-	
-	NSValue *lastSeekableTimeRangeValue = [playerItem.seekableTimeRanges lastObject];
-	if (!lastSeekableTimeRangeValue) {
-		return kCMTimeRangeInvalid;
+	if (_bufferBudget == bufferBudget) {
+		return;
 	}
 	
-	CMTimeRange firstSeekableTimeRange = [firstSeekableTimeRangeValue CMTimeRangeValue];
-	CMTimeRange lastSeekableTimeRange = [lastSeekableTimeRangeValue CMTimeRangeValue];
-	
-	if (!CMTIMERANGE_IS_VALID(firstSeekableTimeRange) || !CMTIMERANGE_IS_VALID(lastSeekableTimeRange)) {
-		return kCMTimeRangeInvalid;
+	[_bufferBudget removeMediaPlayerController:self];
+	_bufferBudget = bufferBudget;
+	[_bufferBudget addMediaPlayerController:self];
+}
+
+- (void)setBufferPriority:(RTSMediaPlayerBufferPriority)bufferPriority
+{
+	_bufferPriority = bufferPriority;
+	[self.bufferBudget setNeedsRebalance];
+}
+
+- (RTSMediaPlayerBufferPriority)effectiveBufferPriority
+{
+	if (self.playbackState == RTSMediaPlaybackStatePaused) {
+		return RTSMediaPlayerBufferPriorityPaused;
 	}
-	
-	CMTimeRange timeRange = CMTimeRangeFromTimeToTime(firstSeekableTimeRange.start, CMTimeRangeGetEnd(lastSeekableTimeRange));
-	
-	// DVR window size too small. Check that we the stream is not an on-demand one first, of course
-	if (CMTIME_IS_INDEFINITE(self.playerItem.duration) && CMTimeGetSeconds(timeRange.duration) < self.minimumDVRWindowLength) {
-		return CMTimeRangeMake(timeRange.start, kCMTimeZero);
+	else if (_bufferPriority == RTSMediaPlayerBufferPriorityVisibleAudible && self.muted) {
+		return RTSMediaPlayerBufferPriorityVisibleMuted;
 	}
 	else {
-		return timeRange;
+		return _bufferPriority;
 	}
 }
 
-- (RTSMediaType)mediaType
+- (void)setAllocatedForwardBufferDuration:(NSTimeInterval)allocatedForwardBufferDuration
 {
-	if (! self.player) {
-		return RTSMediaTypeUnknown;
+	_allocatedForwardBufferDuration = allocatedForwardBufferDuration;
+	[self applyAllocatedForwardBufferDurationToPlayerItem:self.playerItem];
+}
+
+- (void)applyAllocatedForwardBufferDurationToPlayerItem:(AVPlayerItem *)playerItem
+{
+	// Only available since iOS 10. A zero duration lets the player choose automatically
+	if ([playerItem respondsToSelector:@selector(setPreferredForwardBufferDuration:)]) {
+		playerItem.preferredForwardBufferDuration = self.allocatedForwardBufferDuration;
+	}
+}
+
+- (unsigned long long)estimatedBufferedBytes
+{
+	return [self estimatedBytesLoadedAfterTime:self.playerItem.currentTime];
+}
+
+- (unsigned long long)estimatedBytesLoadedAfterTime:(CMTime)time
+{
+	if (!self.playerItem || self.indicatedBitRate <= 0.) {
+		return 0;
 	}
 	
-	NSArray *tracks = self.player.currentItem.tracks;
-	if (tracks.count == 0) {
-		return RTSMediaTypeUnknown;
+	NSTimeInterval bufferedDuration = [self.trackedTimeRangeSet totalDurationAfterTime:CMTimeGetSeconds(time)];
+	return (unsigned long long)(bufferedDuration * self.indicatedBitRate / 8.);
+}
+
+#pragma mark - Buffer health
+
+- (RTSMediaTimeRangeSet *)loadedTimeRangeSet
+{
+	return [self.trackedTimeRangeSet copy];
+}
+
+- (NSTimeInterval)bufferedAheadDuration
+{
+	AVPlayerItem *playerItem = self.playerItem;
+	if (!playerItem) {
+		return 0.;
 	}
 	
-	NSString *mediaType = [[tracks.firstObject assetTrack] mediaType];
-	return [mediaType isEqualToString:AVMediaTypeVideo] ? RTSMediaTypeVideo : RTSMediaTypeAudio;
+	return [self.trackedTimeRangeSet contiguousDurationAfterTime:CMTimeGetSeconds(playerItem.currentTime)];
 }
 
-- (RTSMediaStreamType)streamType
+- (NSTimeInterval)bufferedBehindDuration
 {
-	CMTimeRange timeRange = self.timeRange;
+	AVPlayerItem *playerItem = self.playerItem;
+	if (!playerItem) {
+		return 0.;
+	}
 	
-	if (CMTIMERANGE_IS_INVALID(timeRange)) {
-		return RTSMediaStreamTypeUnknown;
+	return [self.trackedTimeRangeSet contiguousDurationBeforeTime:CMTimeGetSeconds(playerItem.currentTime)];
+}
+
+- (RTSMediaBufferHealth)currentBufferHealth
+{
+	AVPlayerItem *playerItem = self.playerItem;
+	if (!playerItem) {
+		return RTSMediaBufferHealthUnknown;
 	}
-	else if (CMTIMERANGE_IS_EMPTY(timeRange)) {
-		return RTSMediaStreamTypeLive;
+	
+	Float64 currentTime = CMTimeGetSeconds(playerItem.currentTime);
+	NSTimeInterval bufferedAheadDuration = [self.trackedTimeRangeSet contiguousDurationAfterTime:currentTime];
+	
+	// A buffer reaching the end of an on-demand media is always sufficient
+	Float64 duration = CMTimeGetSeconds(playerItem.duration);
+	BOOL reachesEnd = isfinite(duration) && bufferedAheadDuration > 0. && currentTime + bufferedAheadDuration >= duration - RTSMediaBufferHealthEmptyDuration;
+	
+	if (reachesEnd || bufferedAheadDuration >= RTSMediaBufferHealthSufficientDuration) {
+		return RTSMediaBufferHealthSufficient;
 	}
-	else if (CMTIME_IS_INDEFINITE(self.playerItem.duration)) {
-		return RTSMediaStreamTypeDVR;
+	else if (bufferedAheadDuration >= RTSMediaBufferHealthEmptyDuration) {
+		return RTSMediaBufferHealthLow;
 	}
 	else {
-		return RTSMediaStreamTypeOnDemand;
+		return RTSMediaBufferHealthEmpty;
 	}
 }
 
-- (void)setMinimumDVRWindowLength:(NSTimeInterval)minimumDVRWindowLength
+- (void)updateBufferHealth
 {
-	if (minimumDVRWindowLength < 0.) {
-		RTSMediaPlayerLogWarning(@"The minimum DVR window length cannot be negative. Set to 0");
-		_minimumDVRWindowLength = 0.;
-	}
-	else {
-		_minimumDVRWindowLength = minimumDVRWindowLength;
+	RTSMediaBufferHealth bufferHealth = [self currentBufferHealth];
+	if (bufferHealth == _bufferHealth) {
+		return;
 	}
+	
+	RTSMediaBufferHealth previousBufferHealth = _bufferHealth;
+	self.bufferHealth = bufferHealth;
+	
+	RTSMediaPlayerLogDebug(@"Buffer health changed to %@ (%.2f sec. ahead)", @(bufferHealth), self.bufferedAheadDuration);
+	[self postNotificationName:RTSMediaPlayerBufferHealthDidChangeNotification userInfo:@{ RTSMediaPlayerPreviousBufferHealthUserInfoKey : @(previousBufferHealth) }];
 }
 
-- (void)setLiveTolerance:(NSTimeInterval)liveTolerance
+#pragma mark - Watched time ranges
+
+- (void)updateWatchedTimeRangesWithTime:(CMTime)time
 {
-	if (liveTolerance < 0.) {
-		RTSMediaPlayerLogWarning(@"Live tolerance cannot be negative. Set to 0");
-		_liveTolerance = 0.;
+	RTSMediaWatchedRangeTracker *watchedRangeTracker = self.watchedRangeTracker;
+	float rate = self.player.rate;
+	if (!watchedRangeTracker || !self.identifier || rate == 0.f || CMTIME_IS_INVALID(time)
+			|| [self.stateMachine.currentState isEqual:self.seekingState] || self.streamType != RTSMediaStreamTypeOnDemand) {
+		self.watchedTime = NAN;
+		return;
 	}
-	else {
-		_liveTolerance = liveTolerance;
+	
+	// Reverse playback records the interval covered as well
+	NSTimeInterval watchedTime = CMTimeGetSeconds(time);
+	CFTimeInterval watchedUpdateTime = CACurrentMediaTime();
+	if (!isnan(self.watchedTime)) {
+		NSTimeInterval maximumDistance = (watchedUpdateTime - self.watchedUpdateTime) * fabsf(rate) + RTSMediaWatchedRangeTolerance;
+		if (fabs(watchedTime - self.watchedTime) <= maximumDistance) {
+			[watchedRangeTracker addWatchedTimeRangeFromTime:MIN(self.watchedTime, watchedTime)
+													  toTime:MAX(self.watchedTime, watchedTime)
+											   forIdentifier:self.identifier];
+		}
 	}
+	
+	self.watchedTime = watchedTime;
+	self.watchedUpdateTime = watchedUpdateTime;
 }
 
-- (BOOL)isLive
+#pragma mark - Caption indexing
+
+- (void)setCaptionIndexingEnabled:(BOOL)captionIndexingEnabled
 {
-	if (!self.playerItem) {
-		return NO;
+	if (_captionIndexingEnabled == captionIndexingEnabled) {
+		return;
 	}
 	
-	if (self.streamType == RTSMediaStreamTypeLive) {
-		return YES;
+	_captionIndexingEnabled = captionIndexingEnabled;
+	[self attachLegibleOutputToPlayerItem:self.playerItem];
+}
+
+- (RTSMediaCaptionIndex *)captionIndex
+{
+	NSString *identifier = self.identifier;
+	if (!identifier) {
+		return nil;
 	}
-	else if (self.streamType == RTSMediaStreamTypeDVR) {
-		return CMTimeGetSeconds(CMTimeSubtract(CMTimeRangeGetEnd(self.timeRange), self.playerItem.currentTime)) < self.liveTolerance;
+	
+	if (![_captionIndex.identifier isEqualToString:identifier]) {
+		_captionIndex = [[RTSMediaCaptionIndex alloc] initWithIdentifier:identifier];
 	}
-	else {
-		return NO;
+	return _captionIndex;
+}
+
+// Detach the output from the previous item, if any, and attach a new one to the specified item if indexing is enabled.
+// Items can outlive the controller (e.g. when handed over), outputs must therefore never be left attached to them
+- (void)attachLegibleOutputToPlayerItem:(AVPlayerItem *)playerItem
+{
+	AVPlayerItemLegibleOutput *previousLegibleOutput = self.legibleOutput;
+	if (previousLegibleOutput) {
+		[previousLegibleOutput setDelegate:nil queue:NULL];
+		[self.legibleOutputPlayerItem removeOutput:previousLegibleOutput];
+	}
+	self.legibleOutput = nil;
+	self.legibleOutputPlayerItem = nil;
+	self.pendingCueText = nil;
+	
+	if (!playerItem || !self.captionIndexingEnabled) {
+		return;
 	}
+	
+	AVPlayerItemLegibleOutput *legibleOutput = [[AVPlayerItemLegibleOutput alloc] init];
+	[legibleOutput setDelegate:self queue:dispatch_get_main_queue()];
+	[playerItem addOutput:legibleOutput];
+	self.legibleOutput = legibleOutput;
+	self.legibleOutputPlayerItem = playerItem;
 }
 
+#pragma mark - AVPlayerItemLegibleOutputPushDelegate protocol
 
-#pragma mark - AVPlayer
+// Called with the captions displayed from the specified time on, an empty array when none is displayed anymore
+- (void)legibleOutput:(AVPlayerItemLegibleOutput *)output didOutputAttributedStrings:(NSArray<NSAttributedString *> *)strings nativeSampleBuffers:(NSArray *)nativeSamples forItemTime:(CMTime)itemTime
+{
+	if (output != self.legibleOutput || CMTIME_IS_INVALID(itemTime)) {
+		return;
+	}
+	
+	NSTimeInterval time = CMTimeGetSeconds(itemTime);
+	if (self.pendingCueText && time > self.pendingCueStartTime) {
+		NSTimeInterval endTime = MIN(time, self.pendingCueStartTime + RTSMediaCaptionMaximumCueDuration);
+		CMTimeRange timeRange = CMTimeRangeFromTimeToTime(CMTimeMakeWithSeconds(self.pendingCueStartTime, NSEC_PER_SEC), CMTimeMakeWithSeconds(endTime, NSEC_PER_SEC));
+		[self.captionIndex addCueWithTimeRange:timeRange text:self.pendingCueText];
+	}
+	
+	NSString *text = [[strings valueForKey:@"string"] componentsJoinedByString:@" "];
+	self.pendingCueText = (text.length != 0) ? text : nil;
+	self.pendingCueStartTime = time;
+}
 
-static const void * const AVPlayerItemStatusContext = &AVPlayerItemStatusContext;
-static const void * const AVPlayerRateContext = &AVPlayerRateContext;
+#pragma mark - Playlist rewriting
 
-static const void * const AVPlayerItemPlaybackLikelyToKeepUpContext = &AVPlayerItemPlaybackLikelyToKeepUpContext;
-static const void * const AVPlayerItemLoadedTimeRangesContext = &AVPlayerItemLoadedTimeRangesContext;
+// Rewriter only used to remove blocked segments when no playlist rewriter has been assigned
+static RTSMediaPlaylistRewriter *RTSMediaPlayerBlockingPlaylistRewriter(void)
+{
+	static RTSMediaPlaylistRewriter *s_blockingPlaylistRewriter;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		s_blockingPlaylistRewriter = [[RTSMediaPlaylistRewriter alloc] init];
+		s_blockingPlaylistRewriter.variantSelectionEnabled = NO;
+		s_blockingPlaylistRewriter.maximumResolution = CGSizeZero;
+	});
+	return s_blockingPlaylistRewriter;
+}
 
-static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEmptyContext;
+// Identify a media playlist whether it is loaded through the rewriter or not, i.e. whatever its (possibly intercepted)
+// scheme
+static NSString *RTSMediaPlayerPlaylistKey(NSURL *URL)
+{
+	return URL.resourceSpecifier;
+}
 
-- (AVPlayer *)player
+- (AVPlayerItem *)playerItemWithURL:(NSURL *)URL
+{
+	RTSMediaSegmentsController *segmentsController = self.segmentsController;
+	NSString *identifier = self.identifier;
+	NSArray<NSValue *> *blockedTimeRanges = nil;
+	if (segmentsController.removesBlockedSegmentsFromPlaylist && identifier) {
+		blockedTimeRanges = [segmentsController blockedTimeRangesForIdentifier:identifier];
+	}
+	
+	self.removedTimeRangesByPlaylist = nil;
+	self.playedPlaylist = nil;
+	
+	// Blocked segments are removed by rewriting media playlists as they are loaded from the network. Precached and
+	// timeshifted playlists are not, and are therefore only used when no segment is blocked
+	if (blockedTimeRanges.count != 0) {
+		if (self.timeshiftDepth > 0. || [self.precache containsIdentifier:identifier]) {
+			RTSMediaPlayerLogInfo(@"Segments of %@ are blocked. Played from the network, without precache or timeshift recording", URL);
+		}
+	}
+	else {
+		// Precached master playlists have been rewritten with the rewriter of the precache, if any
+		AVURLAsset *precachedAsset = [self.precache assetForIdentifier:identifier contentURL:URL];
+		if (precachedAsset) {
+			if (self.playlistRewriter && self.playlistRewriter != self.precache.playlistRewriter) {
+				RTSMediaPlayerLogDebug(@"%@ played from the precache. The playlist rewriter of the precache applies", URL);
+			}
+			return [AVPlayerItem playerItemWithAsset:precachedAsset];
+		}
+		
+		// Recording continues when the player is rebuilt for the same URL (e.g. after resources have been reclaimed), so
+		// that the buffer is kept. The variant recorded is chosen by the playlist rewriter
+		if (self.timeshiftDepth > 0.) {
+			if (![self.timeshiftRecorder.URL isEqual:URL]) {
+				[self.timeshiftRecorder stop];
+				
+				RTSMediaTimeshiftBuffer *buffer = [[RTSMediaTimeshiftBuffer alloc] initWithFileURL:nil byteCapacity:self.timeshiftByteCapacity depth:self.timeshiftDepth];
+				self.timeshiftRecorder = [[RTSMediaTimeshiftRecorder alloc] initWithURL:URL buffer:buffer];
+				self.timeshiftRecorder.playlistRewriter = self.playlistRewriter;
+			}
+			return [AVPlayerItem playerItemWithAsset:self.timeshiftRecorder.asset];
+		}
+	}
+	
+	if (!self.playlistRewriter && blockedTimeRanges.count == 0) {
+		return [AVPlayerItem playerItemWithURL:URL];
+	}
+	
+	// Size of the view in pixels, unknown if not laid out yet
+	CGFloat scale = [UIScreen mainScreen].scale;
+	CGSize viewSize = CGSizeMake(CGRectGetWidth(self.playerView.bounds) * scale, CGRectGetHeight(self.playerView.bounds) * scale);
+	
+	RTSMediaPlaylistRewriter *playlistRewriter = self.playlistRewriter ?: RTSMediaPlayerBlockingPlaylistRewriter();
+	
+	// Variants can be segmented differently. Time ranges removed from each media playlist are kept, those of the
+	// variant being played are applied
+	NSMutableDictionary<NSString *, NSArray<NSValue *> *> *removedTimeRangesByPlaylist = [NSMutableDictionary dictionary];
+	self.removedTimeRangesByPlaylist = removedTimeRangesByPlaylist;
+	
+	@weakify(self)
+	@weakify(segmentsController)
+	AVURLAsset *asset = [playlistRewriter assetWithURL:URL viewSize:viewSize blockedTimeRanges:blockedTimeRanges removedTimeRangesHandler:^(NSURL *playlistURL, NSArray<NSValue *> *removedTimeRanges) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			@strongify(self)
+			@strongify(segmentsController)
+			if (![self.identifier isEqualToString:identifier] || self.segmentsController != segmentsController
+					|| self.removedTimeRangesByPlaylist != removedTimeRangesByPlaylist) {
+				return;
+			}
+			
+			RTSMediaPlayerLogDebug(@"%@ time range(s) removed from %@", @(removedTimeRanges.count), playlistURL);
+			NSString *playlist = RTSMediaPlayerPlaylistKey(playlistURL);
+			removedTimeRangesByPlaylist[playlist] = removedTimeRanges;
+			
+			// Until the variant being played is known, the last playlist loaded is the one being played
+			if (!self.playedPlaylist || [self.playedPlaylist isEqualToString:playlist]) {
+				[segmentsController setRemovedTimeRanges:removedTimeRanges];
+			}
+		});
+	}];
+	return [AVPlayerItem playerItemWithAsset:asset];
+}
+
+#pragma mark - Timeshifting
+
+- (BOOL)isTimeshifting
+{
+	return self.timeshiftRecorder.recording;
+}
+
+#pragma mark - Stepping and trick play
+
+- (void)stepByCount:(NSInteger)stepCount
+{
+	if (stepCount == 0 || self.reclaimed || !self.readyForCommands) {
+		return;
+	}
+	
+	if (self.player.rate != 0.f || [self.stateMachine.currentState isEqual:self.trickPlayingState]) {
+		[self pause];
+	}
+	
+	// Latency is measured from the first step request which has not resulted in a new frame yet
+	if (self.stepStartMediaTime == 0.) {
+		self.stepStartMediaTime = CACurrentMediaTime();
+		self.stepStartTime = self.player.currentTime;
+	}
+	
+	AVPlayerItem *playerItem = self.playerItem;
+	BOOL canStep = (stepCount > 0) ? playerItem.canStepForward : playerItem.canStepBackward;
+	if (canStep && CMTIME_IS_INVALID(self.stepTargetTime)) {
+		RTSMediaPlayerLogDebug(@"Stepping by %@ frame(s)", @(stepCount));
+		[playerItem stepByCount:stepCount];
+		return;
+	}
+	
+	// Steps requested while a seek is in progress move its target
+	CMTime originTime = CMTIME_IS_VALID(self.stepTargetTime) ? self.stepTargetTime : self.player.currentTime;
+	CMTime stepTargetTime = CMTimeAdd(originTime, CMTimeMultiply([self frameDuration], (int32_t)stepCount));
+	self.stepTargetTime = [self timeClampedToTimeRange:stepTargetTime];
+	
+	if (!self.stepSeeking) {
+		[self seekForStep];
+	}
+}
+
+- (void)seekForStep
+{
+	CMTime time = self.stepTargetTime;
+	RTSMediaPlayerLogDebug(@"Stepping to %.3f sec.", CMTimeGetSeconds(time));
+	
+	self.stepSeeking = YES;
+	
+	// Not using [self seek...] to avoid triggering undesirable state events.
+	@weakify(self)
+	[self.player seekToTime:time toleranceBefore:kCMTimeZero toleranceAfter:kCMTimeZero completionHandler:^(BOOL finished) {
+		@strongify(self)
+		self.stepSeeking = NO;
+		
+		if (!finished) {
+			self.stepTargetTime = kCMTimeInvalid;
+			self.stepStartMediaTime = 0.;
+			return;
+		}
+		
+		if (CMTIME_COMPARE_INLINE(self.stepTargetTime, !=, time)) {
+			[self seekForStep];
+		}
+		else {
+			self.stepTargetTime = kCMTimeInvalid;
+			[self stepDidEnd];
+		}
+	}];
+}
+
+// Frames decoded by the player item are reported through time jumps
+- (void)updateStepWithTime:(CMTime)time
+{
+	if (self.stepStartMediaTime == 0. || CMTIME_IS_VALID(self.stepTargetTime) || CMTIME_COMPARE_INLINE(time, ==, self.stepStartTime)) {
+		return;
+	}
+	
+	[self stepDidEnd];
+}
+
+- (void)stepDidEnd
+{
+	if (self.stepStartMediaTime == 0.) {
+		return;
+	}
+	
+	NSTimeInterval stepLatency = CACurrentMediaTime() - self.stepStartMediaTime;
+	self.stepStartMediaTime = 0.;
+	
+	RTSMediaPlayerLogDebug(@"Stepped to %.3f sec. in %.3f msec.", CMTimeGetSeconds(self.player.currentTime), stepLatency * 1000.);
+	[self postNotificationName:RTSMediaPlayerDidStepNotification userInfo:@{ RTSMediaPlayerStepLatencyUserInfoKey : @(stepLatency) }];
+}
+
+// The duration of a frame of the video being played, or of the default frame rate if unknown (e.g. for audio)
+- (CMTime)frameDuration
+{
+	for (AVPlayerItemTrack *track in self.playerItem.tracks) {
+		if (![track.assetTrack.mediaType isEqualToString:AVMediaTypeVideo]) {
+			continue;
+		}
+		
+		float frameRate = (track.currentVideoFrameRate > 0.f) ? track.currentVideoFrameRate : track.assetTrack.nominalFrameRate;
+		if (frameRate > 0.f) {
+			return CMTimeMakeWithSeconds(1. / frameRate, NSEC_PER_SEC);
+		}
+	}
+	return CMTimeMake(1, RTSMediaDefaultFrameRate);
+}
+
+- (CMTime)timeClampedToTimeRange:(CMTime)time
+{
+	CMTimeRange timeRange = self.timeRange;
+	if (!CMTIMERANGE_IS_VALID(timeRange) || CMTIMERANGE_IS_EMPTY(timeRange)) {
+		return time;
+	}
+	return CMTimeClampToRange(time, timeRange);
+}
+
+- (BOOL)canPlayFastForward
+{
+	return self.playerItem.canPlayFastForward;
+}
+
+- (BOOL)canPlayFastReverse
+{
+	return self.playerItem.canPlayFastReverse;
+}
+
+- (BOOL)canPlayAtRate:(float)rate
+{
+	AVPlayerItem *playerItem = self.playerItem;
+	if (rate > 2.f) {
+		return playerItem.canPlayFastForward;
+	}
+	else if (rate > 0.f && rate < 1.f) {
+		return playerItem.canPlaySlowForward;
+	}
+	else if (rate < -1.f) {
+		return playerItem.canPlayFastReverse;
+	}
+	else if (rate == -1.f) {
+		return playerItem.canPlayReverse;
+	}
+	else if (rate < 0.f) {
+		return playerItem.canPlaySlowReverse;
+	}
+	else {
+		return YES;
+	}
+}
+
+- (void)playAtRate:(float)rate
+{
+	if (rate == 1.f) {
+		[self play];
+		return;
+	}
+	else if (rate == 0.f) {
+		[self pause];
+		return;
+	}
+	
+	if (self.reclaimed || !self.readyForCommands) {
+		RTSMediaPlayerLogWarning(@"Cannot play at rate %.2f before the media is ready to play", rate);
+		return;
+	}
+	
+	if (![self.stateMachine.currentState isEqual:self.trickPlayingState]) {
+		[self fireEvent:self.trickPlayEvent userInfo:nil];
+	}
+	
+	BOOL emulated = ![self canPlayAtRate:rate];
+	RTSMediaPlayerLogInfo(@"Trick playing at rate %.2f%@", rate, emulated ? @" (emulated with seeks)" : @"");
+	
+	self.trickPlayRate = rate;
+	self.trickPlayEmulated = emulated;
+	self.trickPlayStartTime = self.player.currentTime;
+	self.trickPlayStartMediaTime = CACurrentMediaTime();
+	
+	if (emulated) {
+		[self.player pause];
+		[self seekForTrickPlay];
+	}
+	else {
+		self.player.rate = rate;
+	}
+}
+
+// Seeks are made one after the other, each one to the position which would have been reached at the trick play rate
+// when it is made. Tolerant seeks are much faster, since the player can display the closest key frame
+- (void)seekForTrickPlay
+{
+	if (self.trickPlaySeeking || !self.trickPlayEmulated) {
+		return;
+	}
+	
+	CFTimeInterval seekStartMediaTime = CACurrentMediaTime();
+	CMTime elapsedTime = CMTimeMakeWithSeconds((seekStartMediaTime - self.trickPlayStartMediaTime) * self.trickPlayRate, NSEC_PER_SEC);
+	CMTime unclampedTime = CMTimeAdd(self.trickPlayStartTime, elapsedTime);
+	CMTime time = [self timeClampedToTimeRange:unclampedTime];
+	BOOL boundaryReached = CMTIME_COMPARE_INLINE(time, !=, unclampedTime);
+	
+	CMTime tolerance = CMTimeMakeWithSeconds(fabsf(self.trickPlayRate) * RTSMediaTrickPlaySeekInterval, NSEC_PER_SEC);
+	float rate = self.trickPlayRate;
+	
+	self.trickPlaySeeking = YES;
+	
+	// Not using [self seek...] to avoid triggering undesirable state events.
+	@weakify(self)
+	[self.player seekToTime:time toleranceBefore:tolerance toleranceAfter:tolerance completionHandler:^(BOOL finished) {
+		@strongify(self)
+		self.trickPlaySeeking = NO;
+		
+		if (![self.stateMachine.currentState isEqual:self.trickPlayingState] || !self.trickPlayEmulated) {
+			return;
+		}
+		
+		if (boundaryReached && finished && rate == self.trickPlayRate) {
+			[self fireEvent:(rate > 0.f) ? self.endEvent : self.pauseEvent userInfo:nil];
+			return;
+		}
+		
+		NSTimeInterval delay = MAX(RTSMediaTrickPlaySeekInterval - (CACurrentMediaTime() - seekStartMediaTime), 0.);
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+			@strongify(self)
+			[self seekForTrickPlay];
+		});
+	}];
+}
+
+#pragma mark - Resource reclamation
+
+- (void)setIdleReclamationDelay:(NSTimeInterval)idleReclamationDelay
+{
+	if (idleReclamationDelay < 0.) {
+		RTSMediaPlayerLogWarning(@"The idle reclamation delay cannot be negative. Set to 0");
+		_idleReclamationDelay = 0.;
+	}
+	else {
+		_idleReclamationDelay = idleReclamationDelay;
+	}
+}
+
+- (dispatch_source_t)reclamationTimer
+{
+	if (!_reclamationTimer) {
+		_reclamationTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+		dispatch_source_set_timer(_reclamationTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+		@weakify(self)
+		dispatch_source_set_event_handler(_reclamationTimer, ^{
+			@strongify(self)
+			[self reclaimResources];
+		});
+		dispatch_resume(_reclamationTimer);
+	}
+	return _reclamationTimer;
+}
+
+- (void)scheduleResourceReclamation
+{
+	if (self.idleReclamationDelay <= 0.) {
+		return;
+	}
+	
+	int64_t delayInNanoseconds = self.idleReclamationDelay * NSEC_PER_SEC;
+	int64_t toleranceInNanoseconds = 1. * NSEC_PER_SEC;
+	dispatch_source_set_timer(self.reclamationTimer, dispatch_time(DISPATCH_TIME_NOW, delayInNanoseconds), DISPATCH_TIME_FOREVER, toleranceInNanoseconds);
+}
+
+- (void)cancelResourceReclamation
+{
+	if (_reclamationTimer) {
+		dispatch_source_set_timer(_reclamationTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+	}
+}
+
+- (void)reclaimResources
+{
+	if (![self.stateMachine.currentState isEqual:self.pausedState]) {
+		return;
+	}
+	
+	// Releasing the player would end AirPlay or picture in picture playback
+	if (self.player.externalPlaybackActive || _pictureInPictureController.pictureInPictureActive) {
+		RTSMediaPlayerLogDebug(@"Resources are not reclaimed during external or picture in picture playback");
+		return;
+	}
+	
+	NSValue *reclaimedTimeValue = nil;
+	NSNumber *reclaimedLiveOffset = nil;
+	[self getResumeTimeValue:&reclaimedTimeValue liveOffset:&reclaimedLiveOffset];
+	self.reclaimedTimeValue = reclaimedTimeValue;
+	self.reclaimedLiveOffset = reclaimedLiveOffset;
+	
+	// The stream shape is reported as is until the rebuilt player plays
+	RTSMediaStreamType reclaimedStreamType = self.streamType;
+	RTSMediaType reclaimedMediaType = self.mediaType;
+	CMTimeRange reclaimedTimeRange = self.timeRange;
+	
+	unsigned long long reclaimedBytes = [self estimatedBytesLoadedAfterTime:kCMTimeNegativeInfinity];
+	
+	// Snapshot the last displayed frame before the player layer is detached
+	UIView *posterView = nil;
+	if (_view && self.mediaType == RTSMediaTypeVideo) {
+		posterView = [_view snapshotViewAfterScreenUpdates:NO];
+	}
+	
+	self.reclaimed = YES;
+	[self releaseResources];
+	
+	self.reclaimedTimeRangeValue = [NSValue valueWithCMTimeRange:reclaimedTimeRange];
+	self.reclaimedStreamType = reclaimedStreamType;
+	self.reclaimedMediaType = reclaimedMediaType;
+	
+	if (posterView) {
+		posterView.frame = _view.bounds;
+		posterView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+		posterView.userInteractionEnabled = NO;
+		[_view addSubview:posterView];
+		self.posterView = posterView;
+	}
+	
+	RTSMediaPlayerLogInfo(@"Resources reclaimed (about %@ bytes released)", @(reclaimedBytes));
+	[self postNotificationName:RTSMediaPlayerDidReclaimResourcesNotification userInfo:@{ RTSMediaPlayerReclaimedBytesUserInfoKey : @(reclaimedBytes) }];
+}
+
+// Position at which a player rebuilt for the current media must resume. Live streams, and DVR streams played live,
+// simply resume at the live edge
+- (void)getResumeTimeValue:(NSValue **)pTimeValue liveOffset:(NSNumber **)pLiveOffset
+{
+	NSValue *timeValue = nil;
+	NSNumber *liveOffset = nil;
+	
+	AVPlayerItem *playerItem = self.playerItem;
+	RTSMediaStreamType streamType = self.streamType;
+	if (streamType == RTSMediaStreamTypeOnDemand) {
+		timeValue = [NSValue valueWithCMTime:playerItem.currentTime];
+	}
+	else if (streamType == RTSMediaStreamTypeDVR && !self.live) {
+		liveOffset = @(CMTimeGetSeconds(CMTimeSubtract(CMTimeRangeGetEnd(self.timeRange), playerItem.currentTime)));
+	}
+	
+	if (pTimeValue) {
+		*pTimeValue = timeValue;
+	}
+	if (pLiveOffset) {
+		*pLiveOffset = liveOffset;
+	}
+}
+
+- (void)clearReclaimedState
+{
+	self.reclaimed = NO;
+	self.reclaimedTimeValue = nil;
+	self.reclaimedLiveOffset = nil;
+}
+
+- (void)clearReclaimedStreamShape
+{
+	self.reclaimedTimeRangeValue = nil;
+	self.reclaimedStreamType = RTSMediaStreamTypeUnknown;
+	self.reclaimedMediaType = RTSMediaTypeUnknown;
+}
+
+- (void)removePosterView
+{
+	[self.posterView removeFromSuperview];
+	self.posterView = nil;
+}
+
+#pragma mark - Stall recovery
+
+- (void)setStallRecoverySteps:(NSArray<RTSMediaPlayerStallRecoveryStep *> *)stallRecoverySteps
+{
+	_stallRecoverySteps = [stallRecoverySteps copy];
+	
+	[self.stallWatchdog cancel];
+	
+	if (stallRecoverySteps.count != 0) {
+		self.stallWatchdog = [[RTSMediaPlayerStallWatchdog alloc] initWithSteps:stallRecoverySteps];
+		self.stallWatchdog.delegate = self;
+		
+		if ([self.stateMachine.currentState isEqual:self.stalledState]) {
+			[self.stallWatchdog stallDidStart];
+		}
+	}
+	else {
+		self.stallWatchdog = nil;
+	}
+}
+
+// The playback state is kept while the player is released and the new one prepared, without any state change being
+// reported. Playback resumes at the same position once the new player is ready
+- (void)rebuildPlayerWithContentURL:(NSURL *)contentURL
+{
+	NSValue *startTimeValue = nil;
+	NSNumber *startLiveOffset = nil;
+	if (self.readyForCommands) {
+		[self getResumeTimeValue:&startTimeValue liveOffset:&startLiveOffset];
+	}
+	else {
+		// The previous rebuilt player never got ready. Resume where it was meant to start
+		startTimeValue = self.startTimeValue;
+		startLiveOffset = self.startLiveOffset;
+	}
+	
+	self.rebuildingPlayer = YES;
+	self.reclaimed = YES;
+	[self releaseResources];
+	[self clearReclaimedState];
+	
+	self.startLiveOffset = startLiveOffset;
+	self.rebuildContentURL = contentURL;
+	[self loadPlayerAndAutoStartAtTime:startTimeValue ?: [NSValue valueWithCMTime:kCMTimeZero]];
+}
+
+- (void)capPeakBitRate:(double)peakBitRate
+{
+	self.stallPeakBitRate = (self.stallPeakBitRate > 0.) ? MIN(self.stallPeakBitRate, peakBitRate) : peakBitRate;
+	self.playerItem.preferredPeakBitRate = [self effectivePeakBitRate];
+	
+	RTSMediaPlayerLogInfo(@"Peak bit rate capped to %.0f bps", self.stallPeakBitRate);
+}
+
+- (BOOL)requestAlternateContentURL
+{
+	id<RTSMediaPlayerControllerDataSource> dataSource = self.dataSource;
+	NSString *identifier = self.identifier;
+	NSURL *contentURL = self.contentURL;
+	if (!identifier || !contentURL || ![dataSource respondsToSelector:@selector(mediaPlayerController:alternateContentURLForIdentifier:failedContentURL:completionHandler:)]) {
+		return NO;
+	}
+	
+	@weakify(self)
+	[dataSource mediaPlayerController:self alternateContentURLForIdentifier:identifier failedContentURL:contentURL completionHandler:^(NSURL *alternateContentURL) {
+		@strongify(self)
+		
+		// Playback might have recovered or the media might have changed meanwhile
+		if (!alternateContentURL || ![self.identifier isEqualToString:identifier] || !self.stallWatchdog.stalled) {
+			return;
+		}
+		
+		RTSMediaPlayerLogInfo(@"Switching to URL %@", alternateContentURL);
+		[self rebuildPlayerWithContentURL:alternateContentURL];
+	}];
+	return YES;
+}
+
+#pragma mark - RTSMediaPlayerStallWatchdogDelegate protocol
+
+- (BOOL)stallWatchdog:(RTSMediaPlayerStallWatchdog *)stallWatchdog performRecoveryStep:(RTSMediaPlayerStallRecoveryStep *)step
+{
+	switch (step.action) {
+		case RTSMediaPlayerStallRecoveryActionWait: {
+			break;
+		}
+			
+		case RTSMediaPlayerStallRecoveryActionCapBitRate: {
+			double peakBitRate = (step.peakBitRate > 0.) ? step.peakBitRate : self.indicatedBitRate / 2.;
+			if (peakBitRate <= 0.) {
+				return NO;
+			}
+			[self capPeakBitRate:peakBitRate];
+			break;
+		}
+			
+		case RTSMediaPlayerStallRecoveryActionRebuildItem: {
+			// Releasing the player would end picture in picture playback
+			if (!self.contentURL || _pictureInPictureController.pictureInPictureActive) {
+				return NO;
+			}
+			[self rebuildPlayerWithContentURL:self.contentURL];
+			break;
+		}
+			
+		case RTSMediaPlayerStallRecoveryActionSwitchURL: {
+			if (_pictureInPictureController.pictureInPictureActive || ![self requestAlternateContentURL]) {
+				return NO;
+			}
+			break;
+		}
+	}
+	
+	[self postNotificationName:RTSMediaPlayerStallRecoveryActionNotification userInfo:@{ RTSMediaPlayerStallRecoveryActionUserInfoKey : @(step.action),
+																						  RTSMediaPlayerStallDurationUserInfoKey : @(stallWatchdog.stallDuration) }];
+	return YES;
+}
+
+- (void)stallWatchdog:(RTSMediaPlayerStallWatchdog *)stallWatchdog didRecoverAfterDuration:(NSTimeInterval)duration lastAction:(RTSMediaPlayerStallRecoveryAction)lastAction
+{
+	[self postNotificationName:RTSMediaPlayerDidRecoverFromStallNotification userInfo:@{ RTSMediaPlayerStallRecoveryActionUserInfoKey : @(lastAction),
+																						  RTSMediaPlayerStallDurationUserInfoKey : @(duration) }];
+}
+
+#pragma mark - Blackout
+
+- (NSArray<RTSMediaBlackoutWindow *> *)blackoutWindows
+{
+	return self.blackoutSchedule.windows;
+}
+
+- (void)setBlackoutWindows:(NSArray<RTSMediaBlackoutWindow *> *)blackoutWindows
+{
+	self.blackoutSchedule.windows = blackoutWindows;
+	[self cancelBlackoutUpdate];
+	[self updateBlackout];
+}
+
+- (void)setBlackoutClock:(RTSMediaBlackoutClock)blackoutClock
+{
+	_blackoutClock = blackoutClock;
+	[self cancelBlackoutUpdate];
+	[self updateBlackout];
+}
+
+- (NSTimeInterval)slatePreparationInterval
+{
+	return self.blackoutSchedule.slatePreparationInterval;
+}
+
+- (void)setSlatePreparationInterval:(NSTimeInterval)slatePreparationInterval
+{
+	self.blackoutSchedule.slatePreparationInterval = slatePreparationInterval;
+	[self cancelBlackoutUpdate];
+	[self updateBlackout];
+}
+
+// The date against which blackout windows are evaluated, nil if no media is loaded
+- (NSDate *)blackoutDate
+{
+	AVPlayerItem *playerItem = self.playerItem;
+	if (!playerItem) {
+		return nil;
+	}
+	
+	if (self.blackoutClock == RTSMediaBlackoutClockProgramDate) {
+		NSDate *programDate = playerItem.currentDate;
+		if (programDate) {
+			return programDate;
+		}
+	}
+	return [NSDate date];
+}
+
+- (void)updateBlackout
+{
+	[self updateBlackoutWithDate:[self blackoutDate]];
+}
+
+- (void)updateBlackoutWithDate:(NSDate *)date
+{
+	[self.blackoutSchedule updateWithDate:date];
+	[self scheduleBlackoutUpdateAfterDate:date];
+}
+
+// Periodic updates are not accurate enough to switch on the exact frame. The schedule is therefore updated when its next
+// transition is reached as well, with a boundary time observer for program dates (which only advance with playback), or
+// with a timer for the wall clock
+- (void)scheduleBlackoutUpdateAfterDate:(NSDate *)date
+{
+	NSDate *nextTransitionDate = [self.blackoutSchedule nextTransitionDateAfterDate:date];
+	if (nextTransitionDate == self.blackoutTriggerDate || [nextTransitionDate isEqualToDate:self.blackoutTriggerDate]) {
+		return;
+	}
+	
+	[self cancelBlackoutUpdate];
+	
+	if (!nextTransitionDate) {
+		return;
+	}
+	
+	self.blackoutTriggerDate = nextTransitionDate;
+	
+	NSTimeInterval interval = [nextTransitionDate timeIntervalSinceDate:date];
+	AVPlayerItem *playerItem = self.playerItem;
+	if (self.blackoutClock == RTSMediaBlackoutClockProgramDate && playerItem.currentDate) {
+		CMTime time = CMTimeAdd(playerItem.currentTime, CMTimeMakeWithSeconds(interval, NSEC_PER_SEC));
+		
+		@weakify(self)
+		self.blackoutBoundaryObserver = [self.observationProxy addBoundaryTimeObserverForTimes:@[ [NSValue valueWithCMTime:time] ] queue:NULL usingBlock:^{
+			@strongify(self)
+			[self blackoutTriggerDidFire];
+		}];
+	}
+	else {
+		dispatch_source_set_timer(self.blackoutTimer, dispatch_walltime(NULL, (int64_t)(interval * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, 0);
+	}
+}
+
+- (void)cancelBlackoutUpdate
+{
+	if (self.blackoutBoundaryObserver) {
+		[self.observationProxy removeTimeObserver:self.blackoutBoundaryObserver];
+		self.blackoutBoundaryObserver = nil;
+	}
+	
+	if (_blackoutTimer) {
+		dispatch_source_set_timer(_blackoutTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+	}
+	
+	self.blackoutTriggerDate = nil;
+}
+
+- (dispatch_source_t)blackoutTimer
+{
+	if (!_blackoutTimer) {
+		_blackoutTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+		dispatch_source_set_timer(_blackoutTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+		@weakify(self)
+		dispatch_source_set_event_handler(_blackoutTimer, ^{
+			@strongify(self)
+			[self blackoutTriggerDidFire];
+		});
+		dispatch_resume(_blackoutTimer);
+	}
+	return _blackoutTimer;
+}
+
+- (void)blackoutTriggerDidFire
+{
+	NSDate *triggerDate = self.blackoutTriggerDate;
+	if (!triggerDate) {
+		return;
+	}
+	
+	[self cancelBlackoutUpdate];
+	
+	// The transition has been reached, even if the clock has not been updated yet
+	NSDate *date = [self blackoutDate];
+	if (date && [date compare:triggerDate] == NSOrderedAscending) {
+		date = triggerDate;
+	}
+	[self updateBlackoutWithDate:date];
+}
+
+#pragma mark - RTSMediaBlackoutScheduleDelegate protocol
+
+- (void)blackoutScheduleDidRequireSlate:(RTSMediaBlackoutSchedule *)blackoutSchedule
+{
+	// Covers the media during windows, even if the slate cannot be played
+	UIView *blackoutView = [[UIView alloc] initWithFrame:self.view.bounds];
+	blackoutView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+	blackoutView.backgroundColor = [UIColor blackColor];
+	blackoutView.userInteractionEnabled = NO;
+	blackoutView.hidden = YES;
+	[self.view addSubview:blackoutView];
+	self.blackoutView = blackoutView;
+	
+	if (!self.slateURL) {
+		RTSMediaPlayerLogWarning(@"No slate URL has been set. Nothing will be displayed during blackout windows");
+		return;
+	}
+	
+	// Played hidden and muted until a window starts, as the neighbours of a zapping controller
+	RTSMediaPlayerLogDebug(@"Preparing slate %@", self.slateURL);
+	RTSMediaPlayerController *slateMediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentURL:self.slateURL];
+	slateMediaPlayerController.muted = YES;
+	slateMediaPlayerController.bufferBudget = self.bufferBudget;
+	slateMediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityHidden;
+	[slateMediaPlayerController attachPlayerToView:blackoutView];
+	[slateMediaPlayerController play];
+	self.slateMediaPlayerController = slateMediaPlayerController;
+}
+
+- (void)blackoutScheduleDidReleaseSlate:(RTSMediaBlackoutSchedule *)blackoutSchedule
+{
+	RTSMediaPlayerLogDebug(@"Releasing slate");
+	
+	[self.slateMediaPlayerController reset];
+	self.slateMediaPlayerController = nil;
+	
+	[self.blackoutView removeFromSuperview];
+	self.blackoutView = nil;
+}
+
+- (void)blackoutSchedule:(RTSMediaBlackoutSchedule *)blackoutSchedule didEnterWindow:(RTSMediaBlackoutWindow *)window
+{
+	RTSMediaPlayerController *slateMediaPlayerController = self.slateMediaPlayerController;
+	BOOL slatePreBuffered = (slateMediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying);
+	
+	// Swap pictures within the same frame, and sounds at the same time
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	self.blackoutView.hidden = NO;
+	[CATransaction commit];
+	
+	self.blackedOut = YES;
+	self.player.muted = YES;
+	slateMediaPlayerController.muted = self.muted;
+	slateMediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityVisibleAudible;
+	
+	RTSMediaPlayerLogInfo(@"Blackout started (slate pre-buffered: %@)", slatePreBuffered ? @"YES" : @"NO");
+	[self postNotificationName:RTSMediaPlayerBlackoutDidStartNotification userInfo:@{ RTSMediaPlayerBlackoutWindowUserInfoKey : window,
+																					   RTSMediaPlayerSlatePreBufferedUserInfoKey : @(slatePreBuffered) }];
+}
+
+- (void)blackoutSchedule:(RTSMediaBlackoutSchedule *)blackoutSchedule didExitWindow:(RTSMediaBlackoutWindow *)window
+{
+	RTSMediaPlayerController *slateMediaPlayerController = self.slateMediaPlayerController;
+	
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	self.blackoutView.hidden = YES;
+	[CATransaction commit];
+	
+	self.blackedOut = NO;
+	self.player.muted = self.muted;
+	slateMediaPlayerController.muted = YES;
+	slateMediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityHidden;
+	
+	RTSMediaPlayerLogInfo(@"Blackout ended");
+	[self postNotificationName:RTSMediaPlayerBlackoutDidEndNotification userInfo:@{ RTSMediaPlayerBlackoutWindowUserInfoKey : window }];
+}
+
+#pragma mark - Handoff
+
+- (BOOL)takeOverPlaybackFromMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	if (!mediaPlayerController || mediaPlayerController == self) {
+		return NO;
+	}
+	
+	AVPlayer *player = mediaPlayerController.player;
+	RTSMediaPlaybackState playbackState = mediaPlayerController.playbackState;
+	if (!player.currentItem || playbackState == RTSMediaPlaybackStateIdle || playbackState == RTSMediaPlaybackStatePreparing) {
+		RTSMediaPlayerLogWarning(@"Cannot take over playback from a controller without player");
+		return NO;
+	}
+	
+	// Picture in picture is bound to the player layer of the other controller
+	if (mediaPlayerController->_pictureInPictureController.pictureInPictureActive) {
+		RTSMediaPlayerLogWarning(@"Cannot take over playback during picture in picture");
+		return NO;
+	}
+	
+	CFTimeInterval handoffStartTime = CACurrentMediaTime();
+	
+	[self reset];
+	
+	self.identifier = mediaPlayerController.identifier;
+	self.contentURL = mediaPlayerController.contentURL;
+	self.dataSource = (mediaPlayerController.dataSource == mediaPlayerController) ? self : mediaPlayerController.dataSource;
+	
+	// Display the player in both views during the handoff, so that no frame is lost
+	self.playerView.player = player;
+	
+	// Move observers. Blocks of observers sharing the same interval and queue are merged
+	[mediaPlayerController unregisterCustomPeriodicTimeObservers];
+	[mediaPlayerController.periodicTimeObservers enumerateKeysAndObjectsUsingBlock:^(NSString *key, RTSPeriodicTimeObserver *periodicTimeObserver, BOOL *stop) {
+		RTSPeriodicTimeObserver *existingPeriodicTimeObserver = self.periodicTimeObservers[key];
+		if (existingPeriodicTimeObserver) {
+			[periodicTimeObserver moveBlocksToPeriodicTimeObserver:existingPeriodicTimeObserver];
+		}
+		else {
+			self.periodicTimeObservers[key] = periodicTimeObserver;
+		}
+	}];
+	[mediaPlayerController.periodicTimeObservers removeAllObjects];
+	[mediaPlayerController.timeSchedule moveEntriesToTimeSchedule:self.timeSchedule];
+	
+	RTSMediaSegmentsController *segmentsController = mediaPlayerController.segmentsController;
+	if (segmentsController) {
+		mediaPlayerController.segmentsController = nil;
+		segmentsController.playerController = self;
+	}
+	
+	// The recorder serves the item being handed over, and must not be stopped when the other controller is reset.
+	// Playlist rewriting and precache loaders are retained by the asset itself
+	RTSMediaTimeshiftRecorder *timeshiftRecorder = mediaPlayerController.timeshiftRecorder;
+	if (timeshiftRecorder) {
+		mediaPlayerController.timeshiftRecorder = nil;
+		self.timeshiftRecorder = timeshiftRecorder;
+		self.timeshiftDepth = mediaPlayerController.timeshiftDepth;
+		self.timeshiftByteCapacity = mediaPlayerController.timeshiftByteCapacity;
+	}
+	
+	// Settings of the playback being handed over. They are applied to the player when it is adopted, see `-setPlayer:`
+	self.muted = mediaPlayerController.muted;
+	self.preferredPeakBitRate = mediaPlayerController.preferredPeakBitRate;
+	self.bufferBudget = mediaPlayerController.bufferBudget;
+	self.bufferPriority = mediaPlayerController.bufferPriority;
+	self.playlistRewriter = mediaPlayerController.playlistRewriter;
+	self.precache = mediaPlayerController.precache;
+	self.watchedRangeTracker = mediaPlayerController.watchedRangeTracker;
+	self.captionIndex = mediaPlayerController.captionIndex;
+	self.captionIndexingEnabled = mediaPlayerController.captionIndexingEnabled;
+	
+	// A stall in progress restarts with the first recovery step. Bit rate caps applied by previous steps are kept
+	self.stallRecoverySteps = mediaPlayerController.stallRecoverySteps;
+	self.stallPeakBitRate = mediaPlayerController.stallPeakBitRate;
+	
+	// An ongoing blackout window is entered again by the receiver, with its own slate
+	self.slateURL = mediaPlayerController.slateURL;
+	self.slatePreparationInterval = mediaPlayerController.slatePreparationInterval;
+	self.blackoutClock = mediaPlayerController.blackoutClock;
+	self.blackoutWindows = mediaPlayerController.blackoutWindows;
+	
+	// Commands not applied yet are applied by the receiver once the item is ready to play. The queue of the receiver is
+	// empty since it has been reset
+	RTSMediaPlayerCommandQueue *commandQueue = self.commandQueue;
+	self.commandQueue = mediaPlayerController.commandQueue;
+	mediaPlayerController.commandQueue = commandQueue;
+	
+	// Caption and watched time range tracking continue where the other controller stopped
+	NSString *pendingCueText = mediaPlayerController.pendingCueText;
+	NSTimeInterval pendingCueStartTime = mediaPlayerController.pendingCueStartTime;
+	NSTimeInterval watchedTime = mediaPlayerController.watchedTime;
+	CFTimeInterval watchedUpdateTime = mediaPlayerController.watchedUpdateTime;
+	
+	// Pending start information, in case the item is not ready to play yet
+	self.startTimeValue = mediaPlayerController.startTimeValue;
+	self.startTimeApplied = mediaPlayerController.startTimeApplied;
+	self.startLiveOffset = mediaPlayerController.startLiveOffset;
+	self.previousPlaybackTime = mediaPlayerController.previousPlaybackTime;
+	BOOL playScheduled = mediaPlayerController.playScheduled;
+	BOOL pauseScheduled = mediaPlayerController.pauseScheduled;
+	
+	// The other controller does not own the player anymore, releasing it has no effect on playback
+	mediaPlayerController.playerHandedOver = YES;
+	[mediaPlayerController reset];
+	
+	// Reach the state of the other controller, adopting the player instead of loading the media
+	self.handoffPlayer = player;
+	[self fireEvent:self.loadEvent userInfo:nil];
+	
+	switch (playbackState) {
+		case RTSMediaPlaybackStatePlaying: {
+			[self fireEvent:self.playEvent userInfo:nil];
+			break;
+		}
+			
+		case RTSMediaPlaybackStateSeeking: {
+			[self fireEvent:self.seekEvent userInfo:nil];
+			break;
+		}
+			
+		case RTSMediaPlaybackStatePaused: {
+			[self fireEvent:self.pauseEvent userInfo:nil];
+			break;
+		}
+			
+		case RTSMediaPlaybackStateStalled: {
+			[self fireEvent:self.playEvent userInfo:nil];
+			[self fireEvent:self.stallEvent userInfo:nil];
+			break;
+		}
+			
+		case RTSMediaPlaybackStateEnded: {
+			[self fireEvent:self.playEvent userInfo:nil];
+			[self fireEvent:self.endEvent userInfo:nil];
+			break;
+		}
+			
+		case RTSMediaPlaybackStateTrickPlaying: {
+			// Trick play emulation is not handed over, playback continues paused
+			[self.player pause];
+			[self fireEvent:self.pauseEvent userInfo:nil];
+			break;
+		}
+			
+		default: {
+			break;
+		}
+	}
+	
+	self.playScheduled = playScheduled;
+	self.pauseScheduled = pauseScheduled;
+	
+	self.pendingCueText = pendingCueText;
+	self.pendingCueStartTime = pendingCueStartTime;
+	self.watchedTime = watchedTime;
+	self.watchedUpdateTime = watchedUpdateTime;
+	
+	NSTimeInterval handoffDuration = CACurrentMediaTime() - handoffStartTime;
+	RTSMediaPlayerLogInfo(@"Playback taken over in %.3f msec.", handoffDuration * 1000.);
+	[self postNotificationName:RTSMediaPlayerDidTakeOverPlaybackNotification userInfo:@{ RTSMediaPlayerHandoffDurationUserInfoKey : @(handoffDuration) }];
+	
+	return YES;
+}
+
+#pragma mark - Specialized Accessors
+
+- (CMTimeRange)timeRange
+{
+	if (self.reclaimedTimeRangeValue) {
+		return [self.reclaimedTimeRangeValue CMTimeRangeValue];
+	}
+	
+	AVPlayerItem *playerItem = self.playerItem;
+	
+	NSValue *firstSeekableTimeRangeValue = [playerItem.seekableTimeRanges firstObject];
+	if (!firstSeekableTimeRangeValue) {
+		return kCMTimeRangeInvalid;
+	}
+	
+	NSValue *lastSeekableTimeRangeValue = [playerItem.seekableTimeRanges lastObject];
+	if (!lastSeekableTimeRangeValue) {
+		return kCMTimeRangeInvalid;
+	}
+	
+	CMTimeRange firstSeekableTimeRange = [firstSeekableTimeRangeValue CMTimeRangeValue];
+	CMTimeRange lastSeekableTimeRange = [lastSeekableTimeRangeValue CMTimeRangeValue];
+	
+	if (!CMTIMERANGE_IS_VALID(firstSeekableTimeRange) || !CMTIMERANGE_IS_VALID(lastSeekableTimeRange)) {
+		return kCMTimeRangeInvalid;
+	}
+	
+	CMTimeRange timeRange = CMTimeRangeFromTimeToTime(firstSeekableTimeRange.start, CMTimeRangeGetEnd(lastSeekableTimeRange));
+	
+	// DVR window size too small. Check that we the stream is not an on-demand one first, of course
+	if (CMTIME_IS_INDEFINITE(self.playerItem.duration) && CMTimeGetSeconds(timeRange.duration) < self.minimumDVRWindowLength) {
+		return CMTimeRangeMake(timeRange.start, kCMTimeZero);
+	}
+	else {
+		return timeRange;
+	}
+}
+
+- (RTSMediaType)mediaType
+{
+	if (self.reclaimedTimeRangeValue) {
+		return self.reclaimedMediaType;
+	}
+	
+	if (! self.player) {
+		return RTSMediaTypeUnknown;
+	}
+	
+	NSArray *tracks = self.player.currentItem.tracks;
+	if (tracks.count == 0) {
+		return RTSMediaTypeUnknown;
+	}
+	
+	NSString *mediaType = [[tracks.firstObject assetTrack] mediaType];
+	return [mediaType isEqualToString:AVMediaTypeVideo] ? RTSMediaTypeVideo : RTSMediaTypeAudio;
+}
+
+- (RTSMediaStreamType)streamType
+{
+	if (self.reclaimedTimeRangeValue) {
+		return self.reclaimedStreamType;
+	}
+	
+	CMTimeRange timeRange = self.timeRange;
+	
+	if (CMTIMERANGE_IS_INVALID(timeRange)) {
+		return RTSMediaStreamTypeUnknown;
+	}
+	else if (CMTIMERANGE_IS_EMPTY(timeRange)) {
+		return RTSMediaStreamTypeLive;
+	}
+	else if (CMTIME_IS_INDEFINITE(self.playerItem.duration)) {
+		return RTSMediaStreamTypeDVR;
+	}
+	else {
+		return RTSMediaStreamTypeOnDemand;
+	}
+}
+
+- (void)setMinimumDVRWindowLength:(NSTimeInterval)minimumDVRWindowLength
+{
+	if (minimumDVRWindowLength < 0.) {
+		RTSMediaPlayerLogWarning(@"The minimum DVR window length cannot be negative. Set to 0");
+		_minimumDVRWindowLength = 0.;
+	}
+	else {
+		_minimumDVRWindowLength = minimumDVRWindowLength;
+	}
+}
+
+- (void)setLiveTolerance:(NSTimeInterval)liveTolerance
+{
+	if (liveTolerance < 0.) {
+		RTSMediaPlayerLogWarning(@"Live tolerance cannot be negative. Set to 0");
+		_liveTolerance = 0.;
+	}
+	else {
+		_liveTolerance = liveTolerance;
+	}
+}
+
+- (BOOL)isLive
+{
+	// Reclaimed streams are live if playback resumes at the live edge
+	if (!self.playerItem) {
+		if (!self.reclaimed) {
+			return NO;
+		}
+		return self.reclaimedStreamType == RTSMediaStreamTypeLive
+			|| (self.reclaimedStreamType == RTSMediaStreamTypeDVR && !self.reclaimedTimeValue && !self.reclaimedLiveOffset);
+	}
+	
+	if (self.streamType == RTSMediaStreamTypeLive) {
+		return YES;
+	}
+	else if (self.streamType == RTSMediaStreamTypeDVR) {
+		return CMTimeGetSeconds(CMTimeSubtract(CMTimeRangeGetEnd(self.timeRange), self.playerItem.currentTime)) < self.liveTolerance;
+	}
+	else {
+		return NO;
+	}
+}
+
+
+#pragma mark - AVPlayer
+
+static const void * const AVPlayerItemStatusContext = &AVPlayerItemStatusContext;
+static const void * const AVPlayerRateContext = &AVPlayerRateContext;
+
+static const void * const AVPlayerItemPlaybackLikelyToKeepUpContext = &AVPlayerItemPlaybackLikelyToKeepUpContext;
+static const void * const AVPlayerItemLoadedTimeRangesContext = &AVPlayerItemLoadedTimeRangesContext;
+
+static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEmptyContext;
+
+// Serial background queue on which previous players are torn down
+static dispatch_queue_t RTSMediaPlayerReaperQueue(void)
+{
+	static dispatch_queue_t s_reaperQueue;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		s_reaperQueue = dispatch_queue_create("ch.srgssr.mediaplayer.reaper", DISPATCH_QUEUE_SERIAL);
+		dispatch_set_target_queue(s_reaperQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+	});
+	return s_reaperQueue;
+}
+
+- (AVPlayer *)player
 {
 	@synchronized(self)
 	{
@@ -702,63 +2373,87 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 
 - (void)setPlayer:(AVPlayer *)player
 {
+	// Callbacks of the previous player are dropped right away, so that the controller is immediately detached from it.
+	// Removing its observers and releasing it is expensive and made later on a background queue
+	RTSMediaPlayerObservationProxy *previousObservationProxy = self.observationProxy;
+	[previousObservationProxy invalidate];
+	
+	// The previous player is paused right away, otherwise it would remain audible until released. Its item, whose
+	// release is the expensive part of the teardown, is removed later on the background queue, since the controller does
+	// not access the player anymore. A player handed over to another controller must continue playing, though
+	AVPlayer *previousPlayer = _player;
+	AVPlayer *stoppedPlayer = nil;
+	if (previousPlayer && previousPlayer != player && !self.playerHandedOver) {
+		[previousPlayer pause];
+		stoppedPlayer = previousPlayer;
+	}
+	self.playerHandedOver = NO;
+	
 	@synchronized(self)
 	{
-		NSNotificationCenter *defaultCenter = [NSNotificationCenter defaultCenter];
-		
-		[_player removeObserver:self forKeyPath:@"currentItem.status" context:(void *)AVPlayerItemStatusContext];
-		[_player removeObserver:self forKeyPath:@"rate" context:(void *)AVPlayerRateContext];
-		[_player removeObserver:self forKeyPath:@"currentItem.playbackLikelyToKeepUp" context:(void *)AVPlayerItemPlaybackLikelyToKeepUpContext];
-		[_player removeObserver:self forKeyPath:@"currentItem.loadedTimeRanges" context:(void *)AVPlayerItemLoadedTimeRangesContext];
-		[_player removeObserver:self forKeyPath:@"currentItem.playbackBufferEmpty" context:(void *)AVPlayerItemBufferEmptyContext];
-		
-		[defaultCenter removeObserver:self name:AVPlayerItemDidPlayToEndTimeNotification object:_player.currentItem];
-		[defaultCenter removeObserver:self name:AVPlayerItemFailedToPlayToEndTimeNotification object:_player.currentItem];
-		[defaultCenter removeObserver:self name:AVPlayerItemTimeJumpedNotification object:_player.currentItem];
-		[defaultCenter removeObserver:self name:AVPlayerItemPlaybackStalledNotification object:_player.currentItem];
-		[defaultCenter removeObserver:self name:AVPlayerItemNewAccessLogEntryNotification object:_player.currentItem];
-		[defaultCenter removeObserver:self name:AVPlayerItemNewErrorLogEntryNotification object:_player.currentItem];
-		
-		if (self.playbackStartObserver) {
-			[_player removeTimeObserver:self.playbackStartObserver];
-			self.playbackStartObserver = nil;
-		}
-		
-		if (self.periodicTimeObserver) {
-			[_player removeTimeObserver:self.periodicTimeObserver];
-			self.periodicTimeObserver = nil;
-		}
-		
-		[self unregisterCustomPeriodicTimeObservers];
+		// Time observers are removed with the previous proxy
+		self.playbackStartObserver = nil;
+		self.periodicTimeObserver = nil;
+		self.timeScheduleObservers = nil;
+		self.blackoutBoundaryObserver = nil;
+		self.blackoutTriggerDate = nil;
+		self.observationProxy = nil;
 		
 		_player = player;
+		_indicatedBitRate = 0.;
+		_watchedTime = NAN;
 		
 		AVPlayerItem *playerItem = player.currentItem;
+		[self.trackedTimeRangeSet setTimeRanges:playerItem.loadedTimeRanges];
+		[self updateBufferHealth];
+		
 		if (playerItem) {
-			[player addObserver:self forKeyPath:@"currentItem.status" options:0 context:(void *)AVPlayerItemStatusContext];
-			[player addObserver:self forKeyPath:@"rate" options:NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld context:(void *)AVPlayerRateContext];
-			[player addObserver:self forKeyPath:@"currentItem.playbackLikelyToKeepUp" options:0 context:(void *)AVPlayerItemPlaybackLikelyToKeepUpContext];
-			[player addObserver:self forKeyPath:@"currentItem.loadedTimeRanges" options:NSKeyValueObservingOptionNew context:(void *)AVPlayerItemLoadedTimeRangesContext];
-			[player addObserver:self forKeyPath:@"currentItem.playbackBufferEmpty" options:NSKeyValueObservingOptionNew context:(void *)AVPlayerItemBufferEmptyContext];
+			[self applyAllocatedForwardBufferDurationToPlayerItem:playerItem];
+			playerItem.preferredPeakBitRate = [self effectivePeakBitRate];
+			
+			RTSMediaPlayerObservationProxy *observationProxy = [[RTSMediaPlayerObservationProxy alloc] initWithPlayer:player target:self];
+			[observationProxy addObserverForKeyPath:@"currentItem.status" options:0 context:(void *)AVPlayerItemStatusContext];
+			[observationProxy addObserverForKeyPath:@"rate" options:NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld context:(void *)AVPlayerRateContext];
+			[observationProxy addObserverForKeyPath:@"currentItem.playbackLikelyToKeepUp" options:0 context:(void *)AVPlayerItemPlaybackLikelyToKeepUpContext];
+			[observationProxy addObserverForKeyPath:@"currentItem.loadedTimeRanges" options:NSKeyValueObservingOptionNew context:(void *)AVPlayerItemLoadedTimeRangesContext];
+			[observationProxy addObserverForKeyPath:@"currentItem.playbackBufferEmpty" options:NSKeyValueObservingOptionNew context:(void *)AVPlayerItemBufferEmptyContext];
 			
-			[defaultCenter addObserver:self selector:@selector(playerItemDidPlayToEndTime:) name:AVPlayerItemDidPlayToEndTimeNotification object:playerItem];
-			[defaultCenter addObserver:self selector:@selector(playerItemFailedToPlayToEndTime:) name:AVPlayerItemFailedToPlayToEndTimeNotification object:playerItem];
-			[defaultCenter addObserver:self selector:@selector(playerItemTimeJumped:) name:AVPlayerItemTimeJumpedNotification object:playerItem];
-			[defaultCenter addObserver:self selector:@selector(playerItemPlaybackStalled:) name:AVPlayerItemPlaybackStalledNotification object:playerItem];
-			[defaultCenter addObserver:self selector:@selector(playerItemNewAccessLogEntry:) name:AVPlayerItemNewAccessLogEntryNotification object:playerItem];
-			[defaultCenter addObserver:self selector:@selector(playerItemNewErrorLogEntry:) name:AVPlayerItemNewErrorLogEntryNotification object:playerItem];
+			[observationProxy addObserverForItemNotificationName:AVPlayerItemDidPlayToEndTimeNotification selector:@selector(playerItemDidPlayToEndTime:)];
+			[observationProxy addObserverForItemNotificationName:AVPlayerItemFailedToPlayToEndTimeNotification selector:@selector(playerItemFailedToPlayToEndTime:)];
+			[observationProxy addObserverForItemNotificationName:AVPlayerItemTimeJumpedNotification selector:@selector(playerItemTimeJumped:)];
+			[observationProxy addObserverForItemNotificationName:AVPlayerItemPlaybackStalledNotification selector:@selector(playerItemPlaybackStalled:)];
+			[observationProxy addObserverForItemNotificationName:AVPlayerItemNewAccessLogEntryNotification selector:@selector(playerItemNewAccessLogEntry:)];
+			[observationProxy addObserverForItemNotificationName:AVPlayerItemNewErrorLogEntryNotification selector:@selector(playerItemNewErrorLogEntry:)];
+			self.observationProxy = observationProxy;
 			
 			[self registerPlaybackStartBoundaryObserver];
 			[self registerPlaybackRatePeriodicTimeObserver];
 			[self registerCustomPeriodicTimeObservers];
+			[self registerTimeScheduleObservers];
 		}
+		else {
+			[self unregisterCustomPeriodicTimeObservers];
+		}
+	}
+	
+	[self attachLegibleOutputToPlayerItem:player.currentItem];
+	[self updateBlackout];
+	
+	// Observers are removed first, so that removing the item does not trigger any KVO notification
+	if (previousObservationProxy || stoppedPlayer) {
+		dispatch_async(RTSMediaPlayerReaperQueue(), ^{
+			CFTimeInterval tearDownStartTime = CACurrentMediaTime();
+			[previousObservationProxy tearDown];
+			[stoppedPlayer replaceCurrentItemWithPlayerItem:nil];
+			RTSMediaPlayerLogDebug(@"Previous player torn down in %.3f msec.", (CACurrentMediaTime() - tearDownStartTime) * 1000.);
+		});
 	}
 }
 
 - (void)registerPlaybackStartBoundaryObserver
 {
 	if (self.playbackStartObserver) {
-		[self.player removeTimeObserver:self.playbackStartObserver];
+		[self.observationProxy removeTimeObserver:self.playbackStartObserver];
 		self.playbackStartObserver = nil;
 	}
 	
@@ -767,17 +2462,18 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 	CMTime resultTime  = CMTimeAdd(currentTime,timeToAdd);
 	
 	@weakify(self)
-	self.playbackStartObserver = [self.player addBoundaryTimeObserverForTimes:@[[NSValue valueWithCMTime:resultTime]] queue:NULL usingBlock:^{
+	self.playbackStartObserver = [self.observationProxy addBoundaryTimeObserverForTimes:@[[NSValue valueWithCMTime:resultTime]] queue:NULL usingBlock:^{
 		@strongify(self)
 		
 		// Track information is not immediately available in some cases. Wait just a little before actually sending the playing event
 		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
-			if (![self.stateMachine.currentState isEqual:self.playingState] && ![self.stateMachine.currentState isEqual:self.endedState]) {
+			if (![self.stateMachine.currentState isEqual:self.playingState] && ![self.stateMachine.currentState isEqual:self.endedState]
+					&& ![self.stateMachine.currentState isEqual:self.trickPlayingState]) {
 				[self fireEvent:self.playEvent userInfo:nil];
 			}
 		});
 		
-		[self.player removeTimeObserver:self.playbackStartObserver];
+		[self.observationProxy removeTimeObserver:self.playbackStartObserver];
 		self.playbackStartObserver = nil;
 	}];
 }
@@ -785,15 +2481,22 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 - (void)registerPlaybackRatePeriodicTimeObserver
 {
 	if (self.periodicTimeObserver) {
-		[self.player removeTimeObserver:self.periodicTimeObserver];
+		[self.observationProxy removeTimeObserver:self.periodicTimeObserver];
 		self.periodicTimeObserver = nil;
 	}
 	
 	@weakify(self)
-	self.periodicTimeObserver = [self.player addPeriodicTimeObserverForInterval:CMTimeMake(1, 10) queue:dispatch_get_main_queue() usingBlock:^(CMTime playbackTime) {
+	self.periodicTimeObserver = [self.observationProxy addPeriodicTimeObserverForInterval:CMTimeMake(1, 10) queue:dispatch_get_main_queue() usingBlock:^(CMTime playbackTime) {
 		@strongify(self)
 		
-		if (self.player.rate == 0) {
+		// The buffer drains as the playhead moves, even if no new loaded time ranges are received
+		[self updateBufferHealth];
+		[self updateWatchedTimeRangesWithTime:playbackTime];
+		[self updateBlackout];
+		[self updateStepWithTime:playbackTime];
+		
+		// The playhead moves backwards or by jumps while trick playing
+		if (self.player.rate == 0 || [self.stateMachine.currentState isEqual:self.trickPlayingState]) {
 			return;
 		}
 		
@@ -816,10 +2519,9 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 
 #pragma mark - Custom Periodic Observers
 
+// Observers already attached to the previous player switch to the new one without being stopped
 - (void)registerCustomPeriodicTimeObservers
 {
-	[self unregisterCustomPeriodicTimeObservers];
-	
 	for (RTSPeriodicTimeObserver *playbackBlockRegistration in [self.periodicTimeObservers allValues]) {
 		[playbackBlockRegistration attachToMediaPlayer:self.player];
 	}
@@ -870,6 +2572,101 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 	return periodicTimeObserver;
 }
 
+#pragma mark - Boundary and time range observers
+
+- (void)registerTimeScheduleObservers
+{
+	[self unregisterTimeScheduleObservers];
+	
+	if (!self.observationProxy) {
+		return;
+	}
+	
+	// One AVPlayer observer per time, so that the schedule knows which time has been reached without polling
+	NSMutableArray *timeScheduleObservers = [NSMutableArray array];
+	for (NSValue *timeValue in self.timeSchedule.boundaryTimes) {
+		@weakify(self)
+		id timeScheduleObserver = [self.observationProxy addBoundaryTimeObserverForTimes:@[timeValue] queue:NULL usingBlock:^{
+			@strongify(self)
+			
+			// Ignore late notifications for times the schedule has already been moved past, i.e. times which do not lie
+			// between the last time known to the schedule and the current time. The playback rate cannot be used, since the
+			// player might have been paused meanwhile
+			CMTime time = [timeValue CMTimeValue];
+			CMTime scheduleTime = self.timeSchedule.currentTime;
+			CMTime currentTime = self.player.currentTime;
+			if (CMTIME_IS_NUMERIC(scheduleTime) && CMTIME_IS_NUMERIC(currentTime)) {
+				CMTime tolerance = CMTimeMakeWithSeconds(RTSMediaBoundaryTimeTolerance, NSEC_PER_SEC);
+				BOOL forward = (CMTimeCompare(currentTime, scheduleTime) >= 0);
+				BOOL crossed = forward ? (CMTimeCompare(time, scheduleTime) > 0 && CMTimeCompare(time, CMTimeAdd(currentTime, tolerance)) <= 0)
+					: (CMTimeCompare(time, scheduleTime) < 0 && CMTimeCompare(time, CMTimeSubtract(currentTime, tolerance)) >= 0);
+				if (!crossed) {
+					return;
+				}
+			}
+			
+			[self.timeSchedule playToTime:time];
+		}];
+		[timeScheduleObservers addObject:timeScheduleObserver];
+	}
+	self.timeScheduleObservers = [timeScheduleObservers copy];
+}
+
+- (void)unregisterTimeScheduleObservers
+{
+	for (id timeScheduleObserver in self.timeScheduleObservers) {
+		[self.observationProxy removeTimeObserver:timeScheduleObserver];
+	}
+	self.timeScheduleObservers = nil;
+}
+
+- (void (^)(CMTime))timeBlockWithBlock:(void (^)(CMTime time))block queue:(dispatch_queue_t)queue
+{
+	if (!block) {
+		return nil;
+	}
+	
+	dispatch_queue_t targetQueue = queue ?: dispatch_get_main_queue();
+	return ^(CMTime time) {
+		dispatch_async(targetQueue, ^{
+			block(time);
+		});
+	};
+}
+
+- (id)addBoundaryTimeObserverForTimes:(NSArray<NSValue *> *)times queue:(dispatch_queue_t)queue usingBlock:(void (^)(CMTime time))block
+{
+	if (!block) {
+		return nil;
+	}
+	
+	id identifier = [self.timeSchedule addBoundaryTimes:times usingBlock:[self timeBlockWithBlock:block queue:queue]];
+	[self registerTimeScheduleObservers];
+	return identifier;
+}
+
+- (id)addTimeRangeObserverForTimeRange:(CMTimeRange)timeRange
+								 queue:(dispatch_queue_t)queue
+							enterBlock:(void (^)(CMTime time))enterBlock
+							 exitBlock:(void (^)(CMTime time))exitBlock
+{
+	if (!enterBlock && !exitBlock) {
+		return nil;
+	}
+	
+	id identifier = [self.timeSchedule addTimeRange:timeRange
+										 enterBlock:[self timeBlockWithBlock:enterBlock queue:queue]
+										  exitBlock:[self timeBlockWithBlock:exitBlock queue:queue]];
+	[self registerTimeScheduleObservers];
+	return identifier;
+}
+
+- (void)removeBoundaryTimeObserver:(id)observer
+{
+	[self.timeSchedule removeEntryWithIdentifier:observer];
+	[self registerTimeScheduleObservers];
+}
+
 #pragma mark - KVO
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
@@ -882,12 +2679,27 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 		AVPlayerItem *playerItem = player.currentItem;
 		switch (playerItem.status) {
 			case AVPlayerItemStatusReadyToPlay: {
-				if (playScheduled) {
+				if (self.startLiveOffset) {
+					CMTimeRange timeRange = self.timeRange;
+					if (CMTIMERANGE_IS_VALID(timeRange) && !CMTIMERANGE_IS_EMPTY(timeRange)) {
+						// Stay at least slightly after the window start, a zero start time means starting live
+						CMTime startTime = CMTimeSubtract(CMTimeRangeGetEnd(timeRange), CMTimeMakeWithSeconds(self.startLiveOffset.doubleValue, NSEC_PER_SEC));
+						startTime = CMTimeMaximum(startTime, CMTimeAdd(timeRange.start, CMTimeMakeWithSeconds(1., 4.)));
+						self.startTimeValue = [NSValue valueWithCMTime:startTime];
+					}
+					self.startLiveOffset = nil;
+				}
+				
+				if (!self.commandQueue.empty) {
+					[self applyPendingCommandsWithAutoStart:(playScheduled || self.startTimeValue != nil)];
+				}
+				else if (playScheduled) {
 					[self fireEvent:self.playEvent userInfo:nil];
 					[self play];
 				}
 				else if (![self.stateMachine.currentState isEqual:self.playingState] && self.startTimeValue) {
-					if (CMTIME_COMPARE_INLINE([self.startTimeValue CMTimeValue], ==, kCMTimeZero) || CMTIME_IS_INVALID([self.startTimeValue CMTimeValue])) {
+					// No seek is needed if the item has been positioned before buffering started
+					if (self.startTimeApplied || CMTIME_COMPARE_INLINE([self.startTimeValue CMTimeValue], ==, kCMTimeZero) || CMTIME_IS_INVALID([self.startTimeValue CMTimeValue])) {
 						[self play];
 					}
 					else {
@@ -921,6 +2733,7 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 			}
 		}
 		self.startTimeValue = nil;
+		self.startTimeApplied = NO;
 	}
 	else if (context == AVPlayerItemLoadedTimeRangesContext) {
 		// Might happen that we get NSNull
@@ -929,22 +2742,18 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 			return;
 		}
 		
-		NSArray *timeRanges = newValue;
-		if (timeRanges.count == 0) {
-			return;
-		}
-		
-		Float64 bufferMinDuration = 5.0f;
+		[self.trackedTimeRangeSet setTimeRanges:newValue];
+		[self updateBufferHealth];
 		
-		CMTimeRange timerange = [timeRanges.firstObject CMTimeRangeValue]; // Yes, subscripting with [0] may lead to a crash??
-		if (CMTimeGetSeconds(timerange.duration) >= bufferMinDuration && self.player.rate == 0) {
+		if (self.bufferHealth == RTSMediaBufferHealthSufficient && self.player.rate == 0) {
 			[self.player prerollAtRate:0.0 completionHandler:^(BOOL finished) {
 				if (self.pauseScheduled) {
 					self.pauseScheduled = NO;
 					[self fireEvent:self.pauseEvent userInfo:nil];
 				}
 				else if (![self.stateMachine.currentState isEqual:self.pausedState] &&
-						 ![self.stateMachine.currentState isEqual:self.seekingState])
+						 ![self.stateMachine.currentState isEqual:self.seekingState] &&
+						 ![self.stateMachine.currentState isEqual:self.trickPlayingState])
 				{
 					[self play];
 				}
@@ -959,15 +2768,25 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 			return;
 		}
 		
-		AVPlayer *player = object;
-		AVPlayerItem *playerItem = player.currentItem;
+		// Nothing loaded yet
+		if (self.trackedTimeRangeSet.count == 0) {
+			return;
+		}
 		
-		if (playerItem.loadedTimeRanges.count == 0) {
+		// Rates are set by `-playAtRate:` while trick playing. The player only stops by itself when reaching the beginning
+		// of the media in reverse
+		if ([self.stateMachine.currentState isEqual:self.trickPlayingState]) {
+			if (newRate == 0 && !self.trickPlayEmulated) {
+				[self fireEvent:self.pauseEvent userInfo:nil];
+			}
 			return;
 		}
 		
-		CMTimeRange timerange = [playerItem.loadedTimeRanges.firstObject CMTimeRangeValue]; // Yes, subscripting with [0] may lead to a crash??
-		BOOL stoppedManually = CMTimeGetSeconds(timerange.duration) > 0;
+		// The player only stopped manually if media has been loaded at the start of the loaded time ranges. Empty ranges
+		// are not tracked, the first one reported by the item is therefore read (rate changes are rare)
+		AVPlayer *player = object;
+		CMTimeRange timeRange = [player.currentItem.loadedTimeRanges.firstObject CMTimeRangeValue];
+		BOOL stoppedManually = CMTimeGetSeconds(timeRange.duration) > 0;
 		
 		if (oldRate == 1 && newRate == 0 && stoppedManually) {
 			[self fireEvent:self.pauseEvent userInfo:nil];
@@ -1026,6 +2845,17 @@ static const void * const AVPlayerItemBufferEmptyContext = &AVPlayerItemBufferEm
 - (void) playerItemTimeJumped:(NSNotification *)notification
 {
 	RTSMediaPlayerLogVerbose(@"playerItemTimeJumped: %@", notification.userInfo);
+	
+	// Boundaries located between the previous and the new positions must not be reported
+	dispatch_async(dispatch_get_main_queue(), ^{
+		[self.timeSchedule jumpToTime:self.player.currentTime];
+		[self updateStepWithTime:self.player.currentTime];
+		self.watchedTime = NAN;
+		
+		// Program dates do not map to the same item times anymore
+		[self cancelBlackoutUpdate];
+		[self updateBlackout];
+	});
 }
 
 - (void) playerItemPlaybackStalled:(NSNotification *)notification
@@ -1049,7 +2879,30 @@ static void LogProperties(id object)
 {
 	RTSMediaPlayerLogVerbose(@"playerItemNewAccessLogEntry: %@", notification.userInfo);
 	AVPlayerItem *playerItem = notification.object;
-	LogProperties(playerItem.accessLog.events.lastObject);
+	AVPlayerItemAccessLogEvent *event = playerItem.accessLog.events.lastObject;
+	LogProperties(event);
+	
+	// Access log notifications might be received on a background thread
+	double indicatedBitRate = event.indicatedBitrate;
+	double observedBitRate = event.observedBitrate;
+	NSString *playlist = event.URI ? RTSMediaPlayerPlaylistKey([NSURL URLWithString:event.URI]) : nil;
+	dispatch_async(dispatch_get_main_queue(), ^{
+		if (indicatedBitRate > 0. && indicatedBitRate != self.indicatedBitRate) {
+			self.indicatedBitRate = indicatedBitRate;
+			[self.bufferBudget setNeedsRebalance];
+		}
+		[self.playlistRewriter reportObservedBandwidth:observedBitRate];
+		
+		// Apply the time ranges removed from the variant now being played
+		if (playerItem == self.playerItem && playlist && ![playlist isEqualToString:self.playedPlaylist]) {
+			self.playedPlaylist = playlist;
+			
+			NSArray<NSValue *> *removedTimeRanges = self.removedTimeRangesByPlaylist[playlist];
+			if (removedTimeRanges) {
+				[self.segmentsController setRemovedTimeRanges:removedTimeRanges];
+			}
+		}
+	});
 }
 
 - (void) playerItemNewErrorLogEntry:(NSNotification *)notification
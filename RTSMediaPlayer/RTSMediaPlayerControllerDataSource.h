@@ -28,4 +28,21 @@
 		  completionHandler:(void (^)(NSString *identifier, NSURL *contentURL, NSError *error))completionHandler;
 - (void)cancelContentURLRequest:(id)request;
 
+@optional
+
+/**
+ *  Method called when a controller recovering from a stall needs another URL for the media being played (e.g. from
+ *  another CDN), see `stallRecoverySteps`
+ *
+ *  @param mediaPlayerController The media player controller making the request
+ *  @param identifier            The identifier of the media being played
+ *  @param failedContentURL      The URL whose playback stalled
+ *  @param completionHandler     The block which the implementation must call on the main thread to return another
+ *                               URL, or nil if none is available
+ */
+- (void)mediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+alternateContentURLForIdentifier:(NSString *)identifier
+			 failedContentURL:(NSURL *)failedContentURL
+			completionHandler:(void (^)(NSURL *contentURL))completionHandler;
+
 @end
@@ -0,0 +1,62 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+
+/**
+ *  An observation proxy registers KVO, notification and time observers on a player on behalf of a target, and forwards
+ *  callbacks to it as long as it is valid. Once invalidated, which can be done cheaply on the main thread, no callback
+ *  reaches the target anymore, even if it was already in flight. The actual (and more expensive) removal of observers,
+ *  as well as the release of the player, can then be performed later on a background queue with `-tearDown`
+ */
+@interface RTSMediaPlayerObservationProxy : NSObject
+
+/**
+ *  Create a proxy for the specified player, forwarding callbacks to a target (weakly referenced)
+ */
+- (instancetype)initWithPlayer:(AVPlayer *)player target:(NSObject *)target NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The observed player, nil after tear down
+ */
+@property (nonatomic, readonly) AVPlayer *player;
+
+/**
+ *  Observe a key path of the player. Changes are forwarded to `-observeValueForKeyPath:ofObject:change:context:` of
+ *  the target, with the player as object
+ */
+- (void)addObserverForKeyPath:(NSString *)keyPath options:(NSKeyValueObservingOptions)options context:(void *)context;
+
+/**
+ *  Observe a notification posted by the current item of the player. Notifications are forwarded to the target using
+ *  the specified selector
+ */
+- (void)addObserverForItemNotificationName:(NSString *)notificationName selector:(SEL)selector;
+
+/**
+ *  Add and remove player time observers. Blocks are not called anymore after invalidation
+ */
+- (id)addBoundaryTimeObserverForTimes:(NSArray<NSValue *> *)times queue:(dispatch_queue_t)queue usingBlock:(void (^)(void))block;
+- (id)addPeriodicTimeObserverForInterval:(CMTime)interval queue:(dispatch_queue_t)queue usingBlock:(void (^)(CMTime time))block;
+- (void)removeTimeObserver:(id)observer;
+
+/**
+ *  Return YES iff callbacks are forwarded to the target
+ */
+@property (nonatomic, readonly, getter=isValid) BOOL valid;
+
+/**
+ *  Stop forwarding callbacks. When this method returns, no callback is being forwarded and none will be anymore
+ */
+- (void)invalidate;
+
+/**
+ *  Invalidate the proxy, remove all observers and release the player. Can be called from any thread
+ */
+- (void)tearDown;
+
+@end
@@ -0,0 +1,200 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlayerObservationProxy.h"
+
+#import <libextobjc/EXTScope.h>
+
+@interface RTSMediaPlayerObservationProxy ()
+
+@property (nonatomic) AVPlayer *player;
+@property (nonatomic) AVPlayerItem *playerItem;
+@property (nonatomic, weak) NSObject *target;
+
+@property (nonatomic) NSMutableArray<NSDictionary *> *keyPathRegistrations;
+@property (nonatomic) NSMutableDictionary<NSString *, NSString *> *notificationSelectorNames;
+@property (nonatomic) NSMutableArray *timeObservers;
+
+@property (atomic, getter=isValid) BOOL valid;
+@property (nonatomic, getter=isTornDown) BOOL tornDown;
+
+@end
+
+@implementation RTSMediaPlayerObservationProxy
+
+#pragma mark - Object lifecycle
+
+- (instancetype)initWithPlayer:(AVPlayer *)player target:(NSObject *)target
+{
+	if (self = [super init]) {
+		self.player = player;
+		self.playerItem = player.currentItem;
+		self.target = target;
+		self.keyPathRegistrations = [NSMutableArray array];
+		self.notificationSelectorNames = [NSMutableDictionary dictionary];
+		self.timeObservers = [NSMutableArray array];
+		self.valid = YES;
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithPlayer:nil target:nil];
+}
+
+- (void)dealloc
+{
+	[self tearDown];
+}
+
+#pragma mark - Registration
+
+- (void)addObserverForKeyPath:(NSString *)keyPath options:(NSKeyValueObservingOptions)options context:(void *)context
+{
+	[self.player addObserver:self forKeyPath:keyPath options:options context:context];
+	[self.keyPathRegistrations addObject:@{ @"keyPath" : keyPath, @"context" : [NSValue valueWithPointer:context] }];
+}
+
+- (void)addObserverForItemNotificationName:(NSString *)notificationName selector:(SEL)selector
+{
+	if (!self.playerItem) {
+		return;
+	}
+
+	@synchronized(self) {
+		self.notificationSelectorNames[notificationName] = NSStringFromSelector(selector);
+	}
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(forwardNotification:) name:notificationName object:self.playerItem];
+}
+
+// Time observers are called on the main queue, where the proxy is invalidated, so that no block can run after invalidation
+- (id)addBoundaryTimeObserverForTimes:(NSArray<NSValue *> *)times queue:(dispatch_queue_t)queue usingBlock:(void (^)(void))block
+{
+	NSParameterAssert(!queue || queue == dispatch_get_main_queue());
+
+	@weakify(self)
+	id timeObserver = [self.player addBoundaryTimeObserverForTimes:times queue:NULL usingBlock:^{
+		@strongify(self)
+		if (self.valid) {
+			block();
+		}
+	}];
+	[self.timeObservers addObject:timeObserver];
+	return timeObserver;
+}
+
+- (id)addPeriodicTimeObserverForInterval:(CMTime)interval queue:(dispatch_queue_t)queue usingBlock:(void (^)(CMTime time))block
+{
+	NSParameterAssert(!queue || queue == dispatch_get_main_queue());
+
+	@weakify(self)
+	id timeObserver = [self.player addPeriodicTimeObserverForInterval:interval queue:NULL usingBlock:^(CMTime time) {
+		@strongify(self)
+		if (self.valid) {
+			block(time);
+		}
+	}];
+	[self.timeObservers addObject:timeObserver];
+	return timeObserver;
+}
+
+- (void)removeTimeObserver:(id)observer
+{
+	if (!observer || ![self.timeObservers containsObject:observer]) {
+		return;
+	}
+
+	[self.player removeTimeObserver:observer];
+	[self.timeObservers removeObject:observer];
+}
+
+#pragma mark - Invalidation and tear down
+
+- (void)invalidate
+{
+	self.valid = NO;
+}
+
+- (void)tearDown
+{
+	self.valid = NO;
+
+	@synchronized(self) {
+		if (self.tornDown) {
+			return;
+		}
+		self.tornDown = YES;
+
+		for (NSDictionary *keyPathRegistration in self.keyPathRegistrations) {
+			[self.player removeObserver:self forKeyPath:keyPathRegistration[@"keyPath"] context:[keyPathRegistration[@"context"] pointerValue]];
+		}
+		[self.keyPathRegistrations removeAllObjects];
+
+		[[NSNotificationCenter defaultCenter] removeObserver:self];
+		[self.notificationSelectorNames removeAllObjects];
+
+		for (id timeObserver in self.timeObservers) {
+			[self.player removeTimeObserver:timeObserver];
+		}
+		[self.timeObservers removeAllObjects];
+
+		self.playerItem = nil;
+		self.player = nil;
+	}
+}
+
+#pragma mark - Forwarding
+
+// Callbacks are always forwarded on the main thread, where invalidation is made. Callbacks received on other threads
+// are checked again once on the main thread
+- (void)forwardOnMainThread:(void (^)(NSObject *target))block
+{
+	if ([NSThread isMainThread]) {
+		NSObject *target = self.target;
+		if (self.valid && target) {
+			block(target);
+		}
+	}
+	else {
+		@weakify(self)
+		dispatch_async(dispatch_get_main_queue(), ^{
+			@strongify(self)
+			NSObject *target = self.target;
+			if (self.valid && target) {
+				block(target);
+			}
+		});
+	}
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+	[self forwardOnMainThread:^(NSObject *target) {
+		[target observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+	}];
+}
+
+- (void)forwardNotification:(NSNotification *)notification
+{
+	NSString *selectorName = nil;
+	@synchronized(self) {
+		selectorName = self.notificationSelectorNames[notification.name];
+	}
+	if (!selectorName) {
+		return;
+	}
+
+	SEL selector = NSSelectorFromString(selectorName);
+	[self forwardOnMainThread:^(NSObject *target) {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+		[target performSelector:selector withObject:notification];
+#pragma clang diagnostic pop
+	}];
+}
+
+@end
@@ -0,0 +1,128 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+@class RTSMediaPlayerStallWatchdog;
+
+/**
+ *  Actions taken to recover from a stall
+ */
+typedef NS_ENUM(NSInteger, RTSMediaPlayerStallRecoveryAction) {
+	/**
+	 *  Wait for the buffer to fill again
+	 */
+	RTSMediaPlayerStallRecoveryActionWait = 0,
+	/**
+	 *  Cap the peak bit rate so that a lighter variant is played
+	 */
+	RTSMediaPlayerStallRecoveryActionCapBitRate,
+	/**
+	 *  Rebuild the player item at the current position
+	 */
+	RTSMediaPlayerStallRecoveryActionRebuildItem,
+	/**
+	 *  Rebuild the player item at the current position, with another URL (e.g. from another CDN)
+	 */
+	RTSMediaPlayerStallRecoveryActionSwitchURL
+};
+
+/**
+ *  A step of the stall recovery escalation: an action, performed when the step is reached, and the time given to the
+ *  action to let playback resume before the next step is reached
+ */
+@interface RTSMediaPlayerStallRecoveryStep : NSObject <NSCopying>
+
++ (RTSMediaPlayerStallRecoveryStep *)stepWithAction:(RTSMediaPlayerStallRecoveryAction)action timeout:(NSTimeInterval)timeout;
+
+@property (nonatomic, readonly) RTSMediaPlayerStallRecoveryAction action;
+@property (nonatomic, readonly) NSTimeInterval timeout;
+
+/**
+ *  For `RTSMediaPlayerStallRecoveryActionCapBitRate` steps, the peak bit rate applied, in bits per second. Set to 0
+ *  (the default) to cap at half the bit rate of the variant being played
+ */
+@property (nonatomic) double peakBitRate;
+
+@end
+
+/**
+ *  Protocol through which a watchdog has recovery actions performed
+ */
+@protocol RTSMediaPlayerStallWatchdogDelegate <NSObject>
+
+/**
+ *  Perform the action of a step. Return NO if the action cannot be performed (e.g. no other URL available), in which
+ *  case the next step is immediately reached
+ */
+- (BOOL)stallWatchdog:(RTSMediaPlayerStallWatchdog *)stallWatchdog performRecoveryStep:(RTSMediaPlayerStallRecoveryStep *)step;
+
+@optional
+
+/**
+ *  Called when playback has resumed after a stall, with the stall duration and the last action performed
+ */
+- (void)stallWatchdog:(RTSMediaPlayerStallWatchdog *)stallWatchdog didRecoverAfterDuration:(NSTimeInterval)duration lastAction:(RTSMediaPlayerStallRecoveryAction)lastAction;
+
+@end
+
+/**
+ *  A stall watchdog escalates through recovery steps while playback is stalled. Each step is performed when the timeout
+ *  of the previous one elapses without playback having resumed. Once the last step has timed out, the watchdog waits
+ *  until playback resumes or the stall is cancelled.
+ *
+ *  The watchdog is informed of stalls by its owner, which performs the actions as its delegate. It must be used from
+ *  the main thread
+ */
+@interface RTSMediaPlayerStallWatchdog : NSObject
+
+/**
+ *  Wait 2 seconds, cap the bit rate for 4 seconds, rebuild the item and wait 6 seconds, then switch URL and wait 10
+ *  seconds
+ */
++ (NSArray<RTSMediaPlayerStallRecoveryStep *> *)defaultSteps;
+
+/**
+ *  Create a watchdog escalating through the specified steps. `-init` uses the default steps
+ */
+- (instancetype)initWithSteps:(NSArray<RTSMediaPlayerStallRecoveryStep *> *)steps NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, copy) NSArray<RTSMediaPlayerStallRecoveryStep *> *steps;
+
+@property (nonatomic, weak) id<RTSMediaPlayerStallWatchdogDelegate> delegate;
+
+/**
+ *  Inform the watchdog that playback stalled. Does nothing if a stall is already being recovered from, e.g. when the
+ *  rebuilt item stalls again
+ */
+- (void)stallDidStart;
+
+/**
+ *  Inform the watchdog that playback resumed, ending the current stall
+ */
+- (void)stallDidEnd;
+
+/**
+ *  End the current stall without recovery (e.g. the user paused or stopped playback). The delegate is not called
+ */
+- (void)cancel;
+
+/**
+ *  Return YES iff a stall is being recovered from
+ */
+@property (nonatomic, readonly, getter=isStalled) BOOL stalled;
+
+/**
+ *  The index of the step reached during the current stall, `NSNotFound` if none
+ */
+@property (nonatomic, readonly) NSUInteger currentStepIndex;
+
+/**
+ *  The duration of the current stall, 0 if none
+ */
+@property (nonatomic, readonly) NSTimeInterval stallDuration;
+
+@end
@@ -0,0 +1,221 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlayerStallWatchdog.h"
+
+#import <libextobjc/EXTScope.h>
+#import <QuartzCore/QuartzCore.h>
+
+#import "RTSMediaPlayerLogger+Private.h"
+
+static NSString *RTSMediaPlayerStallRecoveryActionName(RTSMediaPlayerStallRecoveryAction action)
+{
+	switch (action) {
+		case RTSMediaPlayerStallRecoveryActionWait: {
+			return @"wait";
+		}
+
+		case RTSMediaPlayerStallRecoveryActionCapBitRate: {
+			return @"cap bit rate";
+		}
+
+		case RTSMediaPlayerStallRecoveryActionRebuildItem: {
+			return @"rebuild item";
+		}
+
+		case RTSMediaPlayerStallRecoveryActionSwitchURL: {
+			return @"switch URL";
+		}
+	}
+}
+
+@interface RTSMediaPlayerStallRecoveryStep ()
+
+@property (nonatomic) RTSMediaPlayerStallRecoveryAction action;
+@property (nonatomic) NSTimeInterval timeout;
+
+@end
+
+@implementation RTSMediaPlayerStallRecoveryStep
+
++ (RTSMediaPlayerStallRecoveryStep *)stepWithAction:(RTSMediaPlayerStallRecoveryAction)action timeout:(NSTimeInterval)timeout
+{
+	RTSMediaPlayerStallRecoveryStep *step = [[RTSMediaPlayerStallRecoveryStep alloc] init];
+	step.action = action;
+	step.timeout = MAX(timeout, 0.);
+	return step;
+}
+
+#pragma mark - NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	RTSMediaPlayerStallRecoveryStep *step = [RTSMediaPlayerStallRecoveryStep stepWithAction:self.action timeout:self.timeout];
+	step.peakBitRate = self.peakBitRate;
+	return step;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; action: %@; timeout: %.2f>",
+			[self class],
+			self,
+			RTSMediaPlayerStallRecoveryActionName(self.action),
+			self.timeout];
+}
+
+@end
+
+@interface RTSMediaPlayerStallWatchdog ()
+
+@property (nonatomic, copy) NSArray<RTSMediaPlayerStallRecoveryStep *> *steps;
+
+@property (nonatomic) NSUInteger currentStepIndex;
+@property (nonatomic) CFTimeInterval stallStartTime;
+@property (nonatomic) RTSMediaPlayerStallRecoveryAction lastAction;
+
+@property (nonatomic, readonly) dispatch_source_t stepTimer;
+
+@end
+
+@implementation RTSMediaPlayerStallWatchdog
+
+@synthesize stepTimer = _stepTimer;
+
+#pragma mark - Class methods
+
++ (NSArray<RTSMediaPlayerStallRecoveryStep *> *)defaultSteps
+{
+	return @[ [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionWait timeout:2.],
+			  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionCapBitRate timeout:4.],
+			  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionRebuildItem timeout:6.],
+			  [RTSMediaPlayerStallRecoveryStep stepWithAction:RTSMediaPlayerStallRecoveryActionSwitchURL timeout:10.] ];
+}
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithSteps:[RTSMediaPlayerStallWatchdog defaultSteps]];
+}
+
+- (instancetype)initWithSteps:(NSArray<RTSMediaPlayerStallRecoveryStep *> *)steps
+{
+	if (self = [super init]) {
+		self.steps = [[NSArray alloc] initWithArray:steps copyItems:YES];
+		self.currentStepIndex = NSNotFound;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	if (_stepTimer) {
+		dispatch_source_cancel(_stepTimer);
+	}
+}
+
+#pragma mark - Getters and setters
+
+- (BOOL)isStalled
+{
+	return self.stallStartTime != 0.;
+}
+
+- (NSTimeInterval)stallDuration
+{
+	return self.stalled ? CACurrentMediaTime() - self.stallStartTime : 0.;
+}
+
+- (dispatch_source_t)stepTimer
+{
+	if (!_stepTimer) {
+		_stepTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+		dispatch_source_set_timer(_stepTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+		@weakify(self)
+		dispatch_source_set_event_handler(_stepTimer, ^{
+			@strongify(self)
+			[self performStepAtIndex:self.currentStepIndex + 1];
+		});
+		dispatch_resume(_stepTimer);
+	}
+	return _stepTimer;
+}
+
+#pragma mark - Stalls
+
+- (void)stallDidStart
+{
+	if (self.stalled) {
+		return;
+	}
+
+	RTSMediaPlayerLogInfo(@"Playback stalled, recovering");
+	self.stallStartTime = CACurrentMediaTime();
+	self.lastAction = RTSMediaPlayerStallRecoveryActionWait;
+	[self performStepAtIndex:0];
+}
+
+- (void)stallDidEnd
+{
+	if (!self.stalled) {
+		return;
+	}
+
+	NSTimeInterval stallDuration = self.stallDuration;
+	RTSMediaPlayerStallRecoveryAction lastAction = self.lastAction;
+	[self cancel];
+
+	RTSMediaPlayerLogInfo(@"Playback recovered from stall in %.3f sec. (last action: %@)", stallDuration, RTSMediaPlayerStallRecoveryActionName(lastAction));
+	if ([self.delegate respondsToSelector:@selector(stallWatchdog:didRecoverAfterDuration:lastAction:)]) {
+		[self.delegate stallWatchdog:self didRecoverAfterDuration:stallDuration lastAction:lastAction];
+	}
+}
+
+- (void)cancel
+{
+	if (_stepTimer) {
+		dispatch_source_set_timer(_stepTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+	}
+
+	self.stallStartTime = 0.;
+	self.currentStepIndex = NSNotFound;
+}
+
+// Steps whose action cannot be performed are skipped
+- (void)performStepAtIndex:(NSUInteger)index
+{
+	for (NSUInteger i = index; i < self.steps.count; ++i) {
+		RTSMediaPlayerStallRecoveryStep *step = self.steps[i];
+		self.currentStepIndex = i;
+
+		if (![self.delegate stallWatchdog:self performRecoveryStep:step]) {
+			RTSMediaPlayerLogDebug(@"Stall recovery step %@ (%@) skipped", @(i), RTSMediaPlayerStallRecoveryActionName(step.action));
+			continue;
+		}
+
+		// The delegate might have ended or cancelled the stall
+		if (!self.stalled) {
+			return;
+		}
+
+		RTSMediaPlayerLogDebug(@"Stall recovery step %@ (%@) performed after %.3f sec.", @(i), RTSMediaPlayerStallRecoveryActionName(step.action), self.stallDuration);
+		self.lastAction = step.action;
+
+		int64_t timeoutInNanoseconds = step.timeout * NSEC_PER_SEC;
+		dispatch_source_set_timer(self.stepTimer, dispatch_time(DISPATCH_TIME_NOW, timeoutInNanoseconds), DISPATCH_TIME_FOREVER, 0);
+		return;
+	}
+
+	// All steps exhausted. Wait until playback resumes
+	if (_stepTimer) {
+		dispatch_source_set_timer(_stepTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+	}
+}
+
+@end
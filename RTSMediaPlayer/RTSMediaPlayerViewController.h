@@ -6,6 +6,7 @@
 
 #import <UIKit/UIKit.h>
 
+@class RTSMediaPlayerController;
 @protocol RTSMediaPlayerControllerDataSource;
 
 /**
@@ -31,4 +32,19 @@
  */
 - (instancetype) initWithContentIdentifier:(NSString *)identifier dataSource:(id<RTSMediaPlayerControllerDataSource>)dataSource OS_NONNULL_ALL;
 
+/**
+ *  Returns an `RTSMediaPlayerViewController` object taking over playback from an existing controller (e.g. an inline
+ *  player), without interrupting it. See `-[RTSMediaPlayerController takeOverPlaybackFromMediaPlayerController:]`. If
+ *  the handoff is not possible, the media of the controller is played from its current position
+ *
+ *  @param mediaPlayerController The controller to take playback over from
+ */
+- (instancetype) initWithMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController OS_NONNULL_ALL;
+
+/**
+ *  The controller used for playback. To hand playback back to another controller when the view controller is dismissed,
+ *  call `-takeOverPlaybackFromMediaPlayerController:` on it with this controller
+ */
+@property (nonatomic, readonly) RTSMediaPlayerController *mediaPlayerController;
+
 @end
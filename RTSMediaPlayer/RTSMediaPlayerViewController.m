@@ -25,6 +25,7 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 
 @property (nonatomic, weak) id<RTSMediaPlayerControllerDataSource> dataSource;
 @property (nonatomic, strong) NSString *identifier;
+@property (nonatomic) RTSMediaPlayerController *handoffMediaPlayerController;
 
 @property (nonatomic, weak) IBOutlet UIView *navigationBarView;
 @property (nonatomic, weak) IBOutlet UIView *bottomBarView;
@@ -43,6 +44,11 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 @property (weak) IBOutlet NSLayoutConstraint *valueLabelWidthConstraint;
 @property (weak) IBOutlet NSLayoutConstraint *timeLeftValueLabelWidthConstraint;
 
+// Bound UI state. Views are only updated when these values change
+@property (nonatomic) BOOL timeSliderHidden;
+@property (nonatomic) BOOL hourLabelsDisplayed;
+@property (nonatomic) BOOL liveButtonVisible;
+
 @end
 
 @implementation RTSMediaPlayerViewController
@@ -72,6 +78,17 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 	return self;
 }
 
+- (instancetype)initWithMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	id<RTSMediaPlayerControllerDataSource> dataSource = (mediaPlayerController.dataSource == (id)mediaPlayerController) ? self : mediaPlayerController.dataSource;
+	if (!(self = [self initWithContentIdentifier:mediaPlayerController.identifier dataSource:dataSource]))
+		return nil;
+	
+	_handoffMediaPlayerController = mediaPlayerController;
+	
+	return self;
+}
+
 - (void)dealloc
 {
     s_mediaPlayerController.overlayViews = nil;
@@ -80,6 +97,13 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 	[[UIApplication sharedApplication] setStatusBarHidden:NO];
 }
 
+#pragma mark - Getters and setters
+
+- (RTSMediaPlayerController *)mediaPlayerController
+{
+	return s_mediaPlayerController;
+}
+
 #pragma mark - View lifecycle
 
 - (void)viewDidLoad
@@ -106,10 +130,22 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
                                                  name:UIApplicationDidBecomeActiveNotification
                                                object:nil];
 	
-	[s_mediaPlayerController setDataSource:self.dataSource];
-	
 	[s_mediaPlayerController attachPlayerToView:self.view];
-	[s_mediaPlayerController playIdentifier:self.identifier];
+	
+	RTSMediaPlayerController *handoffMediaPlayerController = self.handoffMediaPlayerController;
+	self.handoffMediaPlayerController = nil;
+	
+	if (![s_mediaPlayerController takeOverPlaybackFromMediaPlayerController:handoffMediaPlayerController]) {
+		[s_mediaPlayerController setDataSource:self.dataSource];
+		
+		AVPlayerItem *playerItem = handoffMediaPlayerController.playerItem;
+		if (playerItem) {
+			[s_mediaPlayerController playIdentifier:self.identifier atTime:playerItem.currentTime];
+		}
+		else {
+			[s_mediaPlayerController playIdentifier:self.identifier];
+		}
+	}
     
     s_mediaPlayerController.activityView = self.view;
     s_mediaPlayerController.overlayViews = @[self.navigationBarView, self.bottomBarView, self.volumeView, self.liveButton];
@@ -125,27 +161,17 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 	self.liveButton.layer.borderColor = [UIColor whiteColor].CGColor;
 	self.liveButton.layer.borderWidth = 1.f;
 	
-	// Hide the time slider while the stream type is unknown (i.e. the needed slider label size cannot be determined)
-	[self setTimeSliderHidden:YES];
+	// Hide the time slider while the stream type is unknown (i.e. the needed slider label size cannot be determined). The
+	// initial values of other bound properties match the nib
+	_timeSliderHidden = NO;
+	self.timeSliderHidden = YES;
 	
+	// The live state changes as the playhead moves, and must therefore be periodically checked. Views are only touched
+	// when a bound value actually changes
 	@weakify(self)
 	[s_mediaPlayerController addPeriodicTimeObserverForInterval:CMTimeMakeWithSeconds(1., 5.) queue:NULL usingBlock:^(CMTime time) {
 		@strongify(self)
-		
-		if (s_mediaPlayerController.streamType != RTSMediaStreamTypeUnknown) {
-			CGFloat labelWidth = (CMTimeGetSeconds(s_mediaPlayerController.timeRange.duration) >= 60. * 60.) ? 56.f : 45.f;
-			self.valueLabelWidthConstraint.constant = labelWidth;
-			self.timeLeftValueLabelWidthConstraint.constant = labelWidth;
-			
-			if (s_mediaPlayerController.playbackState != RTSMediaPlaybackStateSeeking) {
-				[self updateLiveButton];
-			}
-			
-			[self setTimeSliderHidden:NO];
-		}
-		else {
-			[self setTimeSliderHidden:YES];
-		}
+		[self updateBindings];
 	}];
 }
 
@@ -158,8 +184,37 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 	}
 }
 
+#pragma mark - Bindings
+
+- (void)updateBindings
+{
+	RTSMediaStreamType streamType = s_mediaPlayerController.streamType;
+	self.timeSliderHidden = (streamType == RTSMediaStreamTypeUnknown);
+	if (streamType == RTSMediaStreamTypeUnknown) {
+		return;
+	}
+	
+	self.hourLabelsDisplayed = (CMTimeGetSeconds(s_mediaPlayerController.timeRange.duration) >= 60. * 60.);
+	
+	// Keep the live button as is while seeking, the slider position is not reliable yet
+	if (s_mediaPlayerController.playbackState != RTSMediaPlaybackStateSeeking) {
+		[self updateLiveButtonVisibility];
+	}
+}
+
+- (void)updateLiveButtonVisibility
+{
+	self.liveButtonVisible = (s_mediaPlayerController.streamType == RTSMediaStreamTypeDVR && !self.timeSlider.live);
+}
+
 - (void)setTimeSliderHidden:(BOOL)hidden
 {
+	if (_timeSliderHidden == hidden) {
+		return;
+	}
+	
+	_timeSliderHidden = hidden;
+	
 	self.timeSlider.timeLeftValueLabel.hidden = hidden;
 	self.timeSlider.valueLabel.hidden = hidden;
 	self.timeSlider.hidden = hidden;
@@ -174,23 +229,35 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 	self.loadingLabel.hidden = !hidden;
 }
 
-- (UIStatusBarStyle)preferredStatusBarStyle
+- (void)setHourLabelsDisplayed:(BOOL)hourLabelsDisplayed
 {
-	return UIStatusBarStyleDefault;
+	if (_hourLabelsDisplayed == hourLabelsDisplayed) {
+		return;
+	}
+	
+	_hourLabelsDisplayed = hourLabelsDisplayed;
+	
+	CGFloat labelWidth = hourLabelsDisplayed ? 56.f : 45.f;
+	self.valueLabelWidthConstraint.constant = labelWidth;
+	self.timeLeftValueLabelWidthConstraint.constant = labelWidth;
 }
 
-#pragma mark - UI
-
-- (void)updateLiveButton
+- (void)setLiveButtonVisible:(BOOL)liveButtonVisible
 {
-	if (s_mediaPlayerController.streamType == RTSMediaStreamTypeDVR) {
-		[UIView animateWithDuration:0.2 animations:^{
-			self.liveButton.alpha = self.timeSlider.live ? 0.f : 1.f;
-		}];
-	}
-	else {
-		self.liveButton.alpha = 0.f;
+	if (_liveButtonVisible == liveButtonVisible) {
+		return;
 	}
+	
+	_liveButtonVisible = liveButtonVisible;
+	
+	[UIView animateWithDuration:0.2 animations:^{
+		self.liveButton.alpha = liveButtonVisible ? 1.f : 0.f;
+	}];
+}
+
+- (UIStatusBarStyle)preferredStatusBarStyle
+{
+	return UIStatusBarStyleDefault;
 }
 
 #pragma mark - RTSMediaPlayerControllerDataSource
@@ -216,6 +283,9 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 	if (mediaPlayerController.playbackState == RTSMediaPlaybackStateEnded) {
 		[self dismiss:nil];
 	}
+	else {
+		[self updateBindings];
+	}
 }
 
 - (void)mediaPlayerDidShowControlOverlays:(NSNotification *)notification
@@ -250,9 +320,7 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 
 - (IBAction)goToLive:(id)sender
 {
-	[UIView animateWithDuration:0.2 animations:^{
-		self.liveButton.alpha = 0.f;
-	}];
+	self.liveButtonVisible = NO;
 	
 	CMTimeRange timeRange = s_mediaPlayerController.timeRange;
 	if (CMTIMERANGE_IS_INDEFINITE(timeRange) || CMTIMERANGE_IS_EMPTY(timeRange)) {
@@ -264,7 +332,7 @@ static RTSMediaPlayerSharedController *s_mediaPlayerController = nil;
 
 - (IBAction)seek:(id)sender
 {
-	[self updateLiveButton];
+	[self updateLiveButtonVisibility];
 }
 
 @end
@@ -0,0 +1,127 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <UIKit/UIKit.h>
+
+// Forward declarations
+@class RTSMediaPlayerBufferBudget;
+@class RTSMediaPlayerController;
+@protocol RTSMediaPlayerControllerDataSource;
+
+/**
+ *  Default limits applied to the players managed by a zapping controller
+ */
+FOUNDATION_EXTERN NSUInteger const RTSMediaPlayerZappingControllerDefaultNeighbourCount;
+FOUNDATION_EXTERN double const RTSMediaPlayerZappingControllerDefaultNeighbourPeakBitRate;				// In bits per second
+FOUNDATION_EXTERN unsigned long long const RTSMediaPlayerZappingControllerDefaultMaximumBufferBytes;
+
+/**
+ *  Posted when a zap has been completed, i.e. when the media switched to is playing. Use `RTSMediaPlayerZapLatencyUserInfoKey`
+ *  to retrieve the time elapsed since the zap was requested, and `RTSMediaPlayerZapPreBufferedUserInfoKey` to know whether
+ *  a pre-buffered neighbour was used
+ */
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerZappingControllerDidZapNotification;		// Notification name
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerZapLatencyUserInfoKey;					// Key to access the zap latency, in seconds, as an `NSNumber`
+FOUNDATION_EXTERN NSString * const RTSMediaPlayerZapPreBufferedUserInfoKey;				// Key to access an `NSNumber` wrapping a boolean, YES iff a pre-buffered neighbour was used
+
+/**
+ *  A zapping controller switches between the medias of an ordered list (e.g. live TV channels) with minimal latency.
+ *  Besides the media being played, it keeps its neighbours in the list (previous and next medias) resolved and playing,
+ *  muted and at a low bit rate. When zapping to a neighbour, its view and audio are swapped with the ones of the active
+ *  player in a single frame, after which its quality is raised and the set of neighbours is updated around it
+ *
+ *  The memory used by the buffers of all players is bounded by a dedicated buffer budget (see `RTSMediaPlayerBufferBudget`),
+ *  and the bandwidth they use by the peak bit rate applied to neighbours. Zap latency is recorded and reported with
+ *  `RTSMediaPlayerZappingControllerDidZapNotification`
+ */
+@interface RTSMediaPlayerZappingController : NSObject
+
+/**
+ *  Create a zapping controller, retrieving media URLs from the specified data source
+ */
+- (instancetype)initWithDataSource:(id<RTSMediaPlayerControllerDataSource>)dataSource NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The data source used by all players
+ */
+@property (nonatomic, readonly, weak) id<RTSMediaPlayerControllerDataSource> dataSource;
+
+/**
+ *  The ordered list of media identifiers to zap through. The list wraps around
+ */
+@property (nonatomic, copy) NSArray<NSString *> *identifiers;
+
+/**
+ *  The view in which the player view of the active player is displayed. Player views of neighbours are attached below
+ *  it, so that the first frame is immediately available when zapping
+ */
+@property (nonatomic, weak) IBOutlet UIView *containerView;
+
+/**
+ *  The number of neighbours pre-buffered on each side of the media being played. Defaults to `RTSMediaPlayerZappingControllerDefaultNeighbourCount`.
+ *  Set to 0 to disable pre-buffering
+ */
+@property (nonatomic) NSUInteger neighbourCount;
+
+/**
+ *  The peak bit rate applied to neighbours (see `-[RTSMediaPlayerController preferredPeakBitRate]`). Defaults to
+ *  `RTSMediaPlayerZappingControllerDefaultNeighbourPeakBitRate`
+ */
+@property (nonatomic) double neighbourPeakBitRate;
+
+/**
+ *  The peak bit rate applied to the player of the media being played. Defaults to 0 (no limit)
+ */
+@property (nonatomic) double activePeakBitRate;
+
+/**
+ *  The amount of memory which the buffers of all players can use, in bytes. Defaults to `RTSMediaPlayerZappingControllerDefaultMaximumBufferBytes`
+ */
+@property (nonatomic) unsigned long long maximumBufferBytes;
+
+/**
+ *  The budget shared by the players of the zapping controller
+ */
+@property (nonatomic, readonly) RTSMediaPlayerBufferBudget *bufferBudget;
+
+/**
+ *  The identifier of the media being played, nil if none
+ */
+@property (nonatomic, readonly, copy) NSString *currentIdentifier;
+
+/**
+ *  The player of the media being played, nil if none. The instance changes when zapping, do not keep a reference to it
+ */
+@property (nonatomic, readonly) RTSMediaPlayerController *mediaPlayerController;
+
+/**
+ *  The players of the neighbours currently pre-buffered
+ */
+@property (nonatomic, readonly) NSArray<RTSMediaPlayerController *> *neighbourMediaPlayerControllers;
+
+/**
+ *  Play the media with the specified identifier. If it is a pre-buffered neighbour, playback switches immediately
+ */
+- (void)playIdentifier:(NSString *)identifier;
+
+/**
+ *  Zap to the next (respectively previous) identifier in the list. Does nothing if the media being played does not
+ *  belong to `identifiers`
+ */
+- (void)zapToNextIdentifier;
+- (void)zapToPreviousIdentifier;
+
+/**
+ *  Stop and release all players
+ */
+- (void)reset;
+
+/**
+ *  The latency of the last completed zap, in seconds (0 if none)
+ */
+@property (nonatomic, readonly) NSTimeInterval lastZapLatency;
+
+@end
@@ -0,0 +1,382 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlayerZappingController.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "RTSMediaPlayerBufferBudget.h"
+#import "RTSMediaPlayerConstants.h"
+#import "RTSMediaPlayerController.h"
+#import "RTSMediaPlayerLogger+Private.h"
+
+NSUInteger const RTSMediaPlayerZappingControllerDefaultNeighbourCount = 1;
+double const RTSMediaPlayerZappingControllerDefaultNeighbourPeakBitRate = 400. * 1000.;
+unsigned long long const RTSMediaPlayerZappingControllerDefaultMaximumBufferBytes = 24 * 1024 * 1024;
+
+NSString * const RTSMediaPlayerZappingControllerDidZapNotification = @"RTSMediaPlayerZappingControllerDidZapNotification";
+NSString * const RTSMediaPlayerZapLatencyUserInfoKey = @"ZapLatency";
+NSString * const RTSMediaPlayerZapPreBufferedUserInfoKey = @"ZapPreBuffered";
+
+@interface RTSMediaPlayerZappingController ()
+
+@property (nonatomic, weak) id<RTSMediaPlayerControllerDataSource> dataSource;
+@property (nonatomic) RTSMediaPlayerBufferBudget *bufferBudget;
+
+@property (nonatomic, copy) NSString *currentIdentifier;
+@property (nonatomic) RTSMediaPlayerController *mediaPlayerController;
+@property (nonatomic) NSMutableDictionary<NSString *, RTSMediaPlayerController *> *neighbourMediaPlayerControllersByIdentifier;
+
+@property (nonatomic) CFTimeInterval zapStartTime;
+@property (nonatomic, getter=isZapPreBuffered) BOOL zapPreBuffered;
+@property (nonatomic) NSTimeInterval lastZapLatency;
+
+@end
+
+@implementation RTSMediaPlayerZappingController
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithDataSource:nil];
+}
+
+- (instancetype)initWithDataSource:(id<RTSMediaPlayerControllerDataSource>)dataSource
+{
+	if (self = [super init]) {
+		self.dataSource = dataSource;
+		self.bufferBudget = [[RTSMediaPlayerBufferBudget alloc] initWithMaximumBytes:RTSMediaPlayerZappingControllerDefaultMaximumBufferBytes];
+		self.neighbourMediaPlayerControllersByIdentifier = [NSMutableDictionary dictionary];
+
+		_neighbourCount = RTSMediaPlayerZappingControllerDefaultNeighbourCount;
+		_neighbourPeakBitRate = RTSMediaPlayerZappingControllerDefaultNeighbourPeakBitRate;
+
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(playbackStateDidChange:)
+													 name:RTSMediaPlayerPlaybackStateDidChangeNotification
+												   object:nil];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[self reset];
+}
+
+#pragma mark - Getters and setters
+
+- (void)setIdentifiers:(NSArray<NSString *> *)identifiers
+{
+	_identifiers = [identifiers copy];
+	[self updateNeighbours];
+}
+
+- (void)setContainerView:(UIView *)containerView
+{
+	if (_containerView) {
+		[self.mediaPlayerController.view removeFromSuperview];
+		for (RTSMediaPlayerController *neighbourMediaPlayerController in self.neighbourMediaPlayerControllers) {
+			[neighbourMediaPlayerController.view removeFromSuperview];
+		}
+	}
+
+	_containerView = containerView;
+	[self updatePlayerViews];
+}
+
+- (void)setNeighbourCount:(NSUInteger)neighbourCount
+{
+	_neighbourCount = neighbourCount;
+	[self updateNeighbours];
+}
+
+- (void)setNeighbourPeakBitRate:(double)neighbourPeakBitRate
+{
+	if (neighbourPeakBitRate < 0.) {
+		RTSMediaPlayerLogWarning(@"The neighbour peak bit rate cannot be negative. Set to 0");
+		neighbourPeakBitRate = 0.;
+	}
+
+	_neighbourPeakBitRate = neighbourPeakBitRate;
+
+	for (RTSMediaPlayerController *neighbourMediaPlayerController in self.neighbourMediaPlayerControllers) {
+		neighbourMediaPlayerController.preferredPeakBitRate = neighbourPeakBitRate;
+	}
+}
+
+- (void)setActivePeakBitRate:(double)activePeakBitRate
+{
+	if (activePeakBitRate < 0.) {
+		RTSMediaPlayerLogWarning(@"The active peak bit rate cannot be negative. Set to 0");
+		activePeakBitRate = 0.;
+	}
+
+	_activePeakBitRate = activePeakBitRate;
+	self.mediaPlayerController.preferredPeakBitRate = activePeakBitRate;
+}
+
+- (unsigned long long)maximumBufferBytes
+{
+	return self.bufferBudget.maximumBytes;
+}
+
+- (void)setMaximumBufferBytes:(unsigned long long)maximumBufferBytes
+{
+	self.bufferBudget.maximumBytes = maximumBufferBytes;
+}
+
+- (NSArray<RTSMediaPlayerController *> *)neighbourMediaPlayerControllers
+{
+	return self.neighbourMediaPlayerControllersByIdentifier.allValues;
+}
+
+#pragma mark - Playback
+
+- (void)playIdentifier:(NSString *)identifier
+{
+	NSParameterAssert(identifier);
+
+	if ([identifier isEqualToString:self.currentIdentifier]) {
+		[self.mediaPlayerController play];
+		return;
+	}
+
+	self.zapStartTime = CACurrentMediaTime();
+
+	RTSMediaPlayerController *previousMediaPlayerController = self.mediaPlayerController;
+	NSString *previousIdentifier = self.currentIdentifier;
+
+	RTSMediaPlayerController *mediaPlayerController = self.neighbourMediaPlayerControllersByIdentifier[identifier];
+	if (mediaPlayerController) {
+		[self.neighbourMediaPlayerControllersByIdentifier removeObjectForKey:identifier];
+
+		RTSMediaPlaybackState playbackState = mediaPlayerController.playbackState;
+		self.zapPreBuffered = (playbackState != RTSMediaPlaybackStateIdle && playbackState != RTSMediaPlaybackStatePreparing);
+	}
+	else {
+		mediaPlayerController = [self newMediaPlayerControllerWithIdentifier:identifier];
+		self.zapPreBuffered = NO;
+	}
+
+	// The previous player becomes a neighbour candidate, and is discarded when updating neighbours if not needed anymore
+	if (previousMediaPlayerController) {
+		self.neighbourMediaPlayerControllersByIdentifier[previousIdentifier] = previousMediaPlayerController;
+		[self configureNeighbourMediaPlayerController:previousMediaPlayerController];
+	}
+
+	self.currentIdentifier = identifier;
+	self.mediaPlayerController = mediaPlayerController;
+
+	mediaPlayerController.muted = NO;
+	mediaPlayerController.preferredPeakBitRate = self.activePeakBitRate;
+	mediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityVisibleAudible;
+	[self updatePlayerViews];
+
+	[mediaPlayerController playIdentifier:identifier];
+
+	RTSMediaPlayerLogInfo(@"Zapping from %@ to %@ (pre-buffered: %@)", previousIdentifier, identifier, self.zapPreBuffered ? @"YES" : @"NO");
+
+	if (mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying) {
+		[self finishZap];
+	}
+
+	[self updateNeighbours];
+}
+
+- (void)zapToNextIdentifier
+{
+	[self zapWithOffset:1];
+}
+
+- (void)zapToPreviousIdentifier
+{
+	[self zapWithOffset:-1];
+}
+
+- (void)zapWithOffset:(NSInteger)offset
+{
+	NSString *identifier = [self identifierWithOffset:offset];
+	if (identifier) {
+		[self playIdentifier:identifier];
+	}
+}
+
+- (void)reset
+{
+	self.zapStartTime = 0.;
+
+	[self.mediaPlayerController.view removeFromSuperview];
+	[self.mediaPlayerController reset];
+	self.mediaPlayerController = nil;
+	self.currentIdentifier = nil;
+
+	for (RTSMediaPlayerController *neighbourMediaPlayerController in self.neighbourMediaPlayerControllers) {
+		[neighbourMediaPlayerController.view removeFromSuperview];
+		[neighbourMediaPlayerController reset];
+	}
+	[self.neighbourMediaPlayerControllersByIdentifier removeAllObjects];
+}
+
+- (void)finishZap
+{
+	if (self.zapStartTime == 0.) {
+		return;
+	}
+
+	self.lastZapLatency = CACurrentMediaTime() - self.zapStartTime;
+	self.zapStartTime = 0.;
+
+	RTSMediaPlayerLogInfo(@"Zapped to %@ in %.3f sec.", self.currentIdentifier, self.lastZapLatency);
+	[[NSNotificationCenter defaultCenter] postNotificationName:RTSMediaPlayerZappingControllerDidZapNotification
+														object:self
+													  userInfo:@{ RTSMediaPlayerZapLatencyUserInfoKey : @(self.lastZapLatency),
+																  RTSMediaPlayerZapPreBufferedUserInfoKey : @(self.zapPreBuffered) }];
+}
+
+#pragma mark - Neighbours
+
+// Return the identifier located at the specified offset from the current one in the list, nil if the current
+// identifier does not belong to the list
+- (NSString *)identifierWithOffset:(NSInteger)offset
+{
+	NSInteger count = self.identifiers.count;
+	NSUInteger index = self.currentIdentifier ? [self.identifiers indexOfObject:self.currentIdentifier] : NSNotFound;
+	if (index == NSNotFound || count == 0) {
+		return nil;
+	}
+
+	NSInteger neighbourIndex = (((NSInteger)index + offset) % count + count) % count;
+	return self.identifiers[neighbourIndex];
+}
+
+- (void)updateNeighbours
+{
+	if (!self.currentIdentifier) {
+		return;
+	}
+
+	// Nearest neighbours first, alternating between next and previous ones
+	NSMutableOrderedSet<NSString *> *neighbourIdentifiers = [NSMutableOrderedSet orderedSet];
+	for (NSInteger offset = 1; offset <= (NSInteger)self.neighbourCount; ++offset) {
+		for (NSNumber *signedOffset in @[ @(offset), @(-offset) ]) {
+			NSString *identifier = [self identifierWithOffset:signedOffset.integerValue];
+			if (identifier && ![identifier isEqualToString:self.currentIdentifier]) {
+				[neighbourIdentifiers addObject:identifier];
+			}
+		}
+	}
+
+	// Players which are not needed anymore are reused for new neighbours, or discarded
+	NSMutableArray<RTSMediaPlayerController *> *reusableMediaPlayerControllers = [NSMutableArray array];
+	for (NSString *identifier in self.neighbourMediaPlayerControllersByIdentifier.allKeys) {
+		if (![neighbourIdentifiers containsObject:identifier]) {
+			[reusableMediaPlayerControllers addObject:self.neighbourMediaPlayerControllersByIdentifier[identifier]];
+			[self.neighbourMediaPlayerControllersByIdentifier removeObjectForKey:identifier];
+		}
+	}
+
+	for (NSString *identifier in neighbourIdentifiers) {
+		if (self.neighbourMediaPlayerControllersByIdentifier[identifier]) {
+			continue;
+		}
+
+		RTSMediaPlayerController *neighbourMediaPlayerController = reusableMediaPlayerControllers.lastObject;
+		if (neighbourMediaPlayerController) {
+			[reusableMediaPlayerControllers removeLastObject];
+		}
+		else {
+			neighbourMediaPlayerController = [self newMediaPlayerControllerWithIdentifier:identifier];
+		}
+
+		self.neighbourMediaPlayerControllersByIdentifier[identifier] = neighbourMediaPlayerController;
+		[self configureNeighbourMediaPlayerController:neighbourMediaPlayerController];
+		[neighbourMediaPlayerController playIdentifier:identifier];
+	}
+
+	for (RTSMediaPlayerController *mediaPlayerController in reusableMediaPlayerControllers) {
+		[mediaPlayerController.view removeFromSuperview];
+		[mediaPlayerController reset];
+	}
+
+	[self updatePlayerViews];
+}
+
+- (RTSMediaPlayerController *)newMediaPlayerControllerWithIdentifier:(NSString *)identifier
+{
+	RTSMediaPlayerController *mediaPlayerController = [[RTSMediaPlayerController alloc] initWithContentIdentifier:identifier dataSource:self.dataSource];
+	mediaPlayerController.bufferBudget = self.bufferBudget;
+	return mediaPlayerController;
+}
+
+- (void)configureNeighbourMediaPlayerController:(RTSMediaPlayerController *)mediaPlayerController
+{
+	mediaPlayerController.muted = YES;
+	mediaPlayerController.preferredPeakBitRate = self.neighbourPeakBitRate;
+	mediaPlayerController.bufferPriority = RTSMediaPlayerBufferPriorityHidden;
+}
+
+#pragma mark - Views
+
+- (void)updatePlayerViews
+{
+	UIView *containerView = self.containerView;
+	if (!containerView || !self.mediaPlayerController) {
+		return;
+	}
+
+	// Perform all changes within the same frame
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+
+	UIView *activeView = self.mediaPlayerController.view;
+	if (activeView.superview != containerView) {
+		[self.mediaPlayerController attachPlayerToView:containerView];
+	}
+
+	// Neighbour views are kept below the active view, and below any other view of the container (e.g. overlays)
+	for (RTSMediaPlayerController *neighbourMediaPlayerController in self.neighbourMediaPlayerControllers) {
+		UIView *neighbourView = neighbourMediaPlayerController.view;
+		if (neighbourView.superview != containerView) {
+			[neighbourMediaPlayerController attachPlayerToView:containerView];
+		}
+
+		if ([containerView.subviews indexOfObject:neighbourView] > [containerView.subviews indexOfObject:activeView]) {
+			[containerView insertSubview:activeView aboveSubview:neighbourView];
+		}
+	}
+
+	[CATransaction commit];
+}
+
+#pragma mark - Notifications
+
+- (void)playbackStateDidChange:(NSNotification *)notification
+{
+	if (notification.object != self.mediaPlayerController) {
+		return;
+	}
+
+	if (self.mediaPlayerController.playbackState == RTSMediaPlaybackStatePlaying) {
+		[self finishZap];
+	}
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; currentIdentifier: %@; neighbours: %@; lastZapLatency: %@>",
+			[self class],
+			self,
+			self.currentIdentifier,
+			self.neighbourMediaPlayerControllersByIdentifier.allKeys,
+			@(self.lastZapLatency)];
+}
+
+@end
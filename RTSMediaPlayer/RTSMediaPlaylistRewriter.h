@@ -0,0 +1,105 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+#import "RTSMediaPlayerController.h"
+
+/**
+ *  `AVPlayer` starts HLS playback with the first variant listed in the master playlist, whatever the network conditions
+ *  and the size of the view the media is displayed in. A playlist rewriter intercepts the master playlist when it is
+ *  loaded and rewrites it so that the first variant is the one best suited for playback to start quickly:
+ *
+ *    - The variant with the highest bandwidth fitting the estimated network bandwidth and whose resolution does not
+ *      exceed the size of the view is moved first. Other variants keep their original order.
+ *    - Variants exceeding the maximum resolution or bit rate supported are dropped, unless none would remain.
+ *    - Relative URIs are made absolute, so that only the master playlist itself is loaded through the rewriter.
+ *
+ *  Media playlists can also be rewritten so that media segments contained in blocked time ranges are removed before
+ *  the player sees them (see `-assetWithURL:viewSize:blockedTimeRanges:removedTimeRangesHandler:`).
+ *
+ *  The playlist is parsed and emitted as it is received. Rewriting is optional: assign a rewriter to the
+ *  `playlistRewriter` property of a media player controller to enable it.
+ */
+@interface RTSMediaPlaylistRewriter : NSObject
+
+/**
+ *  A rewriter shared by all controllers, which benefit from the bandwidth estimations made by each other
+ */
++ (RTSMediaPlaylistRewriter *)sharedPlaylistRewriter;
+
+/**
+ *  The estimated network bandwidth, in bits per second. Updated by the controllers using the rewriter when they observe
+ *  the bandwidth during playback. 0 if unknown, in which case variants are chosen according to the view size only
+ */
+@property (atomic) double estimatedBandwidth;
+
+/**
+ *  Update the estimated bandwidth with a new observation (in bits per second)
+ */
+- (void)reportObservedBandwidth:(double)observedBandwidth;
+
+/**
+ *  The maximum resolution supported, in pixels (in either orientation). Variants with a larger resolution are dropped.
+ *  Defaults to the native resolution of the main screen. Set to `CGSizeZero` for no limit
+ */
+@property (atomic) CGSize maximumResolution;
+
+/**
+ *  The maximum bit rate supported, in bits per second. Variants with a larger bandwidth are dropped. Set to 0 (the
+ *  default) for no limit
+ */
+@property (atomic) double maximumBitRate;
+
+/**
+ *  Set to NO to leave variants untouched, e.g. when the rewriter is only used to remove blocked media segments.
+ *  Default is YES
+ */
+@property (atomic, getter=isVariantSelectionEnabled) BOOL variantSelectionEnabled;
+
+/**
+ *  Return an asset whose playlist is rewritten when loaded, for display in a view of the specified size (in pixels,
+ *  `CGSizeZero` if unknown). Only HTTP(S) URLs can be rewritten, a plain asset is returned for other URLs
+ */
+- (AVURLAsset *)assetWithURL:(NSURL *)URL viewSize:(CGSize)viewSize;
+
+/**
+ *  Same as `-assetWithURL:viewSize:`, but media segments entirely contained in one of the blocked time ranges (`NSValue`s
+ *  wrapping `CMTimeRange`s, in media time) are removed from VOD and event media playlists, a discontinuity being
+ *  inserted in their place. Their data is therefore never loaded. Live playlists are left untouched, since the media
+ *  time of their segments is not known. The handler is called on a background queue each time a media playlist has
+ *  been rewritten, with its URL and the time ranges actually removed from it (merged when contiguous). Variants might
+ *  be segmented differently, so that the time ranges removed from them can differ
+ */
+- (AVURLAsset *)assetWithURL:(NSURL *)URL
+					viewSize:(CGSize)viewSize
+		   blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+	removedTimeRangesHandler:(void (^)(NSURL *playlistURL, NSArray<NSValue *> *removedTimeRanges))removedTimeRangesHandler;
+
+/**
+ *  Rewrite playlist data loaded from the specified URL. Used by the assets returned by the rewriter, exposed for
+ *  testing purposes
+ */
+- (NSData *)rewrittenPlaylistWithData:(NSData *)data URL:(NSURL *)URL viewSize:(CGSize)viewSize;
+- (NSData *)rewrittenPlaylistWithData:(NSData *)data
+								  URL:(NSURL *)URL
+							 viewSize:(CGSize)viewSize
+					blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+					removedTimeRanges:(NSArray<NSValue *> **)pRemovedTimeRanges;
+
+@end
+
+@interface RTSMediaPlayerController (RTSMediaPlaylistRewriter)
+
+/**
+ *  The rewriter applied to the playlists played by the controller. Default is nil (no rewriting). Changes are taken
+ *  into account the next time a media is loaded
+ */
+@property (nonatomic) RTSMediaPlaylistRewriter *playlistRewriter;
+
+@end
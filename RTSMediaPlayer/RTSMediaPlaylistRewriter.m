@@ -0,0 +1,919 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPlaylistRewriter.h"
+
+#import "RTSMediaPlayerLogger+Private.h"
+#import "RTSMediaResourceLoading+Private.h"
+
+#import <objc/runtime.h>
+
+// Prefix added to the scheme of the URLs whose loading is intercepted
+static NSString * const RTSMediaPlaylistRewriterSchemePrefix = @"rtsrewrite-";
+
+// Only a fraction of the estimated bandwidth is used when choosing the first variant, so that playback can start
+// without stalling even if the estimation is slightly optimistic
+static const double RTSMediaPlaylistRewriterBandwidthSafetyFactor = 0.8;
+
+// Weight of a new observation in the bandwidth estimation (exponentially weighted moving average)
+static const double RTSMediaPlaylistRewriterBandwidthSmoothingFactor = 0.3;
+
+// Tolerance when checking whether a media segment is contained in a blocked time range (in seconds)
+static const NSTimeInterval RTSMediaPlaylistRewriterBlockingTolerance = 0.001;
+
+static void *RTSMediaPlaylistRewriterLoaderKey = &RTSMediaPlaylistRewriterLoaderKey;
+
+// Parse an attribute list (e.g. `BANDWIDTH=1280000,CODECS="avc1.4d401f,mp4a.40.2"`). Quoted values are returned without
+// their quotes
+static NSDictionary<NSString *, NSString *> *RTSMediaPlaylistAttributes(NSString *attributeList)
+{
+	NSMutableDictionary<NSString *, NSString *> *attributes = [NSMutableDictionary dictionary];
+
+	NSScanner *scanner = [NSScanner scannerWithString:attributeList];
+	scanner.charactersToBeSkipped = nil;
+	while (!scanner.atEnd) {
+		NSString *name = nil;
+		if (![scanner scanUpToString:@"=" intoString:&name] || ![scanner scanString:@"=" intoString:NULL]) {
+			break;
+		}
+
+		NSString *value = nil;
+		if ([scanner scanString:@"\"" intoString:NULL]) {
+			[scanner scanUpToString:@"\"" intoString:&value];
+			[scanner scanString:@"\"" intoString:NULL];
+		}
+		else {
+			[scanner scanUpToString:@"," intoString:&value];
+		}
+		[scanner scanString:@"," intoString:NULL];
+
+		attributes[[name stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]] = value ?: @"";
+	}
+	return [attributes copy];
+}
+
+// Device caps do not depend on the orientation
+static BOOL RTSMediaPlaylistResolutionFitsMaximumResolution(CGSize resolution, CGSize maximumResolution)
+{
+	if (CGSizeEqualToSize(resolution, CGSizeZero) || CGSizeEqualToSize(maximumResolution, CGSizeZero)) {
+		return YES;
+	}
+	return MAX(resolution.width, resolution.height) <= MAX(maximumResolution.width, maximumResolution.height)
+		&& MIN(resolution.width, resolution.height) <= MIN(maximumResolution.width, maximumResolution.height);
+}
+
+// A variant fits a view if it can be displayed without being downscaled
+static BOOL RTSMediaPlaylistResolutionFitsViewSize(CGSize resolution, CGSize viewSize)
+{
+	if (CGSizeEqualToSize(resolution, CGSizeZero) || CGSizeEqualToSize(viewSize, CGSizeZero)) {
+		return YES;
+	}
+	return resolution.width <= viewSize.width && resolution.height <= viewSize.height;
+}
+
+#pragma mark - Variants
+
+@interface RTSMediaPlaylistVariant : NSObject
+
+- (instancetype)initWithLines:(NSArray<NSString *> *)lines;
+
+@property (nonatomic, readonly) NSArray<NSString *> *lines;			// Stream information tag first, URI last
+@property (nonatomic, readonly) double bandwidth;
+@property (nonatomic, readonly) CGSize resolution;						// CGSizeZero if unknown
+@property (nonatomic, readonly, getter=hasVideo) BOOL video;
+
+@end
+
+@implementation RTSMediaPlaylistVariant
+
+- (instancetype)initWithLines:(NSArray<NSString *> *)lines
+{
+	if (self = [super init]) {
+		_lines = [lines copy];
+
+		NSString *streamInformation = lines.firstObject;
+		NSRange separatorRange = [streamInformation rangeOfString:@":"];
+		NSDictionary<NSString *, NSString *> *attributes = RTSMediaPlaylistAttributes([streamInformation substringFromIndex:NSMaxRange(separatorRange)]);
+
+		_bandwidth = [attributes[@"BANDWIDTH"] doubleValue];
+
+		NSArray<NSString *> *dimensions = [attributes[@"RESOLUTION"] componentsSeparatedByString:@"x"];
+		if (dimensions.count == 2) {
+			_resolution = CGSizeMake([dimensions[0] doubleValue], [dimensions[1] doubleValue]);
+		}
+
+		NSString *codecs = attributes[@"CODECS"];
+		_video = (dimensions.count == 2) || [codecs containsString:@"avc"] || [codecs containsString:@"hvc"] || [codecs containsString:@"hev"];
+	}
+	return self;
+}
+
+@end
+
+#pragma mark - Rewriting session
+
+/**
+ *  Rewrite a playlist as it is received. Lines which are not part of a variant are emitted as soon as they are complete.
+ *  Variants are small and kept until the end of the playlist, where they are emitted in their new order. In media
+ *  playlists, media segments contained in blocked time ranges are removed and replaced with a discontinuity
+ */
+@interface RTSMediaPlaylistRewritingSession : NSObject
+
+- (instancetype)initWithRewriter:(RTSMediaPlaylistRewriter *)rewriter
+							 URL:(NSURL *)URL
+						viewSize:(CGSize)viewSize
+			   blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges;
+
+/**
+ *  Append received data, returning the rewritten data which is available
+ */
+- (NSData *)appendData:(NSData *)data;
+
+/**
+ *  Signal the end of the playlist, returning the remaining rewritten data
+ */
+- (NSData *)finish;
+
+/**
+ *  Return YES iff the playlist is a media playlist
+ */
+@property (nonatomic, readonly, getter=isMediaPlaylist) BOOL mediaPlaylist;
+
+/**
+ *  The time ranges (as `NSValue`s wrapping `CMTimeRange`s) which have been removed from a media playlist, in media time
+ */
+@property (nonatomic, readonly) NSArray<NSValue *> *removedTimeRanges;
+
+@end
+
+@interface RTSMediaPlaylistRewritingSession ()
+
+@property (nonatomic) NSURL *URL;
+@property (nonatomic) CGSize viewSize;
+@property (nonatomic) double estimatedBandwidth;
+@property (nonatomic) CGSize maximumResolution;
+@property (nonatomic) double maximumBitRate;
+@property (nonatomic, getter=isVariantSelectionEnabled) BOOL variantSelectionEnabled;
+@property (nonatomic) NSArray<NSValue *> *blockedTimeRanges;
+
+@property (nonatomic) NSMutableData *pendingData;
+@property (nonatomic) NSMutableArray<NSString *> *currentVariantLines;
+@property (nonatomic) NSMutableArray<RTSMediaPlaylistVariant *> *variants;
+
+@property (nonatomic, getter=isMediaPlaylist) BOOL mediaPlaylist;
+@property (nonatomic) NSString *playlistType;
+@property (nonatomic) NSMutableArray<NSString *> *currentSegmentLines;
+@property (nonatomic) NSTimeInterval currentSegmentDuration;
+@property (nonatomic) NSTimeInterval mediaTime;
+@property (nonatomic, getter=hasKeptSegments) BOOL keptSegments;
+@property (nonatomic, getter=isDiscontinuityPending) BOOL discontinuityPending;
+@property (nonatomic) NSMutableArray<NSValue *> *mutableRemovedTimeRanges;
+
+@end
+
+@implementation RTSMediaPlaylistRewritingSession
+
+- (instancetype)initWithRewriter:(RTSMediaPlaylistRewriter *)rewriter
+							 URL:(NSURL *)URL
+						viewSize:(CGSize)viewSize
+			   blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+{
+	if (self = [super init]) {
+		self.URL = URL;
+		self.viewSize = viewSize;
+		self.estimatedBandwidth = rewriter.estimatedBandwidth;
+		self.maximumResolution = rewriter.maximumResolution;
+		self.maximumBitRate = rewriter.maximumBitRate;
+		self.variantSelectionEnabled = rewriter.variantSelectionEnabled;
+		self.blockedTimeRanges = blockedTimeRanges ?: @[];
+		self.pendingData = [NSMutableData data];
+		self.variants = [NSMutableArray array];
+		self.mutableRemovedTimeRanges = [NSMutableArray array];
+	}
+	return self;
+}
+
+- (NSArray<NSValue *> *)removedTimeRanges
+{
+	return [self.mutableRemovedTimeRanges copy];
+}
+
+- (NSData *)appendData:(NSData *)data
+{
+	[self.pendingData appendData:data];
+
+	NSMutableString *output = [NSMutableString string];
+	const char *bytes = self.pendingData.bytes;
+	NSUInteger lineStart = 0;
+	for (NSUInteger i = 0; i < self.pendingData.length; ++i) {
+		if (bytes[i] != '\n') {
+			continue;
+		}
+
+		NSString *line = [[NSString alloc] initWithBytes:bytes + lineStart length:i - lineStart encoding:NSUTF8StringEncoding];
+		[self processLine:line output:output];
+		lineStart = i + 1;
+	}
+	[self.pendingData replaceBytesInRange:NSMakeRange(0, lineStart) withBytes:NULL length:0];
+
+	return [output dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (NSData *)finish
+{
+	NSMutableString *output = [NSMutableString string];
+	if (self.pendingData.length != 0) {
+		NSString *line = [[NSString alloc] initWithData:self.pendingData encoding:NSUTF8StringEncoding];
+		[self processLine:line output:output];
+		self.pendingData.length = 0;
+	}
+
+	// Stream information or media segment tags without URI at the end of the playlist are invalid and dropped
+	self.currentVariantLines = nil;
+	self.currentSegmentLines = nil;
+
+	for (RTSMediaPlaylistVariant *variant in [self rewrittenVariants]) {
+		for (NSString *line in variant.lines) {
+			[output appendFormat:@"%@\n", line];
+		}
+	}
+	return [output dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)processLine:(NSString *)line output:(NSMutableString *)output
+{
+	if (!line) {
+		return;
+	}
+
+	if ([line hasSuffix:@"\r"]) {
+		line = [line substringToIndex:line.length - 1];
+	}
+
+	if (self.currentVariantLines) {
+		// Tags between a stream information tag and its URI belong to the variant
+		if (line.length == 0 || [line hasPrefix:@"#"]) {
+			[self.currentVariantLines addObject:line];
+		}
+		else {
+			[self.currentVariantLines addObject:[self absoluteURIStringForURIString:line playlist:YES]];
+			[self.variants addObject:[[RTSMediaPlaylistVariant alloc] initWithLines:self.currentVariantLines]];
+			self.currentVariantLines = nil;
+		}
+	}
+	else if ([line hasPrefix:@"#EXT-X-STREAM-INF:"]) {
+		self.currentVariantLines = [NSMutableArray arrayWithObject:line];
+	}
+	else if ([self isMediaSegmentTagLine:line]) {
+		if ([line hasPrefix:@"#EXTINF:"]) {
+			self.mediaPlaylist = YES;
+			self.currentSegmentDuration = [[line substringFromIndex:8] doubleValue];
+		}
+
+		if (!self.currentSegmentLines) {
+			self.currentSegmentLines = [NSMutableArray array];
+		}
+		[self.currentSegmentLines addObject:line];
+	}
+	else if ([line hasPrefix:@"#"]) {
+		if ([line hasPrefix:@"#EXT-X-PLAYLIST-TYPE:"]) {
+			self.playlistType = [line substringFromIndex:21];
+		}
+
+		// Alternative renditions and I-frame playlists are media playlists as well
+		BOOL playlist = [line hasPrefix:@"#EXT-X-MEDIA:"] || [line hasPrefix:@"#EXT-X-I-FRAME-STREAM-INF:"];
+		[output appendFormat:@"%@\n", [self lineWithAbsoluteURIAttributes:line playlist:playlist]];
+	}
+	else if (line.length != 0) {
+		if (self.currentSegmentLines) {
+			[self processMediaSegmentWithURIString:line output:output];
+		}
+		else {
+			[output appendFormat:@"%@\n", [self absoluteURIStringForURIString:line playlist:NO]];
+		}
+	}
+	else {
+		[output appendString:@"\n"];
+	}
+}
+
+// Tags applying to the next media segment only
+- (BOOL)isMediaSegmentTagLine:(NSString *)line
+{
+	return [line hasPrefix:@"#EXTINF:"] || [line hasPrefix:@"#EXT-X-BYTERANGE:"] || [line hasPrefix:@"#EXT-X-PROGRAM-DATE-TIME:"]
+		|| [line isEqualToString:@"#EXT-X-DISCONTINUITY"] || [line isEqualToString:@"#EXT-X-GAP"];
+}
+
+- (void)processMediaSegmentWithURIString:(NSString *)URIString output:(NSMutableString *)output
+{
+	NSTimeInterval startTime = self.mediaTime;
+	NSTimeInterval duration = self.currentSegmentDuration;
+	self.mediaTime += duration;
+
+	if ([self isMediaSegmentBlockedWithStartTime:startTime duration:duration]) {
+		[self addRemovedTimeRange:CMTimeRangeMake(CMTimeMakeWithSeconds(startTime, NSEC_PER_SEC), CMTimeMakeWithSeconds(duration, NSEC_PER_SEC))];
+		self.discontinuityPending = YES;
+	}
+	else {
+		// No discontinuity is needed when media segments are removed at the beginning of the playlist
+		if (self.discontinuityPending && self.keptSegments && ![self.currentSegmentLines containsObject:@"#EXT-X-DISCONTINUITY"]) {
+			[output appendString:@"#EXT-X-DISCONTINUITY\n"];
+		}
+
+		for (NSString *line in self.currentSegmentLines) {
+			[output appendFormat:@"%@\n", line];
+		}
+		[output appendFormat:@"%@\n", [self absoluteURIStringForURIString:URIString playlist:NO]];
+
+		self.keptSegments = YES;
+		self.discontinuityPending = NO;
+	}
+
+	self.currentSegmentLines = nil;
+	self.currentSegmentDuration = 0.;
+}
+
+- (BOOL)isMediaSegmentBlockedWithStartTime:(NSTimeInterval)startTime duration:(NSTimeInterval)duration
+{
+	if (self.blockedTimeRanges.count == 0 || duration <= 0.) {
+		return NO;
+	}
+
+	// Media times are only known for playlists which always start at the beginning of the media (VOD and event playlists).
+	// Live sliding windows are left untouched, even when their first media segment happens to be the first one, so that
+	// removed time ranges do not change between reloads
+	BOOL startsAtBeginning = [self.playlistType isEqualToString:@"VOD"] || [self.playlistType isEqualToString:@"EVENT"];
+	if (!startsAtBeginning) {
+		return NO;
+	}
+
+	for (NSValue *blockedTimeRangeValue in self.blockedTimeRanges) {
+		CMTimeRange blockedTimeRange = [blockedTimeRangeValue CMTimeRangeValue];
+		NSTimeInterval blockedStartTime = CMTimeGetSeconds(blockedTimeRange.start);
+		NSTimeInterval blockedEndTime = CMTimeGetSeconds(CMTimeRangeGetEnd(blockedTimeRange));
+		if (blockedStartTime - RTSMediaPlaylistRewriterBlockingTolerance <= startTime
+				&& startTime + duration <= blockedEndTime + RTSMediaPlaylistRewriterBlockingTolerance) {
+			return YES;
+		}
+	}
+	return NO;
+}
+
+// Contiguous removed media segments are merged into a single time range
+- (void)addRemovedTimeRange:(CMTimeRange)timeRange
+{
+	CMTimeRange lastTimeRange = [self.mutableRemovedTimeRanges.lastObject CMTimeRangeValue];
+	if (self.mutableRemovedTimeRanges.count != 0
+			&& fabs(CMTimeGetSeconds(CMTimeRangeGetEnd(lastTimeRange)) - CMTimeGetSeconds(timeRange.start)) < RTSMediaPlaylistRewriterBlockingTolerance) {
+		self.mutableRemovedTimeRanges[self.mutableRemovedTimeRanges.count - 1] = [NSValue valueWithCMTimeRange:CMTimeRangeGetUnion(lastTimeRange, timeRange)];
+	}
+	else {
+		[self.mutableRemovedTimeRanges addObject:[NSValue valueWithCMTimeRange:timeRange]];
+	}
+}
+
+// Playlists must be loaded through the resource loader when media segments might have to be removed from them
+- (NSString *)absoluteURIStringForURIString:(NSString *)URIString playlist:(BOOL)playlist
+{
+	NSURL *URL = [NSURL URLWithString:URIString relativeToURL:self.URL].absoluteURL;
+	if (playlist && self.blockedTimeRanges.count != 0) {
+		URL = RTSMediaResourceLoadingInterceptedURL(URL, RTSMediaPlaylistRewriterSchemePrefix) ?: URL;
+	}
+	return URL.absoluteString ?: URIString;
+}
+
+// Tags like `EXT-X-MEDIA` or `EXT-X-KEY` reference other resources in their `URI` attribute
+- (NSString *)lineWithAbsoluteURIAttributes:(NSString *)line playlist:(BOOL)playlist
+{
+	static NSRegularExpression *s_regularExpression;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		s_regularExpression = [NSRegularExpression regularExpressionWithPattern:@"URI=\"([^\"]*)\"" options:0 error:NULL];
+	});
+
+	NSMutableString *rewrittenLine = [line mutableCopy];
+	NSArray<NSTextCheckingResult *> *matches = [s_regularExpression matchesInString:line options:0 range:NSMakeRange(0, line.length)];
+	for (NSTextCheckingResult *match in [matches reverseObjectEnumerator]) {
+		NSRange URIRange = [match rangeAtIndex:1];
+		[rewrittenLine replaceCharactersInRange:URIRange withString:[self absoluteURIStringForURIString:[line substringWithRange:URIRange] playlist:playlist]];
+	}
+	return [rewrittenLine copy];
+}
+
+- (NSArray<RTSMediaPlaylistVariant *> *)rewrittenVariants
+{
+	NSArray<RTSMediaPlaylistVariant *> *variants = [self.variants copy];
+	if (!self.variantSelectionEnabled || variants.count < 2) {
+		return variants;
+	}
+
+	NSMutableArray<RTSMediaPlaylistVariant *> *supportedVariants = [NSMutableArray array];
+	for (RTSMediaPlaylistVariant *variant in variants) {
+		if ((self.maximumBitRate <= 0. || variant.bandwidth <= self.maximumBitRate)
+				&& RTSMediaPlaylistResolutionFitsMaximumResolution(variant.resolution, self.maximumResolution)) {
+			[supportedVariants addObject:variant];
+		}
+	}
+	if (supportedVariants.count == 0) {
+		[supportedVariants addObjectsFromArray:variants];
+	}
+
+	// Never start with an audio-only variant if video is available
+	NSArray<RTSMediaPlaylistVariant *> *playableVariants = [supportedVariants filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(RTSMediaPlaylistVariant *variant, NSDictionary *bindings) {
+		return variant.hasVideo;
+	}]];
+	if (playableVariants.count == 0) {
+		playableVariants = [supportedVariants copy];
+	}
+
+	NSArray<RTSMediaPlaylistVariant *> *firstVariantCandidates = playableVariants;
+	double availableBandwidth = self.estimatedBandwidth * RTSMediaPlaylistRewriterBandwidthSafetyFactor;
+	if (availableBandwidth > 0.) {
+		firstVariantCandidates = [playableVariants filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(RTSMediaPlaylistVariant *variant, NSDictionary *bindings) {
+			return variant.bandwidth <= availableBandwidth;
+		}]];
+	}
+
+	RTSMediaPlaylistVariant *firstVariant = nil;
+	for (RTSMediaPlaylistVariant *variant in firstVariantCandidates) {
+		if (RTSMediaPlaylistResolutionFitsViewSize(variant.resolution, self.viewSize)
+				&& (!firstVariant || variant.bandwidth > firstVariant.bandwidth)) {
+			firstVariant = variant;
+		}
+	}
+
+	// If nothing fits, start with the lightest variant
+	if (!firstVariant) {
+		NSArray<RTSMediaPlaylistVariant *> *fallbackVariants = (firstVariantCandidates.count != 0) ? firstVariantCandidates : playableVariants;
+		for (RTSMediaPlaylistVariant *variant in fallbackVariants) {
+			if (!firstVariant || variant.bandwidth < firstVariant.bandwidth) {
+				firstVariant = variant;
+			}
+		}
+	}
+
+	[supportedVariants removeObject:firstVariant];
+	[supportedVariants insertObject:firstVariant atIndex:0];
+
+	RTSMediaPlayerLogDebug(@"Playlist rewritten: %@ variant(s) out of %@ kept, starting with bandwidth %.0f", @(supportedVariants.count), @(variants.count), firstVariant.bandwidth);
+	return [supportedVariants copy];
+}
+
+@end
+
+#pragma mark - Loading
+
+@interface RTSMediaPlaylistRewriter ()
+
+@property (nonatomic) NSURLSession *session;
+
+@end
+
+@class RTSMediaPlaylistLoading;
+
+/**
+ *  Delegate of the session shared by all playlists loaded for a rewriter, so that connections can be reused. Calls
+ *  are forwarded to the loading a task belongs to, on its queue
+ */
+@interface RTSMediaPlaylistSessionDelegate : NSObject <NSURLSessionDataDelegate>
+
+- (void)addLoading:(RTSMediaPlaylistLoading *)loading forTask:(NSURLSessionTask *)task;
+
+@end
+
+/**
+ *  Load a playlist on behalf of a loading request, rewriting it as it is received
+ */
+@interface RTSMediaPlaylistLoading : NSObject <NSURLSessionDataDelegate>
+
+- (instancetype)initWithLoadingRequest:(AVAssetResourceLoadingRequest *)loadingRequest
+									URL:(NSURL *)URL
+					  rewritingSession:(RTSMediaPlaylistRewritingSession *)rewritingSession
+							 completion:(void (^)(BOOL finished))completion;
+
+/**
+ *  Start loading with a session whose delegate is a `RTSMediaPlaylistSessionDelegate`. Delegate methods are called on
+ *  the specified queue
+ */
+- (void)startWithSession:(NSURLSession *)session queue:(dispatch_queue_t)queue;
+- (void)cancel;
+
+@property (nonatomic, readonly) dispatch_queue_t queue;
+
+@end
+
+@interface RTSMediaPlaylistLoading ()
+
+@property (nonatomic) AVAssetResourceLoadingRequest *loadingRequest;
+@property (nonatomic) NSURL *URL;
+@property (nonatomic) RTSMediaPlaylistRewritingSession *rewritingSession;
+@property (nonatomic, copy) void (^completion)(BOOL finished);
+
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) NSURLSessionDataTask *dataTask;
+@property (nonatomic) NSMutableData *bufferedData;
+@property (nonatomic) long long outputLength;
+@property (nonatomic, getter=isCancelled) BOOL cancelled;
+
+@end
+
+@implementation RTSMediaPlaylistLoading
+
+- (instancetype)initWithLoadingRequest:(AVAssetResourceLoadingRequest *)loadingRequest
+									URL:(NSURL *)URL
+					  rewritingSession:(RTSMediaPlaylistRewritingSession *)rewritingSession
+							 completion:(void (^)(BOOL finished))completion
+{
+	if (self = [super init]) {
+		self.loadingRequest = loadingRequest;
+		self.URL = URL;
+		self.rewritingSession = rewritingSession;
+		self.completion = completion;
+
+		// Content information requires the total length, only known once the whole playlist has been rewritten
+		if (loadingRequest.contentInformationRequest) {
+			self.bufferedData = [NSMutableData data];
+		}
+	}
+	return self;
+}
+
+- (void)startWithSession:(NSURLSession *)session queue:(dispatch_queue_t)queue
+{
+	NSMutableURLRequest *request = [self.loadingRequest.request mutableCopy];
+	request.URL = self.URL;
+
+	self.queue = queue;
+	self.dataTask = [session dataTaskWithRequest:request];
+	[(RTSMediaPlaylistSessionDelegate *)session.delegate addLoading:self forTask:self.dataTask];
+	[self.dataTask resume];
+}
+
+- (void)cancel
+{
+	self.cancelled = YES;
+	[self.dataTask cancel];
+}
+
+- (void)respondWithData:(NSData *)data
+{
+	if (data.length == 0) {
+		return;
+	}
+
+	if (self.bufferedData) {
+		[self.bufferedData appendData:data];
+		return;
+	}
+
+	// Only provide the part of the data which has been requested and not provided yet
+	AVAssetResourceLoadingDataRequest *dataRequest = self.loadingRequest.dataRequest;
+	long long dataStart = self.outputLength;
+	long long dataEnd = dataStart + data.length;
+	self.outputLength = dataEnd;
+
+	long long start = MAX(dataRequest.currentOffset, dataStart);
+	long long end = dataEnd;
+	if (!dataRequest.requestsAllDataToEndOfResource) {
+		end = MIN(end, dataRequest.requestedOffset + dataRequest.requestedLength);
+	}
+
+	if (start < end) {
+		[dataRequest respondWithData:[data subdataWithRange:NSMakeRange((NSUInteger)(start - dataStart), (NSUInteger)(end - start))]];
+	}
+}
+
+- (void)finishWithError:(NSError *)error
+{
+	if (!self.cancelled) {
+		if (error) {
+			[self.loadingRequest finishLoadingWithError:error];
+		}
+		else {
+			if (self.bufferedData) {
+				NSData *bufferedData = [self.bufferedData copy];
+				self.bufferedData = nil;
+
+				AVAssetResourceLoadingContentInformationRequest *contentInformationRequest = self.loadingRequest.contentInformationRequest;
+				contentInformationRequest.contentType = @"public.m3u-playlist";
+				contentInformationRequest.contentLength = bufferedData.length;
+				contentInformationRequest.byteRangeAccessSupported = NO;
+
+				[self respondWithData:bufferedData];
+			}
+			[self.loadingRequest finishLoading];
+		}
+	}
+
+	if (self.completion) {
+		self.completion(!self.cancelled && !error);
+		self.completion = nil;
+	}
+}
+
+#pragma mark - NSURLSessionDataDelegate protocol
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler
+{
+	if ([response isKindOfClass:[NSHTTPURLResponse class]] && ((NSHTTPURLResponse *)response).statusCode >= 400) {
+		NSInteger statusCode = ((NSHTTPURLResponse *)response).statusCode;
+		RTSMediaPlayerLogWarning(@"Playlist could not be loaded from %@ (HTTP status %@)", self.URL, @(statusCode));
+		[self finishWithError:[NSError errorWithDomain:NSURLErrorDomain
+												  code:NSURLErrorBadServerResponse
+											  userInfo:@{ NSURLErrorFailingURLErrorKey : self.URL,
+														  NSLocalizedDescriptionKey : [NSHTTPURLResponse localizedStringForStatusCode:statusCode] }]];
+		completionHandler(NSURLSessionResponseCancel);
+		return;
+	}
+
+	completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
+{
+	if (self.cancelled || !self.completion) {
+		return;
+	}
+
+	[self respondWithData:[self.rewritingSession appendData:data]];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
+{
+	// Already finished if the response was rejected
+	if (!self.completion) {
+		return;
+	}
+
+	if (!error) {
+		[self respondWithData:[self.rewritingSession finish]];
+	}
+	[self finishWithError:error];
+}
+
+@end
+
+@interface RTSMediaPlaylistSessionDelegate ()
+
+@property (nonatomic) NSMapTable<NSURLSessionTask *, RTSMediaPlaylistLoading *> *loadings;
+
+@end
+
+@implementation RTSMediaPlaylistSessionDelegate
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.loadings = [NSMapTable strongToStrongObjectsMapTable];
+	}
+	return self;
+}
+
+- (void)addLoading:(RTSMediaPlaylistLoading *)loading forTask:(NSURLSessionTask *)task
+{
+	@synchronized(self) {
+		[self.loadings setObject:loading forKey:task];
+	}
+}
+
+- (RTSMediaPlaylistLoading *)loadingForTask:(NSURLSessionTask *)task remove:(BOOL)remove
+{
+	@synchronized(self) {
+		RTSMediaPlaylistLoading *loading = [self.loadings objectForKey:task];
+		if (remove) {
+			[self.loadings removeObjectForKey:task];
+		}
+		return loading;
+	}
+}
+
+#pragma mark - NSURLSessionDataDelegate protocol
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler
+{
+	RTSMediaPlaylistLoading *loading = [self loadingForTask:dataTask remove:NO];
+	if (!loading) {
+		completionHandler(NSURLSessionResponseCancel);
+		return;
+	}
+
+	dispatch_async(loading.queue, ^{
+		[loading URLSession:session dataTask:dataTask didReceiveResponse:response completionHandler:completionHandler];
+	});
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
+{
+	RTSMediaPlaylistLoading *loading = [self loadingForTask:dataTask remove:NO];
+	if (!loading) {
+		return;
+	}
+
+	dispatch_async(loading.queue, ^{
+		[loading URLSession:session dataTask:dataTask didReceiveData:data];
+	});
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
+{
+	RTSMediaPlaylistLoading *loading = [self loadingForTask:task remove:YES];
+	if (!loading) {
+		return;
+	}
+
+	dispatch_async(loading.queue, ^{
+		[loading URLSession:session task:task didCompleteWithError:error];
+	});
+}
+
+@end
+
+/**
+ *  Resource loader delegate of a rewritten asset
+ */
+@interface RTSMediaPlaylistLoader : NSObject <AVAssetResourceLoaderDelegate>
+
+- (instancetype)initWithRewriter:(RTSMediaPlaylistRewriter *)rewriter
+						viewSize:(CGSize)viewSize
+			   blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+		removedTimeRangesHandler:(void (^)(NSURL *playlistURL, NSArray<NSValue *> *removedTimeRanges))removedTimeRangesHandler;
+
+@property (nonatomic, readonly) dispatch_queue_t queue;
+
+@end
+
+@interface RTSMediaPlaylistLoader ()
+
+@property (nonatomic) RTSMediaPlaylistRewriter *rewriter;
+@property (nonatomic) CGSize viewSize;
+@property (nonatomic) NSArray<NSValue *> *blockedTimeRanges;
+@property (nonatomic, copy) void (^removedTimeRangesHandler)(NSURL *playlistURL, NSArray<NSValue *> *removedTimeRanges);
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) NSMapTable<AVAssetResourceLoadingRequest *, RTSMediaPlaylistLoading *> *loadings;
+
+@end
+
+@implementation RTSMediaPlaylistLoader
+
+- (instancetype)initWithRewriter:(RTSMediaPlaylistRewriter *)rewriter
+						viewSize:(CGSize)viewSize
+			   blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+		removedTimeRangesHandler:(void (^)(NSURL *playlistURL, NSArray<NSValue *> *removedTimeRanges))removedTimeRangesHandler
+{
+	if (self = [super init]) {
+		self.rewriter = rewriter;
+		self.viewSize = viewSize;
+		self.blockedTimeRanges = blockedTimeRanges;
+		self.removedTimeRangesHandler = removedTimeRangesHandler;
+		self.queue = dispatch_queue_create("ch.srgssr.mediaplayer.playlistloader", DISPATCH_QUEUE_SERIAL);
+		self.loadings = [NSMapTable strongToStrongObjectsMapTable];
+	}
+	return self;
+}
+
+#pragma mark - AVAssetResourceLoaderDelegate protocol
+
+- (BOOL)resourceLoader:(AVAssetResourceLoader *)resourceLoader shouldWaitForLoadingOfRequestedResource:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	NSURL *originalURL = RTSMediaResourceLoadingOriginalURL(loadingRequest.request.URL, RTSMediaPlaylistRewriterSchemePrefix);
+	if (!originalURL) {
+		return NO;
+	}
+
+	RTSMediaPlaylistRewritingSession *rewritingSession = [[RTSMediaPlaylistRewritingSession alloc] initWithRewriter:self.rewriter
+																												 URL:originalURL
+																											viewSize:self.viewSize
+																								   blockedTimeRanges:self.blockedTimeRanges];
+
+	RTSMediaPlaylistLoading *loading = [[RTSMediaPlaylistLoading alloc] initWithLoadingRequest:loadingRequest URL:originalURL rewritingSession:rewritingSession completion:^(BOOL finished) {
+		[self.loadings removeObjectForKey:loadingRequest];
+
+		if (finished && rewritingSession.mediaPlaylist && self.removedTimeRangesHandler) {
+			self.removedTimeRangesHandler(originalURL, rewritingSession.removedTimeRanges);
+		}
+	}];
+	[self.loadings setObject:loading forKey:loadingRequest];
+	[loading startWithSession:self.rewriter.session queue:self.queue];
+	return YES;
+}
+
+- (void)resourceLoader:(AVAssetResourceLoader *)resourceLoader didCancelLoadingRequest:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	[[self.loadings objectForKey:loadingRequest] cancel];
+}
+
+@end
+
+#pragma mark - Rewriter
+
+@implementation RTSMediaPlaylistRewriter
+
+#pragma mark - Class methods
+
++ (RTSMediaPlaylistRewriter *)sharedPlaylistRewriter
+{
+	static RTSMediaPlaylistRewriter *s_sharedPlaylistRewriter;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		s_sharedPlaylistRewriter = [[RTSMediaPlaylistRewriter alloc] init];
+	});
+	return s_sharedPlaylistRewriter;
+}
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.maximumResolution = [UIScreen mainScreen].nativeBounds.size;
+		self.variantSelectionEnabled = YES;
+
+		// Playlists are reloaded often (live streams, variant switches), a single session lets connections be reused
+		NSOperationQueue *delegateQueue = [[NSOperationQueue alloc] init];
+		delegateQueue.maxConcurrentOperationCount = 1;
+		self.session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+													 delegate:[[RTSMediaPlaylistSessionDelegate alloc] init]
+												delegateQueue:delegateQueue];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	// The session retains its delegate until it is invalidated
+	[_session invalidateAndCancel];
+}
+
+#pragma mark - Bandwidth estimation
+
+- (void)reportObservedBandwidth:(double)observedBandwidth
+{
+	if (observedBandwidth <= 0.) {
+		return;
+	}
+
+	@synchronized(self) {
+		double estimatedBandwidth = self.estimatedBandwidth;
+		self.estimatedBandwidth = (estimatedBandwidth > 0.) ? estimatedBandwidth + RTSMediaPlaylistRewriterBandwidthSmoothingFactor * (observedBandwidth - estimatedBandwidth) : observedBandwidth;
+	}
+}
+
+#pragma mark - Rewriting
+
+- (AVURLAsset *)assetWithURL:(NSURL *)URL viewSize:(CGSize)viewSize
+{
+	return [self assetWithURL:URL viewSize:viewSize blockedTimeRanges:nil removedTimeRangesHandler:nil];
+}
+
+- (AVURLAsset *)assetWithURL:(NSURL *)URL
+					viewSize:(CGSize)viewSize
+		   blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+	removedTimeRangesHandler:(void (^)(NSURL *playlistURL, NSArray<NSValue *> *removedTimeRanges))removedTimeRangesHandler
+{
+	// Use a custom scheme so that the asset cannot load the playlist itself and asks its resource loader delegate
+	NSURL *interceptedURL = RTSMediaResourceLoadingInterceptedURL(URL, RTSMediaPlaylistRewriterSchemePrefix);
+	if (!interceptedURL) {
+		return [AVURLAsset URLAssetWithURL:URL options:nil];
+	}
+
+	AVURLAsset *asset = [AVURLAsset URLAssetWithURL:interceptedURL options:nil];
+
+	// The resource loader only keeps a weak reference to its delegate
+	RTSMediaPlaylistLoader *loader = [[RTSMediaPlaylistLoader alloc] initWithRewriter:self
+																			  viewSize:viewSize
+																	 blockedTimeRanges:blockedTimeRanges
+															  removedTimeRangesHandler:removedTimeRangesHandler];
+	[asset.resourceLoader setDelegate:loader queue:loader.queue];
+	objc_setAssociatedObject(asset, RTSMediaPlaylistRewriterLoaderKey, loader, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+
+	return asset;
+}
+
+- (NSData *)rewrittenPlaylistWithData:(NSData *)data URL:(NSURL *)URL viewSize:(CGSize)viewSize
+{
+	return [self rewrittenPlaylistWithData:data URL:URL viewSize:viewSize blockedTimeRanges:nil removedTimeRanges:NULL];
+}
+
+- (NSData *)rewrittenPlaylistWithData:(NSData *)data
+								  URL:(NSURL *)URL
+							 viewSize:(CGSize)viewSize
+					blockedTimeRanges:(NSArray<NSValue *> *)blockedTimeRanges
+					removedTimeRanges:(NSArray<NSValue *> **)pRemovedTimeRanges
+{
+	RTSMediaPlaylistRewritingSession *rewritingSession = [[RTSMediaPlaylistRewritingSession alloc] initWithRewriter:self
+																												 URL:URL
+																											viewSize:viewSize
+																								   blockedTimeRanges:blockedTimeRanges];
+	NSMutableData *rewrittenData = [NSMutableData dataWithData:[rewritingSession appendData:data]];
+	[rewrittenData appendData:[rewritingSession finish]];
+
+	if (pRemovedTimeRanges) {
+		*pRemovedTimeRanges = rewritingSession.removedTimeRanges;
+	}
+	return [rewrittenData copy];
+}
+
+@end
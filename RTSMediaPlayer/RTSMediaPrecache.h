@@ -0,0 +1,115 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+
+#import "RTSMediaPlayerController.h"
+#import "RTSMediaPlayerControllerDataSource.h"
+
+@class RTSMediaPlaylistRewriter;
+
+/**
+ *  A precache prepares medias likely to be played soon (e.g. the morning news, or a daily podcast), so that their
+ *  playback starts without waiting for the network. For each identifier, and within a byte budget, it:
+ *
+ *    - Resolves the content URL with a data source (e.g. token resolution).
+ *    - Fetches the master playlist, and the media playlist of the variant playback starts with (the first one listed).
+ *    - Fetches the media segments covering the first seconds of on-demand medias.
+ *
+ *  Assign a precache to the `precache` property of a media player controller. When the controller loads a precached
+ *  identifier, it uses the content URL resolved in advance without asking its data source, and playlists and segments
+ *  are served from the cache. Other variants and the remaining segments are loaded from the network as usual.
+ *
+ *  Entries are stored in a directory and expire after `maximumEntryAge`. When the byte budget is exceeded, the oldest
+ *  entries are evicted. Precaching continues when the application enters the background (within a background task),
+ *  and can be started from a background fetch (`-application:performFetchWithCompletionHandler:`). Precaches can be
+ *  used from any thread
+ */
+@interface RTSMediaPrecache : NSObject
+
+/**
+ *  A precache shared by all controllers, stored in the caches directory
+ */
++ (RTSMediaPrecache *)sharedPrecache;
+
+/**
+ *  Create a precache storing its entries in the specified directory, created if needed. Entries already stored in the
+ *  directory are reused. `-init` uses a directory in the temporary directory
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) NSURL *directoryURL;
+
+/**
+ *  The maximum number of bytes stored. Default is 50 MB
+ */
+@property (atomic) unsigned long long byteBudget;
+
+/**
+ *  The duration of the media segments fetched at the beginning of on-demand medias, in seconds. Default is 10 seconds
+ */
+@property (atomic) NSTimeInterval prefetchedDuration;
+
+/**
+ *  The age after which entries are not used anymore, in seconds (resolved URLs might contain tokens which expire).
+ *  Default is 6 hours
+ */
+@property (atomic) NSTimeInterval maximumEntryAge;
+
+/**
+ *  If set, master playlists are rewritten before the variant to fetch is chosen, and served as rewritten. The playlist
+ *  rewriter of a controller playing a precached media is not used. Default is nil
+ */
+@property (atomic) RTSMediaPlaylistRewriter *playlistRewriter;
+
+/**
+ *  Precache medias in order, the first ones having priority for the byte budget. Identifiers already precached are
+ *  skipped. The data source is called on the main thread, with a nil controller. The completion handler is called on
+ *  the main thread with the identifiers available from the cache
+ */
+- (void)precacheIdentifiers:(NSArray<NSString *> *)identifiers
+			 withDataSource:(id<RTSMediaPlayerControllerDataSource>)dataSource
+		  completionHandler:(void (^)(NSArray<NSString *> *precachedIdentifiers))completionHandler;
+
+/**
+ *  Return YES iff an entry which has not expired is available for the identifier
+ */
+- (BOOL)containsIdentifier:(NSString *)identifier;
+
+/**
+ *  The number of bytes stored
+ */
+@property (nonatomic, readonly) unsigned long long byteCount;
+
+/**
+ *  Remove the entry of an identifier, or all entries
+ */
+- (void)removeIdentifier:(NSString *)identifier;
+- (void)removeAllIdentifiers;
+
+/**
+ *  The content URL resolved for an identifier, nil if none or if the entry has expired
+ */
+- (NSURL *)contentURLForIdentifier:(NSString *)identifier;
+
+/**
+ *  Return an asset playing the specified content URL from the cache, nil if the identifier has no entry for this URL.
+ *  Resources which are not available from the cache anymore are loaded from the network
+ */
+- (AVURLAsset *)assetForIdentifier:(NSString *)identifier contentURL:(NSURL *)contentURL;
+
+@end
+
+@interface RTSMediaPlayerController (RTSMediaPrecache)
+
+/**
+ *  The precache from which the controller loads precached identifiers. Default is nil (no precaching). Medias whose
+ *  segments are blocked (see `RTSMediaSegmentsController`) are never played from the cache
+ */
+@property (nonatomic) RTSMediaPrecache *precache;
+
+@end
@@ -0,0 +1,770 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaPrecache.h"
+
+#import <MobileCoreServices/MobileCoreServices.h>
+#import <objc/runtime.h>
+#import <QuartzCore/QuartzCore.h>
+#import <UIKit/UIKit.h>
+
+#import "RTSMediaPlayerLogger+Private.h"
+#import "RTSMediaPlaylistRewriter.h"
+#import "RTSMediaResourceLoading+Private.h"
+
+// Prefix added to the scheme of the URLs of cached resources, so that they are loaded through the resource loader
+static NSString * const RTSMediaPrecacheSchemePrefix = @"rtsprecache-";
+
+static NSString * const RTSMediaPrecacheIndexFileName = @"Index.plist";
+
+// Entry keys
+static NSString * const RTSMediaPrecacheContentURLKey = @"ContentURL";
+static NSString * const RTSMediaPrecacheDateKey = @"Date";
+static NSString * const RTSMediaPrecacheDirectoryNameKey = @"DirectoryName";
+static NSString * const RTSMediaPrecacheByteCountKey = @"ByteCount";
+static NSString * const RTSMediaPrecacheResourcesKey = @"Resources";				// Resources by absolute URL string
+
+// Resource keys
+static NSString * const RTSMediaPrecacheFileNameKey = @"FileName";
+static NSString * const RTSMediaPrecacheContentTypeKey = @"ContentType";
+
+static NSString * const RTSMediaPrecachePlaylistContentType = @"public.m3u-playlist";
+
+static void *RTSMediaPrecacheLoaderKey = &RTSMediaPrecacheLoaderKey;
+
+// Uniform type identifier of a resource, from its MIME type or, if not meaningful, from its path extension
+static NSString *RTSMediaPrecacheContentType(NSURLResponse *response, NSURL *URL)
+{
+	NSString *MIMEType = response.MIMEType;
+	if (MIMEType && ![MIMEType isEqualToString:@"application/octet-stream"]) {
+		NSString *contentType = CFBridgingRelease(UTTypeCreatePreferredIdentifierForTag(kUTTagClassMIMEType, (__bridge CFStringRef)MIMEType, NULL));
+		if (contentType && ![contentType hasPrefix:@"dyn."]) {
+			return contentType;
+		}
+	}
+
+	NSString *pathExtension = URL.pathExtension;
+	if (pathExtension.length != 0) {
+		NSString *contentType = CFBridgingRelease(UTTypeCreatePreferredIdentifierForTag(kUTTagClassFilenameExtension, (__bridge CFStringRef)pathExtension, NULL));
+		if (contentType && ![contentType hasPrefix:@"dyn."]) {
+			return contentType;
+		}
+	}
+
+	return (__bridge NSString *)kUTTypeData;
+}
+
+// The URL of the first variant listed in a master playlist, nil if the playlist is a media playlist
+static NSURL *RTSMediaPrecacheFirstVariantURL(NSString *playlistString, NSURL *URL)
+{
+	__block NSURL *variantURL = nil;
+	__block BOOL streamInformation = NO;
+	[playlistString enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+		line = [line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+		if ([line hasPrefix:@"#EXT-X-STREAM-INF"]) {
+			streamInformation = YES;
+		}
+		else if (streamInformation && line.length != 0 && ![line hasPrefix:@"#"]) {
+			variantURL = [NSURL URLWithString:line relativeToURL:URL].absoluteURL;
+			*stop = YES;
+		}
+	}];
+	return variantURL;
+}
+
+// The URLs of the media segments covering at least the specified duration from the start of a media playlist, nil if
+// segments cannot be precached (live playlists, whose start moves, or byte range segments)
+static NSArray<NSURL *> *RTSMediaPrecacheSegmentURLs(NSString *playlistString, NSURL *URL, NSTimeInterval duration)
+{
+	NSMutableArray<NSURL *> *segmentURLs = [NSMutableArray array];
+	__block NSTimeInterval segmentsDuration = 0.;
+	__block NSTimeInterval segmentDuration = 0.;
+	__block BOOL ended = NO;
+	__block BOOL byteRanges = NO;
+	[playlistString enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+		line = [line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+		if ([line hasPrefix:@"#EXTINF:"]) {
+			segmentDuration = [line substringFromIndex:8].doubleValue;
+		}
+		else if ([line hasPrefix:@"#EXT-X-BYTERANGE"]) {
+			byteRanges = YES;
+		}
+		else if ([line hasPrefix:@"#EXT-X-ENDLIST"]) {
+			ended = YES;
+		}
+		else if (line.length != 0 && ![line hasPrefix:@"#"]) {
+			NSURL *segmentURL = [NSURL URLWithString:line relativeToURL:URL].absoluteURL;
+			if (segmentURL && segmentsDuration < duration) {
+				[segmentURLs addObject:segmentURL];
+			}
+			segmentsDuration += segmentDuration;
+			segmentDuration = 0.;
+		}
+	}];
+	return (ended && !byteRanges) ? [segmentURLs copy] : nil;
+}
+
+// Make the URIs of a playlist absolute, cached resources being loaded through the resource loader delegate
+static NSString *RTSMediaPrecachePlaylistString(NSString *playlistString, NSURL *URL, NSSet<NSString *> *cachedURLStrings)
+{
+	NSString *(^servedURIString)(NSString *) = ^(NSString *URIString) {
+		NSURL *absoluteURL = [NSURL URLWithString:URIString relativeToURL:URL].absoluteURL;
+		if (!absoluteURL) {
+			return URIString;
+		}
+
+		NSURL *interceptedURL = [cachedURLStrings containsObject:absoluteURL.absoluteString] ? RTSMediaResourceLoadingInterceptedURL(absoluteURL, RTSMediaPrecacheSchemePrefix) : nil;
+		return (interceptedURL ?: absoluteURL).absoluteString;
+	};
+
+	NSMutableString *servedPlaylistString = [NSMutableString string];
+	[playlistString enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+		NSString *trimmedLine = [line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+		if (trimmedLine.length != 0 && ![trimmedLine hasPrefix:@"#"]) {
+			line = servedURIString(trimmedLine);
+		}
+		else {
+			// URI attributes of tags (keys, alternate renditions, initialization sections)
+			NSRange attributeRange = [trimmedLine rangeOfString:@"URI=\""];
+			if (attributeRange.location != NSNotFound) {
+				NSUInteger start = NSMaxRange(attributeRange);
+				NSRange endRange = [trimmedLine rangeOfString:@"\"" options:0 range:NSMakeRange(start, trimmedLine.length - start)];
+				if (endRange.location != NSNotFound) {
+					NSRange URIRange = NSMakeRange(start, endRange.location - start);
+					line = [trimmedLine stringByReplacingCharactersInRange:URIRange withString:servedURIString([trimmedLine substringWithRange:URIRange])];
+				}
+			}
+		}
+		[servedPlaylistString appendFormat:@"%@\n", line];
+	}];
+	return [servedPlaylistString copy];
+}
+
+#pragma mark - Loading
+
+/**
+ *  Resource loader delegate of an asset played from the cache. Resources which are not available from the cache (e.g.
+ *  evicted since the asset was created) are loaded from the network
+ */
+@interface RTSMediaPrecacheLoader : NSObject <AVAssetResourceLoaderDelegate>
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL resources:(NSDictionary<NSString *, NSDictionary *> *)resources;
+
+@property (nonatomic, readonly) dispatch_queue_t queue;
+
+@end
+
+@interface RTSMediaPrecacheLoader ()
+
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) NSDictionary<NSString *, NSDictionary *> *resources;
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) NSMapTable<AVAssetResourceLoadingRequest *, NSURLSessionDataTask *> *dataTasks;
+
+@end
+
+@implementation RTSMediaPrecacheLoader
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL resources:(NSDictionary<NSString *, NSDictionary *> *)resources
+{
+	if (self = [super init]) {
+		self.directoryURL = directoryURL;
+		self.resources = resources;
+		self.queue = dispatch_queue_create("ch.srgssr.mediaplayer.precacheloader", DISPATCH_QUEUE_SERIAL);
+		self.dataTasks = [NSMapTable strongToStrongObjectsMapTable];
+	}
+	return self;
+}
+
+#pragma mark - AVAssetResourceLoaderDelegate protocol
+
+- (BOOL)resourceLoader:(AVAssetResourceLoader *)resourceLoader shouldWaitForLoadingOfRequestedResource:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	NSURL *originalURL = RTSMediaResourceLoadingOriginalURL(loadingRequest.request.URL, RTSMediaPrecacheSchemePrefix);
+	if (!originalURL) {
+		return NO;
+	}
+
+	NSDictionary *resource = self.resources[originalURL.absoluteString];
+	if (resource) {
+		NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:resource[RTSMediaPrecacheFileNameKey]];
+		NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:NULL];
+		if (data) {
+			RTSMediaResourceLoadingRespond(loadingRequest, data, resource[RTSMediaPrecacheContentTypeKey]);
+			return YES;
+		}
+
+		RTSMediaPlayerLogWarning(@"Precached resource %@ not available anymore, loading it from the network", originalURL);
+	}
+
+	// Loaded as a whole, only playlists and short segments are expected
+	NSURLSessionDataTask *dataTask = RTSMediaResourceLoadingDataTask([NSURLSession sharedSession], originalURL, ^(NSData *data, NSURLResponse *response, NSError *error) {
+		dispatch_async(self.queue, ^{
+			if (![self.dataTasks objectForKey:loadingRequest]) {
+				return;
+			}
+			[self.dataTasks removeObjectForKey:loadingRequest];
+
+			if (error) {
+				[loadingRequest finishLoadingWithError:error];
+				return;
+			}
+
+			NSString *contentType = [originalURL.pathExtension.lowercaseString isEqualToString:@"m3u8"] ? RTSMediaPrecachePlaylistContentType : RTSMediaPrecacheContentType(response, originalURL);
+			RTSMediaResourceLoadingRespond(loadingRequest, data, contentType);
+		});
+	});
+	[self.dataTasks setObject:dataTask forKey:loadingRequest];
+	[dataTask resume];
+	return YES;
+}
+
+- (void)resourceLoader:(AVAssetResourceLoader *)resourceLoader didCancelLoadingRequest:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	[[self.dataTasks objectForKey:loadingRequest] cancel];
+	[self.dataTasks removeObjectForKey:loadingRequest];
+}
+
+@end
+
+#pragma mark - Precaching
+
+/**
+ *  Resources of an entry being precached, written to its directory within a byte budget
+ */
+@interface RTSMediaPrecacheEntryWriter : NSObject
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL byteBudget:(unsigned long long)byteBudget;
+
+@property (nonatomic, readonly) NSURL *directoryURL;
+@property (nonatomic, readonly) unsigned long long byteCount;
+@property (nonatomic, readonly) NSDictionary<NSString *, NSDictionary *> *resources;
+
+/**
+ *  Bytes not available for the resources written afterwards
+ */
+@property (nonatomic) unsigned long long reservedByteCount;
+
+/**
+ *  Write the data of a resource. Return NO if the budget would be exceeded or if the data could not be written
+ */
+- (BOOL)writeData:(NSData *)data contentType:(NSString *)contentType forURL:(NSURL *)URL;
+
+- (void)discard;
+
+@end
+
+@interface RTSMediaPrecacheEntryWriter ()
+
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) unsigned long long byteBudget;
+@property (nonatomic) unsigned long long byteCount;
+@property (nonatomic) NSMutableDictionary<NSString *, NSDictionary *> *mutableResources;
+
+@end
+
+@implementation RTSMediaPrecacheEntryWriter
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL byteBudget:(unsigned long long)byteBudget
+{
+	if (self = [super init]) {
+		self.directoryURL = directoryURL;
+		self.byteBudget = byteBudget;
+		self.mutableResources = [NSMutableDictionary dictionary];
+	}
+	return self;
+}
+
+- (NSDictionary<NSString *, NSDictionary *> *)resources
+{
+	return [self.mutableResources copy];
+}
+
+- (BOOL)writeData:(NSData *)data contentType:(NSString *)contentType forURL:(NSURL *)URL
+{
+	if (self.byteCount + self.reservedByteCount + data.length > self.byteBudget) {
+		return NO;
+	}
+
+	NSString *fileName = @(self.mutableResources.count).stringValue;
+	NSError *error = nil;
+	if (![[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:&error]
+			|| ![data writeToURL:[self.directoryURL URLByAppendingPathComponent:fileName] options:NSDataWritingAtomic error:&error]) {
+		RTSMediaPlayerLogError(@"Precached resource %@ could not be written. Reason: %@", URL, error);
+		return NO;
+	}
+
+	self.mutableResources[URL.absoluteString] = @{ RTSMediaPrecacheFileNameKey : fileName,
+												   RTSMediaPrecacheContentTypeKey : contentType };
+	self.byteCount += data.length;
+	return YES;
+}
+
+- (void)discard
+{
+	[[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:NULL];
+	[self.mutableResources removeAllObjects];
+	self.byteCount = 0;
+}
+
+@end
+
+/**
+ *  Identifiers precached by a single request
+ */
+@interface RTSMediaPrecacheBatch : NSObject
+
+@property (atomic, getter=isCancelled) BOOL cancelled;
+@property (nonatomic) UIBackgroundTaskIdentifier backgroundTaskIdentifier;
+
+// Accessed on the precache queue only
+@property (nonatomic) NSMutableArray<NSString *> *precachedIdentifiers;
+@property (nonatomic) unsigned long long byteCount;
+
+@end
+
+@implementation RTSMediaPrecacheBatch
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.precachedIdentifiers = [NSMutableArray array];
+		self.backgroundTaskIdentifier = UIBackgroundTaskInvalid;
+	}
+	return self;
+}
+
+@end
+
+@interface RTSMediaPrecache ()
+
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) NSMutableDictionary<NSString *, NSDictionary *> *entries;
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) NSURLSession *session;
+
+@end
+
+@implementation RTSMediaPrecache
+
+#pragma mark - Class methods
+
++ (RTSMediaPrecache *)sharedPrecache
+{
+	static RTSMediaPrecache *s_sharedPrecache;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		NSURL *cachesURL = [[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask].firstObject;
+		NSURL *directoryURL = [[cachesURL URLByAppendingPathComponent:@"SRGMediaPlayer"] URLByAppendingPathComponent:@"Precache"];
+		s_sharedPrecache = [[RTSMediaPrecache alloc] initWithDirectoryURL:directoryURL];
+	});
+	return s_sharedPrecache;
+}
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithDirectoryURL:[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"SRGMediaPlayerPrecache"]]];
+}
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL
+{
+	if (self = [super init]) {
+		self.directoryURL = directoryURL;
+		self.byteBudget = 50 * 1024 * 1024;
+		self.prefetchedDuration = 10.;
+		self.maximumEntryAge = 6. * 60. * 60.;
+		self.queue = dispatch_queue_create("ch.srgssr.mediaplayer.precache", DISPATCH_QUEUE_SERIAL);
+
+		NSOperationQueue *delegateQueue = [[NSOperationQueue alloc] init];
+		delegateQueue.maxConcurrentOperationCount = 1;
+		delegateQueue.underlyingQueue = self.queue;
+		self.session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration] delegate:nil delegateQueue:delegateQueue];
+
+		[[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+		NSDictionary *entries = [NSDictionary dictionaryWithContentsOfURL:[directoryURL URLByAppendingPathComponent:RTSMediaPrecacheIndexFileName]];
+		self.entries = [entries isKindOfClass:[NSDictionary class]] ? [entries mutableCopy] : [NSMutableDictionary dictionary];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[_session invalidateAndCancel];
+}
+
+#pragma mark - Getters and setters
+
+- (unsigned long long)byteCount
+{
+	@synchronized(self) {
+		return [[self.entries.allValues valueForKeyPath:[NSString stringWithFormat:@"@sum.%@", RTSMediaPrecacheByteCountKey]] unsignedLongLongValue];
+	}
+}
+
+#pragma mark - Entries
+
+- (NSDictionary *)freshEntryForIdentifier:(NSString *)identifier
+{
+	if (!identifier) {
+		return nil;
+	}
+
+	@synchronized(self) {
+		NSDictionary *entry = self.entries[identifier];
+		NSDate *date = entry[RTSMediaPrecacheDateKey];
+		return (date && -[date timeIntervalSinceNow] < self.maximumEntryAge) ? entry : nil;
+	}
+}
+
+- (BOOL)containsIdentifier:(NSString *)identifier
+{
+	return [self freshEntryForIdentifier:identifier] != nil;
+}
+
+- (NSURL *)contentURLForIdentifier:(NSString *)identifier
+{
+	NSString *contentURLString = [self freshEntryForIdentifier:identifier][RTSMediaPrecacheContentURLKey];
+	return contentURLString ? [NSURL URLWithString:contentURLString] : nil;
+}
+
+- (AVURLAsset *)assetForIdentifier:(NSString *)identifier contentURL:(NSURL *)contentURL
+{
+	NSDictionary *entry = [self freshEntryForIdentifier:identifier];
+	NSDictionary<NSString *, NSDictionary *> *resources = entry[RTSMediaPrecacheResourcesKey];
+	if (![entry[RTSMediaPrecacheContentURLKey] isEqualToString:contentURL.absoluteString] || !resources[contentURL.absoluteString]) {
+		return nil;
+	}
+
+	NSURL *interceptedURL = RTSMediaResourceLoadingInterceptedURL(contentURL, RTSMediaPrecacheSchemePrefix);
+	if (!interceptedURL) {
+		return nil;
+	}
+
+	AVURLAsset *asset = [AVURLAsset URLAssetWithURL:interceptedURL options:nil];
+
+	// The resource loader only keeps a weak reference to its delegate
+	NSURL *entryDirectoryURL = [self.directoryURL URLByAppendingPathComponent:entry[RTSMediaPrecacheDirectoryNameKey]];
+	RTSMediaPrecacheLoader *loader = [[RTSMediaPrecacheLoader alloc] initWithDirectoryURL:entryDirectoryURL resources:resources];
+	[asset.resourceLoader setDelegate:loader queue:loader.queue];
+	objc_setAssociatedObject(asset, RTSMediaPrecacheLoaderKey, loader, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+
+	RTSMediaPlayerLogDebug(@"Playing %@ from the precache (%@ resources)", identifier, @(resources.count));
+	return asset;
+}
+
+// Store an entry, evicting the oldest entries except the protected ones until the budget is respected
+- (void)storeEntry:(NSDictionary *)entry forIdentifier:(NSString *)identifier protectedIdentifiers:(NSArray<NSString *> *)protectedIdentifiers
+{
+	@synchronized(self) {
+		[self removeEntryForIdentifier:identifier];
+		self.entries[identifier] = entry;
+
+		unsigned long long byteBudget = self.byteBudget;
+		while (self.byteCount > byteBudget) {
+			NSString *oldestIdentifier = nil;
+			NSDate *oldestDate = nil;
+			for (NSString *entryIdentifier in self.entries) {
+				NSDate *date = self.entries[entryIdentifier][RTSMediaPrecacheDateKey];
+				if ([entryIdentifier isEqualToString:identifier] || [protectedIdentifiers containsObject:entryIdentifier]) {
+					continue;
+				}
+				if (!oldestDate || [date compare:oldestDate] == NSOrderedAscending) {
+					oldestIdentifier = entryIdentifier;
+					oldestDate = date;
+				}
+			}
+
+			if (!oldestIdentifier) {
+				break;
+			}
+
+			RTSMediaPlayerLogDebug(@"Precached %@ evicted", oldestIdentifier);
+			[self removeEntryForIdentifier:oldestIdentifier];
+		}
+
+		[self writeIndex];
+	}
+}
+
+// Must be called within a section synchronized on self
+- (void)removeEntryForIdentifier:(NSString *)identifier
+{
+	NSString *directoryName = self.entries[identifier][RTSMediaPrecacheDirectoryNameKey];
+	if (directoryName) {
+		[[NSFileManager defaultManager] removeItemAtURL:[self.directoryURL URLByAppendingPathComponent:directoryName] error:NULL];
+	}
+	[self.entries removeObjectForKey:identifier];
+}
+
+// Must be called within a section synchronized on self
+- (void)writeIndex
+{
+	NSURL *indexURL = [self.directoryURL URLByAppendingPathComponent:RTSMediaPrecacheIndexFileName];
+	if (![self.entries writeToURL:indexURL atomically:YES]) {
+		RTSMediaPlayerLogError(@"Precache index could not be written to %@", indexURL);
+	}
+}
+
+- (void)removeIdentifier:(NSString *)identifier
+{
+	if (!identifier) {
+		return;
+	}
+
+	@synchronized(self) {
+		[self removeEntryForIdentifier:identifier];
+		[self writeIndex];
+	}
+}
+
+- (void)removeAllIdentifiers
+{
+	@synchronized(self) {
+		for (NSString *identifier in self.entries.allKeys) {
+			[self removeEntryForIdentifier:identifier];
+		}
+		[self writeIndex];
+	}
+}
+
+#pragma mark - Precaching
+
+- (void)precacheIdentifiers:(NSArray<NSString *> *)identifiers
+			 withDataSource:(id<RTSMediaPlayerControllerDataSource>)dataSource
+		  completionHandler:(void (^)(NSArray<NSString *> *precachedIdentifiers))completionHandler
+{
+	NSParameterAssert(dataSource);
+
+	RTSMediaPrecacheBatch *batch = [[RTSMediaPrecacheBatch alloc] init];
+
+	// Keep precaching if the application enters the background, or when precaching is started in the background
+	void (^beginBackgroundTask)(void) = ^{
+		UIApplication *application = [UIApplication sharedApplication];
+		batch.backgroundTaskIdentifier = [application beginBackgroundTaskWithName:@"RTSMediaPrecache" expirationHandler:^{
+			RTSMediaPlayerLogWarning(@"Precaching interrupted, background execution time has expired");
+			batch.cancelled = YES;
+			[application endBackgroundTask:batch.backgroundTaskIdentifier];
+			batch.backgroundTaskIdentifier = UIBackgroundTaskInvalid;
+		}];
+	};
+	[NSThread isMainThread] ? beginBackgroundTask() : dispatch_sync(dispatch_get_main_queue(), beginBackgroundTask);
+
+	CFTimeInterval startTime = CACurrentMediaTime();
+	dispatch_async(self.queue, ^{
+		[self precacheIdentifiers:identifiers atIndex:0 withDataSource:dataSource batch:batch completionHandler:^{
+			RTSMediaPlayerLogInfo(@"%@ of %@ identifiers precached in %.3f sec. (%@ bytes)",
+								  @(batch.precachedIdentifiers.count), @(identifiers.count), CACurrentMediaTime() - startTime, @(batch.byteCount));
+
+			NSArray<NSString *> *precachedIdentifiers = [batch.precachedIdentifiers copy];
+			dispatch_async(dispatch_get_main_queue(), ^{
+				if (batch.backgroundTaskIdentifier != UIBackgroundTaskInvalid) {
+					[[UIApplication sharedApplication] endBackgroundTask:batch.backgroundTaskIdentifier];
+					batch.backgroundTaskIdentifier = UIBackgroundTaskInvalid;
+				}
+
+				if (completionHandler) {
+					completionHandler(precachedIdentifiers);
+				}
+			});
+		}];
+	});
+}
+
+// Precache identifiers one after the other, on the queue
+- (void)precacheIdentifiers:(NSArray<NSString *> *)identifiers
+					atIndex:(NSUInteger)index
+			 withDataSource:(id<RTSMediaPlayerControllerDataSource>)dataSource
+					  batch:(RTSMediaPrecacheBatch *)batch
+		  completionHandler:(void (^)(void))completionHandler
+{
+	if (index >= identifiers.count || batch.cancelled) {
+		completionHandler();
+		return;
+	}
+
+	NSString *identifier = identifiers[index];
+	void (^precacheNextIdentifier)(NSDictionary *) = ^(NSDictionary *entry) {
+		if (entry) {
+			[batch.precachedIdentifiers addObject:identifier];
+			batch.byteCount += [entry[RTSMediaPrecacheByteCountKey] unsignedLongLongValue];
+		}
+		[self precacheIdentifiers:identifiers atIndex:index + 1 withDataSource:dataSource batch:batch completionHandler:completionHandler];
+	};
+
+	NSDictionary *entry = [self freshEntryForIdentifier:identifier];
+	if (entry) {
+		precacheNextIdentifier(entry);
+		return;
+	}
+
+	dispatch_async(dispatch_get_main_queue(), ^{
+		[dataSource mediaPlayerController:nil contentURLForIdentifier:identifier completionHandler:^(NSString *resolvedIdentifier, NSURL *contentURL, NSError *error) {
+			dispatch_async(self.queue, ^{
+				if (!contentURL) {
+					RTSMediaPlayerLogWarning(@"The URL of %@ could not be resolved for precaching. Reason: %@", identifier, error);
+					precacheNextIdentifier(nil);
+					return;
+				}
+
+				unsigned long long byteBudget = self.byteBudget;
+				byteBudget = (byteBudget > batch.byteCount) ? byteBudget - batch.byteCount : 0;
+				[self precacheContentURL:contentURL byteBudget:byteBudget batch:batch completionHandler:^(NSDictionary *entry) {
+					if (entry) {
+						[self storeEntry:entry forIdentifier:identifier protectedIdentifiers:batch.precachedIdentifiers];
+					}
+					precacheNextIdentifier(entry);
+				}];
+			});
+		}];
+	});
+}
+
+// Fetch a resource, calling the completion handler on the queue
+- (void)fetchURL:(NSURL *)URL completionHandler:(void (^)(NSData *data, NSString *contentType, NSError *error))completionHandler
+{
+	[RTSMediaResourceLoadingDataTask(self.session, URL, ^(NSData *data, NSURLResponse *response, NSError *error) {
+		if (error) {
+			RTSMediaPlayerLogWarning(@"%@ could not be precached. Reason: %@", URL, error);
+			completionHandler(nil, nil, error);
+		}
+		else {
+			completionHandler(data, RTSMediaPrecacheContentType(response, URL), nil);
+		}
+	}) resume];
+}
+
+- (void)precacheContentURL:(NSURL *)contentURL
+				byteBudget:(unsigned long long)byteBudget
+					 batch:(RTSMediaPrecacheBatch *)batch
+		 completionHandler:(void (^)(NSDictionary *entry))completionHandler
+{
+	NSString *directoryName = [NSUUID UUID].UUIDString;
+	RTSMediaPrecacheEntryWriter *entryWriter = [[RTSMediaPrecacheEntryWriter alloc] initWithDirectoryURL:[self.directoryURL URLByAppendingPathComponent:directoryName]
+																							   byteBudget:byteBudget];
+	NSDictionary *(^entry)(void) = ^{
+		return @{ RTSMediaPrecacheContentURLKey : contentURL.absoluteString,
+				  RTSMediaPrecacheDateKey : [NSDate date],
+				  RTSMediaPrecacheDirectoryNameKey : directoryName,
+				  RTSMediaPrecacheByteCountKey : @(entryWriter.byteCount),
+				  RTSMediaPrecacheResourcesKey : entryWriter.resources };
+	};
+
+	// Only the URL can be precached for other kinds of URLs (e.g. local files)
+	if (!RTSMediaResourceLoadingInterceptedURL(contentURL, RTSMediaPrecacheSchemePrefix)) {
+		completionHandler(entry());
+		return;
+	}
+
+	[self fetchURL:contentURL completionHandler:^(NSData *masterData, NSString *masterContentType, NSError *masterError) {
+		if (!masterData) {
+			completionHandler(nil);
+			return;
+		}
+
+		if (self.playlistRewriter) {
+			masterData = [self.playlistRewriter rewrittenPlaylistWithData:masterData URL:contentURL viewSize:CGSizeZero];
+		}
+
+		NSString *masterString = [[NSString alloc] initWithData:masterData encoding:NSUTF8StringEncoding];
+		NSURL *variantURL = RTSMediaPrecacheFirstVariantURL(masterString, contentURL);
+		if (!variantURL) {
+			[self precacheMasterString:masterString variantString:nil variantURL:contentURL contentURL:contentURL entryWriter:entryWriter batch:batch completionHandler:^{
+				completionHandler(entry());
+			}];
+			return;
+		}
+
+		[self fetchURL:variantURL completionHandler:^(NSData *variantData, NSString *variantContentType, NSError *variantError) {
+			NSString *variantString = variantData ? [[NSString alloc] initWithData:variantData encoding:NSUTF8StringEncoding] : nil;
+			[self precacheMasterString:masterString variantString:variantString variantURL:variantURL contentURL:contentURL entryWriter:entryWriter batch:batch completionHandler:^{
+				completionHandler(entry());
+			}];
+		}];
+	}];
+}
+
+// Precache the first segments of the variant, then the playlists served to the player. The variant string is nil if
+// the master playlist is a media playlist, or if the variant playlist could not be fetched
+- (void)precacheMasterString:(NSString *)masterString
+			   variantString:(NSString *)variantString
+				  variantURL:(NSURL *)variantURL
+				  contentURL:(NSURL *)contentURL
+				 entryWriter:(RTSMediaPrecacheEntryWriter *)entryWriter
+					   batch:(RTSMediaPrecacheBatch *)batch
+		   completionHandler:(void (^)(void))completionHandler
+{
+	BOOL masterIsVariant = [variantURL isEqual:contentURL];
+	NSString *mediaString = masterIsVariant ? masterString : variantString;
+	NSArray<NSURL *> *segmentURLs = mediaString ? RTSMediaPrecacheSegmentURLs(mediaString, variantURL, self.prefetchedDuration) : nil;
+
+	// Playlists are written once the segments cached are known. Reserve the largest size they can have
+	NSSet<NSString *> *allCachedURLStrings = [NSSet setWithArray:[[segmentURLs valueForKey:@"absoluteString"] arrayByAddingObject:variantURL.absoluteString]];
+	NSUInteger playlistsLength = [RTSMediaPrecachePlaylistString(masterString, contentURL, allCachedURLStrings) lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	if (!masterIsVariant && variantString) {
+		playlistsLength += [RTSMediaPrecachePlaylistString(variantString, variantURL, allCachedURLStrings) lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	}
+	entryWriter.reservedByteCount = playlistsLength;
+
+	[self precacheSegmentURLs:segmentURLs atIndex:0 entryWriter:entryWriter batch:batch completionHandler:^{
+		entryWriter.reservedByteCount = 0;
+
+		NSMutableSet<NSString *> *cachedURLStrings = [NSMutableSet setWithArray:entryWriter.resources.allKeys];
+		if (!masterIsVariant && variantString) {
+			NSData *variantData = [RTSMediaPrecachePlaylistString(variantString, variantURL, cachedURLStrings) dataUsingEncoding:NSUTF8StringEncoding];
+			if ([entryWriter writeData:variantData contentType:RTSMediaPrecachePlaylistContentType forURL:variantURL]) {
+				[cachedURLStrings addObject:variantURL.absoluteString];
+			}
+		}
+
+		NSData *masterData = [RTSMediaPrecachePlaylistString(masterString, contentURL, cachedURLStrings) dataUsingEncoding:NSUTF8StringEncoding];
+		if (![entryWriter writeData:masterData contentType:RTSMediaPrecachePlaylistContentType forURL:contentURL]) {
+			// Resources cannot be served without the master playlist, only the URL remains precached
+			[entryWriter discard];
+		}
+
+		RTSMediaPlayerLogDebug(@"%@ precached: %@ resources, %@ bytes", contentURL, @(entryWriter.resources.count), @(entryWriter.byteCount));
+		completionHandler();
+	}];
+}
+
+- (void)precacheSegmentURLs:(NSArray<NSURL *> *)segmentURLs
+					atIndex:(NSUInteger)index
+				entryWriter:(RTSMediaPrecacheEntryWriter *)entryWriter
+					  batch:(RTSMediaPrecacheBatch *)batch
+		  completionHandler:(void (^)(void))completionHandler
+{
+	if (index >= segmentURLs.count || batch.cancelled) {
+		completionHandler();
+		return;
+	}
+
+	NSURL *segmentURL = segmentURLs[index];
+	[self fetchURL:segmentURL completionHandler:^(NSData *data, NSString *contentType, NSError *error) {
+		// Only the first segments are useful, stop at the first one which cannot be precached
+		if (!data || ![entryWriter writeData:data contentType:contentType forURL:segmentURL]) {
+			completionHandler();
+			return;
+		}
+
+		[self precacheSegmentURLs:segmentURLs atIndex:index + 1 entryWriter:entryWriter batch:batch completionHandler:completionHandler];
+	}];
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; directoryURL: %@; byteCount: %@; byteBudget: %@>",
+			[self class],
+			self,
+			self.directoryURL,
+			@(self.byteCount),
+			@(self.byteBudget)];
+}
+
+@end
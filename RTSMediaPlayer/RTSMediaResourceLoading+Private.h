@@ -0,0 +1,36 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+
+/**
+ *  Helpers shared by resource loader delegates. HTTP(S) URLs are loaded through a resource loader delegate when their
+ *  scheme is prefixed with a scheme prefix specific to the delegate (e.g. `rtsprecache-https`)
+ */
+
+/**
+ *  Return the URL to load through the resource loader delegate associated with the scheme prefix, nil if the URL
+ *  cannot be intercepted (e.g. a local file)
+ */
+FOUNDATION_EXTERN NSURL *RTSMediaResourceLoadingInterceptedURL(NSURL *URL, NSString *schemePrefix);
+
+/**
+ *  Return the original URL of a URL intercepted with the scheme prefix, nil if the URL was not intercepted
+ */
+FOUNDATION_EXTERN NSURL *RTSMediaResourceLoadingOriginalURL(NSURL *URL, NSString *schemePrefix);
+
+/**
+ *  Respond to a loading request with the data of a whole resource, and finish loading. Only the requested byte range
+ *  is provided
+ */
+FOUNDATION_EXTERN void RTSMediaResourceLoadingRespond(AVAssetResourceLoadingRequest *loadingRequest, NSData *data, NSString *contentType);
+
+/**
+ *  Return a data task (not resumed) loading a whole resource. HTTP error status codes are reported as errors, in which
+ *  case no data is provided to the completion handler
+ */
+FOUNDATION_EXTERN NSURLSessionDataTask *RTSMediaResourceLoadingDataTask(NSURLSession *session, NSURL *URL, void (^completionHandler)(NSData *data, NSURLResponse *response, NSError *error));
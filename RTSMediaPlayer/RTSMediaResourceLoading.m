@@ -0,0 +1,70 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaResourceLoading+Private.h"
+
+NSURL *RTSMediaResourceLoadingInterceptedURL(NSURL *URL, NSString *schemePrefix)
+{
+	NSString *scheme = URL.scheme.lowercaseString;
+	if (![scheme isEqualToString:@"http"] && ![scheme isEqualToString:@"https"]) {
+		return nil;
+	}
+
+	NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+	URLComponents.scheme = [schemePrefix stringByAppendingString:scheme];
+	return URLComponents.URL;
+}
+
+NSURL *RTSMediaResourceLoadingOriginalURL(NSURL *URL, NSString *schemePrefix)
+{
+	if (![URL.scheme hasPrefix:schemePrefix]) {
+		return nil;
+	}
+
+	NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+	URLComponents.scheme = [URL.scheme substringFromIndex:schemePrefix.length];
+	return URLComponents.URL;
+}
+
+void RTSMediaResourceLoadingRespond(AVAssetResourceLoadingRequest *loadingRequest, NSData *data, NSString *contentType)
+{
+	AVAssetResourceLoadingContentInformationRequest *contentInformationRequest = loadingRequest.contentInformationRequest;
+	if (contentInformationRequest) {
+		contentInformationRequest.contentType = contentType;
+		contentInformationRequest.contentLength = data.length;
+		contentInformationRequest.byteRangeAccessSupported = YES;
+	}
+
+	// Only provide the part of the data which has been requested
+	AVAssetResourceLoadingDataRequest *dataRequest = loadingRequest.dataRequest;
+	if (dataRequest) {
+		long long start = dataRequest.currentOffset;
+		long long end = (long long)data.length;
+		if (!dataRequest.requestsAllDataToEndOfResource) {
+			end = MIN(end, dataRequest.requestedOffset + dataRequest.requestedLength);
+		}
+
+		if (start < end) {
+			[dataRequest respondWithData:[data subdataWithRange:NSMakeRange((NSUInteger)start, (NSUInteger)(end - start))]];
+		}
+	}
+
+	[loadingRequest finishLoading];
+}
+
+NSURLSessionDataTask *RTSMediaResourceLoadingDataTask(NSURLSession *session, NSURL *URL, void (^completionHandler)(NSData *data, NSURLResponse *response, NSError *error))
+{
+	return [session dataTaskWithURL:URL completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+		NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *)response).statusCode : 200;
+		if (!error && statusCode >= 400) {
+			error = [NSError errorWithDomain:NSURLErrorDomain
+										code:NSURLErrorBadServerResponse
+									userInfo:@{ NSURLErrorFailingURLErrorKey : URL,
+												NSLocalizedDescriptionKey : [NSHTTPURLResponse localizedStringForStatusCode:statusCode] }];
+		}
+		completionHandler(error ? nil : data, response, error);
+	}];
+}
@@ -0,0 +1,54 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <Foundation/Foundation.h>
+
+// Forward declarations
+@protocol RTSMediaSegment;
+
+/**
+ *  Internal class for fast lookup of the segment located at a given time. Segments are sorted by start time once, so
+ *  that lookups are performed with a binary search instead of a linear scan
+ */
+@interface RTSMediaSegmentIndex : NSObject
+
+/**
+ *  Create an index for the segments matching the specified test (all segments if nil)
+ *
+ *  @param segments  The segments to index
+ *  @param predicate The test segments must pass to be indexed
+ */
+- (instancetype)initWithSegments:(NSArray<id<RTSMediaSegment>> *)segments passingTest:(BOOL (^)(id<RTSMediaSegment> segment))predicate NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The segments which the index was created from
+ */
+@property (nonatomic, readonly) NSArray<id<RTSMediaSegment>> *segments;
+
+/**
+ *  Update the index after segments have been inserted into the array it was created from, indexing inserted segments
+ *  matching the specified test (all of them if nil). The index is updated in place, without sorting it again, and is
+ *  then identical to an index created from the new array
+ *
+ *  @param segments The new array, in which previously indexed segments keep their relative order
+ *  @param indexes  The indexes of the inserted segments in the new array
+ */
+- (void)updateWithSegments:(NSArray<id<RTSMediaSegment>> *)segments insertedAtIndexes:(NSIndexSet *)indexes passingTest:(BOOL (^)(id<RTSMediaSegment> segment))predicate;
+
+/**
+ *  Return the index (in the `segments` array) of the indexed segment whose time range contains the specified time,
+ *  `NSNotFound` if none. If several segments contain the time, the one appearing first in the `segments` array is
+ *  returned
+ */
+- (NSUInteger)indexOfSegmentAtTime:(CMTime)time;
+
+/**
+ *  Return the indexed segment whose time range contains the specified time, nil if none
+ */
+- (id<RTSMediaSegment>)segmentAtTime:(CMTime)time;
+
+@end
@@ -0,0 +1,222 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaSegmentIndex.h"
+
+#import "RTSMediaSegment.h"
+
+@interface RTSMediaSegmentIndex () {
+@private
+	NSUInteger _count;
+	NSUInteger *_positions;					// Position of sorted segments in the original array
+	Float64 *_startTimes;
+	Float64 *_endTimes;
+	Float64 *_maximumEndTimes;				// Largest end time among segments sorted up to a given position
+}
+
+@property (nonatomic) NSArray<id<RTSMediaSegment>> *segments;
+
+@end
+
+@implementation RTSMediaSegmentIndex
+
+#pragma mark - Object lifecycle
+
+- (instancetype)initWithSegments:(NSArray<id<RTSMediaSegment>> *)segments passingTest:(BOOL (^)(id<RTSMediaSegment> segment))predicate
+{
+	if (self = [super init]) {
+		self.segments = segments;
+		
+		NSMutableArray<NSNumber *> *positions = [NSMutableArray arrayWithCapacity:segments.count];
+		[segments enumerateObjectsUsingBlock:^(id<RTSMediaSegment> segment, NSUInteger idx, BOOL *stop) {
+			CMTimeRange timeRange = segment.timeRange;
+			if (CMTIMERANGE_IS_VALID(timeRange) && !CMTIMERANGE_IS_EMPTY(timeRange) && (!predicate || predicate(segment))) {
+				[positions addObject:@(idx)];
+			}
+		}];
+		
+		// Stable sort, so that segments with the same start time keep their relative order
+		[positions sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSNumber *position1, NSNumber *position2) {
+			CMTime startTime1 = segments[position1.unsignedIntegerValue].timeRange.start;
+			CMTime startTime2 = segments[position2.unsignedIntegerValue].timeRange.start;
+			int32_t result = CMTimeCompare(startTime1, startTime2);
+			return (result < 0) ? NSOrderedAscending : (result > 0) ? NSOrderedDescending : NSOrderedSame;
+		}];
+		
+		_count = positions.count;
+		_positions = calloc(MAX(_count, 1), sizeof(NSUInteger));
+		_startTimes = calloc(MAX(_count, 1), sizeof(Float64));
+		_endTimes = calloc(MAX(_count, 1), sizeof(Float64));
+		_maximumEndTimes = calloc(MAX(_count, 1), sizeof(Float64));
+		
+		for (NSUInteger i = 0; i < _count; ++i) {
+			NSUInteger position = positions[i].unsignedIntegerValue;
+			CMTimeRange timeRange = segments[position].timeRange;
+			
+			_positions[i] = position;
+			_startTimes[i] = CMTimeGetSeconds(timeRange.start);
+			_endTimes[i] = CMTimeGetSeconds(CMTimeRangeGetEnd(timeRange));
+			_maximumEndTimes[i] = (i == 0) ? _endTimes[i] : MAX(_maximumEndTimes[i - 1], _endTimes[i]);
+		}
+	}
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithSegments:@[] passingTest:nil];
+}
+
+- (void)dealloc
+{
+	free(_positions);
+	free(_startTimes);
+	free(_endTimes);
+	free(_maximumEndTimes);
+}
+
+#pragma mark - Updates
+
+- (void)updateWithSegments:(NSArray<id<RTSMediaSegment>> *)segments insertedAtIndexes:(NSIndexSet *)indexes passingTest:(BOOL (^)(id<RTSMediaSegment> segment))predicate
+{
+	NSParameterAssert(segments.count == self.segments.count + indexes.count);
+	
+	self.segments = segments;
+	
+	// For each inserted segment, the number of segments of the previous array located before it. These counts are
+	// non-decreasing, and an inserted segment is located before a previous segment iff its count does not exceed the
+	// previous position of this segment
+	NSUInteger insertedCount = indexes.count;
+	NSUInteger *previousCounts = malloc(MAX(insertedCount, 1) * sizeof(NSUInteger));
+	
+	NSMutableArray<NSNumber *> *positions = [NSMutableArray array];
+	__block NSUInteger insertedIndex = 0;
+	[indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+		previousCounts[insertedIndex] = idx - insertedIndex;
+		++insertedIndex;
+		
+		id<RTSMediaSegment> segment = segments[idx];
+		CMTimeRange timeRange = segment.timeRange;
+		if (CMTIMERANGE_IS_VALID(timeRange) && !CMTIMERANGE_IS_EMPTY(timeRange) && (!predicate || predicate(segment))) {
+			[positions addObject:@(idx)];
+		}
+	}];
+	
+	for (NSUInteger i = 0; i < _count; ++i) {
+		NSUInteger low = 0, high = insertedCount;
+		while (low < high) {
+			NSUInteger middle = low + (high - low) / 2;
+			if (previousCounts[middle] <= _positions[i]) {
+				low = middle + 1;
+			}
+			else {
+				high = middle;
+			}
+		}
+		_positions[i] += low;
+	}
+	free(previousCounts);
+	
+	if (positions.count == 0) {
+		return;
+	}
+	
+	// Only inserted segments need to be sorted. They are then merged with the sorted ones, ties being resolved by position
+	// as the stable sort made when creating the index does
+	[positions sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSNumber *position1, NSNumber *position2) {
+		CMTime startTime1 = segments[position1.unsignedIntegerValue].timeRange.start;
+		CMTime startTime2 = segments[position2.unsignedIntegerValue].timeRange.start;
+		int32_t result = CMTimeCompare(startTime1, startTime2);
+		return (result < 0) ? NSOrderedAscending : (result > 0) ? NSOrderedDescending : NSOrderedSame;
+	}];
+	
+	NSUInteger count = _count + positions.count;
+	NSUInteger *mergedPositions = malloc(count * sizeof(NSUInteger));
+	Float64 *startTimes = malloc(count * sizeof(Float64));
+	Float64 *endTimes = malloc(count * sizeof(Float64));
+	Float64 *maximumEndTimes = malloc(count * sizeof(Float64));
+	
+	NSUInteger i = 0, j = 0;
+	CMTimeRange timeRange = segments[positions[0].unsignedIntegerValue].timeRange;
+	Float64 insertedStartTime = CMTimeGetSeconds(timeRange.start);
+	for (NSUInteger k = 0; k < count; ++k) {
+		BOOL takesInserted = (i == _count);
+		if (!takesInserted && j < positions.count) {
+			NSUInteger insertedPosition = positions[j].unsignedIntegerValue;
+			takesInserted = (insertedStartTime < _startTimes[i]) || (insertedStartTime == _startTimes[i] && insertedPosition < _positions[i]);
+		}
+		
+		if (takesInserted) {
+			mergedPositions[k] = positions[j].unsignedIntegerValue;
+			startTimes[k] = insertedStartTime;
+			endTimes[k] = CMTimeGetSeconds(CMTimeRangeGetEnd(timeRange));
+			
+			if (++j < positions.count) {
+				timeRange = segments[positions[j].unsignedIntegerValue].timeRange;
+				insertedStartTime = CMTimeGetSeconds(timeRange.start);
+			}
+		}
+		else {
+			mergedPositions[k] = _positions[i];
+			startTimes[k] = _startTimes[i];
+			endTimes[k] = _endTimes[i];
+			++i;
+		}
+		maximumEndTimes[k] = (k == 0) ? endTimes[k] : MAX(maximumEndTimes[k - 1], endTimes[k]);
+	}
+	
+	free(_positions);
+	free(_startTimes);
+	free(_endTimes);
+	free(_maximumEndTimes);
+	
+	_count = count;
+	_positions = mergedPositions;
+	_startTimes = startTimes;
+	_endTimes = endTimes;
+	_maximumEndTimes = maximumEndTimes;
+}
+
+#pragma mark - Lookup
+
+- (NSUInteger)indexOfSegmentAtTime:(CMTime)time
+{
+	if (CMTIME_IS_INVALID(time) || CMTIME_IS_INDEFINITE(time)) {
+		return NSNotFound;
+	}
+	
+	Float64 seconds = CMTimeGetSeconds(time);
+	
+	// Number of segments starting at or before the specified time
+	NSUInteger low = 0, high = _count;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (_startTimes[middle] <= seconds) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	
+	// Walk back among these segments, stopping as soon as none of the remaining ones can end after the time. Time ranges
+	// are half-open, as for `CMTimeRangeContainsTime`
+	NSUInteger index = NSNotFound;
+	for (NSUInteger i = low; i > 0 && _maximumEndTimes[i - 1] > seconds; --i) {
+		if (_endTimes[i - 1] > seconds) {
+			index = MIN(index, _positions[i - 1]);
+		}
+	}
+	return index;
+}
+
+- (id<RTSMediaSegment>)segmentAtTime:(CMTime)time
+{
+	NSUInteger index = [self indexOfSegmentAtTime:time];
+	return (index != NSNotFound) ? self.segments[index] : nil;
+}
+
+@end
@@ -0,0 +1,21 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaSegmentsController.h"
+
+@interface RTSMediaSegmentsController (Private)
+
+/**
+ *  The time ranges of the blocked logical segments of the media with the specified identifier
+ */
+- (NSArray<NSValue *> *)blockedTimeRangesForIdentifier:(NSString *)identifier;
+
+/**
+ *  Set the time ranges removed from the playlist of the media being played
+ */
+- (void)setRemovedTimeRanges:(NSArray<NSValue *> *)removedTimeRanges;
+
+@end
@@ -49,12 +49,58 @@
  */
 @property(nonatomic, weak) IBOutlet id<RTSMediaSegmentsDataSource> dataSource;
 
+/**
+ *  When set to YES, blocked logical segments of the media being played are removed from its playlists before the player
+ *  sees them, so that their data is never loaded and no seek is required to skip them. Media segments are cut out and
+ *  replaced with a discontinuity, playback jumping seamlessly from the end of the previous kept media segment to the
+ *  start of the next one. Only media segments entirely contained in a blocked segment can be removed, and only for VOD
+ *  and event playlists. Blocked segments which cannot be removed (or only partially) are still skipped during playback
+ *  as usual.
+ *
+ *  Segments must have been loaded before playback starts for this setting to have any effect. Default is NO
+ *
+ *  @discussion Times reported by the player do not match media times anymore once time ranges have been removed.
+ *              Segment lookup methods expect player times, and conversions can be made with `-playerTimeForMediaTime:`
+ *              and `-mediaTimeForPlayerTime:`
+ */
+@property (nonatomic) BOOL removesBlockedSegmentsFromPlaylist;
+
+/**
+ *  The time ranges (`NSValue`s wrapping `CMTimeRange`s, in media time) removed from the playlist of the media being
+ *  played, sorted by start time. Empty if none
+ */
+@property (nonatomic, readonly) NSArray<NSValue *> *removedTimeRanges;
+
+/**
+ *  Convert a media time (e.g. a segment time) into the corresponding player time, taking removed time ranges into
+ *  account. Times within a removed time range are mapped to the point where the range was cut
+ */
+- (CMTime)playerTimeForMediaTime:(CMTime)mediaTime;
+
+/**
+ *  Convert a player time into the corresponding media time, taking removed time ranges into account
+ */
+- (CMTime)mediaTimeForPlayerTime:(CMTime)playerTime;
+
 /**
  *  Reload segments data for given media identifier. The completion handler block (optional) will be called when reloading
  *  ends
  */
 - (void)reloadSegmentsForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSError *error))completionHandler;
 
+/**
+ *  Same as `-reloadSegmentsForIdentifier:completionHandler:`, with a block (optional) called each time segments have been
+ *  received, with the indexes (in `visibleSegments`) of the visible segments which have been inserted
+ *
+ *  @discussion When the data source delivers segments progressively, the segments of the previous reload are discarded
+ *              when the first batch is received, and each batch is then merged into the segment list and its lookup
+ *              indexes, which are kept sorted by start time. Otherwise segments are replaced at once and the block is
+ *              called a single time, before the completion handler
+ */
+- (void)reloadSegmentsForIdentifier:(NSString *)identifier
+                       batchHandler:(void (^)(NSIndexSet *insertedVisibleSegmentIndexes))batchHandler
+                  completionHandler:(void (^)(NSError *error))completionHandler;
+
 /**
  *  The segment list currently managed by the segments controller
  */
@@ -72,6 +118,25 @@
  */
 - (id<RTSMediaSegment>)currentSegment;
 
+/**
+ *  Return the logical segment of the media being played whose time range contains the specified time, nil if none.
+ *  This is the segment which becomes the current segment when the playhead reaches the time
+ *
+ *  @discussion Lookups use an index built when segments are reloaded and are therefore cheap, even for long segment lists
+ */
+- (id<RTSMediaSegment>)segmentAtTime:(CMTime)time;
+
+/**
+ *  Return the visible segment of the media being played whose time range contains the specified time, nil if none
+ */
+- (id<RTSMediaSegment>)visibleSegmentAtTime:(CMTime)time;
+
+/**
+ *  Return the index (in `visibleSegments`) of the visible segment of the media being played whose time range contains
+ *  the specified time, `NSNotFound` if none
+ */
+- (NSUInteger)indexOfVisibleSegmentAtTime:(CMTime)time;
+
 /**
  *  Asks the segments controller to play the specified segment
  */
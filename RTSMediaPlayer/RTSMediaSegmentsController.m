@@ -6,11 +6,14 @@
 
 #import <AVFoundation/AVFoundation.h>
 #import <libextobjc/EXTScope.h>
+#import <QuartzCore/QuartzCore.h>
 
 #import "RTSMediaPlayerController.h"
 #import "RTSMediaPlayerController+Private.h"
 #import "RTSMediaSegment.h"
+#import "RTSMediaSegmentIndex.h"
 #import "RTSMediaSegmentsController.h"
+#import "RTSMediaSegmentsController+Private.h"
 #import "RTSMediaPlayerLogger+Private.h"
 #import "RTSMediaSegmentsDataSource.h"
 
@@ -24,13 +27,26 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
 @interface RTSMediaSegmentsController ()
 @property(nonatomic, strong) NSString *identifier;
 @property(nonatomic, strong) NSArray *segments;
+@property(nonatomic, strong) NSArray *visibleSegments;
+@property(nonatomic, strong) NSDictionary<NSString *, RTSMediaSegmentIndex *> *logicalSegmentIndexes;
+@property(nonatomic, strong) NSDictionary<NSString *, RTSMediaSegmentIndex *> *visibleSegmentIndexes;
 @property(nonatomic, strong) id playerTimeObserver;
 @property(nonatomic, weak) id<RTSMediaSegment> lastPlaybackPositionLogicalSegment;
 @property(nonatomic, strong) id segmentsRequestHandle;
+@property(nonatomic) NSUInteger segmentsReloadCount;
+@property(nonatomic, strong) NSArray<NSValue *> *removedTimeRanges;
 @end
 
 @implementation RTSMediaSegmentsController
 
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.removedTimeRanges = @[];
+    }
+    return self;
+}
+
 - (void)setPlayerController:(RTSMediaPlayerController *)playerController
 {
     _playerController = playerController;
@@ -38,10 +54,111 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
     playerController.segmentsController = self;
 }
 
+- (void)setSegments:(NSArray *)segments
+{
+    _segments = segments;
+    
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id<RTSMediaSegment>segment, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return [segment isVisible];
+    }];
+    self.visibleSegments = [segments filteredArrayUsingPredicate:predicate];
+    
+    // Index segments per media identifier, so that lookups during playback do not require scanning all segments
+    NSMutableDictionary<NSString *, RTSMediaSegmentIndex *> *logicalSegmentIndexes = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, RTSMediaSegmentIndex *> *visibleSegmentIndexes = [NSMutableDictionary dictionary];
+    for (NSString *identifier in [segments valueForKeyPath:@"@distinctUnionOfObjects.segmentIdentifier"]) {
+        logicalSegmentIndexes[identifier] = [[RTSMediaSegmentIndex alloc] initWithSegments:segments passingTest:^BOOL(id<RTSMediaSegment> segment) {
+            return segment.logical && [segment.segmentIdentifier isEqualToString:identifier];
+        }];
+        visibleSegmentIndexes[identifier] = [[RTSMediaSegmentIndex alloc] initWithSegments:self.visibleSegments passingTest:^BOOL(id<RTSMediaSegment> segment) {
+            return [segment.segmentIdentifier isEqualToString:identifier];
+        }];
+    }
+    self.logicalSegmentIndexes = [logicalSegmentIndexes copy];
+    self.visibleSegmentIndexes = [visibleSegmentIndexes copy];
+}
+
+// Segments are sorted by start time and merged into the existing ones, which must be sorted as well. Return the indexes
+// (in `visibleSegments`) of the inserted visible segments
+- (NSIndexSet *)mergeSegments:(NSArray *)segments
+{
+    NSComparator comparator = ^NSComparisonResult(id<RTSMediaSegment> segment1, id<RTSMediaSegment> segment2) {
+        int32_t result = CMTimeCompare(segment1.timeRange.start, segment2.timeRange.start);
+        return (result < 0) ? NSOrderedAscending : (result > 0) ? NSOrderedDescending : NSOrderedSame;
+    };
+    NSArray *sortedSegments = [segments sortedArrayWithOptions:NSSortStable usingComparator:comparator];
+    
+    // Segments are inserted after existing ones with the same start time
+    NSArray * (^merge)(NSArray *, NSArray *, NSIndexSet **) = ^(NSArray *array, NSArray *insertedSegments, NSIndexSet **pIndexes) {
+        NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+        [insertedSegments enumerateObjectsUsingBlock:^(id<RTSMediaSegment> segment, NSUInteger idx, BOOL *stop) {
+            NSUInteger index = [array indexOfObject:segment
+                                      inSortedRange:NSMakeRange(0, array.count)
+                                            options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+                                    usingComparator:comparator];
+            [indexes addIndex:index + idx];
+        }];
+        *pIndexes = [indexes copy];
+        
+        NSMutableArray *mergedArray = [array mutableCopy];
+        [mergedArray insertObjects:insertedSegments atIndexes:indexes];
+        return [mergedArray copy];
+    };
+    
+    NSIndexSet *insertedIndexes = nil;
+    _segments = merge(self.segments ?: @[], sortedSegments, &insertedIndexes);
+    
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id<RTSMediaSegment>segment, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return [segment isVisible];
+    }];
+    NSIndexSet *insertedVisibleIndexes = nil;
+    _visibleSegments = merge(self.visibleSegments ?: @[], [sortedSegments filteredArrayUsingPredicate:predicate], &insertedVisibleIndexes);
+    
+    // Existing indexes are updated in place, since their positions refer to the whole segment lists
+    NSMutableDictionary<NSString *, RTSMediaSegmentIndex *> *logicalSegmentIndexes = [self.logicalSegmentIndexes mutableCopy] ?: [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, RTSMediaSegmentIndex *> *visibleSegmentIndexes = [self.visibleSegmentIndexes mutableCopy] ?: [NSMutableDictionary dictionary];
+    for (NSString *identifier in [logicalSegmentIndexes.allKeys copy]) {
+        [logicalSegmentIndexes[identifier] updateWithSegments:self.segments insertedAtIndexes:insertedIndexes passingTest:^BOOL(id<RTSMediaSegment> segment) {
+            return segment.logical && [segment.segmentIdentifier isEqualToString:identifier];
+        }];
+        [visibleSegmentIndexes[identifier] updateWithSegments:self.visibleSegments insertedAtIndexes:insertedVisibleIndexes passingTest:^BOOL(id<RTSMediaSegment> segment) {
+            return [segment.segmentIdentifier isEqualToString:identifier];
+        }];
+    }
+    for (NSString *identifier in [sortedSegments valueForKeyPath:@"@distinctUnionOfObjects.segmentIdentifier"]) {
+        if (logicalSegmentIndexes[identifier]) {
+            continue;
+        }
+        
+        logicalSegmentIndexes[identifier] = [[RTSMediaSegmentIndex alloc] initWithSegments:self.segments passingTest:^BOOL(id<RTSMediaSegment> segment) {
+            return segment.logical && [segment.segmentIdentifier isEqualToString:identifier];
+        }];
+        visibleSegmentIndexes[identifier] = [[RTSMediaSegmentIndex alloc] initWithSegments:self.visibleSegments passingTest:^BOOL(id<RTSMediaSegment> segment) {
+            return [segment.segmentIdentifier isEqualToString:identifier];
+        }];
+    }
+    self.logicalSegmentIndexes = [logicalSegmentIndexes copy];
+    self.visibleSegmentIndexes = [visibleSegmentIndexes copy];
+    
+    return insertedVisibleIndexes;
+}
+
 - (void)reloadSegmentsForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSError *error))completionHandler
+{
+    [self reloadSegmentsForIdentifier:identifier batchHandler:nil completionHandler:completionHandler];
+}
+
+- (void)reloadSegmentsForIdentifier:(NSString *)identifier
+                       batchHandler:(void (^)(NSIndexSet *insertedVisibleSegmentIndexes))batchHandler
+                  completionHandler:(void (^)(NSError *error))completionHandler
 {
     NSParameterAssert(identifier);
     
+    // Removed time ranges belong to the media previously played
+    if (![self.identifier isEqualToString:identifier]) {
+        self.removedTimeRanges = @[];
+    }
+    
     self.identifier = identifier;
     
     if (!self.playerController) {
@@ -72,6 +189,10 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
 		
         [self addBlockingTimeObserver];
         
+        if (batchHandler) {
+            batchHandler([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, self.visibleSegments.count)]);
+        }
+        
         if (completionHandler) {
             completionHandler(nil);
         }
@@ -81,7 +202,60 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
 		[self.dataSource cancelSegmentsRequest:self.segmentsRequestHandle];
 	}
     
-    self.segmentsRequestHandle = [self.dataSource segmentsController:self segmentsForIdentifier:identifier withCompletionHandler:reloadCompletionBlock];
+    if ([self.dataSource respondsToSelector:@selector(segmentsController:segmentsForIdentifier:withBatchHandler:)]) {
+        // Batches delivered for a previous reload are ignored
+        NSUInteger reloadCount = ++self.segmentsReloadCount;
+        CFTimeInterval startTime = CACurrentMediaTime();
+        __block BOOL firstBatchReceived = NO;
+        __block BOOL visibleSegmentsReceived = NO;
+        
+        RTSMediaSegmentsBatchHandler reloadBatchBlock = ^(NSString *identifier, NSArray *segments, BOOL finished, NSError *error) {
+            if (reloadCount != self.segmentsReloadCount) {
+                return;
+            }
+            
+            // The segments of the previous reload are discarded, which must be reported even if the batch is empty
+            BOOL segmentsDiscarded = !firstBatchReceived;
+            if (segmentsDiscarded) {
+                firstBatchReceived = YES;
+                self.segments = [NSArray new];
+            }
+            
+            if (segments.count != 0 || segmentsDiscarded) {
+                NSIndexSet *insertedVisibleSegmentIndexes = [self mergeSegments:segments ?: @[]];
+                if (!visibleSegmentsReceived && insertedVisibleSegmentIndexes.count != 0) {
+                    visibleSegmentsReceived = YES;
+                    RTSMediaPlayerLogInfo(@"First visible segments of %@ received after %.3f sec.", identifier, CACurrentMediaTime() - startTime);
+                }
+                
+                if (!self.playerTimeObserver) {
+                    [self addBlockingTimeObserver];
+                }
+                
+                if (batchHandler) {
+                    batchHandler(insertedVisibleSegmentIndexes);
+                }
+            }
+            
+            if (!finished && !error) {
+                return;
+            }
+            
+            RTSMediaPlayerLogDebug(@"%@ segments of %@ received in %.3f sec.", @(self.segments.count), identifier, CACurrentMediaTime() - startTime);
+            
+            self.segmentsRequestHandle = nil;
+            ++self.segmentsReloadCount;
+            
+            if (completionHandler) {
+                completionHandler(error);
+            }
+        };
+        
+        self.segmentsRequestHandle = [self.dataSource segmentsController:self segmentsForIdentifier:identifier withBatchHandler:reloadBatchBlock];
+    }
+    else {
+        self.segmentsRequestHandle = [self.dataSource segmentsController:self segmentsForIdentifier:identifier withCompletionHandler:reloadCompletionBlock];
+    }
 }
 
 - (void)removeBlockingTimeObserver
@@ -104,16 +278,7 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
             return;
         }
 		
-		// We assume that all logical segments of a full length have an identifier that is IDENTICAL to the fullLength's.
-        __block id<RTSMediaSegment> currentSegment = nil;
-        [self.segments enumerateObjectsUsingBlock:^(id<RTSMediaSegment> segment, NSUInteger idx, BOOL * _Nonnull stop) {
-            if ([segment.segmentIdentifier isEqualToString:self.playerController.identifier] && segment.logical) {
-				if (CMTimeRangeContainsTime(segment.timeRange, time)) {
-					currentSegment = segment;
-					*stop = YES;
-				}
-            }
-        }];
+        id<RTSMediaSegment> currentSegment = [self segmentAtTime:time];
         
         if (self.lastPlaybackPositionLogicalSegment != currentSegment) {
 			NSDictionary *userInfo = nil;
@@ -153,7 +318,7 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
                                                                 object:self
                                                               userInfo:userInfo];
             
-            [self.playerController seekToTime:CMTimeRangeGetEnd(currentSegment.timeRange) completionHandler:^(BOOL finished) {
+            [self.playerController seekToTime:[self playerTimeForMediaTime:CMTimeRangeGetEnd(currentSegment.timeRange)] completionHandler:^(BOOL finished) {
                 NSDictionary *userInfo = @{RTSMediaPlaybackSegmentChangeValueInfoKey: @(RTSMediaPlaybackSegmentSeekUponBlockingEnd),
                                            RTSMediaPlaybackSegmentChangePreviousSegmentInfoKey: currentSegment};
                 [[NSNotificationCenter defaultCenter] postNotificationName:RTSMediaPlaybackSegmentDidChangeNotification
@@ -173,12 +338,79 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
                                                                              usingBlock:checkBlock];
 }
 
-- (NSArray *)visibleSegments
+- (id<RTSMediaSegment>)segmentAtTime:(CMTime)time
 {
-    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id<RTSMediaSegment>segment, NSDictionary<NSString *,id> * _Nullable bindings) {
-        return [segment isVisible];
-    }];
-    return [self.segments filteredArrayUsingPredicate:predicate];
+    // We assume that all logical segments of a full length have an identifier that is IDENTICAL to the fullLength's.
+    NSString *identifier = self.playerController.identifier;
+    return identifier ? [self.logicalSegmentIndexes[identifier] segmentAtTime:[self mediaTimeForPlayerTime:time]] : nil;
+}
+
+- (id<RTSMediaSegment>)visibleSegmentAtTime:(CMTime)time
+{
+    NSString *identifier = self.playerController.identifier;
+    return identifier ? [self.visibleSegmentIndexes[identifier] segmentAtTime:[self mediaTimeForPlayerTime:time]] : nil;
+}
+
+- (NSUInteger)indexOfVisibleSegmentAtTime:(CMTime)time
+{
+    NSString *identifier = self.playerController.identifier;
+    return identifier ? [self.visibleSegmentIndexes[identifier] indexOfSegmentAtTime:[self mediaTimeForPlayerTime:time]] : NSNotFound;
+}
+
+- (NSArray<NSValue *> *)blockedTimeRangesForIdentifier:(NSString *)identifier
+{
+    NSMutableArray<NSValue *> *blockedTimeRanges = [NSMutableArray array];
+    for (id<RTSMediaSegment> segment in self.segments) {
+        if (segment.logical && segment.blocked && [segment.segmentIdentifier isEqualToString:identifier]) {
+            [blockedTimeRanges addObject:[NSValue valueWithCMTimeRange:segment.timeRange]];
+        }
+    }
+    return [blockedTimeRanges copy];
+}
+
+- (void)setRemovedTimeRanges:(NSArray<NSValue *> *)removedTimeRanges
+{
+    _removedTimeRanges = [removedTimeRanges sortedArrayUsingComparator:^NSComparisonResult(NSValue *timeRangeValue1, NSValue *timeRangeValue2) {
+        return CMTimeCompare([timeRangeValue1 CMTimeRangeValue].start, [timeRangeValue2 CMTimeRangeValue].start);
+    }] ?: @[];
+}
+
+- (CMTime)playerTimeForMediaTime:(CMTime)mediaTime
+{
+    if (!CMTIME_IS_NUMERIC(mediaTime)) {
+        return mediaTime;
+    }
+    
+    CMTime removedDuration = kCMTimeZero;
+    for (NSValue *removedTimeRangeValue in self.removedTimeRanges) {
+        CMTimeRange removedTimeRange = [removedTimeRangeValue CMTimeRangeValue];
+        if (CMTIME_COMPARE_INLINE(mediaTime, <, removedTimeRange.start)) {
+            break;
+        }
+        else if (CMTIME_COMPARE_INLINE(mediaTime, <, CMTimeRangeGetEnd(removedTimeRange))) {
+            return CMTimeSubtract(removedTimeRange.start, removedDuration);
+        }
+        removedDuration = CMTimeAdd(removedDuration, removedTimeRange.duration);
+    }
+    return CMTimeSubtract(mediaTime, removedDuration);
+}
+
+- (CMTime)mediaTimeForPlayerTime:(CMTime)playerTime
+{
+    if (!CMTIME_IS_NUMERIC(playerTime)) {
+        return playerTime;
+    }
+    
+    // A player time located at a cut corresponds to the media time right after the removed time range
+    CMTime removedDuration = kCMTimeZero;
+    for (NSValue *removedTimeRangeValue in self.removedTimeRanges) {
+        CMTimeRange removedTimeRange = [removedTimeRangeValue CMTimeRangeValue];
+        if (CMTIME_COMPARE_INLINE(playerTime, <, CMTimeSubtract(removedTimeRange.start, removedDuration))) {
+            break;
+        }
+        removedDuration = CMTimeAdd(removedDuration, removedTimeRange.duration);
+    }
+    return CMTimeAdd(playerTime, removedDuration);
 }
 
 - (id<RTSMediaSegment>)currentSegment
@@ -214,7 +446,7 @@ NSString * const RTSMediaPlaybackSegmentChangeUserSelectInfoKey = @"RTSMediaPlay
     }
     
     if ([self.playerController.identifier isEqualToString:segment.segmentIdentifier]) {
-        [self.playerController playAtTime:segment.timeRange.start];
+        [self.playerController playAtTime:[self playerTimeForMediaTime:segment.timeRange.start]];
     }
     else {
         [self.playerController playIdentifier:segment.segmentIdentifier];
@@ -12,6 +12,7 @@
 
 // Block signatures
 typedef void (^RTSMediaSegmentsCompletionHandler)(NSString *identifier, NSArray *segments, NSError *error);
+typedef void (^RTSMediaSegmentsBatchHandler)(NSString *identifier, NSArray *segments, BOOL finished, NSError *error);
 
 /**
  * Protocol describing how a media segments controller receives the segment information it requires
@@ -33,4 +34,23 @@ typedef void (^RTSMediaSegmentsCompletionHandler)(NSString *identifier, NSArray
    withCompletionHandler:(RTSMediaSegmentsCompletionHandler)completionHandler;
 - (void)cancelSegmentsRequest:(id)request;
 
+@optional
+
+/**
+ *  Progressive variant of `-segmentsController:segmentsForIdentifier:withCompletionHandler:`, called instead of it when
+ *  implemented. Segments can be delivered in several batches as they are parsed, e.g. those around the playhead first,
+ *  so that they can be displayed before the whole list is available
+ *
+ *  @param controller   The segments controller making the request
+ *  @param identifier   The identifier for which segments must be retrieved
+ *  @param batchHandler The block which the implementation must call, on the main thread, once per batch of segments. Set
+ *                      `finished` to YES for the last batch (which can be empty). Delivery ends with the first error,
+ *                      segments already delivered being kept
+ *
+ *  @return A connection handle which can be used to cancel the request
+ */
+- (id)segmentsController:(RTSMediaSegmentsController *)controller
+   segmentsForIdentifier:(NSString *)identifier
+        withBatchHandler:(RTSMediaSegmentsBatchHandler)batchHandler;
+
 @end
@@ -0,0 +1,93 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <Foundation/Foundation.h>
+
+/**
+ *  A compact set of disjoint time intervals, sorted by start time. Overlapping or adjacent intervals are merged when
+ *  added. Times are expressed in seconds and stored in plain C arrays, so that reading from the set is cheap and does
+ *  not involve any boxing (unlike `AVPlayerItem` time range arrays)
+ *
+ *  Intervals are closed, i.e. a time located at the start or at the end of an interval is contained in it. Durations
+ *  are answered in logarithmic time from cumulative durations, updated lazily from the first interval which changed
+ *
+ *  Sets are archived as a packed list of interval bounds, 16 bytes per interval
+ */
+@interface RTSMediaTimeRangeSet : NSObject <NSCopying, NSSecureCoding>
+
+/**
+ *  Create a set from an array of `NSValue`s wrapping `CMTimeRange`s (e.g. `AVPlayerItem` loaded or seekable time ranges).
+ *  Invalid, indefinite and empty time ranges are ignored
+ */
+- (instancetype)initWithTimeRanges:(NSArray<NSValue *> *)timeRanges;
+
+/**
+ *  The number of disjoint intervals in the set
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ *  The sum of the durations of all intervals
+ */
+@property (nonatomic, readonly) NSTimeInterval totalDuration;
+
+/**
+ *  The start and end times of the interval at the specified index. The index must be valid
+ */
+- (NSTimeInterval)startTimeAtIndex:(NSUInteger)index;
+- (NSTimeInterval)endTimeAtIndex:(NSUInteger)index;
+
+/**
+ *  Return the index of the interval containing the specified time, `NSNotFound` if none
+ */
+- (NSUInteger)indexOfTimeRangeContainingTime:(NSTimeInterval)time;
+
+/**
+ *  Return YES iff the specified time is contained in one of the intervals
+ */
+- (BOOL)containsTime:(NSTimeInterval)time;
+
+/**
+ *  Return the duration available without interruption after (respectively before) the specified time, i.e. the part of
+ *  the interval containing the time which lies after (respectively before) it. Return 0 if the time is not contained
+ *  in the set
+ */
+- (NSTimeInterval)contiguousDurationAfterTime:(NSTimeInterval)time;
+- (NSTimeInterval)contiguousDurationBeforeTime:(NSTimeInterval)time;
+
+/**
+ *  Return the total duration of the intervals (or parts of intervals) located after the specified time
+ */
+- (NSTimeInterval)totalDurationAfterTime:(NSTimeInterval)time;
+
+/**
+ *  Return the total duration of the intervals (or parts of intervals) located between the specified times
+ */
+- (NSTimeInterval)totalDurationFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime;
+
+/**
+ *  Add an interval to the set, merging it with the intervals it overlaps or touches. Empty or invalid intervals are
+ *  ignored
+ */
+- (void)addTimeRangeFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime;
+
+/**
+ *  Replace the content of the set with the specified `NSValue`s wrapping `CMTimeRange`s
+ */
+- (void)setTimeRanges:(NSArray<NSValue *> *)timeRanges;
+
+/**
+ *  Remove all intervals
+ */
+- (void)removeAllTimeRanges;
+
+/**
+ *  Return YES iff both sets contain the same intervals
+ */
+- (BOOL)isEqualToTimeRangeSet:(RTSMediaTimeRangeSet *)timeRangeSet;
+
+@end
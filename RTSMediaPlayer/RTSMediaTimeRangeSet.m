@@ -0,0 +1,325 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaTimeRangeSet.h"
+
+@interface RTSMediaTimeRangeSet () {
+@private
+	NSTimeInterval *_startTimes;
+	NSTimeInterval *_endTimes;
+	NSTimeInterval *_cumulativeDurations;		// Sum of the durations of the intervals before each index, `_count + 1` entries
+	NSUInteger _cumulativeCount;				// Number of up-to-date cumulative durations
+	NSUInteger _count;
+	NSUInteger _capacity;
+}
+
+@end
+
+@implementation RTSMediaTimeRangeSet
+
+#pragma mark - Object lifecycle
+
+- (instancetype)initWithTimeRanges:(NSArray<NSValue *> *)timeRanges
+{
+	if (self = [super init]) {
+		[self setTimeRanges:timeRanges];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_startTimes);
+	free(_endTimes);
+	free(_cumulativeDurations);
+}
+
+#pragma mark - Getters and setters
+
+- (NSUInteger)count
+{
+	return _count;
+}
+
+- (NSTimeInterval)totalDuration
+{
+	if (_count == 0) {
+		return 0.;
+	}
+	
+	[self updateCumulativeDurations];
+	return _cumulativeDurations[_count];
+}
+
+- (NSTimeInterval)startTimeAtIndex:(NSUInteger)index
+{
+	NSParameterAssert(index < _count);
+	return _startTimes[index];
+}
+
+- (NSTimeInterval)endTimeAtIndex:(NSUInteger)index
+{
+	NSParameterAssert(index < _count);
+	return _endTimes[index];
+}
+
+#pragma mark - Queries
+
+- (void)updateCumulativeDurations
+{
+	for (NSUInteger i = MAX(_cumulativeCount, 1); i <= _count; ++i) {
+		_cumulativeDurations[i] = _cumulativeDurations[i - 1] + _endTimes[i - 1] - _startTimes[i - 1];
+	}
+	_cumulativeCount = _count + 1;
+}
+
+// Return the index of the first interval ending at or after the specified time
+- (NSUInteger)lowerBoundForEndTime:(NSTimeInterval)time
+{
+	NSUInteger low = 0, high = _count;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (_endTimes[middle] < time) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+// Return the number of intervals starting at or before the specified time
+- (NSUInteger)upperBoundForTime:(NSTimeInterval)time
+{
+	NSUInteger low = 0, high = _count;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (_startTimes[middle] <= time) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+- (NSUInteger)indexOfTimeRangeContainingTime:(NSTimeInterval)time
+{
+	NSUInteger upperBound = [self upperBoundForTime:time];
+	if (upperBound == 0) {
+		return NSNotFound;
+	}
+	
+	NSUInteger index = upperBound - 1;
+	return (time <= _endTimes[index]) ? index : NSNotFound;
+}
+
+- (BOOL)containsTime:(NSTimeInterval)time
+{
+	return [self indexOfTimeRangeContainingTime:time] != NSNotFound;
+}
+
+- (NSTimeInterval)contiguousDurationAfterTime:(NSTimeInterval)time
+{
+	NSUInteger index = [self indexOfTimeRangeContainingTime:time];
+	return (index != NSNotFound) ? _endTimes[index] - time : 0.;
+}
+
+- (NSTimeInterval)contiguousDurationBeforeTime:(NSTimeInterval)time
+{
+	NSUInteger index = [self indexOfTimeRangeContainingTime:time];
+	return (index != NSNotFound) ? time - _startTimes[index] : 0.;
+}
+
+- (NSTimeInterval)totalDurationAfterTime:(NSTimeInterval)time
+{
+	NSTimeInterval totalDuration = 0.;
+	for (NSUInteger i = _count; i > 0; --i) {
+		if (_endTimes[i - 1] <= time) {
+			break;
+		}
+		totalDuration += _endTimes[i - 1] - MAX(_startTimes[i - 1], time);
+	}
+	return totalDuration;
+}
+
+- (NSTimeInterval)totalDurationFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime
+{
+	if (_count == 0 || isnan(startTime) || isnan(endTime) || endTime <= startTime) {
+		return 0.;
+	}
+	
+	// Intervals in [first, last[ overlap the requested range. Only the first and last ones can partially lie outside it
+	NSUInteger first = [self lowerBoundForEndTime:startTime];
+	NSUInteger last = [self upperBoundForTime:endTime];
+	if (first >= last) {
+		return 0.;
+	}
+	
+	[self updateCumulativeDurations];
+	NSTimeInterval totalDuration = _cumulativeDurations[last] - _cumulativeDurations[first];
+	totalDuration -= MAX(startTime - _startTimes[first], 0.);
+	totalDuration -= MAX(_endTimes[last - 1] - endTime, 0.);
+	return totalDuration;
+}
+
+#pragma mark - Changing the set
+
+- (void)reserveCapacity:(NSUInteger)capacity
+{
+	if (capacity <= _capacity) {
+		return;
+	}
+	
+	NSUInteger newCapacity = MAX(capacity, 2 * _capacity);
+	_startTimes = realloc(_startTimes, newCapacity * sizeof(NSTimeInterval));
+	_endTimes = realloc(_endTimes, newCapacity * sizeof(NSTimeInterval));
+	_cumulativeDurations = realloc(_cumulativeDurations, (newCapacity + 1) * sizeof(NSTimeInterval));
+	_cumulativeDurations[0] = 0.;
+	_capacity = newCapacity;
+}
+
+- (void)addTimeRangeFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime
+{
+	if (isnan(startTime) || isnan(endTime) || isinf(startTime) || isinf(endTime) || endTime <= startTime) {
+		return;
+	}
+	
+	// Intervals in [first, last[ overlap or touch the new one and are merged into it
+	NSUInteger first = [self lowerBoundForEndTime:startTime];
+	NSUInteger last = [self upperBoundForTime:endTime];
+	
+	if (first < last) {
+		startTime = MIN(startTime, _startTimes[first]);
+		endTime = MAX(endTime, _endTimes[last - 1]);
+	}
+	else {
+		[self reserveCapacity:_count + 1];
+	}
+	
+	// Replace the merged intervals with a single one
+	NSUInteger removedCount = last - first;
+	NSUInteger tailCount = _count - last;
+	if (removedCount != 1) {
+		memmove(&_startTimes[first + 1], &_startTimes[last], tailCount * sizeof(NSTimeInterval));
+		memmove(&_endTimes[first + 1], &_endTimes[last], tailCount * sizeof(NSTimeInterval));
+	}
+	_startTimes[first] = startTime;
+	_endTimes[first] = endTime;
+	_count = first + 1 + tailCount;
+	
+	// Cumulative durations up to the first changed interval remain valid
+	_cumulativeCount = MIN(_cumulativeCount, first + 1);
+}
+
+- (void)setTimeRanges:(NSArray<NSValue *> *)timeRanges
+{
+	[self removeAllTimeRanges];
+	[self reserveCapacity:timeRanges.count];
+	
+	for (NSValue *timeRangeValue in timeRanges) {
+		CMTimeRange timeRange = [timeRangeValue CMTimeRangeValue];
+		if (!CMTIMERANGE_IS_VALID(timeRange) || CMTIMERANGE_IS_INDEFINITE(timeRange) || CMTIMERANGE_IS_EMPTY(timeRange)) {
+			continue;
+		}
+		[self addTimeRangeFromTime:CMTimeGetSeconds(timeRange.start) toTime:CMTimeGetSeconds(CMTimeRangeGetEnd(timeRange))];
+	}
+}
+
+- (void)removeAllTimeRanges
+{
+	_count = 0;
+	_cumulativeCount = MIN(_cumulativeCount, 1);
+}
+
+#pragma mark - Equality
+
+- (BOOL)isEqualToTimeRangeSet:(RTSMediaTimeRangeSet *)timeRangeSet
+{
+	if (_count != timeRangeSet->_count) {
+		return NO;
+	}
+	
+	return memcmp(_startTimes, timeRangeSet->_startTimes, _count * sizeof(NSTimeInterval)) == 0
+		&& memcmp(_endTimes, timeRangeSet->_endTimes, _count * sizeof(NSTimeInterval)) == 0;
+}
+
+- (BOOL)isEqual:(id)object
+{
+	if (![object isKindOfClass:[RTSMediaTimeRangeSet class]]) {
+		return NO;
+	}
+	
+	return [self isEqualToTimeRangeSet:object];
+}
+
+- (NSUInteger)hash
+{
+	return _count;
+}
+
+#pragma mark - NSSecureCoding protocol
+
++ (BOOL)supportsSecureCoding
+{
+	return YES;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)decoder
+{
+	if (self = [super init]) {
+		NSData *data = [decoder decodeObjectOfClass:[NSData class] forKey:@"timeRanges"];
+		NSUInteger count = data.length / (2 * sizeof(NSTimeInterval));
+		[self reserveCapacity:count];
+		
+		// Added one by one, so that corrupted data cannot break the ordering of the intervals
+		const NSTimeInterval *bounds = data.bytes;
+		for (NSUInteger i = 0; i < count; ++i) {
+			[self addTimeRangeFromTime:bounds[2 * i] toTime:bounds[2 * i + 1]];
+		}
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	NSMutableData *data = [NSMutableData dataWithLength:_count * 2 * sizeof(NSTimeInterval)];
+	NSTimeInterval *bounds = data.mutableBytes;
+	for (NSUInteger i = 0; i < _count; ++i) {
+		bounds[2 * i] = _startTimes[i];
+		bounds[2 * i + 1] = _endTimes[i];
+	}
+	[coder encodeObject:data forKey:@"timeRanges"];
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	RTSMediaTimeRangeSet *timeRangeSet = [[[self class] allocWithZone:zone] init];
+	[timeRangeSet reserveCapacity:_count];
+	if (_count != 0) {
+		memcpy(timeRangeSet->_startTimes, _startTimes, _count * sizeof(NSTimeInterval));
+		memcpy(timeRangeSet->_endTimes, _endTimes, _count * sizeof(NSTimeInterval));
+	}
+	timeRangeSet->_count = _count;
+	return timeRangeSet;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	NSMutableArray<NSString *> *intervalDescriptions = [NSMutableArray arrayWithCapacity:_count];
+	for (NSUInteger i = 0; i < _count; ++i) {
+		[intervalDescriptions addObject:[NSString stringWithFormat:@"[%.3f, %.3f]", _startTimes[i], _endTimes[i]]];
+	}
+	return [NSString stringWithFormat:@"<%@: %p; timeRanges: %@>", [self class], self, [intervalDescriptions componentsJoinedByString:@", "]];
+}
+
+@end
@@ -0,0 +1,86 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <Foundation/Foundation.h>
+
+/**
+ *  A schedule of boundary times and time ranges, evaluated against a playhead position. Boundaries and range edges are
+ *  kept sorted by time, so that moving the playhead only visits the entries located between its previous and new
+ *  positions
+ *
+ *  The schedule does not observe any player by itself. Its position must be updated by calling `-playToTime:` when
+ *  playback continuously reaches a time, and `-jumpToTime:` after a discontinuity (e.g. a seek). This makes it possible
+ *  to drive the schedule with a virtual clock. `RTSMediaPlayerController` uses a schedule to implement its boundary and
+ *  time range observers
+ *
+ *  Time ranges are half-open, as for `CMTimeRangeContainsTime`: a time located at the end of a range is not contained
+ *  in it. All blocks are called synchronously on the thread updating the schedule
+ */
+@interface RTSMediaTimeSchedule : NSObject
+
+/**
+ *  Register a block to be called when playback crosses one of the specified times
+ *
+ *  @param times The times (as `NSValue`s wrapping `CMTime`s) to observe. Invalid times are ignored
+ *  @param block The block to call, receiving the time which has been crossed
+ *
+ *  @return An opaque identifier for the registration, nil if nothing was registered
+ */
+- (id)addBoundaryTimes:(NSArray<NSValue *> *)times usingBlock:(void (^)(CMTime time))block;
+
+/**
+ *  Register blocks to be called when the playhead enters or exits a time range, whether it moves continuously or jumps.
+ *  If the playhead is already within the range, the enter block is called immediately
+ *
+ *  @param timeRange  The time range to observe. Invalid or empty time ranges are not registered
+ *  @param enterBlock The block to call when entering the range (optional)
+ *  @param exitBlock  The block to call when exiting the range (optional)
+ *
+ *  @discussion Blocks receive the time of the range edge which has been crossed, or the playhead time after a jump
+ *
+ *  @return An opaque identifier for the registration, nil if nothing was registered
+ */
+- (id)addTimeRange:(CMTimeRange)timeRange enterBlock:(void (^)(CMTime time))enterBlock exitBlock:(void (^)(CMTime time))exitBlock;
+
+/**
+ *  Unregister the boundary times or time range matching the specified identifier (does nothing if not found). No exit
+ *  block is called
+ */
+- (void)removeEntryWithIdentifier:(id)identifier;
+
+/**
+ *  Move all entries to another schedule, keeping their identifiers and whether the playhead is within their time range.
+ *  The other schedule is then moved to the position of the receiver, as for `-jumpToTime:`, and the receiver is left
+ *  empty, with an unknown position
+ */
+- (void)moveEntriesToTimeSchedule:(RTSMediaTimeSchedule *)timeSchedule;
+
+/**
+ *  The sorted distinct times (as `NSValue`s wrapping `CMTime`s) at which the playhead must be reported with `-playToTime:`
+ *  for all boundaries and range edges to be detected
+ */
+@property (nonatomic, readonly) NSArray<NSValue *> *boundaryTimes;
+
+/**
+ *  The last playhead position, invalid if unknown
+ */
+@property (nonatomic, readonly) CMTime currentTime;
+
+/**
+ *  Move the playhead continuously (forward or backward) to the specified time. Boundaries between the previous and the
+ *  new position are crossed in order, and range edges are reported as they are crossed. An invalid time is treated as
+ *  a jump
+ */
+- (void)playToTime:(CMTime)time;
+
+/**
+ *  Move the playhead to the specified time without crossing boundaries in between. Only ranges whose containment changes
+ *  are reported, exits first. An invalid time means the playhead is not within any range anymore
+ */
+- (void)jumpToTime:(CMTime)time;
+
+@end
@@ -0,0 +1,382 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaTimeSchedule.h"
+
+// Event types, in the order in which events at the same time are processed during forward playback (exits before
+// enters, so that adjacent ranges are correctly switched)
+typedef NS_ENUM(NSInteger, RTSMediaTimeScheduleEventType) {
+	RTSMediaTimeScheduleEventTypeRangeEnd,
+	RTSMediaTimeScheduleEventTypeBoundary,
+	RTSMediaTimeScheduleEventTypeRangeStart
+};
+
+@interface RTSMediaTimeScheduleEntry : NSObject
+
+@property (nonatomic) id identifier;
+@property (nonatomic) CMTimeRange timeRange;
+@property (nonatomic, copy) void (^block)(CMTime time);
+@property (nonatomic, copy) void (^exitBlock)(CMTime time);
+@property (nonatomic, getter=isInside) BOOL inside;
+
+@end
+
+@interface RTSMediaTimeScheduleEvent : NSObject
+
+@property (nonatomic) CMTime time;
+@property (nonatomic) RTSMediaTimeScheduleEventType type;
+@property (nonatomic) RTSMediaTimeScheduleEntry *entry;
+
+@end
+
+@interface RTSMediaTimeSchedule ()
+
+@property (nonatomic) NSMutableArray<RTSMediaTimeScheduleEntry *> *entries;
+@property (nonatomic) NSMutableArray<RTSMediaTimeScheduleEvent *> *events;
+@property (nonatomic) CMTime currentTime;
+
+@end
+
+static NSComparisonResult RTSMediaTimeScheduleEventCompare(RTSMediaTimeScheduleEvent *event1, RTSMediaTimeScheduleEvent *event2)
+{
+	int32_t result = CMTimeCompare(event1.time, event2.time);
+	if (result != 0) {
+		return (result < 0) ? NSOrderedAscending : NSOrderedDescending;
+	}
+	else if (event1.type != event2.type) {
+		return (event1.type < event2.type) ? NSOrderedAscending : NSOrderedDescending;
+	}
+	else {
+		return NSOrderedSame;
+	}
+}
+
+@implementation RTSMediaTimeSchedule
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.entries = [NSMutableArray array];
+		self.events = [NSMutableArray array];
+		self.currentTime = kCMTimeInvalid;
+	}
+	return self;
+}
+
+#pragma mark - Getters and setters
+
+- (NSArray<NSValue *> *)boundaryTimes
+{
+	NSMutableArray<NSValue *> *boundaryTimes = [NSMutableArray array];
+	for (RTSMediaTimeScheduleEvent *event in self.events) {
+		if (boundaryTimes.count == 0 || CMTimeCompare([boundaryTimes.lastObject CMTimeValue], event.time) != 0) {
+			[boundaryTimes addObject:[NSValue valueWithCMTime:event.time]];
+		}
+	}
+	return [boundaryTimes copy];
+}
+
+#pragma mark - Registration
+
+- (id)addBoundaryTimes:(NSArray<NSValue *> *)times usingBlock:(void (^)(CMTime time))block
+{
+	if (!block) {
+		return nil;
+	}
+
+	RTSMediaTimeScheduleEntry *entry = [[RTSMediaTimeScheduleEntry alloc] init];
+	entry.identifier = [[NSUUID UUID] UUIDString];
+	entry.block = block;
+
+	BOOL inserted = NO;
+	for (NSValue *timeValue in times) {
+		CMTime time = [timeValue CMTimeValue];
+		if (CMTIME_IS_NUMERIC(time)) {
+			[self insertEventWithTime:time type:RTSMediaTimeScheduleEventTypeBoundary entry:entry];
+			inserted = YES;
+		}
+	}
+
+	if (!inserted) {
+		return nil;
+	}
+
+	[self.entries addObject:entry];
+	return entry.identifier;
+}
+
+- (id)addTimeRange:(CMTimeRange)timeRange enterBlock:(void (^)(CMTime time))enterBlock exitBlock:(void (^)(CMTime time))exitBlock
+{
+	if (!CMTIMERANGE_IS_VALID(timeRange) || CMTIMERANGE_IS_EMPTY(timeRange) || CMTIMERANGE_IS_INDEFINITE(timeRange)) {
+		return nil;
+	}
+
+	RTSMediaTimeScheduleEntry *entry = [[RTSMediaTimeScheduleEntry alloc] init];
+	entry.identifier = [[NSUUID UUID] UUIDString];
+	entry.timeRange = timeRange;
+	entry.block = enterBlock;
+	entry.exitBlock = exitBlock;
+
+	[self insertEventWithTime:timeRange.start type:RTSMediaTimeScheduleEventTypeRangeStart entry:entry];
+	[self insertEventWithTime:CMTimeRangeGetEnd(timeRange) type:RTSMediaTimeScheduleEventTypeRangeEnd entry:entry];
+	[self.entries addObject:entry];
+
+	if (CMTIME_IS_NUMERIC(self.currentTime) && CMTimeRangeContainsTime(timeRange, self.currentTime)) {
+		[self enterEntry:entry atTime:self.currentTime];
+	}
+
+	return entry.identifier;
+}
+
+- (void)removeEntryWithIdentifier:(id)identifier
+{
+	if (!identifier) {
+		return;
+	}
+
+	NSUInteger index = [self.entries indexOfObjectPassingTest:^BOOL(RTSMediaTimeScheduleEntry *entry, NSUInteger idx, BOOL *stop) {
+		return [entry.identifier isEqual:identifier];
+	}];
+	if (index == NSNotFound) {
+		return;
+	}
+
+	RTSMediaTimeScheduleEntry *entry = self.entries[index];
+	[self.entries removeObjectAtIndex:index];
+
+	NSIndexSet *eventIndexes = [self.events indexesOfObjectsPassingTest:^BOOL(RTSMediaTimeScheduleEvent *event, NSUInteger idx, BOOL *stop) {
+		return event.entry == entry;
+	}];
+	[self.events removeObjectsAtIndexes:eventIndexes];
+}
+
+- (void)moveEntriesToTimeSchedule:(RTSMediaTimeSchedule *)timeSchedule
+{
+	if (!timeSchedule || timeSchedule == self) {
+		return;
+	}
+
+	[timeSchedule.entries addObjectsFromArray:self.entries];
+	for (RTSMediaTimeScheduleEvent *event in self.events) {
+		[timeSchedule insertEvent:event];
+	}
+
+	CMTime currentTime = self.currentTime;
+	[self.entries removeAllObjects];
+	[self.events removeAllObjects];
+	self.currentTime = kCMTimeInvalid;
+
+	// Moved entries are consistent with this position, only entries of the other schedule can be entered or exited
+	[timeSchedule jumpToTime:currentTime];
+}
+
+- (void)insertEventWithTime:(CMTime)time type:(RTSMediaTimeScheduleEventType)type entry:(RTSMediaTimeScheduleEntry *)entry
+{
+	RTSMediaTimeScheduleEvent *event = [[RTSMediaTimeScheduleEvent alloc] init];
+	event.time = time;
+	event.type = type;
+	event.entry = entry;
+	[self insertEvent:event];
+}
+
+- (void)insertEvent:(RTSMediaTimeScheduleEvent *)event
+{
+	NSUInteger index = [self.events indexOfObject:event
+									inSortedRange:NSMakeRange(0, self.events.count)
+										  options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+								  usingComparator:^NSComparisonResult(RTSMediaTimeScheduleEvent *event1, RTSMediaTimeScheduleEvent *event2) {
+									  return RTSMediaTimeScheduleEventCompare(event1, event2);
+								  }];
+	[self.events insertObject:event atIndex:index];
+}
+
+#pragma mark - Playhead
+
+- (void)playToTime:(CMTime)time
+{
+	if (!CMTIME_IS_NUMERIC(time) || !CMTIME_IS_NUMERIC(self.currentTime)) {
+		[self jumpToTime:time];
+		return;
+	}
+
+	CMTime previousTime = self.currentTime;
+	int32_t direction = CMTimeCompare(time, previousTime);
+	if (direction == 0) {
+		return;
+	}
+
+	self.currentTime = time;
+
+	// Only visit events located between the two positions. Blocks might alter the schedule, iterate over a snapshot
+	NSArray<RTSMediaTimeScheduleEvent *> *events = [self.events copy];
+	if (direction > 0) {
+		// Boundaries and edges in (previousTime, time]
+		for (NSUInteger i = [self indexOfFirstEventAfterTime:previousTime]; i < events.count; ++i) {
+			RTSMediaTimeScheduleEvent *event = events[i];
+			if (CMTimeCompare(event.time, time) > 0) {
+				break;
+			}
+
+			switch (event.type) {
+				case RTSMediaTimeScheduleEventTypeBoundary: {
+					[self crossBoundaryOfEntry:event.entry atTime:event.time];
+					break;
+				}
+
+				case RTSMediaTimeScheduleEventTypeRangeStart: {
+					[self enterEntry:event.entry atTime:event.time];
+					break;
+				}
+
+				case RTSMediaTimeScheduleEventTypeRangeEnd: {
+					[self exitEntry:event.entry atTime:event.time];
+					break;
+				}
+			}
+		}
+	}
+	else {
+		// Boundaries in [time, previousTime), edges in (time, previousTime], crossed in reverse order
+		NSUInteger index = [self indexOfFirstEventAfterTime:previousTime];
+		for (NSUInteger i = index; i > 0; --i) {
+			RTSMediaTimeScheduleEvent *event = events[i - 1];
+			int32_t comparison = CMTimeCompare(event.time, time);
+			if (comparison < 0) {
+				break;
+			}
+
+			switch (event.type) {
+				case RTSMediaTimeScheduleEventTypeBoundary: {
+					if (CMTimeCompare(event.time, previousTime) < 0) {
+						[self crossBoundaryOfEntry:event.entry atTime:event.time];
+					}
+					break;
+				}
+
+				case RTSMediaTimeScheduleEventTypeRangeStart: {
+					if (comparison > 0) {
+						[self exitEntry:event.entry atTime:event.time];
+					}
+					break;
+				}
+
+				case RTSMediaTimeScheduleEventTypeRangeEnd: {
+					if (comparison > 0) {
+						[self enterEntry:event.entry atTime:event.time];
+					}
+					break;
+				}
+			}
+		}
+	}
+}
+
+- (void)jumpToTime:(CMTime)time
+{
+	self.currentTime = CMTIME_IS_NUMERIC(time) ? time : kCMTimeInvalid;
+
+	NSArray<RTSMediaTimeScheduleEntry *> *entries = [self.entries copy];
+	NSMutableArray<RTSMediaTimeScheduleEntry *> *enteredEntries = [NSMutableArray array];
+	for (RTSMediaTimeScheduleEntry *entry in entries) {
+		if (CMTIMERANGE_IS_INVALID(entry.timeRange)) {
+			continue;
+		}
+
+		BOOL inside = CMTIME_IS_NUMERIC(time) && CMTimeRangeContainsTime(entry.timeRange, time);
+		if (entry.inside && !inside) {
+			[self exitEntry:entry atTime:time];
+		}
+		else if (!entry.inside && inside) {
+			[enteredEntries addObject:entry];
+		}
+	}
+
+	for (RTSMediaTimeScheduleEntry *entry in enteredEntries) {
+		[self enterEntry:entry atTime:time];
+	}
+}
+
+// Index of the first event strictly after the specified time (the number of events if none)
+- (NSUInteger)indexOfFirstEventAfterTime:(CMTime)time
+{
+	NSUInteger low = 0, high = self.events.count;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (CMTimeCompare(self.events[middle].time, time) <= 0) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+- (void)crossBoundaryOfEntry:(RTSMediaTimeScheduleEntry *)entry atTime:(CMTime)time
+{
+	// The entry might have been removed by a block called earlier
+	if (![self.entries containsObject:entry]) {
+		return;
+	}
+	
+	entry.block(time);
+}
+
+- (void)enterEntry:(RTSMediaTimeScheduleEntry *)entry atTime:(CMTime)time
+{
+	if (entry.inside || ![self.entries containsObject:entry]) {
+		return;
+	}
+
+	entry.inside = YES;
+	if (entry.block) {
+		entry.block(time);
+	}
+}
+
+- (void)exitEntry:(RTSMediaTimeScheduleEntry *)entry atTime:(CMTime)time
+{
+	if (!entry.inside || ![self.entries containsObject:entry]) {
+		return;
+	}
+
+	entry.inside = NO;
+	if (entry.exitBlock) {
+		entry.exitBlock(time);
+	}
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; entries: %@; events: %@; currentTime: %@>",
+			[self class],
+			self,
+			@(self.entries.count),
+			@(self.events.count),
+			@(CMTimeGetSeconds(self.currentTime))];
+}
+
+@end
+
+@implementation RTSMediaTimeScheduleEntry
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		self.timeRange = kCMTimeRangeInvalid;
+	}
+	return self;
+}
+
+@end
+
+@implementation RTSMediaTimeScheduleEvent
+
+@end
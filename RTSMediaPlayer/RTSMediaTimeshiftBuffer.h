@@ -0,0 +1,80 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  A media segment stored in a timeshift buffer
+ */
+@interface RTSMediaTimeshiftSegment : NSObject
+
+@property (nonatomic, readonly) long long sequenceNumber;
+@property (nonatomic, readonly) NSTimeInterval duration;
+@property (nonatomic, readonly) NSUInteger byteCount;
+
+/**
+ *  Return YES iff the segment does not follow the previous one stored (e.g. segments have been missed in between)
+ */
+@property (nonatomic, readonly, getter=isDiscontinuous) BOOL discontinuous;
+
+@end
+
+/**
+ *  A timeshift buffer stores the last media segments of a live stream in a file of fixed size, used as a ring buffer.
+ *  The file is memory-mapped, so that segments are written and read without any system call, and never synchronized
+ *  with the disk explicitly: the system writes pages back lazily, only if memory is needed.
+ *
+ *  Segments are numbered in the order they are appended, without gaps. The oldest segments are evicted when the
+ *  duration stored exceeds the depth of the buffer, or when their bytes are needed for new segments. The file is
+ *  removed when the buffer is deallocated. Buffers can be used from any thread
+ */
+@interface RTSMediaTimeshiftBuffer : NSObject
+
+/**
+ *  Create a buffer storing at most `depth` seconds of media in a file of `byteCapacity` bytes, created (or replaced)
+ *  at the specified location, or in the temporary directory if nil. `-init` uses a 64 MB capacity and a 30 minute depth
+ */
+- (instancetype)initWithFileURL:(NSURL *)fileURL byteCapacity:(NSUInteger)byteCapacity depth:(NSTimeInterval)depth NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) NSURL *fileURL;
+@property (nonatomic, readonly) NSUInteger byteCapacity;
+@property (nonatomic, readonly) NSTimeInterval depth;
+
+/**
+ *  Append a segment, evicting older ones as needed. Return NO if the segment cannot be stored (empty segment, segment
+ *  larger than the capacity, or file which could not be mapped)
+ */
+- (BOOL)appendSegmentWithData:(NSData *)data duration:(NSTimeInterval)duration discontinuous:(BOOL)discontinuous;
+
+/**
+ *  The data of a segment, nil if not stored (anymore). The data is copied, and therefore remains valid after the
+ *  segment has been evicted
+ */
+- (NSData *)dataForSegmentWithSequenceNumber:(long long)sequenceNumber;
+
+/**
+ *  The segments stored, in sequence order, and the sequence number the next segment appended will receive
+ */
+@property (nonatomic, readonly) NSArray<RTSMediaTimeshiftSegment *> *segments;
+@property (nonatomic, readonly) long long nextSequenceNumber;
+
+/**
+ *  The number of discontinuities evicted with older segments, as expected by `EXT-X-DISCONTINUITY-SEQUENCE`
+ */
+@property (nonatomic, readonly) long long discontinuitySequenceNumber;
+
+/**
+ *  The total duration and size of the segments stored
+ */
+@property (nonatomic, readonly) NSTimeInterval duration;
+@property (nonatomic, readonly) NSUInteger byteCount;
+
+/**
+ *  Evict all segments. Sequence numbers are not reused
+ */
+- (void)removeAllSegments;
+
+@end
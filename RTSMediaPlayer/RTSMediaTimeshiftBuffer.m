@@ -0,0 +1,223 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaTimeshiftBuffer.h"
+
+#import "RTSMediaPlayerLogger+Private.h"
+
+#import <fcntl.h>
+#import <sys/mman.h>
+#import <unistd.h>
+
+static const NSUInteger RTSMediaTimeshiftBufferDefaultByteCapacity = 64 * 1024 * 1024;
+static const NSTimeInterval RTSMediaTimeshiftBufferDefaultDepth = 30. * 60.;
+
+@interface RTSMediaTimeshiftSegment ()
+
+@property (nonatomic) long long sequenceNumber;
+@property (nonatomic) NSTimeInterval duration;
+@property (nonatomic) NSUInteger byteCount;
+@property (nonatomic, getter=isDiscontinuous) BOOL discontinuous;
+
+@property (nonatomic) NSUInteger offset;								// Location in the file
+
+@end
+
+@implementation RTSMediaTimeshiftSegment
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; sequenceNumber: %@; duration: %@; byteCount: %@; discontinuous: %@>",
+			[self class],
+			self,
+			@(self.sequenceNumber),
+			@(self.duration),
+			@(self.byteCount),
+			self.discontinuous ? @"YES" : @"NO"];
+}
+
+@end
+
+@interface RTSMediaTimeshiftBuffer ()
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) NSUInteger byteCapacity;
+@property (nonatomic) NSTimeInterval depth;
+
+@property (nonatomic) uint8_t *bytes;									// NULL if the file could not be mapped
+@property (nonatomic) NSUInteger writeOffset;
+@property (nonatomic) NSMutableArray<RTSMediaTimeshiftSegment *> *mutableSegments;
+@property (nonatomic) long long nextSequenceNumber;
+@property (nonatomic) long long discontinuitySequenceNumber;
+@property (nonatomic) NSTimeInterval duration;
+@property (nonatomic) NSUInteger byteCount;
+
+@end
+
+@implementation RTSMediaTimeshiftBuffer
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithFileURL:nil byteCapacity:RTSMediaTimeshiftBufferDefaultByteCapacity depth:RTSMediaTimeshiftBufferDefaultDepth];
+}
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL byteCapacity:(NSUInteger)byteCapacity depth:(NSTimeInterval)depth
+{
+	NSParameterAssert(!fileURL || fileURL.isFileURL);
+
+	if (self = [super init]) {
+		if (!fileURL) {
+			NSString *fileName = [[NSUUID UUID].UUIDString stringByAppendingPathExtension:@"timeshift"];
+			fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+		}
+
+		self.fileURL = fileURL;
+		self.byteCapacity = byteCapacity;
+		self.depth = MAX(depth, 0.);
+		self.mutableSegments = [NSMutableArray array];
+
+		// The mapping remains valid once the file descriptor has been closed
+		int fileDescriptor = open(fileURL.fileSystemRepresentation, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+		if (fileDescriptor != -1) {
+			if (byteCapacity != 0 && ftruncate(fileDescriptor, (off_t)byteCapacity) == 0) {
+				void *bytes = mmap(NULL, byteCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+				if (bytes != MAP_FAILED) {
+					self.bytes = bytes;
+				}
+			}
+			close(fileDescriptor);
+		}
+
+		if (!self.bytes) {
+			RTSMediaPlayerLogError(@"The timeshift buffer file %@ could not be mapped (%s)", fileURL.path, strerror(errno));
+		}
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	if (_bytes) {
+		munmap(_bytes, _byteCapacity);
+	}
+	unlink(_fileURL.fileSystemRepresentation);
+}
+
+#pragma mark - Getters and setters
+
+- (NSArray<RTSMediaTimeshiftSegment *> *)segments
+{
+	@synchronized(self) {
+		return [self.mutableSegments copy];
+	}
+}
+
+#pragma mark - Segments
+
+- (BOOL)appendSegmentWithData:(NSData *)data duration:(NSTimeInterval)duration discontinuous:(BOOL)discontinuous
+{
+	@synchronized(self) {
+		if (!self.bytes || data.length == 0 || data.length > self.byteCapacity) {
+			return NO;
+		}
+
+		// Segments are stored contiguously. If the end of the file is too small, it is skipped
+		NSUInteger offset = self.writeOffset;
+		if (offset + data.length > self.byteCapacity) {
+			[self evictSegmentsOverlappingRange:NSMakeRange(offset, self.byteCapacity - offset)];
+			offset = 0;
+		}
+		[self evictSegmentsOverlappingRange:NSMakeRange(offset, data.length)];
+
+		memcpy(self.bytes + offset, data.bytes, data.length);
+		self.writeOffset = offset + data.length;
+
+		RTSMediaTimeshiftSegment *segment = [[RTSMediaTimeshiftSegment alloc] init];
+		segment.sequenceNumber = self.nextSequenceNumber;
+		segment.duration = duration;
+		segment.byteCount = data.length;
+		segment.discontinuous = discontinuous;
+		segment.offset = offset;
+		[self.mutableSegments addObject:segment];
+
+		self.nextSequenceNumber++;
+		self.duration += duration;
+		self.byteCount += data.length;
+
+		while (self.duration > self.depth && self.mutableSegments.count > 1) {
+			[self evictFirstSegment];
+		}
+		return YES;
+	}
+}
+
+- (NSData *)dataForSegmentWithSequenceNumber:(long long)sequenceNumber
+{
+	@synchronized(self) {
+		long long firstSequenceNumber = self.mutableSegments.firstObject.sequenceNumber;
+		if (sequenceNumber < firstSequenceNumber || sequenceNumber >= self.nextSequenceNumber || self.mutableSegments.count == 0) {
+			return nil;
+		}
+
+		RTSMediaTimeshiftSegment *segment = self.mutableSegments[(NSUInteger)(sequenceNumber - firstSequenceNumber)];
+		return [NSData dataWithBytes:self.bytes + segment.offset length:segment.byteCount];
+	}
+}
+
+- (void)removeAllSegments
+{
+	@synchronized(self) {
+		while (self.mutableSegments.count != 0) {
+			[self evictFirstSegment];
+		}
+		self.writeOffset = 0;
+		self.duration = 0.;
+	}
+}
+
+// Segments are stored in sequence order, starting after the write offset. Segments overlapping a range starting at
+// the write offset are therefore always the oldest ones
+- (void)evictSegmentsOverlappingRange:(NSRange)range
+{
+	while (self.mutableSegments.count != 0) {
+		RTSMediaTimeshiftSegment *firstSegment = self.mutableSegments.firstObject;
+		if (NSIntersectionRange(range, NSMakeRange(firstSegment.offset, firstSegment.byteCount)).length == 0) {
+			break;
+		}
+		[self evictFirstSegment];
+	}
+}
+
+- (void)evictFirstSegment
+{
+	RTSMediaTimeshiftSegment *firstSegment = self.mutableSegments.firstObject;
+	[self.mutableSegments removeObjectAtIndex:0];
+
+	self.duration -= firstSegment.duration;
+	self.byteCount -= firstSegment.byteCount;
+	if (firstSegment.discontinuous) {
+		self.discontinuitySequenceNumber++;
+	}
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; fileURL: %@; segments: %@; duration: %@; byteCount: %@>",
+			[self class],
+			self,
+			self.fileURL,
+			@(self.mutableSegments.count),
+			@(self.duration),
+			@(self.byteCount)];
+}
+
+@end
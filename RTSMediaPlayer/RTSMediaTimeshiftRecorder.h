@@ -0,0 +1,56 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+
+#import "RTSMediaTimeshiftBuffer.h"
+
+@class RTSMediaPlaylistRewriter;
+
+/**
+ *  A timeshift recorder plays a live stream without DVR window as if it had one. The media segments of the stream are
+ *  recorded into a timeshift buffer as they are published, and the player is served a sliding media playlist listing
+ *  the segments of the buffer. The player therefore sees a DVR window as long as the recording, up to the depth of the
+ *  buffer, and can pause, seek backwards and go back to live as usual.
+ *
+ *  Recording starts when the asset returned by the recorder loads its playlist. Only the first variant listed in the
+ *  master playlist is recorded. Streams which cannot be recorded (on-demand or event streams, streams whose own window
+ *  is at least as long as the buffer depth, and encrypted or byte range streams) are played as is. Recording continues
+ *  while playback is paused, until the recorder is stopped
+ */
+@interface RTSMediaTimeshiftRecorder : NSObject
+
+/**
+ *  Create a recorder for the stream at the specified URL (master or media playlist), recording into a buffer
+ */
+- (instancetype)initWithURL:(NSURL *)URL buffer:(RTSMediaTimeshiftBuffer *)buffer NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) NSURL *URL;
+@property (nonatomic, readonly) RTSMediaTimeshiftBuffer *buffer;
+
+/**
+ *  If set, the master playlist is rewritten before the variant to record is chosen (e.g. to apply variant selection).
+ *  Streams played as is are not rewritten. Must be set before recording starts. Default is nil
+ */
+@property (atomic) RTSMediaPlaylistRewriter *playlistRewriter;
+
+/**
+ *  The asset to play. Only HTTP(S) URLs can be recorded, a plain asset is returned for other URLs
+ */
+@property (nonatomic, readonly) AVURLAsset *asset;
+
+/**
+ *  Return YES iff the stream is being recorded
+ */
+@property (atomic, readonly, getter=isRecording) BOOL recording;
+
+/**
+ *  Stop recording. The segments already recorded can still be played
+ */
+- (void)stop;
+
+@end
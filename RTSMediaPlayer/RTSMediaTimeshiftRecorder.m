@@ -0,0 +1,498 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaTimeshiftRecorder.h"
+
+#import <libextobjc/EXTScope.h>
+#import <MobileCoreServices/MobileCoreServices.h>
+
+#import "RTSMediaPlayerLogger+Private.h"
+#import "RTSMediaPlaylistRewriter.h"
+#import "RTSMediaResourceLoading+Private.h"
+
+// Prefix added to the scheme of the playlist URL, so that it is loaded through the resource loader
+static NSString * const RTSMediaTimeshiftSchemePrefix = @"rtstimeshift-";
+
+// Scheme of the URLs of the segments served from the buffer
+static NSString * const RTSMediaTimeshiftSegmentScheme = @"rtstimeshiftsegment";
+
+static NSString * const RTSMediaTimeshiftPlaylistContentType = @"public.m3u-playlist";
+
+// Media playlists are reloaded every half target duration, but not more often than this interval (in seconds)
+static const NSTimeInterval RTSMediaTimeshiftMinimumReloadInterval = 0.5;
+
+#pragma mark - Playlists
+
+@interface RTSMediaTimeshiftPlaylistSegment : NSObject
+
+@property (nonatomic) long long sequenceNumber;
+@property (nonatomic) NSTimeInterval duration;
+@property (nonatomic) NSURL *URL;
+
+@end
+
+@implementation RTSMediaTimeshiftPlaylistSegment
+
+@end
+
+/**
+ *  A playlist loaded from the network, with the information needed for recording
+ */
+@interface RTSMediaTimeshiftPlaylist : NSObject
+
+- (instancetype)initWithString:(NSString *)string URL:(NSURL *)URL;
+
+@property (nonatomic, readonly) NSURL *variantURL;									// First variant listed, nil for media playlists
+
+@property (nonatomic, readonly) NSTimeInterval targetDuration;
+@property (nonatomic, readonly) NSArray<RTSMediaTimeshiftPlaylistSegment *> *segments;
+@property (nonatomic, readonly) NSTimeInterval duration;
+@property (nonatomic, readonly, getter=hasPlaylistType) BOOL playlistType;			// VOD or event
+@property (nonatomic, readonly, getter=isEnded) BOOL ended;
+@property (nonatomic, readonly, getter=isRecordable) BOOL recordable;				// No encryption, byte ranges or initialization sections
+
+@end
+
+@interface RTSMediaTimeshiftPlaylist ()
+
+@property (nonatomic) NSURL *variantURL;
+@property (nonatomic) NSTimeInterval targetDuration;
+@property (nonatomic) NSArray<RTSMediaTimeshiftPlaylistSegment *> *segments;
+@property (nonatomic) NSTimeInterval duration;
+@property (nonatomic, getter=hasPlaylistType) BOOL playlistType;
+@property (nonatomic, getter=isEnded) BOOL ended;
+@property (nonatomic, getter=isRecordable) BOOL recordable;
+
+@end
+
+@implementation RTSMediaTimeshiftPlaylist
+
+- (instancetype)initWithString:(NSString *)string URL:(NSURL *)URL
+{
+	if (self = [super init]) {
+		NSMutableArray<RTSMediaTimeshiftPlaylistSegment *> *segments = [NSMutableArray array];
+		__block long long sequenceNumber = 0;
+		__block NSTimeInterval segmentDuration = 0.;
+		__block BOOL streamInformation = NO;
+		self.recordable = YES;
+
+		[string enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+			line = [line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+			if ([line hasPrefix:@"#EXT-X-STREAM-INF"]) {
+				streamInformation = YES;
+			}
+			else if ([line hasPrefix:@"#EXTINF:"]) {
+				segmentDuration = [line substringFromIndex:8].doubleValue;
+			}
+			else if ([line hasPrefix:@"#EXT-X-TARGETDURATION:"]) {
+				self.targetDuration = [line substringFromIndex:22].doubleValue;
+			}
+			else if ([line hasPrefix:@"#EXT-X-MEDIA-SEQUENCE:"]) {
+				sequenceNumber = [line substringFromIndex:22].longLongValue;
+			}
+			else if ([line hasPrefix:@"#EXT-X-PLAYLIST-TYPE:"]) {
+				self.playlistType = YES;
+			}
+			else if ([line hasPrefix:@"#EXT-X-ENDLIST"]) {
+				self.ended = YES;
+			}
+			else if ([line hasPrefix:@"#EXT-X-BYTERANGE"] || [line hasPrefix:@"#EXT-X-MAP"]
+					 || ([line hasPrefix:@"#EXT-X-KEY"] && ![line containsString:@"METHOD=NONE"])) {
+				self.recordable = NO;
+			}
+			else if (line.length != 0 && ![line hasPrefix:@"#"]) {
+				NSURL *absoluteURL = [NSURL URLWithString:line relativeToURL:URL].absoluteURL;
+				if (streamInformation) {
+					self.variantURL = absoluteURL;
+					*stop = YES;
+					return;
+				}
+
+				RTSMediaTimeshiftPlaylistSegment *segment = [[RTSMediaTimeshiftPlaylistSegment alloc] init];
+				segment.sequenceNumber = sequenceNumber++;
+				segment.duration = segmentDuration;
+				segment.URL = absoluteURL;
+				[segments addObject:segment];
+
+				self.duration += segmentDuration;
+				segmentDuration = 0.;
+			}
+		}];
+
+		self.segments = [segments copy];
+	}
+	return self;
+}
+
+@end
+
+#pragma mark - Recorder
+
+typedef NS_ENUM(NSInteger, RTSMediaTimeshiftRecorderState) {
+	RTSMediaTimeshiftRecorderStateIdle = 0,
+	RTSMediaTimeshiftRecorderStateStarting,
+	RTSMediaTimeshiftRecorderStateRecording,					// Also once recording has been stopped, to serve the segments recorded
+	RTSMediaTimeshiftRecorderStatePassthrough,
+	RTSMediaTimeshiftRecorderStateFailed
+};
+
+@interface RTSMediaTimeshiftRecorder () <AVAssetResourceLoaderDelegate>
+
+@property (nonatomic) NSURL *URL;
+@property (nonatomic) RTSMediaTimeshiftBuffer *buffer;
+@property (nonatomic) AVURLAsset *asset;
+@property (atomic, getter=isRecording) BOOL recording;
+
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) NSURLSession *session;
+
+// Only accessed on the queue
+@property (nonatomic) RTSMediaTimeshiftRecorderState state;
+@property (nonatomic) NSError *error;
+@property (nonatomic) NSMutableArray<AVAssetResourceLoadingRequest *> *pendingLoadingRequests;
+@property (nonatomic) NSURL *mediaPlaylistURL;
+@property (nonatomic) NSTimeInterval targetDuration;
+@property (nonatomic) NSString *segmentPathExtension;
+@property (nonatomic) long long lastSourceSequenceNumber;			// -1 if none
+@property (nonatomic, getter=isStopped) BOOL stopped;
+
+@end
+
+@implementation RTSMediaTimeshiftRecorder
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithURL:[NSURL URLWithString:@""] buffer:[[RTSMediaTimeshiftBuffer alloc] init]];
+}
+
+- (instancetype)initWithURL:(NSURL *)URL buffer:(RTSMediaTimeshiftBuffer *)buffer
+{
+	NSParameterAssert(buffer);
+
+	if (self = [super init]) {
+		self.URL = URL;
+		self.buffer = buffer;
+		self.queue = dispatch_queue_create("ch.srgssr.mediaplayer.timeshift", DISPATCH_QUEUE_SERIAL);
+		self.pendingLoadingRequests = [NSMutableArray array];
+		self.lastSourceSequenceNumber = -1;
+
+		NSOperationQueue *delegateQueue = [[NSOperationQueue alloc] init];
+		delegateQueue.maxConcurrentOperationCount = 1;
+		delegateQueue.underlyingQueue = self.queue;
+		self.session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration] delegate:nil delegateQueue:delegateQueue];
+
+		// Use a custom scheme so that the asset cannot load the playlist itself and asks its resource loader delegate.
+		// The resource loader only keeps a weak reference to its delegate
+		NSURL *interceptedURL = RTSMediaResourceLoadingInterceptedURL(URL, RTSMediaTimeshiftSchemePrefix);
+		if (interceptedURL) {
+			self.asset = [AVURLAsset URLAssetWithURL:interceptedURL options:nil];
+			[self.asset.resourceLoader setDelegate:self queue:self.queue];
+		}
+		else {
+			self.asset = [AVURLAsset URLAssetWithURL:URL options:nil];
+		}
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[_session invalidateAndCancel];
+}
+
+#pragma mark - Recording
+
+- (void)stop
+{
+	self.recording = NO;
+
+	// Requests in progress complete with a cancellation error, which ends recording if it was starting
+	dispatch_async(self.queue, ^{
+		self.stopped = YES;
+		[self.session invalidateAndCancel];
+		[self respondToPendingLoadingRequests];
+	});
+}
+
+// Fetch a resource, calling the completion handler on the queue
+- (void)fetchURL:(NSURL *)URL completionHandler:(void (^)(NSData *data, NSError *error))completionHandler
+{
+	if (self.stopped) {
+		completionHandler(nil, [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:@{ NSURLErrorFailingURLErrorKey : URL }]);
+		return;
+	}
+
+	[RTSMediaResourceLoadingDataTask(self.session, URL, ^(NSData *data, NSURLResponse *response, NSError *error) {
+		completionHandler(data, error);
+	}) resume];
+}
+
+- (void)start
+{
+	self.state = RTSMediaTimeshiftRecorderStateStarting;
+
+	[self fetchURL:self.URL completionHandler:^(NSData *data, NSError *error) {
+		if (!data) {
+			[self failWithError:error];
+			return;
+		}
+
+		// The first variant listed is recorded
+		RTSMediaPlaylistRewriter *playlistRewriter = self.playlistRewriter;
+		if (playlistRewriter) {
+			data = [playlistRewriter rewrittenPlaylistWithData:data URL:self.URL viewSize:CGSizeZero];
+		}
+
+		RTSMediaTimeshiftPlaylist *playlist = [[RTSMediaTimeshiftPlaylist alloc] initWithString:[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] URL:self.URL];
+		NSURL *variantURL = playlist.variantURL;
+		if (!variantURL) {
+			[self beginWithPlaylist:playlist URL:self.URL];
+			return;
+		}
+
+		[self fetchURL:variantURL completionHandler:^(NSData *variantData, NSError *variantError) {
+			if (!variantData) {
+				[self failWithError:variantError];
+				return;
+			}
+
+			RTSMediaTimeshiftPlaylist *variantPlaylist = [[RTSMediaTimeshiftPlaylist alloc] initWithString:[[NSString alloc] initWithData:variantData encoding:NSUTF8StringEncoding] URL:variantURL];
+			[self beginWithPlaylist:variantPlaylist URL:variantURL];
+		}];
+	}];
+}
+
+- (void)beginWithPlaylist:(RTSMediaTimeshiftPlaylist *)playlist URL:(NSURL *)URL
+{
+	if (playlist.playlistType || playlist.ended || !playlist.recordable || playlist.segments.count == 0 || playlist.duration >= self.buffer.depth) {
+		RTSMediaPlayerLogInfo(@"%@ cannot benefit from timeshift recording, played as is", URL);
+		self.state = RTSMediaTimeshiftRecorderStatePassthrough;
+		[self respondToPendingLoadingRequests];
+		return;
+	}
+
+	RTSMediaPlayerLogInfo(@"Timeshift recording of %@ started", URL);
+	self.mediaPlaylistURL = URL;
+	self.segmentPathExtension = playlist.segments.firstObject.URL.pathExtension;
+	self.state = RTSMediaTimeshiftRecorderStateRecording;
+	self.recording = YES;
+	[self recordPlaylist:playlist];
+}
+
+- (void)failWithError:(NSError *)error
+{
+	RTSMediaPlayerLogWarning(@"Timeshift recording of %@ could not be started. Reason: %@", self.URL, error);
+	self.error = error;
+	self.state = RTSMediaTimeshiftRecorderStateFailed;
+	[self respondToPendingLoadingRequests];
+}
+
+- (void)recordPlaylist:(RTSMediaTimeshiftPlaylist *)playlist
+{
+	self.targetDuration = playlist.targetDuration;
+
+	// A stream restarting with lower sequence numbers is recorded again from its current window
+	if (playlist.segments.lastObject.sequenceNumber < self.lastSourceSequenceNumber) {
+		RTSMediaPlayerLogWarning(@"The sequence numbers of %@ went backwards, recording continues after a discontinuity", self.mediaPlaylistURL);
+		self.lastSourceSequenceNumber = -1;
+	}
+
+	NSIndexSet *newSegmentIndexes = [playlist.segments indexesOfObjectsPassingTest:^BOOL(RTSMediaTimeshiftPlaylistSegment *segment, NSUInteger idx, BOOL *stop) {
+		return segment.sequenceNumber > self.lastSourceSequenceNumber;
+	}];
+	[self recordSegments:[playlist.segments objectsAtIndexes:newSegmentIndexes] atIndex:0 completionHandler:^{
+		if (playlist.ended) {
+			RTSMediaPlayerLogInfo(@"%@ has ended, timeshift recording stopped", self.mediaPlaylistURL);
+			self.recording = NO;
+		}
+
+		[self respondToPendingLoadingRequests];
+		[self scheduleReload];
+	}];
+}
+
+// Record segments one after the other, on the queue. Segments which cannot be loaded are skipped
+- (void)recordSegments:(NSArray<RTSMediaTimeshiftPlaylistSegment *> *)segments atIndex:(NSUInteger)index completionHandler:(void (^)(void))completionHandler
+{
+	if (index >= segments.count || !self.recording) {
+		completionHandler();
+		return;
+	}
+
+	RTSMediaTimeshiftPlaylistSegment *segment = segments[index];
+	[self fetchURL:segment.URL completionHandler:^(NSData *data, NSError *error) {
+		if (data) {
+			BOOL discontinuous = (self.buffer.nextSequenceNumber != 0 && (self.lastSourceSequenceNumber == -1 || segment.sequenceNumber != self.lastSourceSequenceNumber + 1));
+			if ([self.buffer appendSegmentWithData:data duration:segment.duration discontinuous:discontinuous]) {
+				self.lastSourceSequenceNumber = segment.sequenceNumber;
+			}
+			else {
+				RTSMediaPlayerLogWarning(@"The segment %@ (%@ bytes) could not be stored in the timeshift buffer", segment.URL, @(data.length));
+			}
+		}
+		else {
+			RTSMediaPlayerLogWarning(@"The segment %@ could not be recorded. Reason: %@", segment.URL, error);
+		}
+
+		[self recordSegments:segments atIndex:index + 1 completionHandler:completionHandler];
+	}];
+}
+
+- (void)scheduleReload
+{
+	if (!self.recording) {
+		return;
+	}
+
+	NSTimeInterval reloadInterval = MAX(self.targetDuration / 2., RTSMediaTimeshiftMinimumReloadInterval);
+
+	@weakify(self)
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(reloadInterval * NSEC_PER_SEC)), self.queue, ^{
+		@strongify(self)
+		if (!self.recording) {
+			return;
+		}
+
+		[self fetchURL:self.mediaPlaylistURL completionHandler:^(NSData *data, NSError *error) {
+			if (!data) {
+				RTSMediaPlayerLogWarning(@"%@ could not be reloaded for timeshift recording. Reason: %@", self.mediaPlaylistURL, error);
+				[self scheduleReload];
+				return;
+			}
+
+			[self recordPlaylist:[[RTSMediaTimeshiftPlaylist alloc] initWithString:[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] URL:self.mediaPlaylistURL]];
+		}];
+	});
+}
+
+#pragma mark - Serving
+
+// Sliding media playlist listing the segments of the buffer. Without end tag while recording, so that the player
+// sees a live stream whose window grows up to the buffer depth
+- (NSData *)playlistData
+{
+	NSArray<RTSMediaTimeshiftSegment *> *segments = self.buffer.segments;
+	long long discontinuitySequenceNumber = self.buffer.discontinuitySequenceNumber;
+
+	NSTimeInterval targetDuration = self.targetDuration;
+	for (RTSMediaTimeshiftSegment *segment in segments) {
+		targetDuration = MAX(targetDuration, segment.duration);
+	}
+
+	NSMutableString *playlist = [NSMutableString stringWithString:@"#EXTM3U\n#EXT-X-VERSION:3\n"];
+	[playlist appendFormat:@"#EXT-X-TARGETDURATION:%@\n", @(ceil(targetDuration))];
+	[playlist appendFormat:@"#EXT-X-MEDIA-SEQUENCE:%@\n", @(segments.firstObject.sequenceNumber)];
+	[playlist appendFormat:@"#EXT-X-DISCONTINUITY-SEQUENCE:%@\n", @(discontinuitySequenceNumber)];
+
+	NSString *pathExtension = self.segmentPathExtension.length != 0 ? self.segmentPathExtension : @"ts";
+	for (RTSMediaTimeshiftSegment *segment in segments) {
+		if (segment.discontinuous) {
+			[playlist appendString:@"#EXT-X-DISCONTINUITY\n"];
+		}
+		[playlist appendFormat:@"#EXTINF:%.3f,\n%@://buffer/%@.%@\n", segment.duration, RTSMediaTimeshiftSegmentScheme, @(segment.sequenceNumber), pathExtension];
+	}
+
+	if (!self.recording) {
+		[playlist appendString:@"#EXT-X-ENDLIST\n"];
+	}
+	return [playlist dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+// Return NO if the request must wait until recording has started
+- (BOOL)respondToPlaylistLoadingRequest:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	switch (self.state) {
+		case RTSMediaTimeshiftRecorderStateRecording: {
+			// The player needs at least one segment to start
+			if (self.buffer.segments.count == 0 && self.recording) {
+				return NO;
+			}
+
+			RTSMediaResourceLoadingRespond(loadingRequest, [self playlistData], RTSMediaTimeshiftPlaylistContentType);
+			return YES;
+		}
+
+		case RTSMediaTimeshiftRecorderStatePassthrough: {
+			// Relative URIs are resolved against the redirection target, from which everything is loaded as usual
+			loadingRequest.redirect = [NSURLRequest requestWithURL:self.URL];
+			loadingRequest.response = [[NSHTTPURLResponse alloc] initWithURL:self.URL statusCode:302 HTTPVersion:nil headerFields:nil];
+			[loadingRequest finishLoading];
+			return YES;
+		}
+
+		case RTSMediaTimeshiftRecorderStateFailed: {
+			[loadingRequest finishLoadingWithError:self.error ?: [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil]];
+			return YES;
+		}
+
+		default: {
+			return NO;
+		}
+	}
+}
+
+- (void)respondToPendingLoadingRequests
+{
+	for (AVAssetResourceLoadingRequest *loadingRequest in [self.pendingLoadingRequests copy]) {
+		if ([self respondToPlaylistLoadingRequest:loadingRequest]) {
+			[self.pendingLoadingRequests removeObject:loadingRequest];
+		}
+	}
+}
+
+#pragma mark - AVAssetResourceLoaderDelegate protocol
+
+- (BOOL)resourceLoader:(AVAssetResourceLoader *)resourceLoader shouldWaitForLoadingOfRequestedResource:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	NSURL *URL = loadingRequest.request.URL;
+	if ([URL.scheme isEqualToString:RTSMediaTimeshiftSegmentScheme]) {
+		long long sequenceNumber = URL.lastPathComponent.stringByDeletingPathExtension.longLongValue;
+		NSData *data = [self.buffer dataForSegmentWithSequenceNumber:sequenceNumber];
+		if (!data) {
+			RTSMediaPlayerLogWarning(@"The segment %@ is not available from the timeshift buffer anymore", @(sequenceNumber));
+			[loadingRequest finishLoadingWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorFileDoesNotExist userInfo:@{ NSURLErrorFailingURLErrorKey : URL }]];
+			return YES;
+		}
+
+		NSString *contentType = CFBridgingRelease(UTTypeCreatePreferredIdentifierForTag(kUTTagClassFilenameExtension, (__bridge CFStringRef)URL.pathExtension, NULL));
+		RTSMediaResourceLoadingRespond(loadingRequest, data, contentType);
+		return YES;
+	}
+
+	if (!RTSMediaResourceLoadingOriginalURL(URL, RTSMediaTimeshiftSchemePrefix)) {
+		return NO;
+	}
+
+	if (self.state == RTSMediaTimeshiftRecorderStateIdle) {
+		[self start];
+	}
+
+	if (![self respondToPlaylistLoadingRequest:loadingRequest]) {
+		[self.pendingLoadingRequests addObject:loadingRequest];
+	}
+	return YES;
+}
+
+- (void)resourceLoader:(AVAssetResourceLoader *)resourceLoader didCancelLoadingRequest:(AVAssetResourceLoadingRequest *)loadingRequest
+{
+	[self.pendingLoadingRequests removeObject:loadingRequest];
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; URL: %@; recording: %@; buffer: %@>",
+			[self class],
+			self,
+			self.URL,
+			self.recording ? @"YES" : @"NO",
+			self.buffer];
+}
+
+@end
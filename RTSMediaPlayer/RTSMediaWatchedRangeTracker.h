@@ -0,0 +1,83 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <Foundation/Foundation.h>
+
+#import "RTSMediaPlayerController.h"
+
+@class RTSMediaTimeRangeSet;
+
+/**
+ *  A watched range tracker records which parts of medias have been watched, as compact sets of intervals (in seconds)
+ *  per media identifier. Intervals are merged as they are added, so that the size of a record only depends on the
+ *  number of distinct parts watched, not on how long playback lasted. Duration queries are answered in logarithmic
+ *  time (see `RTSMediaTimeRangeSet`)
+ *
+ *  Records are persisted to a file, if any, a few seconds after they change and when the application enters the
+ *  background. Trackers can be used from any thread
+ *
+ *  Assign a tracker to the `watchedRangeTracker` property of a media player controller so that it records what the
+ *  controller plays
+ */
+@interface RTSMediaWatchedRangeTracker : NSObject
+
+/**
+ *  A tracker shared by all controllers, persisted in the application support directory
+ */
++ (RTSMediaWatchedRangeTracker *)sharedTracker;
+
+/**
+ *  Create a tracker persisted to the specified file, loading records it already contains. Records are only kept in
+ *  memory if the URL is nil, which `-init` does
+ */
+- (instancetype)initWithFileURL:(NSURL *)fileURL NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) NSURL *fileURL;
+
+/**
+ *  Record a watched interval for the specified identifier. Invalid intervals are ignored
+ */
+- (void)addWatchedTimeRangeFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime forIdentifier:(NSString *)identifier;
+
+/**
+ *  A copy of the intervals watched for the specified identifier (empty if none)
+ */
+- (RTSMediaTimeRangeSet *)watchedTimeRangeSetForIdentifier:(NSString *)identifier;
+
+/**
+ *  The duration watched for the specified identifier between two times, e.g. within a segment
+ */
+- (NSTimeInterval)watchedDurationForIdentifier:(NSString *)identifier fromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime;
+- (NSTimeInterval)watchedDurationForIdentifier:(NSString *)identifier inTimeRange:(CMTimeRange)timeRange;
+
+/**
+ *  The fraction (between 0 and 1) of a media of the specified duration which has been watched
+ */
+- (double)watchedFractionForIdentifier:(NSString *)identifier duration:(NSTimeInterval)duration;
+
+/**
+ *  Forget the intervals watched for an identifier, or for all of them
+ */
+- (void)removeWatchedTimeRangesForIdentifier:(NSString *)identifier;
+- (void)removeAllWatchedTimeRanges;
+
+/**
+ *  Immediately write pending changes to the file, if any. Return NO if writing failed
+ */
+- (BOOL)save;
+
+@end
+
+@interface RTSMediaPlayerController (RTSMediaWatchedRangeTracker)
+
+/**
+ *  The tracker recording the parts of on-demand medias played by the controller, under its identifier. Seeks and other
+ *  discontinuities are never recorded as watched, whatever the playback rate. Default is nil (no tracking)
+ */
+@property (nonatomic) RTSMediaWatchedRangeTracker *watchedRangeTracker;
+
+@end
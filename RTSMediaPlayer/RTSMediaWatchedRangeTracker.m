@@ -0,0 +1,270 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "RTSMediaWatchedRangeTracker.h"
+
+#import <libextobjc/EXTScope.h>
+#import <UIKit/UIKit.h>
+
+#import "RTSMediaPlayerLogger+Private.h"
+#import "RTSMediaTimeRangeSet.h"
+
+// Changes are written in batches
+static const NSTimeInterval RTSMediaWatchedRangeTrackerSaveDelay = 5.;
+
+@interface RTSMediaWatchedRangeTracker ()
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) NSMutableDictionary<NSString *, RTSMediaTimeRangeSet *> *timeRangeSets;
+@property (nonatomic) dispatch_queue_t saveQueue;
+@property (nonatomic, getter=isDirty) BOOL dirty;
+@property (nonatomic, getter=isSaveScheduled) BOOL saveScheduled;
+
+@end
+
+@implementation RTSMediaWatchedRangeTracker
+
+#pragma mark - Class methods
+
++ (RTSMediaWatchedRangeTracker *)sharedTracker
+{
+	static RTSMediaWatchedRangeTracker *s_sharedTracker;
+	static dispatch_once_t s_onceToken;
+	dispatch_once(&s_onceToken, ^{
+		NSURL *applicationSupportURL = [[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask].firstObject;
+		NSURL *fileURL = [[applicationSupportURL URLByAppendingPathComponent:@"SRGMediaPlayer"] URLByAppendingPathComponent:@"WatchedRanges.archive"];
+		s_sharedTracker = [[RTSMediaWatchedRangeTracker alloc] initWithFileURL:fileURL];
+	});
+	return s_sharedTracker;
+}
+
+#pragma mark - Object lifecycle
+
+- (instancetype)init
+{
+	return [self initWithFileURL:nil];
+}
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL
+{
+	if (self = [super init]) {
+		self.fileURL = fileURL;
+		self.timeRangeSets = [self timeRangeSetsFromFileURL:fileURL] ?: [NSMutableDictionary dictionary];
+		self.saveQueue = dispatch_queue_create("ch.srgssr.mediaplayer.watchedranges", DISPATCH_QUEUE_SERIAL);
+
+		if (fileURL) {
+			[[NSNotificationCenter defaultCenter] addObserver:self
+													 selector:@selector(applicationDidEnterBackground:)
+														 name:UIApplicationDidEnterBackgroundNotification
+													   object:nil];
+		}
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Records
+
+- (void)addWatchedTimeRangeFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime forIdentifier:(NSString *)identifier
+{
+	if (!identifier) {
+		return;
+	}
+
+	@synchronized(self) {
+		RTSMediaTimeRangeSet *timeRangeSet = self.timeRangeSets[identifier];
+		if (!timeRangeSet) {
+			timeRangeSet = [RTSMediaTimeRangeSet new];
+			self.timeRangeSets[identifier] = timeRangeSet;
+		}
+
+		NSUInteger count = timeRangeSet.count;
+		NSTimeInterval totalDuration = timeRangeSet.totalDuration;
+		[timeRangeSet addTimeRangeFromTime:startTime toTime:endTime];
+		if (timeRangeSet.count == count && timeRangeSet.totalDuration == totalDuration) {
+			return;
+		}
+	}
+
+	[self setNeedsSave];
+}
+
+- (RTSMediaTimeRangeSet *)watchedTimeRangeSetForIdentifier:(NSString *)identifier
+{
+	if (!identifier) {
+		return [RTSMediaTimeRangeSet new];
+	}
+
+	@synchronized(self) {
+		return [self.timeRangeSets[identifier] copy] ?: [RTSMediaTimeRangeSet new];
+	}
+}
+
+- (NSTimeInterval)watchedDurationForIdentifier:(NSString *)identifier fromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime
+{
+	if (!identifier) {
+		return 0.;
+	}
+
+	@synchronized(self) {
+		return [self.timeRangeSets[identifier] totalDurationFromTime:startTime toTime:endTime];
+	}
+}
+
+- (NSTimeInterval)watchedDurationForIdentifier:(NSString *)identifier inTimeRange:(CMTimeRange)timeRange
+{
+	if (!CMTIMERANGE_IS_VALID(timeRange) || CMTIMERANGE_IS_INDEFINITE(timeRange)) {
+		return 0.;
+	}
+
+	return [self watchedDurationForIdentifier:identifier
+									 fromTime:CMTimeGetSeconds(timeRange.start)
+									   toTime:CMTimeGetSeconds(CMTimeRangeGetEnd(timeRange))];
+}
+
+- (double)watchedFractionForIdentifier:(NSString *)identifier duration:(NSTimeInterval)duration
+{
+	if (duration <= 0. || isnan(duration) || isinf(duration)) {
+		return 0.;
+	}
+
+	return MIN([self watchedDurationForIdentifier:identifier fromTime:0. toTime:duration] / duration, 1.);
+}
+
+- (void)removeWatchedTimeRangesForIdentifier:(NSString *)identifier
+{
+	if (!identifier) {
+		return;
+	}
+
+	@synchronized(self) {
+		[self.timeRangeSets removeObjectForKey:identifier];
+	}
+	[self setNeedsSave];
+}
+
+- (void)removeAllWatchedTimeRanges
+{
+	@synchronized(self) {
+		[self.timeRangeSets removeAllObjects];
+	}
+	[self setNeedsSave];
+}
+
+#pragma mark - Persistence
+
+- (NSMutableDictionary<NSString *, RTSMediaTimeRangeSet *> *)timeRangeSetsFromFileURL:(NSURL *)fileURL
+{
+	if (!fileURL) {
+		return nil;
+	}
+
+	NSData *data = [NSData dataWithContentsOfURL:fileURL];
+	if (!data) {
+		return nil;
+	}
+
+	NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+	unarchiver.requiresSecureCoding = YES;
+
+	NSDictionary<NSString *, RTSMediaTimeRangeSet *> *timeRangeSets = nil;
+	@try {
+		NSSet<Class> *classes = [NSSet setWithObjects:[NSDictionary class], [NSString class], [RTSMediaTimeRangeSet class], nil];
+		timeRangeSets = [unarchiver decodeObjectOfClasses:classes forKey:NSKeyedArchiveRootObjectKey];
+	}
+	@catch (NSException *exception) {
+		RTSMediaPlayerLogWarning(@"Watched ranges could not be read from %@. Reason: %@", fileURL, exception.reason);
+	}
+	[unarchiver finishDecoding];
+
+	return [timeRangeSets mutableCopy];
+}
+
+- (void)setNeedsSave
+{
+	if (!self.fileURL) {
+		return;
+	}
+
+	@synchronized(self) {
+		self.dirty = YES;
+		if (self.saveScheduled) {
+			return;
+		}
+		self.saveScheduled = YES;
+	}
+
+	@weakify(self)
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(RTSMediaWatchedRangeTrackerSaveDelay * NSEC_PER_SEC)), self.saveQueue, ^{
+		@strongify(self)
+		[self writePendingChanges];
+	});
+}
+
+- (BOOL)save
+{
+	__block BOOL success = YES;
+	dispatch_sync(self.saveQueue, ^{
+		success = [self writePendingChanges];
+	});
+	return success;
+}
+
+// Must be called on the save queue, so that files are written in order
+- (BOOL)writePendingChanges
+{
+	NSURL *fileURL = self.fileURL;
+	if (!fileURL) {
+		return YES;
+	}
+
+	// Sets are copied, so that archiving does not block recording
+	NSDictionary<NSString *, RTSMediaTimeRangeSet *> *timeRangeSets = nil;
+	@synchronized(self) {
+		self.saveScheduled = NO;
+		if (!self.dirty) {
+			return YES;
+		}
+		self.dirty = NO;
+
+		timeRangeSets = [[NSDictionary alloc] initWithDictionary:self.timeRangeSets copyItems:YES];
+	}
+
+	NSMutableData *data = [NSMutableData data];
+	NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+	archiver.requiresSecureCoding = YES;
+	[archiver encodeObject:timeRangeSets forKey:NSKeyedArchiveRootObjectKey];
+	[archiver finishEncoding];
+
+	NSError *error = nil;
+	[[NSFileManager defaultManager] createDirectoryAtURL:[fileURL URLByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:NULL];
+	if (![data writeToURL:fileURL options:NSDataWritingAtomic error:&error]) {
+		RTSMediaPlayerLogError(@"Watched ranges could not be saved to %@. Reason: %@", fileURL, error);
+
+		@synchronized(self) {
+			self.dirty = YES;
+		}
+		return NO;
+	}
+
+	RTSMediaPlayerLogDebug(@"Watched ranges of %@ identifiers saved (%@ bytes)", @(timeRangeSets.count), @(data.length));
+	return YES;
+}
+
+#pragma mark - Notifications
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+	dispatch_async(self.saveQueue, ^{
+		[self writePendingChanges];
+	});
+}
+
+@end
@@ -39,6 +39,13 @@
  */
 - (void)removeBlockWithIdentifier:(id)identifier;
 
+/**
+ *  Move all registered blocks to another periodic time observer, keeping their identifiers
+ *
+ *  @param periodicTimeObserver The observer to which blocks must be moved (mandatory)
+ */
+- (void)moveBlocksToPeriodicTimeObserver:(RTSPeriodicTimeObserver *)periodicTimeObserver;
+
 /**
  *  The time interval at which the observer executes all associated blocks
  */
@@ -50,7 +57,7 @@
 @property(nonatomic, readonly, weak) AVPlayer *player;
 
 /**
- *  Attach to a player. If a previous association existed, it will be removed first
+ *  Attach to a player. If a previous association existed, the observer switches to the new player without being restarted
  */
 - (void)attachToMediaPlayer:(AVPlayer *)player;
 
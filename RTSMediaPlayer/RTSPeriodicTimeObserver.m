@@ -48,9 +48,14 @@ static void *s_kvoContext  = &s_kvoContext;
 		return;
 	}
 	
-	[self removeObserver];
+	// The timer reads the player when it fires, and is therefore kept when switching to another player
 	self.player = player;
-	[self startObserver];
+	if (player) {
+		[self startObserver];
+	}
+	else {
+		[self removeObserver];
+	}
 }
 
 - (void)detachFromMediaPlayer
@@ -84,6 +89,22 @@ static void *s_kvoContext  = &s_kvoContext;
 	}
 }
 
+- (void)moveBlocksToPeriodicTimeObserver:(RTSPeriodicTimeObserver *)periodicTimeObserver
+{
+	NSParameterAssert(periodicTimeObserver);
+	
+	if (periodicTimeObserver == self) {
+		return;
+	}
+	
+	[self.blocks enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, void (^block)(CMTime), BOOL *stop) {
+		[periodicTimeObserver setBlock:block forIdentifier:identifier];
+	}];
+	
+	[self.blocks removeAllObjects];
+	[self removeObserver];
+}
+
 #pragma mark - Observers
 
 - (void)startObserver
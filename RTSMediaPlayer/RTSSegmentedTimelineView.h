@@ -21,7 +21,8 @@
  *  segments from the controller
  *
  *  Customisation of timeline cells is achieved through subclassing of `UICollectionViewCell`, exactly like a usual
- *  `UICollectionView`
+ *  `UICollectionView`. Cells conforming to the `RTSSegmentedTimelineViewCell` protocol are automatically kept in sync
+ *  with the playhead of the player associated with the segments controller
  */
 @interface RTSSegmentedTimelineView : UIView <UICollectionViewDataSource, UICollectionViewDelegate>
 
@@ -45,6 +46,18 @@
  */
 @property (nonatomic) IBInspectable CGFloat itemSpacing;
 
+/**
+ *  The number of steps with which segment progress is reported to cells (see `RTSSegmentedTimelineViewCell`). Cells
+ *  are only updated when their progress moves to another step. Defaults to 100, minimum is 1
+ */
+@property (nonatomic) IBInspectable NSInteger progressStepCount;
+
+/**
+ *  The index (in the `visibleSegments` of the segments controller) of the segment containing the playhead,
+ *  `NSNotFound` if none
+ */
+@property (nonatomic, readonly) NSUInteger activeSegmentIndex;
+
 /**
  *  Register cell classes for reuse. Cells must be subclasses of `UICollectionViewCell` and can be instantiated either
  *  programmatically or using a nib. For more information about cell reuse, refer to `UICollectionView` documentation.
@@ -55,7 +68,8 @@
 
 /**
  *  Call this method to trigger a reload of the segments from the data source, for the specified identifier. An optional
- *  completion handler block can be provided
+ *  completion handler block can be provided. Segments delivered progressively by the data source are inserted as they
+ *  are received
  */
 - (void)reloadSegmentsForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSError *error))completionHandler;
 
@@ -72,6 +86,13 @@
  */
 - (NSArray *)visibleCells;
 
+/**
+ *  Update cells for the specified playhead time. The timeline automatically tracks the playhead of the player associated
+ *  with its segments controller while displayed. You only need to call this method to reflect another time, e.g. the
+ *  position of a slider being dragged. Only cells whose state actually changes are updated
+ */
+- (void)updateWithPlayheadTime:(CMTime)time;
+
 /**
  *  Scroll to make the specified segment visible (does nothing if the segment does not belong to the visible segments
  *  of the segmentsController.
@@ -80,6 +101,22 @@
 
 @end
 
+/**
+ *  Protocol which timeline cells can optionally conform to in order to reflect the playhead position
+ */
+@protocol RTSSegmentedTimelineViewCell <NSObject>
+
+/**
+ *  Called when the cell is displayed, and afterwards when the playhead enters or leaves the associated segment, or when
+ *  the progress within the segment moves to another step (see `progressStepCount`)
+ *
+ *  @param active   YES iff the playhead is located within the segment
+ *  @param progress The played fraction of the segment, between 0 and 1
+ */
+- (void)setActive:(BOOL)active progress:(float)progress;
+
+@end
+
 /**
  *  Timeline delegate protocol
  */
@@ -12,11 +12,23 @@
 #import "RTSMediaSegmentsController.h"
 #import "RTSMediaSegmentsDataSource.h"
 
+#import <libextobjc/EXTScope.h>
+
 // Function declarations
 static void commonInit(RTSSegmentedTimelineView *self);
 
-@interface RTSSegmentedTimelineView ()
+@interface RTSSegmentedTimelineView () {
+@private
+	NSInteger *_cellStates;				// Last state applied for each visible segment, -1 if none
+	NSUInteger _cellStatesCount;
+}
+
 @property (nonatomic, weak) UICollectionView *collectionView;
+@property (nonatomic) CMTime playheadTime;
+@property (nonatomic) NSUInteger activeSegmentIndex;
+@property (nonatomic) id periodicTimeObserver;
+@property (nonatomic, weak) RTSMediaPlayerController *periodicTimeObserverMediaPlayerController;
+
 @end
 
 @implementation RTSSegmentedTimelineView
@@ -39,8 +51,22 @@ static void commonInit(RTSSegmentedTimelineView *self);
 	return self;
 }
 
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[self unregisterPeriodicTimeObserver];
+	
+	free(_cellStates);
+}
+
 #pragma mark - Getters and setters
 
+- (void)setSegmentsController:(RTSMediaSegmentsController *)segmentsController
+{
+	_segmentsController = segmentsController;
+	[self registerPeriodicTimeObserver];
+}
+
 - (void)setItemWidth:(CGFloat)itemWidth
 {
 	_itemWidth = itemWidth;
@@ -53,6 +79,13 @@ static void commonInit(RTSSegmentedTimelineView *self);
 	[self layoutIfNeeded];
 }
 
+- (void)setProgressStepCount:(NSInteger)progressStepCount
+{
+	_progressStepCount = MAX(progressStepCount, 1);
+	[self resetCellStates];
+	[self updateVisibleCells];
+}
+
 #pragma mark - Overrides
 
 - (void)layoutSubviews
@@ -65,6 +98,12 @@ static void commonInit(RTSSegmentedTimelineView *self);
 	[collectionViewLayout invalidateLayout];
 }
 
+- (void)didMoveToWindow
+{
+	[super didMoveToWindow];
+	[self registerPeriodicTimeObserver];
+}
+
 #pragma mark - Cell reuse
 
 - (void)registerClass:(Class)cellClass forCellWithReuseIdentifier:(NSString *)identifier
@@ -92,12 +131,153 @@ static void commonInit(RTSSegmentedTimelineView *self);
 
 - (void)reloadSegmentsForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSError *error))completionHandler
 {
-	[self.segmentsController reloadSegmentsForIdentifier:identifier completionHandler:^(NSError *error) {
+	[self.segmentsController reloadSegmentsForIdentifier:identifier batchHandler:^(NSIndexSet *insertedVisibleSegmentIndexes) {
+		[self insertSegmentsAtIndexes:insertedVisibleSegmentIndexes];
+	} completionHandler:^(NSError *error) {
 		if (completionHandler) {
 			completionHandler(error);
 		}
+	}];
+}
+
+// Cells are only inserted when segments are merged into those already displayed. Otherwise data is reloaded
+- (void)insertSegmentsAtIndexes:(NSIndexSet *)indexes
+{
+	[self resetCellStates];
+	
+	NSUInteger count = self.segmentsController.visibleSegments.count;
+	if (indexes.count == count || [self.collectionView numberOfItemsInSection:0] + indexes.count != count) {
 		[self.collectionView reloadData];
+		return;
+	}
+	
+	NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray arrayWithCapacity:indexes.count];
+	[indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+		[indexPaths addObject:[NSIndexPath indexPathForRow:idx inSection:0]];
+	}];
+	[self.collectionView insertItemsAtIndexPaths:indexPaths];
+}
+
+#pragma mark - Playhead tracking
+
+// The playhead is only tracked while the view is displayed. Any existing observer is removed first
+- (void)registerPeriodicTimeObserver
+{
+	[self unregisterPeriodicTimeObserver];
+	
+	RTSMediaPlayerController *mediaPlayerController = self.segmentsController.playerController;
+	if (!self.window || !mediaPlayerController) {
+		return;
+	}
+	
+	@weakify(self)
+	self.periodicTimeObserver = [mediaPlayerController addPeriodicTimeObserverForInterval:CMTimeMake(1., 5.) queue:NULL usingBlock:^(CMTime time) {
+		@strongify(self)
+		[self updateWithPlayheadTime:time];
 	}];
+	self.periodicTimeObserverMediaPlayerController = mediaPlayerController;
+}
+
+- (void)unregisterPeriodicTimeObserver
+{
+	if (!self.periodicTimeObserver) {
+		return;
+	}
+	
+	// Observers follow the player when it is handed over to another controller, remove it from both
+	[self.periodicTimeObserverMediaPlayerController removePeriodicTimeObserver:self.periodicTimeObserver];
+	[self.segmentsController.playerController removePeriodicTimeObserver:self.periodicTimeObserver];
+	self.periodicTimeObserver = nil;
+	self.periodicTimeObserverMediaPlayerController = nil;
+}
+
+- (void)mediaPlayerControllerDidTakeOverPlayback:(NSNotification *)notification
+{
+	if (notification.object == self.segmentsController.playerController && notification.object != self.periodicTimeObserverMediaPlayerController) {
+		[self registerPeriodicTimeObserver];
+	}
+}
+
+- (void)updateWithPlayheadTime:(CMTime)time
+{
+	self.playheadTime = time;
+	self.activeSegmentIndex = [self.segmentsController indexOfVisibleSegmentAtTime:time];
+	[self updateVisibleCells];
+}
+
+- (void)updateVisibleCells
+{
+	for (UICollectionViewCell *cell in self.collectionView.visibleCells) {
+		NSIndexPath *indexPath = [self.collectionView indexPathForCell:cell];
+		if (indexPath) {
+			[self updateCell:cell atIndex:indexPath.row force:NO];
+		}
+	}
+}
+
+// Cells are only notified when the state they display changes, so that the cost of a playhead update does not depend
+// on cell implementations. The state encodes the progress step and whether the segment is active
+- (void)updateCell:(UICollectionViewCell *)cell atIndex:(NSUInteger)index force:(BOOL)force
+{
+	if (![cell conformsToProtocol:@protocol(RTSSegmentedTimelineViewCell)]) {
+		return;
+	}
+	
+	if (_cellStatesCount != self.segmentsController.visibleSegments.count) {
+		[self resetCellStates];
+	}
+	
+	if (index >= _cellStatesCount) {
+		return;
+	}
+	
+	NSInteger state = [self stateForSegmentAtIndex:index];
+	if (!force && state == _cellStates[index]) {
+		return;
+	}
+	
+	_cellStates[index] = state;
+	
+	BOOL active = (state % 2 == 1);
+	float progress = (float)(state / 2) / self.progressStepCount;
+	[(id<RTSSegmentedTimelineViewCell>)cell setActive:active progress:progress];
+}
+
+- (NSInteger)stateForSegmentAtIndex:(NSUInteger)index
+{
+	id<RTSMediaSegment> segment = self.segmentsController.visibleSegments[index];
+	
+	float progress = 0.f;
+	if (CMTIME_IS_NUMERIC(self.playheadTime)
+			&& [segment.segmentIdentifier isEqualToString:self.segmentsController.playerController.identifier]) {
+		CMTimeRange timeRange = segment.timeRange;
+		CMTime playheadMediaTime = [self.segmentsController mediaTimeForPlayerTime:self.playheadTime];
+		Float64 elapsed = CMTimeGetSeconds(CMTimeSubtract(playheadMediaTime, timeRange.start));
+		Float64 duration = CMTimeGetSeconds(timeRange.duration);
+		if (duration > 0.) {
+			progress = fmaxf(fminf(elapsed / duration, 1.f), 0.f);
+		}
+		else {
+			progress = (elapsed >= 0.) ? 1.f : 0.f;
+		}
+	}
+	
+	NSInteger step = (NSInteger)floorf(progress * self.progressStepCount);
+	return 2 * step + ((index == self.activeSegmentIndex) ? 1 : 0);
+}
+
+- (void)resetCellStates
+{
+	NSUInteger count = self.segmentsController.visibleSegments.count;
+	if (count != _cellStatesCount) {
+		free(_cellStates);
+		_cellStates = (count != 0) ? malloc(count * sizeof(NSInteger)) : NULL;
+		_cellStatesCount = count;
+	}
+	
+	for (NSUInteger i = 0; i < _cellStatesCount; ++i) {
+		_cellStates[i] = -1;
+	}
 }
 
 #pragma mark - UICollectionViewDataSource protocol
@@ -110,7 +290,9 @@ static void commonInit(RTSSegmentedTimelineView *self);
 - (UICollectionViewCell *)collectionView:(UICollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath
 {
 	id<RTSMediaSegment> segment = self.segmentsController.visibleSegments[indexPath.row];
-	return [self.delegate timelineView:self cellForSegment:segment];
+	UICollectionViewCell *cell = [self.delegate timelineView:self cellForSegment:segment];
+	[self updateCell:cell atIndex:indexPath.row force:YES];
+	return cell;
 }
 
 #pragma mark - UICollectionViewDelegate protocol
@@ -203,6 +385,12 @@ static void commonInit(RTSSegmentedTimelineView *self)
 	[self addSubview:collectionView];
 	self.collectionView = collectionView;
 	
+	// Playhead tracking follows the segments controller when it is handed over to another player controller
+	[[NSNotificationCenter defaultCenter] addObserver:self
+											 selector:@selector(mediaPlayerControllerDidTakeOverPlayback:)
+												 name:RTSMediaPlayerDidTakeOverPlaybackNotification
+											   object:nil];
+	
 	// Remove implicit constraints for views managed by autolayout
 	collectionView.translatesAutoresizingMaskIntoConstraints = NO;
 	
@@ -238,4 +426,7 @@ static void commonInit(RTSSegmentedTimelineView *self)
 	
 	self.itemWidth = 60.f;
 	self.itemSpacing = 4.f;
+	self.progressStepCount = 100;
+	self.playheadTime = kCMTimeInvalid;
+	self.activeSegmentIndex = NSNotFound;
 }
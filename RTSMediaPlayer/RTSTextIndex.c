@@ -0,0 +1,662 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "RTSTextIndex.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longer words are truncated
+#define RTSTextIndexMaximumWordLength 64
+
+// Further words of a query are ignored
+#define RTSTextIndexMaximumQueryWordCount 16
+
+// Maximum length of a position delta, in bytes
+#define RTSTextIndexMaximumDeltaLength 5
+
+// Phrases continue in the next cue only if it starts at most this number of seconds after the previous one ends
+static const double RTSTextIndexMaximumCueGap = 2.;
+
+typedef struct {
+	uint32_t textOffset;			// In the term text of the index
+	uint32_t textLength;
+	uint32_t hash;
+	uint32_t positionCount;
+	uint32_t lastPosition;
+	uint32_t pendingLength;			// Postings length reserved while a cue is being added
+	size_t postingsLength;
+	size_t postingsCapacity;
+	uint8_t *postings;				// Positions of the term, as variable-length deltas
+} RTSTextIndexTerm;
+
+struct RTSTextIndex {
+	double *startTimes;
+	double *endTimes;
+	uint32_t *firstPositions;		// Position of the first word of each cue, non-decreasing
+	size_t cueCount;
+	size_t cueCapacity;
+	uint32_t nextPosition;
+
+	char *termText;					// Text of all terms, one after the other
+	size_t termTextLength;
+	size_t termTextCapacity;
+
+	RTSTextIndexTerm *terms;
+	size_t termCount;
+	size_t termCapacity;
+	size_t postingsCapacity;		// Sum of the postings capacities of all terms
+
+	uint32_t *buckets;				// Hash table of term indexes plus one (0 if empty), with linear probing
+	size_t bucketCount;
+};
+
+// MARK: - Words
+
+static int RTSTextIndexIsWordCharacter(unsigned char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+// Read the next word of a text, lowercased. Return a pointer right after it, NULL if there is none
+static const char *RTSTextIndexNextWord(const char *text, char *word, size_t *pLength)
+{
+	const unsigned char *c = (const unsigned char *)text;
+	while (*c && !RTSTextIndexIsWordCharacter(*c)) {
+		++c;
+	}
+	if (!*c) {
+		return NULL;
+	}
+
+	size_t length = 0;
+	while (*c && (RTSTextIndexIsWordCharacter(*c) || *c == '\'')) {
+		if (*c != '\'' && length < RTSTextIndexMaximumWordLength) {
+			word[length++] = (*c >= 'A' && *c <= 'Z') ? (char)(*c + ('a' - 'A')) : (char)*c;
+		}
+		++c;
+	}
+	*pLength = length;
+	return (const char *)c;
+}
+
+// FNV-1a
+static uint32_t RTSTextIndexHash(const char *word, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= (unsigned char)word[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// MARK: - Terms
+
+static int RTSTextIndexRehash(RTSTextIndexRef index, size_t bucketCount)
+{
+	uint32_t *buckets = calloc(bucketCount, sizeof(uint32_t));
+	if (!buckets) {
+		return 0;
+	}
+
+	size_t mask = bucketCount - 1;
+	for (size_t i = 0; i < index->termCount; ++i) {
+		size_t bucket = index->terms[i].hash & mask;
+		while (buckets[bucket] != 0) {
+			bucket = (bucket + 1) & mask;
+		}
+		buckets[bucket] = (uint32_t)(i + 1);
+	}
+
+	free(index->buckets);
+	index->buckets = buckets;
+	index->bucketCount = bucketCount;
+	return 1;
+}
+
+// Return the index of the term for a word, SIZE_MAX if none (and if it could not be created, when requested)
+static size_t RTSTextIndexTermIndex(RTSTextIndexRef index, const char *word, size_t length, int create)
+{
+	uint32_t hash = RTSTextIndexHash(word, length);
+	size_t mask = index->bucketCount - 1;
+	size_t bucket = hash & mask;
+	for (; index->buckets[bucket] != 0; bucket = (bucket + 1) & mask) {
+		RTSTextIndexTerm *term = &index->terms[index->buckets[bucket] - 1];
+		if (term->hash == hash && term->textLength == length && memcmp(index->termText + term->textOffset, word, length) == 0) {
+			return index->buckets[bucket] - 1;
+		}
+	}
+
+	if (!create || index->termCount >= UINT32_MAX - 1) {
+		return SIZE_MAX;
+	}
+
+	if (index->termCount == index->termCapacity) {
+		size_t termCapacity = 2 * index->termCapacity;
+		RTSTextIndexTerm *terms = realloc(index->terms, termCapacity * sizeof(RTSTextIndexTerm));
+		if (!terms) {
+			return SIZE_MAX;
+		}
+		index->terms = terms;
+		index->termCapacity = termCapacity;
+	}
+
+	if (index->termTextLength + length > index->termTextCapacity) {
+		size_t termTextCapacity = 2 * index->termTextCapacity;
+		while (index->termTextLength + length > termTextCapacity) {
+			termTextCapacity *= 2;
+		}
+		char *termText = realloc(index->termText, termTextCapacity);
+		if (!termText) {
+			return SIZE_MAX;
+		}
+		index->termText = termText;
+		index->termTextCapacity = termTextCapacity;
+	}
+
+	// Keep the hash table at most half full
+	if (2 * (index->termCount + 1) > index->bucketCount) {
+		if (!RTSTextIndexRehash(index, 2 * index->bucketCount)) {
+			return SIZE_MAX;
+		}
+		mask = index->bucketCount - 1;
+		bucket = hash & mask;
+		while (index->buckets[bucket] != 0) {
+			bucket = (bucket + 1) & mask;
+		}
+	}
+
+	RTSTextIndexTerm *term = &index->terms[index->termCount];
+	memset(term, 0, sizeof(RTSTextIndexTerm));
+	term->textOffset = (uint32_t)index->termTextLength;
+	term->textLength = (uint32_t)length;
+	term->hash = hash;
+
+	memcpy(index->termText + index->termTextLength, word, length);
+	index->termTextLength += length;
+
+	index->buckets[bucket] = (uint32_t)(index->termCount + 1);
+	return index->termCount++;
+}
+
+static int RTSTextIndexReservePostings(RTSTextIndexRef index, RTSTextIndexTerm *term, size_t length)
+{
+	if (length <= term->postingsCapacity) {
+		return 1;
+	}
+
+	size_t postingsCapacity = (term->postingsCapacity != 0) ? 2 * term->postingsCapacity : 8;
+	while (postingsCapacity < length) {
+		postingsCapacity *= 2;
+	}
+
+	uint8_t *postings = realloc(term->postings, postingsCapacity);
+	if (!postings) {
+		return 0;
+	}
+
+	index->postingsCapacity += postingsCapacity - term->postingsCapacity;
+	term->postings = postings;
+	term->postingsCapacity = postingsCapacity;
+	return 1;
+}
+
+// Enough space must have been reserved
+static void RTSTextIndexAppendPosition(RTSTextIndexTerm *term, uint32_t position)
+{
+	uint32_t delta = position - term->lastPosition;
+	do {
+		uint8_t byte = delta & 0x7f;
+		delta >>= 7;
+		term->postings[term->postingsLength++] = (delta != 0) ? (byte | 0x80) : byte;
+	} while (delta != 0);
+
+	term->lastPosition = position;
+	++term->positionCount;
+}
+
+// Return the sorted positions of a term, NULL if memory could not be allocated. Must be freed by the caller
+static uint32_t *RTSTextIndexCopyPositions(const RTSTextIndexTerm *term)
+{
+	uint32_t *positions = malloc((term->positionCount != 0 ? term->positionCount : 1) * sizeof(uint32_t));
+	if (!positions) {
+		return NULL;
+	}
+
+	uint32_t position = 0;
+	size_t offset = 0;
+	for (uint32_t i = 0; i < term->positionCount; ++i) {
+		uint32_t delta = 0;
+		int shift = 0;
+		uint8_t byte;
+		do {
+			byte = term->postings[offset++];
+			delta |= (uint32_t)(byte & 0x7f) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+
+		position += delta;
+		positions[i] = position;
+	}
+	return positions;
+}
+
+static int RTSTextIndexContainsPosition(const uint32_t *positions, uint32_t count, uint32_t position)
+{
+	uint32_t low = 0, high = count;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (positions[middle] < position) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low < count && positions[low] == position;
+}
+
+// MARK: - Cues
+
+static int RTSTextIndexReserveCues(RTSTextIndexRef index)
+{
+	if (index->cueCount < index->cueCapacity) {
+		return 1;
+	}
+
+	// Arrays which could be grown keep their larger size if another one cannot
+	size_t cueCapacity = 2 * index->cueCapacity;
+	double *startTimes = realloc(index->startTimes, cueCapacity * sizeof(double));
+	if (!startTimes) {
+		return 0;
+	}
+	index->startTimes = startTimes;
+
+	double *endTimes = realloc(index->endTimes, cueCapacity * sizeof(double));
+	if (!endTimes) {
+		return 0;
+	}
+	index->endTimes = endTimes;
+
+	uint32_t *firstPositions = realloc(index->firstPositions, cueCapacity * sizeof(uint32_t));
+	if (!firstPositions) {
+		return 0;
+	}
+	index->firstPositions = firstPositions;
+
+	index->cueCapacity = cueCapacity;
+	return 1;
+}
+
+// MARK: - Index
+
+RTSTextIndexRef RTSTextIndexCreate(void)
+{
+	RTSTextIndexRef index = calloc(1, sizeof(struct RTSTextIndex));
+	if (!index) {
+		return NULL;
+	}
+
+	index->cueCapacity = 64;
+	index->startTimes = malloc(index->cueCapacity * sizeof(double));
+	index->endTimes = malloc(index->cueCapacity * sizeof(double));
+	index->firstPositions = malloc(index->cueCapacity * sizeof(uint32_t));
+
+	index->termCapacity = 64;
+	index->terms = malloc(index->termCapacity * sizeof(RTSTextIndexTerm));
+
+	index->termTextCapacity = 512;
+	index->termText = malloc(index->termTextCapacity);
+
+	index->bucketCount = 128;
+	index->buckets = calloc(index->bucketCount, sizeof(uint32_t));
+
+	if (!index->startTimes || !index->endTimes || !index->firstPositions || !index->terms || !index->termText || !index->buckets) {
+		RTSTextIndexDestroy(index);
+		return NULL;
+	}
+	return index;
+}
+
+void RTSTextIndexDestroy(RTSTextIndexRef index)
+{
+	if (!index) {
+		return;
+	}
+
+	for (size_t i = 0; i < index->termCount; ++i) {
+		free(index->terms[i].postings);
+	}
+	free(index->terms);
+	free(index->termText);
+	free(index->buckets);
+	free(index->startTimes);
+	free(index->endTimes);
+	free(index->firstPositions);
+	free(index);
+}
+
+size_t RTSTextIndexAddCue(RTSTextIndexRef index, double startTime, double endTime, const char *text)
+{
+	if (!RTSTextIndexReserveCues(index)) {
+		return SIZE_MAX;
+	}
+
+	// Resolve the words of the cue and reserve space for their positions first, so that the index is left unchanged
+	// if memory runs out (except for terms which might have been created)
+	size_t wordCount = 0, wordCapacity = 16;
+	size_t *termIndexes = malloc(wordCapacity * sizeof(size_t));
+	if (!termIndexes) {
+		return SIZE_MAX;
+	}
+
+	char word[RTSTextIndexMaximumWordLength];
+	size_t length = 0;
+	for (const char *c = (text ? text : ""); (c = RTSTextIndexNextWord(c, word, &length)); ) {
+		if (wordCount == wordCapacity) {
+			wordCapacity *= 2;
+			size_t *newTermIndexes = realloc(termIndexes, wordCapacity * sizeof(size_t));
+			if (!newTermIndexes) {
+				goto failure;
+			}
+			termIndexes = newTermIndexes;
+		}
+
+		size_t termIndex = RTSTextIndexTermIndex(index, word, length, 1);
+		if (termIndex == SIZE_MAX) {
+			goto failure;
+		}
+		termIndexes[wordCount++] = termIndex;
+
+		RTSTextIndexTerm *term = &index->terms[termIndex];
+		term->pendingLength += RTSTextIndexMaximumDeltaLength;
+		if (!RTSTextIndexReservePostings(index, term, term->postingsLength + term->pendingLength)) {
+			goto failure;
+		}
+	}
+
+	if (index->nextPosition > UINT32_MAX - wordCount - 1) {
+		goto failure;
+	}
+
+	// Leave a gap between cues which are not contiguous, so that phrases cannot span them
+	if (index->cueCount != 0) {
+		double previousStartTime = index->startTimes[index->cueCount - 1];
+		double previousEndTime = index->endTimes[index->cueCount - 1];
+		if (startTime < previousStartTime || startTime - previousEndTime > RTSTextIndexMaximumCueGap) {
+			++index->nextPosition;
+		}
+	}
+
+	index->startTimes[index->cueCount] = startTime;
+	index->endTimes[index->cueCount] = endTime;
+	index->firstPositions[index->cueCount] = index->nextPosition;
+
+	for (size_t i = 0; i < wordCount; ++i) {
+		RTSTextIndexTerm *term = &index->terms[termIndexes[i]];
+		term->pendingLength = 0;
+		RTSTextIndexAppendPosition(term, index->nextPosition++);
+	}
+
+	free(termIndexes);
+	return index->cueCount++;
+
+failure:
+	for (size_t i = 0; i < index->termCount; ++i) {
+		index->terms[i].pendingLength = 0;
+	}
+	free(termIndexes);
+	return SIZE_MAX;
+}
+
+// MARK: - Search
+
+// Return YES iff the first match is worse than the second one
+static int RTSTextIndexIsWorseMatch(const RTSTextIndexMatch *match1, const RTSTextIndexMatch *match2)
+{
+	if (match1->score != match2->score) {
+		return match1->score < match2->score;
+	}
+	if (match1->startTime != match2->startTime) {
+		return match1->startTime > match2->startTime;
+	}
+	return match1->cueIndex > match2->cueIndex;
+}
+
+static int RTSTextIndexCompareMatches(const void *pointer1, const void *pointer2)
+{
+	const RTSTextIndexMatch *match1 = pointer1, *match2 = pointer2;
+	return RTSTextIndexIsWorseMatch(match1, match2) - RTSTextIndexIsWorseMatch(match2, match1);
+}
+
+// Restore the heap property (worst match at the root) below the specified node
+static void RTSTextIndexSiftDown(RTSTextIndexMatch *heap, size_t count, size_t node)
+{
+	for (;;) {
+		size_t worst = node;
+		size_t left = 2 * node + 1, right = left + 1;
+		if (left < count && RTSTextIndexIsWorseMatch(&heap[left], &heap[worst])) {
+			worst = left;
+		}
+		if (right < count && RTSTextIndexIsWorseMatch(&heap[right], &heap[worst])) {
+			worst = right;
+		}
+		if (worst == node) {
+			return;
+		}
+
+		RTSTextIndexMatch match = heap[node];
+		heap[node] = heap[worst];
+		heap[worst] = match;
+		node = worst;
+	}
+}
+
+// Find the cue containing a position, starting from a cue located at or before it. Positions being looked up in
+// increasing order, cues are searched with exponentially growing steps, then a binary search
+static uint32_t RTSTextIndexNextCueIndexForPosition(RTSTextIndexRef index, uint32_t cueIndex, uint32_t position)
+{
+	size_t step = 1;
+	size_t low = cueIndex + 1, high = low;
+	while (high < index->cueCount && index->firstPositions[high] <= position) {
+		low = high + 1;
+		high += step;
+		step *= 2;
+	}
+	if (high > index->cueCount) {
+		high = index->cueCount;
+	}
+
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (index->firstPositions[middle] <= position) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return (uint32_t)(low - 1);
+}
+
+size_t RTSTextIndexSearch(RTSTextIndexRef index, const char *query, RTSTextIndexMatch *matches, size_t maximumCount)
+{
+	if (!query || maximumCount == 0 || index->cueCount == 0) {
+		return 0;
+	}
+
+	// Query words, in order (SIZE_MAX if not indexed)
+	size_t queryTermIndexes[RTSTextIndexMaximumQueryWordCount];
+	size_t queryWordCount = 0;
+
+	char word[RTSTextIndexMaximumWordLength];
+	size_t length = 0;
+	for (const char *c = query; queryWordCount < RTSTextIndexMaximumQueryWordCount && (c = RTSTextIndexNextWord(c, word, &length)); ) {
+		size_t termIndex = RTSTextIndexTermIndex(index, word, length, 0);
+
+		// Terms created for a cue which could not be added have no positions
+		queryTermIndexes[queryWordCount++] = (termIndex != SIZE_MAX && index->terms[termIndex].positionCount != 0) ? termIndex : SIZE_MAX;
+	}
+	if (queryWordCount == 0) {
+		return 0;
+	}
+
+	uint32_t *positions[RTSTextIndexMaximumQueryWordCount] = { NULL };
+	int distinct[RTSTextIndexMaximumQueryWordCount] = { 0 };
+	double *scores = NULL;
+	unsigned char *phrases = NULL;
+	uint32_t *cueIndexes = NULL;
+	size_t matchCount = 0;
+
+	// Scores are accumulated per cue. Distinct words are weighted by their inverse document frequency, missing words
+	// weighing as much as the rarest ones
+	scores = calloc(index->cueCount, sizeof(double));
+	phrases = calloc(index->cueCount, sizeof(unsigned char));
+	if (!scores || !phrases) {
+		goto exit;
+	}
+
+	int phrasePossible = 1;
+	double totalWeight = 0.;
+	size_t rarestWordIndex = 0;
+
+	for (size_t i = 0; i < queryWordCount; ++i) {
+		size_t termIndex = queryTermIndexes[i];
+		if (termIndex == SIZE_MAX) {
+			phrasePossible = 0;
+			totalWeight += log(1. + index->cueCount);
+			continue;
+		}
+
+		const RTSTextIndexTerm *term = &index->terms[termIndex];
+		if (queryTermIndexes[rarestWordIndex] == SIZE_MAX || term->positionCount < index->terms[queryTermIndexes[rarestWordIndex]].positionCount) {
+			rarestWordIndex = i;
+		}
+
+		distinct[i] = 1;
+		for (size_t j = 0; j < i; ++j) {
+			if (queryTermIndexes[j] == termIndex) {
+				distinct[i] = 0;
+				positions[i] = positions[j];
+				break;
+			}
+		}
+		if (!distinct[i]) {
+			continue;
+		}
+
+		positions[i] = RTSTextIndexCopyPositions(term);
+		uint32_t *newCueIndexes = realloc(cueIndexes, term->positionCount * sizeof(uint32_t));
+		if (!positions[i] || !newCueIndexes) {
+			free(newCueIndexes ? newCueIndexes : cueIndexes);
+			cueIndexes = NULL;
+			goto exit;
+		}
+		cueIndexes = newCueIndexes;
+
+		// Positions are sorted, thus so are the cues containing them
+		size_t cueCount = 0;
+		uint32_t cueIndex = 0;
+		for (uint32_t j = 0; j < term->positionCount; ++j) {
+			cueIndex = RTSTextIndexNextCueIndexForPosition(index, (j == 0) ? 0 : cueIndex, positions[i][j]);
+			if (cueCount == 0 || cueIndexes[cueCount - 1] != cueIndex) {
+				cueIndexes[cueCount++] = cueIndex;
+			}
+		}
+
+		double weight = log(1. + (double)index->cueCount / cueCount);
+		totalWeight += weight;
+		for (size_t j = 0; j < cueCount; ++j) {
+			scores[cueIndexes[j]] += weight;
+		}
+	}
+
+	// Phrases are located from the positions of their rarest word
+	if (phrasePossible) {
+		uint32_t positionCount = index->terms[queryTermIndexes[rarestWordIndex]].positionCount;
+		uint32_t cueIndex = 0;
+		for (uint32_t j = 0; j < positionCount; ++j) {
+			if (positions[rarestWordIndex][j] < rarestWordIndex) {
+				continue;
+			}
+
+			uint32_t position = positions[rarestWordIndex][j] - (uint32_t)rarestWordIndex;
+			int found = 1;
+			for (size_t i = 0; i < queryWordCount && found; ++i) {
+				found = (i == rarestWordIndex) || RTSTextIndexContainsPosition(positions[i], index->terms[queryTermIndexes[i]].positionCount, position + (uint32_t)i);
+			}
+			if (found) {
+				cueIndex = RTSTextIndexNextCueIndexForPosition(index, (position < index->firstPositions[cueIndex]) ? 0 : cueIndex, position);
+				phrases[cueIndex] = 1;
+			}
+		}
+	}
+
+	// Keep the best matches in a heap whose root is the worst of them
+	for (size_t cueIndex = 0; cueIndex < index->cueCount; ++cueIndex) {
+		if (scores[cueIndex] == 0. && !phrases[cueIndex]) {
+			continue;
+		}
+
+		RTSTextIndexMatch match;
+		match.cueIndex = cueIndex;
+		match.startTime = index->startTimes[cueIndex];
+		match.endTime = index->endTimes[cueIndex];
+		match.score = ((totalWeight > 0.) ? scores[cueIndex] / totalWeight : 0.) + (phrases[cueIndex] ? 1. : 0.);
+		match.phrase = phrases[cueIndex];
+
+		if (matchCount < maximumCount) {
+			matches[matchCount++] = match;
+			if (matchCount == maximumCount) {
+				for (size_t node = matchCount / 2; node-- > 0; ) {
+					RTSTextIndexSiftDown(matches, matchCount, node);
+				}
+			}
+		}
+		else if (RTSTextIndexIsWorseMatch(&matches[0], &match)) {
+			matches[0] = match;
+			RTSTextIndexSiftDown(matches, matchCount, 0);
+		}
+	}
+
+	qsort(matches, matchCount, sizeof(RTSTextIndexMatch), RTSTextIndexCompareMatches);
+
+exit:
+	for (size_t i = 0; i < queryWordCount; ++i) {
+		if (distinct[i]) {
+			free(positions[i]);
+		}
+	}
+	free(cueIndexes);
+	free(scores);
+	free(phrases);
+	return matchCount;
+}
+
+// MARK: - Statistics
+
+size_t RTSTextIndexGetCueCount(RTSTextIndexRef index)
+{
+	return index->cueCount;
+}
+
+size_t RTSTextIndexGetTermCount(RTSTextIndexRef index)
+{
+	return index->termCount;
+}
+
+size_t RTSTextIndexGetMemorySize(RTSTextIndexRef index)
+{
+	return sizeof(struct RTSTextIndex)
+		+ index->cueCapacity * (2 * sizeof(double) + sizeof(uint32_t))
+		+ index->termTextCapacity
+		+ index->termCapacity * sizeof(RTSTextIndexTerm)
+		+ index->postingsCapacity
+		+ index->bucketCount * sizeof(uint32_t);
+}
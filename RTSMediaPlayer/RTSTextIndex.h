@@ -0,0 +1,76 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef RTSTextIndex_h
+#define RTSTextIndex_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  A compact inverted index over timed text cues (e.g. captions), answering phrase queries with the cues where the
+ *  phrase is said, ranked by match. Cues are added incrementally, in any order, and can be searched at any time.
+ *
+ *  Words are maximal runs of ASCII letters and digits and of non-ASCII bytes (apostrophes are ignored within words).
+ *  ASCII letters are lowercased, other characters must be normalized by the caller (e.g. case and diacritics folding)
+ *  for the text and the queries alike. Word positions are stored as variable-length deltas per word, so that the index
+ *  typically occupies less memory than the text itself.
+ *
+ *  This is plain C99 with no platform dependency. An index is not thread-safe and must be used from one thread at a
+ *  time
+ */
+typedef struct RTSTextIndex *RTSTextIndexRef;
+
+/**
+ *  A cue matching a query
+ */
+typedef struct {
+	size_t cueIndex;			// Index of the cue, in the order cues were added
+	double startTime;
+	double endTime;
+	double score;				// Between 0 and 2, higher for better matches
+	int phrase;					// Non-zero iff the query words appear in sequence, starting within the cue
+} RTSTextIndexMatch;
+
+/**
+ *  Create an empty index, NULL if memory could not be allocated. Destroy it with `RTSTextIndexDestroy`
+ */
+RTSTextIndexRef RTSTextIndexCreate(void);
+void RTSTextIndexDestroy(RTSTextIndexRef index);
+
+/**
+ *  Add a cue spanning the specified times, with UTF-8 text. Return the index of the cue, or `(size_t)-1` if memory could
+ *  not be allocated (the index is then left unchanged).
+ *
+ *  Phrases can span consecutive cues, provided the second cue starts at most a couple of seconds after the first one
+ *  ends (captions often split sentences across cues)
+ */
+size_t RTSTextIndexAddCue(RTSTextIndexRef index, double startTime, double endTime, const char *text);
+
+/**
+ *  Search cues matching a UTF-8 query. The best matches (at most `maximumCount`) are written into `matches`, sorted by
+ *  decreasing score, then by start time. Return the number of matches written.
+ *
+ *  Cues where the whole phrase starts score above 1. Other cues score below 1, according to the words they contain,
+ *  rare words weighing more than common ones
+ */
+size_t RTSTextIndexSearch(RTSTextIndexRef index, const char *query, RTSTextIndexMatch *matches, size_t maximumCount);
+
+/**
+ *  The number of cues, of distinct words (terms) and the memory used by the index, in bytes
+ */
+size_t RTSTextIndexGetCueCount(RTSTextIndexRef index);
+size_t RTSTextIndexGetTermCount(RTSTextIndexRef index);
+size_t RTSTextIndexGetMemorySize(RTSTextIndexRef index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,132 @@
+//
+//  Copyright (c) SRG. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+// Standalone benchmark of the caption text index, built outside of the library with RTSTextIndexBenchmark.mk. Cues are
+// generated from a fixed seed, so that runs are reproducible:
+//
+//     make -f RTSTextIndexBenchmark.mk run [CUE_COUNT=200000]
+
+#include "RTSTextIndex.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RTSTextIndexBenchmarkVocabularySize 20000
+#define RTSTextIndexBenchmarkMatchCount 20
+
+static const char *RTSTextIndexBenchmarkCommonWords[] = {
+	"the", "of", "and", "to", "a", "in", "is", "that", "for", "it", "on", "with", "as", "was", "federal", "council",
+	"we", "they", "this", "be", "at", "by", "not", "are", "from", "have", "has", "but", "what", "all"
+};
+
+static const char *RTSTextIndexBenchmarkQueries[] = {
+	"the", "federal council", "of the federal council", "zyqaxu", "voted against the proposal"
+};
+
+// Deterministic generator (xorshift), independent of the C library
+static uint32_t s_state = 2463534242u;
+
+static uint32_t RandomNumber(void)
+{
+	s_state ^= s_state << 13;
+	s_state ^= s_state >> 17;
+	s_state ^= s_state << 5;
+	return s_state;
+}
+
+static double Now(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+// Pronounceable words of 3 to 9 letters
+static void MakeWord(char *word)
+{
+	static const char consonants[] = "bcdfghjklmnprstvwxz";
+	static const char vowels[] = "aeiouy";
+
+	size_t length = 3 + RandomNumber() % 7;
+	for (size_t i = 0; i < length; ++i) {
+		word[i] = (i % 2 == 0) ? consonants[RandomNumber() % (sizeof(consonants) - 1)] : vowels[RandomNumber() % (sizeof(vowels) - 1)];
+	}
+	word[length] = '\0';
+}
+
+int main(int argc, char *argv[])
+{
+	size_t cueCount = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200000;
+	size_t commonWordCount = sizeof(RTSTextIndexBenchmarkCommonWords) / sizeof(RTSTextIndexBenchmarkCommonWords[0]);
+
+	static char vocabulary[RTSTextIndexBenchmarkVocabularySize][10];
+	for (size_t i = 0; i < RTSTextIndexBenchmarkVocabularySize; ++i) {
+		MakeWord(vocabulary[i]);
+	}
+
+	// Generate all cues first, so that only indexing is measured. About half of the words are common ones, the other
+	// ones roughly follow a Zipf distribution over the vocabulary
+	char **texts = malloc(cueCount * sizeof(char *));
+	size_t textByteCount = 0;
+	for (size_t i = 0; i < cueCount; ++i) {
+		char text[256];
+		size_t length = 0;
+		size_t wordCount = 5 + RandomNumber() % 6;
+		for (size_t j = 0; j < wordCount; ++j) {
+			const char *word = NULL;
+			if (RandomNumber() % 2 == 0) {
+				word = RTSTextIndexBenchmarkCommonWords[RandomNumber() % commonWordCount];
+			}
+			else {
+				size_t rank = (size_t)RandomNumber() % RTSTextIndexBenchmarkVocabularySize + 1;
+				word = vocabulary[(size_t)RandomNumber() % rank];
+			}
+			length += (size_t)snprintf(text + length, sizeof(text) - length, (j == 0) ? "%s" : " %s", word);
+		}
+		texts[i] = malloc(length + 1);
+		memcpy(texts[i], text, length + 1);
+		textByteCount += length;
+	}
+
+	RTSTextIndexRef index = RTSTextIndexCreate();
+	if (!index) {
+		fprintf(stderr, "The index could not be created\n");
+		return EXIT_FAILURE;
+	}
+
+	double startTime = Now();
+	for (size_t i = 0; i < cueCount; ++i) {
+		RTSTextIndexAddCue(index, 2. * i, 2. * i + 1.8, texts[i]);
+	}
+	double indexingDuration = Now() - startTime;
+
+	printf("%zu cues (%.1f MB of text)\n", cueCount, textByteCount / 1e6);
+	printf("indexing: %.3f s (%.2f us per cue)\n", indexingDuration, indexingDuration * 1e6 / cueCount);
+	printf("index memory: %.1f MB for %zu terms\n", RTSTextIndexGetMemorySize(index) / 1e6, RTSTextIndexGetTermCount(index));
+
+	RTSTextIndexMatch matches[RTSTextIndexBenchmarkMatchCount];
+	for (size_t i = 0; i < sizeof(RTSTextIndexBenchmarkQueries) / sizeof(RTSTextIndexBenchmarkQueries[0]); ++i) {
+		const char *query = RTSTextIndexBenchmarkQueries[i];
+
+		// Average over several runs, single queries on rare words being too fast to be measured
+		static const size_t runCount = 10;
+		size_t matchCount = 0;
+		startTime = Now();
+		for (size_t run = 0; run < runCount; ++run) {
+			matchCount = RTSTextIndexSearch(index, query, matches, RTSTextIndexBenchmarkMatchCount);
+		}
+		double searchDuration = (Now() - startTime) / runCount;
+		printf("query \"%s\": %.3f ms (%zu matches)\n", query, searchDuration * 1e3, matchCount);
+	}
+
+	RTSTextIndexDestroy(index);
+	for (size_t i = 0; i < cueCount; ++i) {
+		free(texts[i]);
+	}
+	free(texts);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,34 @@
+#
+#  Copyright (c) SRG. All rights reserved.
+#
+#  License information is available from the LICENSE file.
+#
+
+# Standalone build of the caption text index benchmark, with any C99 compiler (the index has no platform dependency):
+#
+#     make -f RTSTextIndexBenchmark.mk run [CUE_COUNT=200000]
+
+SOURCE_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
+BUILD_DIR ?= $(SOURCE_DIR)build
+
+CC ?= cc
+CFLAGS ?= -O2
+CFLAGS += -std=c99 -Wall -Wextra
+LDLIBS += -lm
+CUE_COUNT ?= 200000
+
+BENCHMARK := $(BUILD_DIR)/RTSTextIndexBenchmark
+
+.PHONY: all run clean
+
+all: $(BENCHMARK)
+
+$(BENCHMARK): $(SOURCE_DIR)RTSTextIndex.c $(SOURCE_DIR)RTSTextIndexBenchmark.c $(SOURCE_DIR)RTSTextIndex.h
+	@mkdir -p $(BUILD_DIR)
+	$(CC) $(CFLAGS) -o $@ $(SOURCE_DIR)RTSTextIndex.c $(SOURCE_DIR)RTSTextIndexBenchmark.c $(LDLIBS)
+
+run: $(BENCHMARK)
+	$(BENCHMARK) $(CUE_COUNT)
+
+clean:
+	rm -rf $(BUILD_DIR)
@@ -11,6 +11,7 @@
 #import "UIBezierPath+RTSMediaPlayerUtils.h"
 
 #import <SRGMediaPlayer/RTSMediaPlayerController.h>
+#import <SRGMediaPlayer/RTSMediaTimeRangeSet.h>
 #import <libextobjc/EXTScope.h>
 
 #define SLIDER_VERTICAL_CENTER self.frame.size.height/2
@@ -286,24 +287,27 @@ static NSString *RTSTimeSliderFormatter(NSTimeInterval seconds)
 	CGContextSetStrokeColorWithColor(context, self.maximumTrackTintColor.CGColor);
 	CGContextStrokePath(context);
 	
-	for (NSValue *value in self.mediaPlayerController.playerItem.loadedTimeRanges) {
-		CMTimeRange timeRange = [value CMTimeRangeValue];
-		[self drawTimeRangeProgress:timeRange context:context];
+	CGFloat duration = CMTimeGetSeconds(self.mediaPlayerController.playerItem.duration);
+	if (isnan(duration))
+		return;
+	
+	RTSMediaTimeRangeSet *loadedTimeRangeSet = self.mediaPlayerController.loadedTimeRangeSet;
+	for (NSUInteger i = 0; i < loadedTimeRangeSet.count; ++i) {
+		[self drawTimeRangeProgressFromTime:[loadedTimeRangeSet startTimeAtIndex:i]
+									 toTime:[loadedTimeRangeSet endTimeAtIndex:i]
+								   duration:duration
+									context:context];
 	}
 }
 
-- (void)drawTimeRangeProgress:(CMTimeRange)timeRange context:(CGContextRef)context
+- (void)drawTimeRangeProgressFromTime:(NSTimeInterval)startTime toTime:(NSTimeInterval)endTime duration:(CGFloat)duration context:(CGContextRef)context
 {
 	CGFloat lineWidth = 1.0f;
 	
-	CGFloat duration = CMTimeGetSeconds(self.mediaPlayerController.playerItem.duration);
-	if (isnan(duration))
-		return;
-	
 	CGRect trackFrame = [self trackRectForBounds:self.bounds];
 	
-	CGFloat minX = CGRectGetWidth(trackFrame) / duration * CMTimeGetSeconds(timeRange.start);
-	CGFloat maxX = CGRectGetWidth(trackFrame) / duration * (CMTimeGetSeconds(timeRange.start)+CMTimeGetSeconds(timeRange.duration));
+	CGFloat minX = CGRectGetWidth(trackFrame) / duration * startTime;
+	CGFloat maxX = CGRectGetWidth(trackFrame) / duration * endTime;
 	
 	CGContextSetLineWidth(context, lineWidth);
 	CGContextSetLineCap(context,kCGLineCapButt);
@@ -32,7 +32,8 @@
 @property (nonatomic, weak) IBOutlet id<RTSTimelineSliderDelegate> delegate;
 
 /**
- *  Call this method to trigger a reload of the segments from the data source
+ *  Call this method to trigger a reload of the segments from the data source. Segments delivered progressively by the
+ *  data source are drawn as they are received
  */
 - (void)reloadSegmentsForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSError *error))completionHandler;
 
@@ -69,14 +69,17 @@
 	CGFloat thumbEndXPos = CGRectGetMidX([self thumbRectForBounds:rect trackRect:trackRect value:self.maximumValue]);
 	
 	for (id<RTSMediaSegment> segment in self.segmentsController.visibleSegments) {	
+		// The timeline displays player times, which differ from media times if time ranges have been removed
+		CMTime startTime = [self.segmentsController playerTimeForMediaTime:segment.timeRange.start];
+		
 		// Skip events not in the timeline
-		if (CMTIME_COMPARE_INLINE(segment.timeRange.start, < , timeRange.start)
-			|| CMTIME_COMPARE_INLINE(segment.timeRange.start, >, CMTimeRangeGetEnd(timeRange)))
+		if (CMTIME_COMPARE_INLINE(startTime, < , timeRange.start)
+			|| CMTIME_COMPARE_INLINE(startTime, >, CMTimeRangeGetEnd(timeRange)))
 		{
 			continue;
 		}
 		
-		CGFloat tickXPos = thumbStartXPos + (CMTimeGetSeconds(segment.timeRange.start) / CMTimeGetSeconds(timeRange.duration)) * (thumbEndXPos - thumbStartXPos);
+		CGFloat tickXPos = thumbStartXPos + (CMTimeGetSeconds(startTime) / CMTimeGetSeconds(timeRange.duration)) * (thumbEndXPos - thumbStartXPos);
 		
 		UIImage *iconImage = nil;
 		if ([self.delegate respondsToSelector:@selector(timelineSlider:iconImageForSegment:)]) {
@@ -115,7 +118,9 @@
 
 - (void)reloadSegmentsForIdentifier:(NSString *)identifier completionHandler:(void (^)(NSError *error))completionHandler
 {
-	[self.segmentsController reloadSegmentsForIdentifier:identifier completionHandler:^(NSError *error){
+	[self.segmentsController reloadSegmentsForIdentifier:identifier batchHandler:^(NSIndexSet *insertedVisibleSegmentIndexes) {
+		[self setNeedsDisplay];
+	} completionHandler:^(NSError *error){
 		[self setNeedsDisplay];
 		if (completionHandler) {
 			completionHandler(error);
@@ -4,11 +4,22 @@
 //  License information is available from the LICENSE file.
 //
 
+#import <SRGMediaPlayer/RTSMediaBlackoutSchedule.h>
+#import <SRGMediaPlayer/RTSMediaCaptionIndex.h>
+#import <SRGMediaPlayer/RTSMediaPlayerBufferBudget.h>
+#import <SRGMediaPlayer/RTSMediaPlayerCommandQueue.h>
 #import <SRGMediaPlayer/RTSMediaPlayerConstants.h>
 #import <SRGMediaPlayer/RTSMediaPlayerController.h>
 #import <SRGMediaPlayer/RTSMediaPlayerControllerDataSource.h>
 #import <SRGMediaPlayer/RTSMediaPlayerError.h>
+#import <SRGMediaPlayer/RTSMediaPlayerStallWatchdog.h>
 #import <SRGMediaPlayer/RTSMediaPlayerViewController.h>
+#import <SRGMediaPlayer/RTSMediaPlayerZappingController.h>
+#import <SRGMediaPlayer/RTSMediaPlaylistRewriter.h>
+#import <SRGMediaPlayer/RTSMediaPrecache.h>
+#import <SRGMediaPlayer/RTSMediaTimeshiftBuffer.h>
+#import <SRGMediaPlayer/RTSMediaTimeshiftRecorder.h>
+#import <SRGMediaPlayer/RTSMediaWatchedRangeTracker.h>
 
 // Overlay Views
 #import <SRGMediaPlayer/RTSMediaPlayerPlaybackButton.h>
@@ -32,3 +43,5 @@
 #import <SRGMediaPlayer/NSBundle+RTSMediaPlayer.h>
 #import <SRGMediaPlayer/RTSActivityGestureRecognizer.h>
 #import <SRGMediaPlayer/RTSMediaPlayerVersion.h>
+#import <SRGMediaPlayer/RTSMediaTimeRangeSet.h>
+#import <SRGMediaPlayer/RTSMediaTimeSchedule.h>